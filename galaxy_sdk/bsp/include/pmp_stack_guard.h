@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __PMP_STACK_GUARD_H__
+#define __PMP_STACK_GUARD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup PMP_STACK_GUARD
+ *  @brief PMP guard region below the stack of the running task
+ *  @ingroup BSP
+ *  @{
+ */
+
+#include <stdint.h>
+#include "vs_conf.h"
+
+/**
+ * Size of the guard in bytes, a power of 2, raised to the PMP granularity.
+ * Up to twice this size at the bottom of each stack becomes unusable
+ */
+#ifndef CONFIG_PMP_STACK_GUARD_SIZE
+#define CONFIG_PMP_STACK_GUARD_SIZE 32
+#endif
+
+/** PMP entry of the guard, entry 0 so that it has the highest priority */
+#define PMP_STACK_GUARD_ENTRY 0
+
+/**
+ * @brief Enable the guard, it is placed on the next task switch
+ * @note Needs CONFIG_PMP_STACK_GUARD for the port hooks, and the Smepmp rule
+ * locking bypass (mseccfg.RLB) since a guard for machine mode must be locked
+ * @return VSD_SUCCESS on success, VSD_ERR_UNSUPPORTED without Smepmp or RLB
+ */
+int pmp_stack_guard_init(void);
+
+/**
+ * @brief Open the guard, for code reading the bottom of task stacks
+ * @note The guard sits inside the bottom of the running task's stack, so
+ * uxTaskGetSystemState and uxTaskGetStackHighWaterMark, which scan it, must
+ * be called between pmp_stack_guard_open and pmp_stack_guard_close. Calls
+ * nest, no task is guarded while the guard is open. Without
+ * pmp_stack_guard_init both do nothing
+ * @note The prebuilt osal_dump_os_state scans the stacks too and faults on
+ * the guard unless it is called while the guard is open
+ */
+void pmp_stack_guard_open(void);
+
+/**
+ * @brief Close the guard again after pmp_stack_guard_open
+ */
+void pmp_stack_guard_close(void);
+
+/** Hooks called from portasm.S when CONFIG_PMP_STACK_GUARD is set */
+void pmp_guard_switch(void *tcb);
+void pmp_guard_exc_enter(uint32_t mcause, uint32_t sp);
+void pmp_guard_exc_exit(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PMP_STACK_GUARD_H__ */
@@ -35,6 +35,7 @@ extern "C" {
 
 #include <stdint.h>
 #include "platform.h"
+#include "vs_conf.h"
 /*-----------------------------------------------------------
  * Port specific definitions.
  *
@@ -99,12 +100,24 @@ typedef uint32_t TickType_t;
 extern void vPortEnterCritical(void);
 extern void vPortExitCritical(void);
 extern void vPortYield(void);
+#if CONFIG_LATENCY_STATS
+/* Time the sections entered from SDK and application code, see latency_stats.h */
+extern void latency_crit_enter(void);
+extern void latency_crit_exit(void);
+extern uint8_t latency_crit_enter_isr(void);
+extern void latency_crit_exit_isr(uint8_t mask);
+#define portSET_INTERRUPT_MASK_FROM_ISR()    latency_crit_enter_isr()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x) latency_crit_exit_isr(x)
+#define portENTER_CRITICAL()                 latency_crit_enter()
+#define portEXIT_CRITICAL()                  latency_crit_exit()
+#else
 #define portSET_INTERRUPT_MASK_FROM_ISR()    ulPortRaiseBASEPRI()
 #define portCLEAR_INTERRUPT_MASK_FROM_ISR(x) vPortSetBASEPRI(x)
-#define portDISABLE_INTERRUPTS()             vPortRaiseBASEPRI()
-#define portENABLE_INTERRUPTS()              vPortSetBASEPRI(0)
 #define portENTER_CRITICAL()                 vPortEnterCritical()
 #define portEXIT_CRITICAL()                  vPortExitCritical()
+#endif
+#define portDISABLE_INTERRUPTS()             vPortRaiseBASEPRI()
+#define portENABLE_INTERRUPTS()              vPortSetBASEPRI(0)
 
 /*-----------------------------------------------------------*/
 /* Timer functionality */
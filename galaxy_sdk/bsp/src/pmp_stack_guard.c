@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include "pmp_stack_guard.h"
+#include "vsd_error.h"
+#include "sys_common.h"
+#include "bsp_common.h"
+#include "platform.h"
+#include "uart_printf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define MSECCFG_RLB         BIT(2)
+#define PMP_GUARD_CFG       (PMP_L | PMP_A_NAPOT)
+#define PMP_GUARD_CFG_MASK  0xFFUL
+
+typedef struct PmpGuard {
+    uint32_t size;
+    uint32_t base;
+    void *task;
+    volatile uint32_t open;
+    volatile bool enabled;
+} PmpGuard;
+
+extern void vApplicationStackOverflowHook(TaskHandle_t task, char *name);
+
+static PmpGuard g_pmp_guard;
+
+/*
+ * Read mseccfg under a temporary trap handler, a core without Smepmp raises
+ * an illegal instruction that skips the read. The handler keeps the mode
+ * bits of mtvec and the 64 bytes alignment of CLIC mode
+ */
+static bool pmp_has_smepmp(void)
+{
+    uint32_t found, mie;
+
+    mie = __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+    __ASM volatile("   la    t0, 2f\n"
+                   "   csrr  t1, mtvec\n"
+                   "   andi  t2, t1, 0x3F\n"
+                   "   or    t0, t0, t2\n"
+                   "   csrw  mtvec, t0\n"
+                   "   li    %0, 1\n"
+                   "   csrr  t2, %1\n"
+                   "   j     3f\n"
+                   "   .balign 64\n"
+                   "2: csrr  t2, mepc\n"
+                   "   addi  t2, t2, 4\n"
+                   "   csrw  mepc, t2\n"
+                   "   li    %0, 0\n"
+                   "   mret\n"
+                   "3: csrw  mtvec, t1\n"
+                   : "=&r"(found)
+                   : "i"(CSR_MSECCFG)
+                   : "t0", "t1", "t2", "memory");
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+    return found != 0;
+}
+
+/* Granularity is found by writing all ones to an OFF entry, see the privileged spec */
+static uint32_t pmp_granularity(void)
+{
+    uint32_t cfg, addr, gran;
+
+    cfg  = __RV_CSR_READ(CSR_PMPCFG0) & PMP_GUARD_CFG_MASK;
+    addr = __RV_CSR_READ(CSR_PMPADDR0);
+    __RV_CSR_CLEAR(CSR_PMPCFG0, PMP_GUARD_CFG_MASK);
+    __RV_CSR_WRITE(CSR_PMPADDR0, 0xFFFFFFFFUL);
+    gran = __RV_CSR_READ(CSR_PMPADDR0);
+    __RV_CSR_WRITE(CSR_PMPADDR0, addr);
+    __RV_CSR_SET(CSR_PMPCFG0, cfg);
+    if (!gran) {
+        return 0;
+    }
+    return 1UL << (__builtin_ctz(gran) + 2);
+}
+
+int pmp_stack_guard_init(void)
+{
+    uint32_t gran;
+
+    if (!pmp_has_smepmp()) {
+        return VSD_ERR_UNSUPPORTED;
+    }
+    /* Without RLB a locked entry could never be moved again */
+    __RV_CSR_SET(CSR_MSECCFG, MSECCFG_RLB);
+    if (!(__RV_CSR_READ(CSR_MSECCFG) & MSECCFG_RLB)) {
+        return VSD_ERR_UNSUPPORTED;
+    }
+    gran = pmp_granularity();
+    if (!gran) {
+        return VSD_ERR_UNSUPPORTED;
+    }
+
+    g_pmp_guard.size    = MAX(MAX(gran, CONFIG_PMP_STACK_GUARD_SIZE), 8U);
+    g_pmp_guard.base    = 0;
+    g_pmp_guard.task    = NULL;
+    g_pmp_guard.open    = 0;
+    g_pmp_guard.enabled = true;
+    return VSD_SUCCESS;
+}
+
+CRITICAL_SECTION
+void pmp_guard_switch(void *tcb)
+{
+    uint32_t stack, base;
+
+    if (!g_pmp_guard.enabled || !tcb) {
+        return;
+    }
+    /* StaticTask_t mirrors the TCB, pxDummy6 is pxStack, the lowest address */
+    stack = (uint32_t)(uintptr_t)((StaticTask_t *)tcb)->pxDummy6;
+    base  = (stack + g_pmp_guard.size - 1) & ~(g_pmp_guard.size - 1);
+
+    /* NAPOT: base >> 2 with size / 8 - 1 in the low bits */
+    __RV_CSR_WRITE(CSR_PMPADDR0, (base >> 2) | ((g_pmp_guard.size >> 3) - 1));
+    if (!g_pmp_guard.task) {
+        __RV_CSR_CLEAR(CSR_PMPCFG0, PMP_GUARD_CFG_MASK);
+        __RV_CSR_SET(CSR_PMPCFG0, g_pmp_guard.open ? PMP_L : PMP_GUARD_CFG);
+    }
+    g_pmp_guard.base = base;
+    g_pmp_guard.task = tcb;
+}
+
+/*
+ * exc_entry opened the guard before saving the context, which now may have
+ * been written below the stack. Only report and stop here
+ */
+void pmp_guard_exc_enter(uint32_t mcause, uint32_t sp)
+{
+    uint32_t cause = mcause & MCAUSE_CAUSE;
+    uint32_t addr  = __RV_CSR_READ(CSR_MTVAL);
+    void *task     = g_pmp_guard.task;
+
+    if (!g_pmp_guard.enabled || !task) {
+        return;
+    }
+    if ((cause != CAUSE_FAULT_LOAD && cause != CAUSE_FAULT_STORE) || addr < g_pmp_guard.base ||
+        addr >= g_pmp_guard.base + g_pmp_guard.size) {
+        return;
+    }
+    uart_printf("\r\nstack overflow in %s: access 0x%08x at pc 0x%08x, sp 0x%08x, "
+                "guard 0x%08x-0x%08x\r\n",
+                pcTaskGetName(task), (unsigned int)addr, (unsigned int)__RV_CSR_READ(CSR_MEPC),
+                (unsigned int)sp, (unsigned int)g_pmp_guard.base,
+                (unsigned int)(g_pmp_guard.base + g_pmp_guard.size));
+    vApplicationStackOverflowHook(task, pcTaskGetName(task));
+    while (1)
+        ;
+}
+
+void pmp_guard_exc_exit(void)
+{
+    if (g_pmp_guard.enabled && g_pmp_guard.task && !g_pmp_guard.open) {
+        __RV_CSR_SET(CSR_PMPCFG0, PMP_A_NAPOT);
+    }
+}
+
+void pmp_stack_guard_open(void)
+{
+    if (!g_pmp_guard.enabled) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    g_pmp_guard.open++;
+    __RV_CSR_CLEAR(CSR_PMPCFG0, PMP_A);
+    taskEXIT_CRITICAL();
+}
+
+void pmp_stack_guard_close(void)
+{
+    if (!g_pmp_guard.enabled) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    if (g_pmp_guard.open && !--g_pmp_guard.open && g_pmp_guard.task) {
+        __RV_CSR_SET(CSR_PMPCFG0, PMP_A_NAPOT);
+    }
+    taskEXIT_CRITICAL();
+}
@@ -114,7 +114,12 @@ your application. */
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK                1
 #define configUSE_TICK_HOOK                0
+/* The PMP guard catches the overflow at the faulting access instead */
+#if CONFIG_PMP_STACK_GUARD
+#define configCHECK_FOR_STACK_OVERFLOW     0
+#else
 #define configCHECK_FOR_STACK_OVERFLOW     1
+#endif
 #define configUSE_MALLOC_FAILED_HOOK       1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK 0
 
@@ -188,5 +193,6 @@ your application. */
 #define INCLUDE_xTaskResumeFromISR          1
 
 /* A header file that defines trace macro can be included here. */
+#include "trace_hooks.h"
 
 #endif /* FREERTOS_CONFIG_H */
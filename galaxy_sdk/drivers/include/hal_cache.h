@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _HAL_CACHE_H
+#define _HAL_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup CACHE
+ * Cache line locking HAL API and definition
+ * @ingroup HAL
+ * Hardware Abstraction Layer
+ *  @{
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_common.h"
+
+/**
+ * @brief Max number of locked regions
+ */
+#define CACHE_LOCK_REGION_MAX (8)
+
+/**
+ * @enum CacheTypeDef
+ * @brief Cache which a region is locked into
+ */
+typedef enum CacheTypeDef {
+    CACHE_TYPE_ICACHE = 0, /**< Instruction cache, for code */
+    CACHE_TYPE_DCACHE = 1, /**< Data cache, for tables and buffers */
+    CACHE_TYPE_MAX,
+} CacheTypeDef;
+
+/**
+ * @brief A locked region, as reported by hal_cache_lock_get
+ */
+typedef struct CacheLockRegion {
+    const char *name;  /**< Name given when locking */
+    uint32_t start;    /**< First locked line address */
+    uint32_t lines;    /**< Number of locked lines */
+    uint8_t type;      /**< Cache type, @see CacheTypeDef */
+} CacheLockRegion;
+
+/**
+ * @brief Usage of one cache
+ */
+typedef struct CacheLockUsage {
+    uint32_t line_size; /**< Line size in bytes */
+    uint32_t size;      /**< Cache size in bytes */
+    uint32_t budget;    /**< Bytes which may be locked */
+    uint32_t locked;    /**< Bytes locked */
+} CacheLockUsage;
+
+/** Lock a variable, e.g. a coefficient table in SENSOR_DATA_SECTION */
+#define HAL_CACHE_LOCK_OBJ(type, obj) hal_cache_lock_region(#obj, type, &(obj), sizeof(obj))
+
+/**
+ * @brief Set the budgets of lockable bytes
+ * @param[in] icache_budget Bytes of I-Cache, capped to N-1 of the N ways
+ * @param[in] dcache_budget Bytes of D-Cache, capped to N-1 of the N ways
+ * @note At least one way stays unlocked for normal code and data
+ * @return Return VSD_SUCCESS for succeed, VSD_ERR_UNSUPPORTED if no cache
+ */
+int hal_cache_lock_init(uint32_t icache_budget, uint32_t dcache_budget);
+
+/**
+ * @brief Lock an address range into a cache
+ * @param[in] name Name of the region for the report, must stay valid
+ * @param[in] type Cache type, @see CacheTypeDef
+ * @param[in] start Start address, rounded down to a cache line
+ * @param[in] size Size in bytes, rounded up to cache lines
+ * @note A region which exceeds the budget or the ways of a set is not locked
+ * at all. Lines shared with other regions are charged once and stay locked
+ * until the last region holding them is unlocked
+ * @return Return VSD_SUCCESS for succeed, VSD_ERR_FULL if over budget or
+ * lockable ways, others for failure
+ */
+int hal_cache_lock_region(const char *name, CacheTypeDef type, const void *start, uint32_t size);
+
+/**
+ * @brief Lock a linker section with known bounds
+ * @param[in] section ".itext", i.e. CRITICAL_SECTION and DRV_ISR_SECTION code
+ * @return Return VSD_SUCCESS for succeed, VSD_ERR_NON_EXIST for unknown
+ * sections, others see hal_cache_lock_region
+ */
+int hal_cache_lock_section(const char *section);
+
+/**
+ * @brief Unlock a region locked by hal_cache_lock_region
+ * @param[in] name Name given when locking
+ * @return Return VSD_SUCCESS for succeed, VSD_ERR_NON_EXIST if not locked
+ */
+int hal_cache_unlock_region(const char *name);
+
+/**
+ * @brief Unlock all regions, the lines stay valid in cache
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_cache_unlock_all(void);
+
+/**
+ * @brief Get the locked regions
+ * @param[out] regions Locked regions
+ * @param[in] max Max number of regions to get
+ * @return Number of regions got
+ */
+uint32_t hal_cache_lock_get(CacheLockRegion *regions, uint32_t max);
+
+/**
+ * @brief Get the lock usage of a cache
+ * @param[in] type Cache type, @see CacheTypeDef
+ * @param[out] usage Line size, budget and locked bytes
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_cache_lock_usage(CacheTypeDef type, CacheLockUsage *usage);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_CACHE_H */
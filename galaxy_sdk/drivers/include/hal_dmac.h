@@ -442,6 +442,57 @@ typedef struct DmacLliItem {
     uint32_t dstat;          /**< Destination Status Register for Channel x */
 } DmacLliItem;
 
+/** Alignment of the LLI descriptor memory, equal to the cache line size */
+#define DMAC_LLI_ALIGN 32
+
+/**
+ * @brief Pool of preallocated Linked List Items. Descriptors are taken from
+ * non-cacheable memory so that the DMAC always sees what the CPU wrote, and
+ * they can be reused across transfers without going back to the heap
+ */
+typedef struct DmacLliPool {
+    DmacLliItem *items;     /**< Descriptor storage, DMAC_LLI_ALIGN aligned */
+    DmacLliItem *free_list; /**< Free descriptors, chained by llp */
+    void *mem;              /**< Memory allocated by the pool, NULL if provided by caller */
+    uint32_t total;         /**< Total number of descriptors */
+    uint32_t free_num;      /**< Number of free descriptors */
+} DmacLliPool;
+
+/**
+ * @brief One segment of a multi-block transfer
+ */
+typedef struct DmacLliSeg {
+    uint32_t src_addr; /**< Source address of this segment */
+    uint32_t dst_addr; /**< Destination address of this segment */
+    uint32_t len;      /**< Length of this segment in bytes */
+} DmacLliSeg;
+
+/**
+ * @brief Parameters used to build a descriptor chain from segments
+ */
+typedef struct DmacLliChainCfg {
+    const DmacLliSeg *segs; /**< Segments of the transfer, in order */
+    uint32_t seg_num;       /**< Number of segments */
+    /**
+     * Raise the block interrupt every irq_interval descriptors. 0 means only
+     * the last descriptor of the chain raises the interrupt, so the whole chain
+     * costs one interrupt
+     */
+    uint32_t irq_interval;
+    bool is_cyclic; /**< Link the last descriptor back to the first one */
+} DmacLliChainCfg;
+
+/**
+ * @brief Descriptor chain built from a DmacLliPool
+ */
+typedef struct DmacLliChain {
+    DmacLliItem *head; /**< First descriptor of the chain */
+    DmacLliItem *tail; /**< Last descriptor of the chain */
+    uint32_t num;      /**< Number of descriptors in the chain */
+    uint32_t len;      /**< Total bytes described by the chain */
+    bool is_cyclic;    /**< Whether tail is linked back to head */
+} DmacLliChain;
+
 /**
  * @brief DMAC channel mux select
  */
@@ -576,6 +627,74 @@ int hal_dmac_chan_stop(const DmacDevice *device, DmacXferCfg *xfer_cfg);
  */
 void hal_dmac_isr_handler(const DmacDevice *device);
 
+/**
+ * @brief Get the current source and destination address of a channel
+ * @param[in] device the Dmac device
+ * @param[in] xfer_cfg Channel configuration returned by hal_dmac_chan_init
+ * @param[out] src_addr Current value of SARx, NULL if not needed
+ * @param[out] dst_addr Current value of DARx, NULL if not needed
+ * @note Used to get the progress of a running cyclic transfer without
+ * waiting for the block interrupt
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_dmac_chan_get_addr(const DmacDevice *device, const DmacXferCfg *xfer_cfg,
+                           uint32_t *src_addr, uint32_t *dst_addr);
+
+/**
+ * @brief Initialize a LLI pool
+ * @param[in] pool The pool to be initialized
+ * @param[in] items Descriptor storage, NULL to allocate it from non-cacheable
+ * heap. Caller provided storage must be non-cacheable and DMAC_LLI_ALIGN
+ * aligned, e.g. placed in NONCACHE_DATA_SECTION with aligned(DMAC_LLI_ALIGN)
+ * @param[in] num Number of descriptors in the pool
+ * @note Pool operations must not be called from ISR
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_dmac_lli_pool_init(DmacLliPool *pool, DmacLliItem *items, uint32_t num);
+
+/**
+ * @brief Release the memory allocated by hal_dmac_lli_pool_init
+ * @param[in] pool The pool to be released
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_dmac_lli_pool_deinit(DmacLliPool *pool);
+
+/**
+ * @brief Build a descriptor chain from a list of segments
+ * @param[in] device the Dmac device
+ * @param[in] pool Pool where the descriptors are taken from
+ * @param[in] xfer_cfg Channel configuration returned by hal_dmac_chan_init, its
+ * ctl_reg provides the width, increment and burst settings of every descriptor
+ * @param[in] cfg Segments and chain options, @see DmacLliChainCfg
+ * @param[out] chain The chain built
+ * @note A segment longer than max_blk_ts items is split into several
+ * descriptors; every segment length must be a multiple of the source width
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_dmac_lli_chain_build(const DmacDevice *device, DmacLliPool *pool,
+                             const DmacXferCfg *xfer_cfg, const DmacLliChainCfg *cfg,
+                             DmacLliChain *chain);
+
+/**
+ * @brief Return the descriptors of a chain to its pool
+ * @param[in] pool Pool where the descriptors are taken from
+ * @param[in] chain The chain to be freed
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_dmac_lli_chain_free(DmacLliPool *pool, DmacLliChain *chain);
+
+/**
+ * @brief Start a multi-block transfer described by a chain
+ * @param[in] device the Dmac device
+ * @param[in] xfer_cfg Channel configuration returned by hal_dmac_chan_init
+ * @param[in] chain The chain built by hal_dmac_lli_chain_build
+ * @param[in] xfer_cb DMA transfer callback and param. In cyclic mode the
+ * callback is called for every descriptor that raises the block interrupt
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_dmac_lli_chain_start(const DmacDevice *device, DmacXferCfg *xfer_cfg,
+                             const DmacLliChain *chain, DmaCbAndParam *xfer_cb);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -156,11 +156,37 @@ typedef struct GpioOperations {
     void (*irq_ind_handler)(const GpioDevice *device, unsigned char irq_id);
 } GpioOperations;
 
+/**
+ * @brief Optional port-wide operations of a GPIO group. Each bit of a mask
+ * is one port of the group, bit 0 for port 0
+ */
+typedef struct GpioPortOperations {
+    /** Read the input level of all ports */
+    uint32_t (*port_read)(const GpioDevice *device);
+    /** Read the output level of all ports */
+    uint32_t (*port_output_get)(const GpioDevice *device);
+    /** Set ports in mask to the level in value with one register write */
+    void (*port_write)(const GpioDevice *device, uint32_t mask, uint32_t value);
+    /** Toggle the output of ports in mask with one register write */
+    void (*port_toggle)(const GpioDevice *device, uint32_t mask);
+    /** Get the pending interrupt status of all ports */
+    uint32_t (*irq_pending)(const GpioDevice *device);
+    /** Clear the pending interrupt status of ports in mask */
+    void (*irq_clear)(const GpioDevice *device, uint32_t mask);
+} GpioPortOperations;
+
 /**
  * @brief GPIO interrupt callback handler
  */
 typedef void (*GpioIrqHandler)(void);
 
+/**
+ * @brief GPIO interrupt callback handler with context
+ * @param arg The argument given at registration
+ * @param port The port which triggers the interrupt
+ */
+typedef void (*GpioPinHandler)(void *arg, uint8_t port);
+
 /**
  * @brief Add GPIO device instance
  * @note This API should be called by GPIO IP driver to add initialized instance
@@ -170,6 +196,19 @@ typedef void (*GpioIrqHandler)(void);
  */
 int hal_gpio_add_dev(GpioDevice *device);
 
+/**
+ * @brief Replace the port-wide operations of a GPIO group
+ * @note hal_gpio_add_dev installs operations on the port A data, interrupt
+ * status and end-of-interrupt registers of the DW_apb_gpio layout. A GPIO IP
+ * driver with another layout calls this after hal_gpio_add_dev. With NULL
+ * the mask APIs fall back to per-pin operations and
+ * hal_gpio_set_pin_handler is unsupported
+ * @param device The device of GPIO group
+ * @param ops The port-wide operations
+ * @return Return VSD_SUCCESS for succeed, others for failure
+ */
+int hal_gpio_add_port_ops(const GpioDevice *device, const GpioPortOperations *ops);
+
 /**
  * @brief Get Gpio Group device instance
  * @param group_id Gpio group id
@@ -253,6 +292,51 @@ int hal_gpio_output_get(const GpioPort *gpio, uint32_t *value);
  */
 int hal_gpio_dir_get(const GpioPort *gpio, uint32_t *value);
 
+/**
+ * @brief Set the output level of several ports of a group at once
+ * @param group Gpio group id
+ * @param mask Ports to be changed, bit n for port n
+ * @param value Output level of ports in mask, 1 for high. invert of GpioPort
+ * is not applied
+ * @return Return result
+ * @retval VSD_SUCCESS for succeed, others for failure
+ */
+int hal_gpio_write_mask(uint8_t group, uint32_t mask, uint32_t value);
+
+/**
+ * @brief Read the input level of all ports of a group
+ * @param group Gpio group id
+ * @param value Input level, bit n for port n
+ * @return Return result
+ * @retval VSD_SUCCESS for succeed, others for failure
+ */
+int hal_gpio_read_port(uint8_t group, uint32_t *value);
+
+/**
+ * @brief Toggle the output of several ports of a group at once
+ * @param group Gpio group id
+ * @param mask Ports to be toggled, bit n for port n
+ * @return Return result
+ * @retval VSD_SUCCESS for succeed, others for failure
+ */
+int hal_gpio_toggle_mask(uint8_t group, uint32_t mask);
+
+/**
+ * @brief Set the interrupt handler of a pin in the dispatch table and enable
+ * its interrupt
+ * @note With irq_pending and irq_clear of GpioPortOperations the group ISR
+ * reads the pending mask once and calls the handlers by bit scan, so the
+ * latency does not depend on the number of pins, and the interrupt stays
+ * enabled after trigger. Otherwise the IP driver dispatches the pin as for
+ * hal_gpio_enable_irq, and irq_reload of GpioPort applies
+ * @param gpio The gpio pin which provides the interrupt trigger
+ * @param handler The handler, NULL to remove it and disable the interrupt
+ * @param arg Argument given to the handler
+ * @return Return result
+ * @retval VSD_SUCCESS for succeed, others for failure
+ */
+int hal_gpio_set_pin_handler(const GpioPort *gpio, GpioPinHandler handler, void *arg);
+
 /**
  * @brief Interrupt handler for an External Interrupt
  * @param device The gpio group device instance
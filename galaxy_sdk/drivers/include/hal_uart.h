@@ -205,6 +205,79 @@ typedef struct UartOperations {
     void (*irq_handler)(const UartDevice *dev);
 } UartOperations;
 
+/** @brief Flags of a ring receive event */
+enum UartRingRxFlag {
+    UART_RING_RX_BLOCK   = 0x01, /**< A DMA block of the ring was filled */
+    UART_RING_RX_IDLE    = 0x02, /**< RX line went idle, end of a frame */
+    UART_RING_RX_OVERRUN = 0x04, /**< Unread data was overwritten by DMA */
+};
+
+/**
+ * @brief View of received data inside the ring. Data crossing the end of the
+ * ring is given as two parts, part 1 is empty otherwise
+ */
+typedef struct UartRingRxEvent {
+    const uint8_t *data[2]; /**< Start of each part, pointing into the ring */
+    uint32_t len[2];        /**< Length of each part */
+    uint32_t flags;         /**< Combination of UartRingRxFlag */
+    uint32_t lost;          /**< Bytes dropped when UART_RING_RX_OVERRUN is set */
+} UartRingRxEvent;
+
+/**
+ * @brief Callback of ring receiving, the views are released when it returns
+ * @param device The device instance
+ * @param evt The received data and the reason of delivery
+ */
+typedef void (*UartRingRxCallback)(const void *device, const UartRingRxEvent *evt);
+
+/**
+ * @brief Parameters of continuous ring receiving with DMA
+ */
+typedef struct UartRingRxParam {
+    /**
+     * Ring buffer, must be non-cacheable memory (e.g. NONCACHE_DATA_SECTION)
+     * for the SoC who has no DLM
+     */
+    uint8_t *buffer;
+    uint32_t buff_len; /**< Length of the ring, multiple of blk_num */
+    /**
+     * Number of DMA blocks the ring is split into (at least 2). The block
+     * interrupt is the only interrupt of the stream, so it bounds the latency
+     * of long frames. A block must fit one descriptor (max_blk_ts). After an
+     * overrun the block under the write position is dropped too
+     */
+    uint32_t blk_num;
+    /** Idle time ending a frame in microseconds, 0 for 2 characters time */
+    uint32_t idle_us;
+    /** Address of the RX data register, 0 to use base of hw_cfg */
+    uint32_t fifo_addr;
+    UartRingRxCallback callback; /**< Callback for delivering data */
+} UartRingRxParam;
+
+/**
+ * @brief Runtime state of ring receiving, owned by caller
+ */
+typedef struct UartRingRx {
+    const UartDevice *dev;      /**< UART device bound to this ring */
+    UartRingRxParam param;      /**< Parameters given at start */
+    DmacXferCfg *xfer_cfg;      /**< DMA channel used for receiving */
+    DmaCbAndParam dma_cb;       /**< Block callback of the DMA channel */
+    DmacLliPool pool;           /**< Descriptors of the ring */
+    DmacLliChain chain;         /**< Cyclic chain, one descriptor per block */
+    uint32_t blk_len;           /**< Bytes of each block */
+    volatile uint32_t blk_done; /**< Blocks completed, updated in ISR */
+    uint32_t blk_seen;          /**< Blocks accounted in wr_total */
+    uint32_t wr_pos;            /**< Last write offset sampled from DMA */
+    uint32_t wr_total;          /**< Bytes written by DMA since start */
+    uint32_t rd_pos;            /**< Offset of the first undelivered byte */
+    uint32_t rd_total;          /**< Bytes delivered since start */
+    uint32_t idle_wr;           /**< wr_total at the last activity */
+    uint64_t idle_start;        /**< Cycle of the last activity */
+    uint64_t idle_cycles;       /**< Idle time in CPU cycles */
+    uint32_t overruns;          /**< Number of overruns since start */
+    bool busy;                  /**< A delivery is in progress */
+} UartRingRx;
+
 /**
  * @brief Add the UART controller device
  * @param[in]  dev  the UART device
@@ -317,6 +390,47 @@ int hal_uart_stop(const UartDevice *dev);
  */
 int hal_uart_config(UartDevice *dev, const UartXferConfig *cfg);
 
+/**
+ * @brief Start continuous receiving into a ring with cyclic DMA
+ * @param[in]   dev   UART device, its hw_cfg must enable the DMA mode
+ * @param[in]   ring  State of ring receiving, kept by caller until stop
+ * @param[in]   param Parameters of ring receiving
+ * @note Data is delivered in place, without copy, when a block is filled and
+ * when the line is idle. The character timeout interrupt of the UART ends a
+ * frame, otherwise idle is found by hal_uart_ring_rx_poll. The IP driver
+ * does not see that interrupt while the ring runs
+ *
+ * @return  VSD_SUCCESS on success, others on error
+ */
+int hal_uart_ring_rx_start(const UartDevice *dev, UartRingRx *ring, const UartRingRxParam *param);
+
+/**
+ * @brief Check the ring and deliver the pending data if the line is idle
+ * @param[in]   ring  State of ring receiving
+ * @note Only needed when the UART raises no interrupt after the line goes
+ * idle. An idle line is then seen one period after the last byte, so gaps
+ * shorter than the period of the calls do not split frames
+ *
+ * @return  VSD_SUCCESS on success, others on error
+ */
+int hal_uart_ring_rx_poll(UartRingRx *ring);
+
+/**
+ * @brief Deliver the pending data now as the end of a frame
+ * @param[in]   ring  State of ring receiving
+ *
+ * @return  VSD_SUCCESS on success, others on error
+ */
+int hal_uart_ring_rx_flush(UartRingRx *ring);
+
+/**
+ * @brief Stop ring receiving and release its DMA resources
+ * @param[in]   ring  State of ring receiving
+ *
+ * @return  VSD_SUCCESS on success, others on error
+ */
+int hal_uart_ring_rx_stop(UartRingRx *ring);
+
 /**
  * @brief UART irq handle function
  * @param dev UART device instance
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "hal_cache.h"
+#include "vsd_error.h"
+#include "bsp_common.h"
+#include "platform.h"
+
+typedef struct CacheLockCtx {
+    CacheLockUsage usage[CACHE_TYPE_MAX];
+    CacheLockRegion regions[CACHE_LOCK_REGION_MAX];
+    uint32_t num;
+    bool inited;
+} CacheLockCtx;
+
+extern char _itext[];
+extern char _eitext[];
+
+static CacheLockCtx g_cache_lock;
+
+static int cache_info_get(CacheTypeDef type, CacheInfo_Type *info)
+{
+    if (type == CACHE_TYPE_ICACHE) {
+        if (!ICachePresent()) {
+            return VSD_ERR_UNSUPPORTED;
+        }
+        GetICacheInfo(info);
+    } else {
+        if (!DCachePresent()) {
+            return VSD_ERR_UNSUPPORTED;
+        }
+        GetDCacheInfo(info);
+    }
+    return info->linesize && info->ways > 1 ? VSD_SUCCESS : VSD_ERR_UNSUPPORTED;
+}
+
+static void cache_unlock_lines(CacheTypeDef type, uint32_t addr, uint32_t lines)
+{
+    if (type == CACHE_TYPE_ICACHE) {
+        MUnlockICacheLines(addr, lines);
+    } else {
+        MUnlockDCacheLines(addr, lines);
+    }
+}
+
+/*
+ * Whether another region of the cache holds the line at addr, shared lines
+ * are locked and charged once
+ */
+static bool cache_line_shared(CacheTypeDef type, uint32_t addr, const CacheLockRegion *self)
+{
+    const CacheLockRegion *region;
+    uint32_t line_size = g_cache_lock.usage[type].line_size;
+    uint32_t i;
+
+    for (i = 0; i < g_cache_lock.num; i++) {
+        region = &g_cache_lock.regions[i];
+        if (region != self && region->type == type && addr >= region->start &&
+            addr - region->start < region->lines * line_size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Unlock the first lines of a range which no other region holds, returns their number */
+static uint32_t cache_unlock_own(CacheTypeDef type, uint32_t addr, uint32_t lines,
+                                 const CacheLockRegion *self)
+{
+    uint32_t line_size = g_cache_lock.usage[type].line_size;
+    uint32_t i, own = 0;
+
+    for (i = 0; i < lines; i++) {
+        if (!cache_line_shared(type, addr + i * line_size, self)) {
+            cache_unlock_lines(type, addr + i * line_size, 1);
+            own++;
+        }
+    }
+    return own;
+}
+
+int hal_cache_lock_init(uint32_t icache_budget, uint32_t dcache_budget)
+{
+    const uint32_t budget[CACHE_TYPE_MAX] = {icache_budget, dcache_budget};
+    CacheInfo_Type info;
+    CacheLockUsage *usage;
+    uint32_t type, max;
+    int ret = VSD_ERR_UNSUPPORTED;
+
+    hal_cache_unlock_all();
+    memset(&g_cache_lock, 0, sizeof(g_cache_lock));
+    for (type = 0; type < CACHE_TYPE_MAX; type++) {
+        if (cache_info_get(type, &info) != VSD_SUCCESS) {
+            continue;
+        }
+        /* CCM refuses to lock the last way of a set */
+        usage            = &g_cache_lock.usage[type];
+        max              = info.size / info.ways * (info.ways - 1);
+        usage->line_size = info.linesize;
+        usage->size      = info.size;
+        usage->budget    = MIN(budget[type], max);
+        ret              = VSD_SUCCESS;
+    }
+    g_cache_lock.inited = (ret == VSD_SUCCESS);
+    return ret;
+}
+
+int hal_cache_lock_region(const char *name, CacheTypeDef type, const void *start, uint32_t size)
+{
+    CacheLockUsage *usage;
+    CacheLockRegion *region;
+    uint32_t addr, lines, own, i;
+    unsigned long fail;
+
+    if (!name || !start) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (type >= CACHE_TYPE_MAX || !size) {
+        return VSD_ERR_INVALID_PARAM;
+    }
+    if (!g_cache_lock.inited) {
+        return VSD_ERR_NOT_INITIALIZED;
+    }
+    usage = &g_cache_lock.usage[type];
+    if (!usage->line_size) {
+        return VSD_ERR_UNSUPPORTED;
+    }
+    if (g_cache_lock.num >= CACHE_LOCK_REGION_MAX) {
+        return VSD_ERR_FULL;
+    }
+
+    addr  = (uint32_t)(uintptr_t)start & ~(usage->line_size - 1);
+    lines = DIV_ROUND_UP((uint32_t)(uintptr_t)start + size - addr, usage->line_size);
+    for (i = 0, own = 0; i < lines; i++) {
+        own += !cache_line_shared(type, addr + i * usage->line_size, NULL);
+    }
+    if (usage->locked + own * usage->line_size > usage->budget) {
+        return VSD_ERR_FULL;
+    }
+
+    /* Lock line by line so that a failure can be rolled back exactly */
+    for (i = 0; i < lines; i++) {
+        if (cache_line_shared(type, addr + i * usage->line_size, NULL)) {
+            continue;
+        }
+        if (type == CACHE_TYPE_ICACHE) {
+            fail = MLockICacheLine(addr + i * usage->line_size);
+        } else {
+            fail = MLockDCacheLine(addr + i * usage->line_size);
+        }
+        if (fail != CCM_OP_SUCCESS) {
+            cache_unlock_own(type, addr, i, NULL);
+            return fail == CCM_OP_EXCEED_ERR ? VSD_ERR_FULL : VSD_ERR_HW;
+        }
+    }
+
+    region        = &g_cache_lock.regions[g_cache_lock.num++];
+    region->name  = name;
+    region->start = addr;
+    region->lines = lines;
+    region->type  = type;
+    usage->locked += own * usage->line_size;
+    return VSD_SUCCESS;
+}
+
+int hal_cache_lock_section(const char *section)
+{
+    if (!section) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (!strcmp(section, ".itext")) {
+        uint32_t size = (uint32_t)((uintptr_t)_eitext - (uintptr_t)_itext);
+
+        return size ? hal_cache_lock_region(section, CACHE_TYPE_ICACHE, _itext, size)
+                    : VSD_SUCCESS;
+    }
+    return VSD_ERR_NON_EXIST;
+}
+
+int hal_cache_unlock_region(const char *name)
+{
+    CacheLockRegion *region;
+    uint32_t i;
+
+    if (!name) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    for (i = 0; i < g_cache_lock.num; i++) {
+        region = &g_cache_lock.regions[i];
+        if (strcmp(region->name, name)) {
+            continue;
+        }
+        g_cache_lock.usage[region->type].locked -=
+            cache_unlock_own(region->type, region->start, region->lines, region) *
+            g_cache_lock.usage[region->type].line_size;
+        g_cache_lock.num--;
+        memmove(region, region + 1, (g_cache_lock.num - i) * sizeof(CacheLockRegion));
+        return VSD_SUCCESS;
+    }
+    return VSD_ERR_NON_EXIST;
+}
+
+int hal_cache_unlock_all(void)
+{
+    const CacheLockRegion *region;
+    uint32_t i;
+
+    for (i = 0; i < g_cache_lock.num; i++) {
+        region = &g_cache_lock.regions[i];
+        cache_unlock_lines(region->type, region->start, region->lines);
+    }
+    g_cache_lock.num = 0;
+    for (i = 0; i < CACHE_TYPE_MAX; i++) {
+        g_cache_lock.usage[i].locked = 0;
+    }
+    return VSD_SUCCESS;
+}
+
+uint32_t hal_cache_lock_get(CacheLockRegion *regions, uint32_t max)
+{
+    uint32_t num;
+
+    if (!regions) {
+        return 0;
+    }
+    num = MIN(max, g_cache_lock.num);
+    memcpy(regions, g_cache_lock.regions, num * sizeof(CacheLockRegion));
+    return num;
+}
+
+int hal_cache_lock_usage(CacheTypeDef type, CacheLockUsage *usage)
+{
+    if (!usage) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (type >= CACHE_TYPE_MAX) {
+        return VSD_ERR_INVALID_PARAM;
+    }
+    *usage = g_cache_lock.usage[type];
+    return VSD_SUCCESS;
+}
@@ -31,6 +31,29 @@
 #include <string.h>
 #include "hal_dmac.h"
 #include "vsd_error.h"
+#include "bsp_common.h"
+
+/* Bit fields of CTLx register, used to fill the ctl_l/ctl_h of descriptors */
+#define DMAC_CTL_INT_EN_POS     0
+#define DMAC_CTL_DST_WIDTH_POS  1
+#define DMAC_CTL_SRC_WIDTH_POS  4
+#define DMAC_CTL_DINC_POS       7
+#define DMAC_CTL_SINC_POS       9
+#define DMAC_CTL_DST_MSIZE_POS  11
+#define DMAC_CTL_SRC_MSIZE_POS  14
+#define DMAC_CTL_SRC_GTH_EN_POS 17
+#define DMAC_CTL_DST_SCT_EN_POS 18
+#define DMAC_CTL_TT_FC_POS      20
+#define DMAC_CTL_DMS_POS        23
+#define DMAC_CTL_SMS_POS        25
+#define DMAC_CTL_LLP_DST_EN_POS 27
+#define DMAC_CTL_LLP_SRC_EN_POS 28
+#define DMAC_CTL_BLOCK_TS_MAX   0xFFF
+
+/* Channel register map of DW_ahb_dmac */
+#define DMAC_CHAN_REG_SIZE 0x58
+#define DMAC_CHAN_SAR      0x00
+#define DMAC_CHAN_DAR      0x08
 
 static DmacDevice *g_dmac_dev[DMAC_ID_MAX] = {NULL};
 
@@ -127,3 +150,233 @@ void hal_dmac_isr_handler(const DmacDevice *device)
     }
     return get_ops(device)->isr_handler(device);
 }
+
+int hal_dmac_chan_get_addr(const DmacDevice *device, const DmacXferCfg *xfer_cfg,
+                           uint32_t *src_addr, uint32_t *dst_addr)
+{
+    uint32_t base;
+
+    if (!device || !device->hw_cfg || !xfer_cfg) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (xfer_cfg->chn_id >= device->hw_cfg->ch_sum) {
+        return VSD_ERR_INVALID_PARAM;
+    }
+
+    base = device->hw_cfg->base_addr + xfer_cfg->chn_id * DMAC_CHAN_REG_SIZE;
+    if (src_addr) {
+        *src_addr = *(volatile uint32_t *)(base + DMAC_CHAN_SAR);
+    }
+    if (dst_addr) {
+        *dst_addr = *(volatile uint32_t *)(base + DMAC_CHAN_DAR);
+    }
+    return VSD_SUCCESS;
+}
+
+int hal_dmac_lli_pool_init(DmacLliPool *pool, DmacLliItem *items, uint32_t num)
+{
+    uint32_t i;
+
+    if (!pool) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (!num || ((uintptr_t)items & (DMAC_LLI_ALIGN - 1))) {
+        return VSD_ERR_INVALID_PARAM;
+    }
+
+    memset(pool, 0, sizeof(DmacLliPool));
+    if (!items) {
+        pool->mem = DRV_MALLOC(num * sizeof(DmacLliItem) + DMAC_LLI_ALIGN - 1);
+        if (!pool->mem) {
+            return VSD_ERR_NO_MEMORY;
+        }
+        items = (DmacLliItem *)(((uintptr_t)pool->mem + DMAC_LLI_ALIGN - 1) &
+                                ~((uintptr_t)DMAC_LLI_ALIGN - 1));
+    }
+
+    for (i = 0; i < num; i++) {
+        items[i].llp = (i + 1 < num) ? &items[i + 1] : NULL;
+    }
+    pool->items     = items;
+    pool->free_list = items;
+    pool->total     = num;
+    pool->free_num  = num;
+    return VSD_SUCCESS;
+}
+
+int hal_dmac_lli_pool_deinit(DmacLliPool *pool)
+{
+    if (!pool) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (pool->free_num != pool->total) {
+        return VSD_ERR_BUSY;
+    }
+
+    if (pool->mem) {
+        DRV_FREE(pool->mem);
+    }
+    memset(pool, 0, sizeof(DmacLliPool));
+    return VSD_SUCCESS;
+}
+
+static DmacLliItem *lli_pool_take(DmacLliPool *pool, uint32_t num)
+{
+    DmacLliItem *head = NULL;
+    DmacLliItem *item;
+    uint32_t i;
+
+    osal_enter_critical();
+    if (pool->free_num >= num) {
+        head = pool->free_list;
+        item = head;
+        for (i = 1; i < num; i++) {
+            item = item->llp;
+        }
+        pool->free_list = item->llp;
+        pool->free_num -= num;
+        item->llp = NULL;
+    }
+    osal_exit_critical();
+    return head;
+}
+
+static uint32_t lli_ctl_low(const DmacCtlReg *ctl)
+{
+    return ((uint32_t)ctl->dst_xfer_width << DMAC_CTL_DST_WIDTH_POS) |
+           ((uint32_t)ctl->src_xfer_width << DMAC_CTL_SRC_WIDTH_POS) |
+           ((uint32_t)ctl->dinc << DMAC_CTL_DINC_POS) |
+           ((uint32_t)ctl->sinc << DMAC_CTL_SINC_POS) |
+           ((uint32_t)ctl->dst_msize << DMAC_CTL_DST_MSIZE_POS) |
+           ((uint32_t)ctl->src_msize << DMAC_CTL_SRC_MSIZE_POS) |
+           ((uint32_t)ctl->src_gth_en << DMAC_CTL_SRC_GTH_EN_POS) |
+           ((uint32_t)ctl->dst_sct_en << DMAC_CTL_DST_SCT_EN_POS) |
+           ((uint32_t)ctl->tt_fc << DMAC_CTL_TT_FC_POS) |
+           ((uint32_t)ctl->dms << DMAC_CTL_DMS_POS) | ((uint32_t)ctl->sms << DMAC_CTL_SMS_POS) |
+           BIT(DMAC_CTL_LLP_DST_EN_POS) | BIT(DMAC_CTL_LLP_SRC_EN_POS);
+}
+
+static uint32_t lli_addr_offset(uint32_t addr, uint32_t inc, uint32_t offset)
+{
+    if (inc == DMA_ADDR_INC) {
+        return addr + offset;
+    } else if (inc == DMA_ADDR_DEC) {
+        return addr - offset;
+    }
+    return addr;
+}
+
+int hal_dmac_lli_chain_build(const DmacDevice *device, DmacLliPool *pool,
+                             const DmacXferCfg *xfer_cfg, const DmacLliChainCfg *cfg,
+                             DmacLliChain *chain)
+{
+    const DmacCtlReg *ctl;
+    DmacLliItem *item, *prev = NULL;
+    uint32_t max_bytes, ctl_l, width_mask;
+    uint32_t need = 0, idx = 0;
+    uint32_t i, offset, chunk;
+
+    if (!device || !pool || !xfer_cfg || !cfg || !cfg->segs || !chain) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (!cfg->seg_num || !device->max_blk_ts) {
+        return VSD_ERR_INVALID_PARAM;
+    }
+
+    ctl        = &xfer_cfg->ctl_reg;
+    width_mask = (1U << ctl->src_xfer_width) - 1;
+    max_bytes  = MIN(device->max_blk_ts, DMAC_CTL_BLOCK_TS_MAX) << ctl->src_xfer_width;
+    for (i = 0; i < cfg->seg_num; i++) {
+        if (!cfg->segs[i].len || (cfg->segs[i].len & width_mask)) {
+            return VSD_ERR_INVALID_PARAM;
+        }
+        need += DIV_ROUND_UP(cfg->segs[i].len, max_bytes);
+    }
+
+    item = lli_pool_take(pool, need);
+    if (!item) {
+        return VSD_ERR_NO_MEMORY;
+    }
+
+    memset(chain, 0, sizeof(DmacLliChain));
+    chain->head      = item;
+    chain->num       = need;
+    chain->is_cyclic = cfg->is_cyclic;
+    ctl_l            = lli_ctl_low(ctl);
+    for (i = 0; i < cfg->seg_num; i++) {
+        for (offset = 0; offset < cfg->segs[i].len; offset += chunk) {
+            chunk = MIN(cfg->segs[i].len - offset, max_bytes);
+            if (prev) {
+                item = prev->llp;
+            }
+            item->sar   = lli_addr_offset(cfg->segs[i].src_addr, ctl->sinc, offset);
+            item->dar   = lli_addr_offset(cfg->segs[i].dst_addr, ctl->dinc, offset);
+            item->ctl_l = ctl_l;
+            item->ctl_h = chunk >> ctl->src_xfer_width;
+            item->sstat = 0;
+            item->dstat = 0;
+            idx++;
+            if (cfg->irq_interval && (idx % cfg->irq_interval) == 0) {
+                item->ctl_l |= BIT(DMAC_CTL_INT_EN_POS);
+            }
+            chain->len += chunk;
+            prev = item;
+        }
+    }
+
+    /* The last descriptor always reports, it closes the chain or the ring */
+    chain->tail = prev;
+    chain->tail->ctl_l |= BIT(DMAC_CTL_INT_EN_POS);
+    if (cfg->is_cyclic) {
+        chain->tail->llp = chain->head;
+    } else {
+        chain->tail->llp = NULL;
+        chain->tail->ctl_l &= ~(BIT(DMAC_CTL_LLP_DST_EN_POS) | BIT(DMAC_CTL_LLP_SRC_EN_POS));
+    }
+    return VSD_SUCCESS;
+}
+
+int hal_dmac_lli_chain_free(DmacLliPool *pool, DmacLliChain *chain)
+{
+    DmacLliItem *item, *next;
+    uint32_t i;
+
+    if (!pool || !chain) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+    if (!chain->head) {
+        return VSD_SUCCESS;
+    }
+
+    osal_enter_critical();
+    item = chain->head;
+    for (i = 0; i < chain->num; i++) {
+        next            = item->llp;
+        item->llp       = pool->free_list;
+        pool->free_list = item;
+        item            = next;
+    }
+    pool->free_num += chain->num;
+    osal_exit_critical();
+
+    memset(chain, 0, sizeof(DmacLliChain));
+    return VSD_SUCCESS;
+}
+
+int hal_dmac_lli_chain_start(const DmacDevice *device, DmacXferCfg *xfer_cfg,
+                             const DmacLliChain *chain, DmaCbAndParam *xfer_cb)
+{
+    if (!device || !xfer_cfg || !chain || !chain->head) {
+        return VSD_ERR_INVALID_POINTER;
+    }
+
+    xfer_cfg->llpx               = chain->head;
+    xfer_cfg->lli_num            = chain->num;
+    xfer_cfg->is_cyclic          = chain->is_cyclic;
+    xfer_cfg->len                = chain->len;
+    xfer_cfg->src_addr           = chain->head->sar;
+    xfer_cfg->dst_addr           = chain->head->dar;
+    xfer_cfg->ctl_reg.llp_src_en = 1;
+    xfer_cfg->ctl_reg.llp_dst_en = 1;
+    return hal_dmac_chan_start(device, xfer_cfg, xfer_cb);
+}
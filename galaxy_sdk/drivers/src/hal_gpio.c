@@ -34,11 +34,28 @@
 #include "vsd_error.h"
 #include "osal_heap_api.h"
 #include "sys_common.h"
+#include "osal_adapter.h"
 
 #define MAX_GPIO_GROUPS (4) /**< Limit group number */
 #define MAX_GPIO_NUM    (22)
 
+/* Port A registers of the GPIO IP, DW_apb_gpio layout */
+#define GPIO_REG_DR         0x00
+#define GPIO_REG_INTSTATUS  0x40
+#define GPIO_REG_EOI        0x4C
+#define GPIO_REG_EXT_PORT   0x50
+
+#define GPIO_REG(dev, off) (*(volatile uint32_t *)(uintptr_t)((dev)->hw_config->base + (off)))
+
+typedef struct GpioPinIrq {
+    GpioPinHandler handler;
+    void *arg;
+} GpioPinIrq;
+
 static GpioDevice *gpio_grp_dev[MAX_GPIO_GROUPS] = {NULL};
+static const GpioPortOperations *gpio_port_ops[MAX_GPIO_GROUPS];
+static GpioPinIrq gpio_pin_irq[MAX_GPIO_GROUPS][MAX_GPIO_NUM + 1];
+static uint32_t gpio_pin_irq_mask[MAX_GPIO_GROUPS];
 static uint8_t group_num;
 
 static inline GpioOperations *get_ops(uint8_t group)
@@ -46,13 +63,60 @@ static inline GpioOperations *get_ops(uint8_t group)
     return (GpioOperations *)gpio_grp_dev[group]->ops;
 }
 
+static uint32_t gpio_port_read(const GpioDevice *device)
+{
+    return GPIO_REG(device, GPIO_REG_EXT_PORT);
+}
+
+static uint32_t gpio_port_output_get(const GpioDevice *device)
+{
+    return GPIO_REG(device, GPIO_REG_DR);
+}
+
+static void gpio_port_write(const GpioDevice *device, uint32_t mask, uint32_t value)
+{
+    osal_enter_critical();
+    GPIO_REG(device, GPIO_REG_DR) = (GPIO_REG(device, GPIO_REG_DR) & ~mask) | (value & mask);
+    osal_exit_critical();
+}
+
+static void gpio_port_toggle(const GpioDevice *device, uint32_t mask)
+{
+    osal_enter_critical();
+    GPIO_REG(device, GPIO_REG_DR) ^= mask;
+    osal_exit_critical();
+}
+
+DRV_ISR_SECTION
+static uint32_t gpio_port_irq_pending(const GpioDevice *device)
+{
+    return GPIO_REG(device, GPIO_REG_INTSTATUS);
+}
+
+DRV_ISR_SECTION
+static void gpio_port_irq_clear(const GpioDevice *device, uint32_t mask)
+{
+    GPIO_REG(device, GPIO_REG_EOI) = mask;
+}
+
+/* Default port operations, an IP driver with another layout replaces them */
+static const GpioPortOperations gpio_reg_port_ops = {
+    .port_read       = gpio_port_read,
+    .port_output_get = gpio_port_output_get,
+    .port_write      = gpio_port_write,
+    .port_toggle     = gpio_port_toggle,
+    .irq_pending     = gpio_port_irq_pending,
+    .irq_clear       = gpio_port_irq_clear,
+};
+
 int hal_gpio_add_dev(GpioDevice *device)
 {
     int ret   = VSD_ERR_FULL;
     uint8_t i = 0;
     for (i = 0; i < sizeof(gpio_grp_dev) / sizeof(gpio_grp_dev[0]); i++) {
         if (gpio_grp_dev[i] == NULL) {
-            gpio_grp_dev[i] = device;
+            gpio_grp_dev[i]  = device;
+            gpio_port_ops[i] = device->hw_config ? &gpio_reg_port_ops : NULL;
             group_num += 1;
             ret = VSD_SUCCESS;
 
@@ -69,7 +133,8 @@ int hal_gpio_remove_dev(GpioDevice *device)
 
     for (i = 0; i < sizeof(gpio_grp_dev) / sizeof(gpio_grp_dev[0]); i++) {
         if (gpio_grp_dev[i] == device) {
-            gpio_grp_dev[i] = NULL;
+            gpio_grp_dev[i]  = NULL;
+            gpio_port_ops[i] = NULL;
             group_num -= 1;
             ret = VSD_SUCCESS;
             break;
@@ -78,6 +143,19 @@ int hal_gpio_remove_dev(GpioDevice *device)
     return ret;
 }
 
+int hal_gpio_add_port_ops(const GpioDevice *device, const GpioPortOperations *ops)
+{
+    uint8_t i;
+
+    for (i = 0; i < sizeof(gpio_grp_dev) / sizeof(gpio_grp_dev[0]); i++) {
+        if (gpio_grp_dev[i] == device) {
+            gpio_port_ops[i] = ops;
+            return VSD_SUCCESS;
+        }
+    }
+    return VSD_ERR_NON_EXIST;
+}
+
 GpioDevice *hal_gpio_get_device(uint8_t group_id)
 {
     uint8_t i;
@@ -248,13 +326,189 @@ int hal_gpio_dir_get(const GpioPort *gpio, uint32_t *value)
     return VSD_SUCCESS;
 }
 
+int hal_gpio_write_mask(uint8_t group, uint32_t mask, uint32_t value)
+{
+    const GpioPortOperations *port_ops;
+    uint32_t bits;
+    uint8_t port;
+
+    if (group >= group_num || (mask >> (MAX_GPIO_NUM + 1)))
+        return VSD_ERR_INVALID_PARAM;
+
+    port_ops = gpio_port_ops[group];
+    if (port_ops && port_ops->port_write) {
+        port_ops->port_write(gpio_grp_dev[group], mask, value);
+        return VSD_SUCCESS;
+    }
+    if (!get_ops(group)->output_set)
+        return VSD_ERR_INVALID_PARAM;
+
+    osal_enter_critical();
+    for (bits = mask; bits; bits &= bits - 1) {
+        port = __builtin_ctz(bits);
+        get_ops(group)->output_set(gpio_grp_dev[group], port, (value >> port) & 1);
+    }
+    osal_exit_critical();
+    return VSD_SUCCESS;
+}
+
+int hal_gpio_read_port(uint8_t group, uint32_t *value)
+{
+    const GpioPortOperations *port_ops;
+    uint32_t levels = 0;
+    uint8_t port;
+
+    if (group >= group_num || !value)
+        return VSD_ERR_INVALID_PARAM;
+
+    port_ops = gpio_port_ops[group];
+    if (port_ops && port_ops->port_read) {
+        *value = port_ops->port_read(gpio_grp_dev[group]) & ((2UL << MAX_GPIO_NUM) - 1);
+        return VSD_SUCCESS;
+    }
+    if (!get_ops(group)->input_get)
+        return VSD_ERR_INVALID_PARAM;
+
+    osal_enter_critical();
+    for (port = 0; port <= MAX_GPIO_NUM; port++) {
+        if (get_ops(group)->input_get(gpio_grp_dev[group], port))
+            levels |= 1UL << port;
+    }
+    osal_exit_critical();
+    *value = levels;
+    return VSD_SUCCESS;
+}
+
+int hal_gpio_toggle_mask(uint8_t group, uint32_t mask)
+{
+    const GpioPortOperations *port_ops;
+    uint32_t bits;
+    uint8_t port, is_high;
+
+    if (group >= group_num || (mask >> (MAX_GPIO_NUM + 1)))
+        return VSD_ERR_INVALID_PARAM;
+
+    port_ops = gpio_port_ops[group];
+    if (port_ops && port_ops->port_toggle) {
+        port_ops->port_toggle(gpio_grp_dev[group], mask);
+        return VSD_SUCCESS;
+    }
+    if (port_ops && port_ops->port_write && port_ops->port_output_get) {
+        osal_enter_critical();
+        port_ops->port_write(gpio_grp_dev[group], mask,
+                             ~port_ops->port_output_get(gpio_grp_dev[group]));
+        osal_exit_critical();
+        return VSD_SUCCESS;
+    }
+    if ((!get_ops(group)->output_get) || (!get_ops(group)->output_set))
+        return VSD_ERR_INVALID_PARAM;
+
+    osal_enter_critical();
+    for (bits = mask; bits; bits &= bits - 1) {
+        port    = __builtin_ctz(bits);
+        is_high = get_ops(group)->output_get(gpio_grp_dev[group], port);
+        get_ops(group)->output_set(gpio_grp_dev[group], port, !is_high);
+    }
+    osal_exit_critical();
+    return VSD_SUCCESS;
+}
+
+static inline bool gpio_has_pending(uint8_t group)
+{
+    const GpioPortOperations *port_ops = gpio_port_ops[group];
+
+    return port_ops && port_ops->irq_pending && port_ops->irq_clear;
+}
+
+/* Serve and clear the pending pins that have a table entry, returns all pending pins */
+DRV_ISR_SECTION
+static uint32_t gpio_pin_serve(uint8_t group)
+{
+    const GpioPortOperations *port_ops = gpio_port_ops[group];
+    const GpioPinIrq *pin_irq;
+    uint32_t pending, table;
+    uint8_t port;
+
+    pending = port_ops->irq_pending(gpio_grp_dev[group]);
+    table   = pending & gpio_pin_irq_mask[group];
+    if (table)
+        port_ops->irq_clear(gpio_grp_dev[group], table);
+    for (; table; table &= table - 1) {
+        port    = __builtin_ctz(table);
+        pin_irq = &gpio_pin_irq[group][port];
+        if (pin_irq->handler)
+            pin_irq->handler(pin_irq->arg, port);
+    }
+    return pending;
+}
+
+/*
+ * The IP driver calls a GpioIrqHandler without arguments, so all pins share
+ * this one. hal_gpio_irq_handler normally serves table pins before the IP
+ * driver sees them, this covers an IP driver that calls it directly
+ */
+DRV_ISR_SECTION
+static void gpio_pin_irq_handler(void)
+{
+    uint8_t group;
+
+    for (group = 0; group < group_num; group++) {
+        if (gpio_pin_irq_mask[group] && gpio_has_pending(group))
+            gpio_pin_serve(group);
+    }
+}
+
+int hal_gpio_set_pin_handler(const GpioPort *gpio, GpioPinHandler handler, void *arg)
+{
+    int ret;
+
+    if (!gpio || gpio->group >= group_num || gpio->port > MAX_GPIO_NUM)
+        return VSD_ERR_INVALID_PARAM;
+    if (!gpio_has_pending(gpio->group))
+        return VSD_ERR_UNSUPPORTED;
+
+    if (!handler) {
+        osal_enter_critical();
+        gpio_pin_irq_mask[gpio->group] &= ~(1UL << gpio->port);
+        gpio_pin_irq[gpio->group][gpio->port].handler = NULL;
+        osal_exit_critical();
+        return hal_gpio_disable_irq(gpio);
+    }
+
+    osal_enter_critical();
+    gpio_pin_irq[gpio->group][gpio->port].handler = handler;
+    gpio_pin_irq[gpio->group][gpio->port].arg     = arg;
+    gpio_pin_irq_mask[gpio->group] |= 1UL << gpio->port;
+    osal_exit_critical();
+
+    ret = hal_gpio_enable_irq(gpio, gpio_pin_irq_handler);
+    if (ret != VSD_SUCCESS) {
+        osal_enter_critical();
+        gpio_pin_irq_mask[gpio->group] &= ~(1UL << gpio->port);
+        gpio_pin_irq[gpio->group][gpio->port].handler = NULL;
+        osal_exit_critical();
+    }
+    return ret;
+}
+
 DRV_ISR_SECTION
 void hal_gpio_irq_handler(const GpioDevice *device)
 {
+    uint32_t pending;
+    uint8_t group;
+
     if (!device || device->group_id >= group_num)
         return;
 
-    if (!get_ops(device->group_id)->irq_grp_handler)
+    group = device->group_id;
+    if (gpio_pin_irq_mask[group] && gpio_has_pending(group)) {
+        pending = gpio_pin_serve(group);
+        /* Everything pending was served by the table */
+        if (!(pending & ~gpio_pin_irq_mask[group]))
+            return;
+    }
+
+    if (!get_ops(group)->irq_grp_handler)
         return;
-    return get_ops(device->group_id)->irq_grp_handler(gpio_grp_dev[device->group_id]);
+    return get_ops(group)->irq_grp_handler(gpio_grp_dev[group]);
 }
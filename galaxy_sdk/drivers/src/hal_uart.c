@@ -31,8 +31,22 @@
 #include "hal_uart.h"
 #include "vsd_error.h"
 #include "hal_common.h"
+#include "bsp_common.h"
+#include "soc_sysctl.h"
+#include "platform.h"
+
+/* Bits of one character on line, used for the default idle time */
+#define UART_RING_RX_CHAR_BITS  10
+#define UART_RING_RX_IDLE_CHARS 2
+/* Interrupt identity of the UART (16550 compatible), character timeout */
+#define UART_REG_IIR            0x08
+#define UART_IIR_IID_MASK       0x0F
+#define UART_IIR_IID_RX_TIMEOUT 0x0C
+/* Block transfer size limit of a DMA descriptor, in items */
+#define UART_RING_RX_BLK_TS_MAX 0xFFF
 
 static UartDevice *hal_dev[HAL_UART_DEV_MAX] = {NULL};
+static UartRingRx *hal_ring[HAL_UART_DEV_MAX];
 
 static inline UartOperations *get_ops(const UartDevice *dev)
 {
@@ -203,11 +217,295 @@ int hal_uart_config(UartDevice *dev, const UartXferConfig *cfg)
     return get_ops(dev)->uart_config(dev, cfg);
 }
 
+static void ring_rx_deliver(UartRingRx *ring, uint32_t flags);
+
 DRV_ISR_SECTION
 void hal_uart_irq_handler(const UartDevice *dev)
 {
-    if (!dev || !get_ops(dev)->irq_handler)
+    UartRingRx *ring = NULL;
+    uint32_t iir;
+    uint8_t i;
+
+    if (!dev)
         return;
 
-    return get_ops(dev)->irq_handler(dev);
+    for (i = 0; i < HAL_UART_DEV_MAX && !ring; i++) {
+        if (hal_ring[i] && hal_ring[i]->dev == dev)
+            ring = hal_ring[i];
+    }
+    /*
+     * The character timeout of a ring device ends its frame. The RX DMA
+     * drains the FIFO, so the IP driver must not read it for this interrupt
+     */
+    if (ring) {
+        iir = *(volatile uint32_t *)(uintptr_t)(dev->hw_cfg->base + UART_REG_IIR);
+        if ((iir & UART_IIR_IID_MASK) == UART_IIR_IID_RX_TIMEOUT) {
+            ring_rx_deliver(ring, UART_RING_RX_IDLE);
+            return;
+        }
+    }
+    if (get_ops(dev)->irq_handler)
+        get_ops(dev)->irq_handler(dev);
+}
+
+/*
+ * Ring state is shared between the DMA block interrupt and the poll context,
+ * use the MIE bit directly as taskENTER_CRITICAL is not allowed in ISR
+ */
+static inline uint32_t ring_rx_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void ring_rx_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+/* Sample the write offset of DMA and account it in wr_total */
+static void ring_rx_update(UartRingRx *ring)
+{
+    const UartRingRxParam *param = &ring->param;
+    uint32_t dar, pos, delta, blocks;
+
+    if (hal_dmac_chan_get_addr(ring->dev->dmac_dev, ring->xfer_cfg, NULL, &dar) != VSD_SUCCESS) {
+        return;
+    }
+
+    pos = dar - (uint32_t)(uintptr_t)param->buffer;
+    if (pos >= param->buff_len) {
+        /* DAR is not reloaded yet after the last block */
+        pos = 0;
+    }
+    delta  = (pos + param->buff_len - ring->wr_pos) % param->buff_len;
+    blocks = ring->blk_done - ring->blk_seen;
+    /* Each completed block crossed one boundary, a smaller delta means a full lap */
+    while (blocks && delta < (blocks - 1) * ring->blk_len + 1) {
+        delta += param->buff_len;
+    }
+
+    ring->blk_seen = ring->blk_done;
+    ring->wr_pos   = pos;
+    ring->wr_total += delta;
+}
+
+static void ring_rx_deliver(UartRingRx *ring, uint32_t flags)
+{
+    const UartRingRxParam *param = &ring->param;
+    UartRingRxEvent evt;
+    uint32_t pending, mie;
+
+    mie = ring_rx_lock();
+    if (ring->busy) {
+        /* The pending data is picked up by the next delivery */
+        ring_rx_unlock(mie);
+        return;
+    }
+    ring_rx_update(ring);
+    memset(&evt, 0, sizeof(evt));
+    pending = ring->wr_total - ring->rd_total;
+    if (pending > param->buff_len - ring->blk_len) {
+        /*
+         * Keep one block ahead of the write position out of the delivery,
+         * DMA is filling it while the callback runs
+         */
+        evt.flags |= UART_RING_RX_OVERRUN;
+        evt.lost       = pending - (param->buff_len - ring->blk_len);
+        ring->rd_total = ring->wr_total - (param->buff_len - ring->blk_len);
+        ring->rd_pos   = (ring->wr_pos + ring->blk_len) % param->buff_len;
+        ring->overruns++;
+        pending = param->buff_len - ring->blk_len;
+    } else if (!pending) {
+        ring_rx_unlock(mie);
+        return;
+    }
+    evt.flags |= flags;
+    evt.data[0] = param->buffer + ring->rd_pos;
+    evt.len[0]  = MIN(pending, param->buff_len - ring->rd_pos);
+    evt.data[1] = param->buffer;
+    evt.len[1]  = pending - evt.len[0];
+    ring->busy  = true;
+    ring_rx_unlock(mie);
+
+    if (param->callback) {
+        param->callback(ring->dev, &evt);
+    }
+
+    mie = ring_rx_lock();
+    ring->rd_total += pending;
+    ring->rd_pos = (ring->rd_pos + pending) % param->buff_len;
+    ring->busy   = false;
+    ring_rx_unlock(mie);
+}
+
+DRV_ISR_SECTION
+static void ring_rx_block_done(const void *param)
+{
+    UartRingRx *ring = (UartRingRx *)param;
+
+    ring->blk_done++;
+    ring_rx_deliver(ring, UART_RING_RX_BLOCK);
+}
+
+/* Rings are looked up by hal_uart_irq_handler, a full table leaves polling only */
+static void ring_rx_bind(UartRingRx *ring, bool bind)
+{
+    uint32_t mie;
+    uint8_t i;
+
+    mie = ring_rx_lock();
+    for (i = 0; i < HAL_UART_DEV_MAX; i++) {
+        if (bind ? !hal_ring[i] : hal_ring[i] == ring) {
+            hal_ring[i] = bind ? ring : NULL;
+            break;
+        }
+    }
+    ring_rx_unlock(mie);
+}
+
+int hal_uart_ring_rx_start(const UartDevice *dev, UartRingRx *ring, const UartRingRxParam *param)
+{
+    DmaInitCfg init_cfg;
+    DmacLliChainCfg chain_cfg;
+    DmacLliSeg *segs;
+    uint32_t idle_us, i;
+    int ret;
+
+    if (!dev || !dev->hw_cfg || !dev->xfer_cfg || !dev->dmac_dev || !ring || !param ||
+        !param->buffer)
+        return VSD_ERR_INVALID_POINTER;
+    if (!dev->hw_cfg->dma_mode || !dev->xfer_cfg->baud_rate)
+        return VSD_ERR_UNSUPPORTED;
+    if (param->blk_num < 2 || !param->buff_len || (param->buff_len % param->blk_num))
+        return VSD_ERR_INVALID_PARAM;
+    /* Lap detection counts one descriptor per block, blocks must not be split */
+    if (param->buff_len / param->blk_num >
+        MIN(dev->dmac_dev->max_blk_ts, UART_RING_RX_BLK_TS_MAX))
+        return VSD_ERR_INVALID_PARAM;
+
+    memset(ring, 0, sizeof(UartRingRx));
+    ring->dev     = dev;
+    ring->param   = *param;
+    ring->blk_len = param->buff_len / param->blk_num;
+    idle_us       = param->idle_us;
+    if (!idle_us) {
+        idle_us = DIV_ROUND_UP(UART_RING_RX_IDLE_CHARS * UART_RING_RX_CHAR_BITS * 1000000U,
+                               dev->xfer_cfg->baud_rate);
+    }
+    ring->idle_cycles = (uint64_t)idle_us * soc_cpu_clock_get_freq() / 1000000U;
+
+    memset(&init_cfg, 0, sizeof(init_cfg));
+    init_cfg.src_type    = DMA_UART;
+    init_cfg.dst_type    = DMA_PERI_MEM;
+    init_cfg.fifo_width  = WIDTH_8_BITS_TYPE;
+    init_cfg.mux_id      = dev->hw_cfg->rx_mux_id;
+    init_cfg.block_ts    = ring->blk_len;
+    init_cfg.src_addr    = param->fifo_addr ? param->fifo_addr : dev->hw_cfg->base;
+    init_cfg.dst_addr    = (uint32_t)(uintptr_t)param->buffer;
+    init_cfg.len         = param->buff_len;
+    init_cfg.trigger_lvl = 1;
+    init_cfg.is_cyclic   = true;
+    ret = hal_dmac_chan_init(dev->dmac_dev, &ring->xfer_cfg, &init_cfg);
+    if (ret != VSD_SUCCESS)
+        return ret;
+
+    ret = hal_dmac_lli_pool_init(&ring->pool, NULL, param->blk_num);
+    if (ret != VSD_SUCCESS)
+        goto err_chan;
+
+    segs = osal_malloc(param->blk_num * sizeof(DmacLliSeg));
+    if (!segs) {
+        ret = VSD_ERR_NO_MEMORY;
+        goto err_pool;
+    }
+    for (i = 0; i < param->blk_num; i++) {
+        segs[i].src_addr = init_cfg.src_addr;
+        segs[i].dst_addr = init_cfg.dst_addr + i * ring->blk_len;
+        segs[i].len      = ring->blk_len;
+    }
+    chain_cfg.segs         = segs;
+    chain_cfg.seg_num      = param->blk_num;
+    chain_cfg.irq_interval = 1;
+    chain_cfg.is_cyclic    = true;
+    ret = hal_dmac_lli_chain_build(dev->dmac_dev, &ring->pool, ring->xfer_cfg, &chain_cfg,
+                                   &ring->chain);
+    osal_free(segs);
+    if (ret != VSD_SUCCESS)
+        goto err_pool;
+
+    ring->idle_start      = __get_rv_cycle();
+    ring->dma_cb.callback = ring_rx_block_done;
+    ring->dma_cb.param    = ring;
+    ret = hal_dmac_lli_chain_start(dev->dmac_dev, ring->xfer_cfg, &ring->chain, &ring->dma_cb);
+    if (ret != VSD_SUCCESS)
+        goto err_chain;
+    ring_rx_bind(ring, true);
+    return VSD_SUCCESS;
+
+err_chain:
+    hal_dmac_lli_chain_free(&ring->pool, &ring->chain);
+err_pool:
+    hal_dmac_lli_pool_deinit(&ring->pool);
+err_chan:
+    hal_dmac_chan_stop(dev->dmac_dev, ring->xfer_cfg);
+    ring->dev = NULL;
+    return ret;
+}
+
+static void ring_rx_check_idle(UartRingRx *ring)
+{
+    uint64_t now;
+    uint32_t mie;
+    bool idle = false;
+
+    now = __get_rv_cycle();
+    mie = ring_rx_lock();
+    ring_rx_update(ring);
+    if (ring->wr_total != ring->idle_wr) {
+        ring->idle_wr    = ring->wr_total;
+        ring->idle_start = now;
+    } else if (ring->wr_total != ring->rd_total) {
+        idle = (now - ring->idle_start) >= ring->idle_cycles;
+    }
+    ring_rx_unlock(mie);
+
+    if (idle)
+        ring_rx_deliver(ring, UART_RING_RX_IDLE);
+}
+
+int hal_uart_ring_rx_poll(UartRingRx *ring)
+{
+    if (!ring || !ring->dev)
+        return VSD_ERR_INVALID_POINTER;
+
+    ring_rx_check_idle(ring);
+    return VSD_SUCCESS;
+}
+
+int hal_uart_ring_rx_flush(UartRingRx *ring)
+{
+    if (!ring || !ring->dev)
+        return VSD_ERR_INVALID_POINTER;
+
+    ring_rx_deliver(ring, UART_RING_RX_IDLE);
+    return VSD_SUCCESS;
+}
+
+int hal_uart_ring_rx_stop(UartRingRx *ring)
+{
+    int ret;
+
+    if (!ring || !ring->dev)
+        return VSD_ERR_INVALID_POINTER;
+
+    ret = hal_dmac_chan_stop(ring->dev->dmac_dev, ring->xfer_cfg);
+    if (ret != VSD_SUCCESS)
+        return ret;
+    ring_rx_bind(ring, false);
+    hal_dmac_lli_chain_free(&ring->pool, &ring->chain);
+    hal_dmac_lli_pool_deinit(&ring->pool);
+    ring->dev = NULL;
+    return VSD_SUCCESS;
 }
@@ -37,6 +37,10 @@
 #include "osal_task_api.h"
 #include "vpi_error.h"
 #include "main.h"
+#include "boot_init.h"
+#if CONFIG_PMP_STACK_GUARD
+#include "pmp_stack_guard.h"
+#endif
 
 static void task_sample(void *param)
 {
@@ -56,11 +60,18 @@ static void task_init_app(void *param)
 {
     BoardDevice board_dev;
 
+    boot_mark("scheduler");
+    boot_init_run(BOOT_LEVEL_POST_KERNEL);
+
     /* Initialize board */
     board_register(board_get_ops());
     board_init((void *)&board_dev);
     if (board_dev.name)
         uart_printf("Board: %s", board_dev.name);
+    boot_mark("board_init");
+
+    /* Non critical init runs concurrently with the application */
+    boot_init_run(BOOT_LEVEL_APPLICATION);
 
     uart_printf("Hello VeriHealthi!\r\n");
 
@@ -72,6 +83,7 @@ int main(void)
 {
     int ret;
 
+    boot_mark("main");
     ret = soc_init();
     ret = vsd_to_vpi(ret);
     if (ret != VPI_SUCCESS) {
@@ -83,6 +95,13 @@ int main(void)
     } else {
         uart_printf("soc init done");
     }
+    boot_mark("soc_init");
+    boot_init_run(BOOT_LEVEL_PRE_KERNEL_1);
+    boot_init_run(BOOT_LEVEL_PRE_KERNEL_2);
+#if CONFIG_PMP_STACK_GUARD
+    if (vsd_to_vpi(pmp_stack_guard_init()) != VPI_SUCCESS)
+        uart_printf("no pmp stack guard");
+#endif
 
     osal_create_task(task_init_app, "init_app", 512, 1, NULL);
     osal_start_scheduler();
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _BIO_CODEC_H_
+#define _BIO_CODEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup BIO_CODEC
+ *  Lossless block codec of biosignal samples, prediction and adaptive Rice
+ *  @ingroup VPI
+ *  @{
+ */
+
+/*
+ * Each block decodes on its own, so a lost BLE notification loses only its
+ * samples. Layout, decoded by tools/bio_codec.py as well:
+ *
+ *   byte 0     0xB0 | mode, mode 0 to 3 is the predictor order, 0xF raw
+ *   byte 1     bits per sample
+ *   byte 2, 3  number of samples, little endian
+ *   byte 4     initial Rice parameter
+ *   byte 5     sequence number, +1 per block
+ *   then the residuals MSB first, padded with 0 to a byte
+ *
+ * Order k predicts with the k-th difference, e.g. 2 x[n-1] - x[n-2] for 2,
+ * the first samples of a block use the lower orders. A residual r is coded
+ * as u = 2r or -2r - 1 with Rice parameter k: u >> k zeros, a 1, then the k
+ * low bits. u >> k >= BIO_CODEC_ESCAPE is coded as BIO_CODEC_ESCAPE zeros,
+ * a 1 and u in bits + 4 bits. k adapts per sample to the mean of u as in
+ * LOCO-I, starting from byte 4. Blocks that would not be smaller than the
+ * samples are sent raw, two's complement in bits bits
+ */
+
+#define BIO_CODEC_HEADER      6
+#define BIO_CODEC_BLOCK_MAX   4096
+#define BIO_CODEC_ESCAPE      20
+/** Largest encoded block of num samples */
+#define BIO_CODEC_BOUND(num, bits) (BIO_CODEC_HEADER + ((num) * (bits) + 7) / 8)
+/** BioCodecCfg order chosen per block as the one with the smallest residuals */
+#define BIO_CODEC_ORDER_AUTO  0xff
+
+/**
+ * @brief Encoder configuration
+ */
+typedef struct BioCodecCfg {
+    uint8_t bits;  /**< Sample width, 8 to 24 */
+    uint8_t order; /**< Predictor order 0 to 3, or BIO_CODEC_ORDER_AUTO */
+} BioCodecCfg;
+
+/**
+ * @brief Encoder state, owned by caller
+ */
+typedef struct BioEncoder {
+    BioCodecCfg cfg;
+    uint8_t seq;        /**< Sequence number of the next block */
+    uint32_t samples;   /**< Samples encoded */
+    uint32_t bytes;     /**< Bytes produced, headers included */
+} BioEncoder;
+
+/**
+ * @brief Initialize an encoder
+ * @param enc The encoder
+ * @param cfg Configuration
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int bio_encoder_init(BioEncoder *enc, const BioCodecCfg *cfg);
+
+/**
+ * @brief Encode one block
+ * @param enc The encoder
+ * @param in Samples, sign extended, within bits
+ * @param num Number of samples, 1 to BIO_CODEC_BLOCK_MAX
+ * @param out Block
+ * @param size Size of out, at least BIO_CODEC_BOUND(num, bits)
+ * @param used Bytes written
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ * @note One pass chooses the order and one codes, nothing is allocated
+ */
+int bio_encode(BioEncoder *enc, const int32_t *in, uint32_t num, uint8_t *out, uint32_t size,
+               uint32_t *used);
+
+/**
+ * @brief Decode one block
+ * @param in Data starting with a block
+ * @param size Bytes in in
+ * @param out Samples, sign extended
+ * @param num_max Capacity of out
+ * @param num Samples decoded
+ * @param used Bytes of the block, the next block starts after them
+ * @param seq Sequence number of the block, may be NULL
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_BAD_DATA for a corrupt
+ * block, others for failure
+ */
+int bio_decode(const uint8_t *in, uint32_t size, int32_t *out, uint32_t num_max, uint32_t *num,
+               uint32_t *used, uint8_t *seq);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BIO_CODEC_H_ */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _BOOT_INIT_H_
+#define _BOOT_INIT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bsp_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup BOOT_INIT
+ *  Boot checkpoints and init functions with dependencies
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Max number of boot checkpoints */
+#define BOOT_MARK_NUM 24
+/** Max number of init entries over all levels */
+#define BOOT_INIT_MAX 48
+/** Tasks running APPLICATION level entries concurrently */
+#define BOOT_INIT_WORKERS 2
+
+/**
+ * Init levels, in the order of the .z_init_* sections of the linker script
+ */
+typedef enum BootLevel {
+    BOOT_LEVEL_PRE_KERNEL_1 = 0, /**< Run by main right after soc_init */
+    BOOT_LEVEL_PRE_KERNEL_2,     /**< Run by main before the scheduler starts */
+    BOOT_LEVEL_POST_KERNEL,      /**< Run in order by the init task */
+    BOOT_LEVEL_APPLICATION,      /**< Run concurrently by worker tasks */
+    BOOT_LEVEL_NUM,
+} BootLevel;
+
+/** The entry is skipped at its level and runs on first boot_init_require */
+#define BOOT_INIT_LAZY BIT(0)
+
+/**
+ * @brief An init entry, placed in ROM by BOOT_INIT or BOOT_INIT_DEPS
+ */
+typedef struct BootInitEntry {
+    const char *name;
+    int (*init)(void);
+    /** Names of the entries which must be done before, the first is unused */
+    const char *const *deps;
+    uint8_t dep_num;
+    uint8_t flags;
+} __attribute__((aligned(4))) BootInitEntry;
+
+/**
+ * @brief Output function of the report
+ * @param line A text line, terminated by newline
+ * @param arg Argument given to boot_init_dump
+ */
+typedef void (*BootWriter)(const char *line, void *arg);
+
+/**
+ * @brief Declare an init function with dependencies
+ * @param level PRE_KERNEL_1, PRE_KERNEL_2, POST_KERNEL or APPLICATION
+ * @param prio 0 to 99, lower runs first within a level
+ * @param fn Function of type int (*)(void), returns VPI_SUCCESS for succeed
+ * @param flags 0 or BOOT_INIT_LAZY
+ * @param ... Names of the functions this one depends on, as strings
+ */
+#define BOOT_INIT_DEPS(level, prio, fn, flags, ...)                                        \
+    static const char *const __boot_deps_##fn[] = {NULL, ##__VA_ARGS__};                  \
+    static const BootInitEntry __boot_init_##fn                                            \
+        __attribute__((used, section(".z_init_" #level #prio "_" #fn))) = {                \
+            #fn, fn, __boot_deps_##fn,                                                      \
+            sizeof(__boot_deps_##fn) / sizeof(__boot_deps_##fn[0]) - 1, (flags)}
+
+/** Declare an init function without dependencies, see BOOT_INIT_DEPS */
+#define BOOT_INIT(level, prio, fn, flags) BOOT_INIT_DEPS(level, prio, fn, flags)
+
+/**
+ * @brief Record a named checkpoint with the cycles since reset
+ * @param name Name of the checkpoint, must be a string literal
+ * @note Can be called before the scheduler starts, later marks are dropped
+ * when BOOT_MARK_NUM is reached
+ */
+void boot_mark(const char *name);
+
+/**
+ * @brief Run the entries of a level
+ * @param level BOOT_LEVEL_PRE_KERNEL_1 to BOOT_LEVEL_POST_KERNEL run in order
+ * in the caller, BOOT_LEVEL_APPLICATION starts the worker tasks and returns
+ * @return Return VPI_SUCCESS for succeed, or the first error of an entry
+ */
+int boot_init_run(BootLevel level);
+
+/**
+ * @brief Run an entry now if it did not run yet, e.g. a lazy one
+ * @param name Name of the init function
+ * @return Return value of the init function, VPI_ERR_INVALID if unknown
+ */
+int boot_init_require(const char *name);
+
+/**
+ * @brief Wait until all entries which are not lazy are done
+ * @param timeout_ms Timeout in milliseconds
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_TIMEOUT for timeout
+ */
+int boot_init_wait(uint32_t timeout_ms);
+
+/**
+ * @brief Print checkpoints and the duration of each init function
+ * @param writer Output function
+ * @param arg Argument given to writer
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int boot_init_dump(BootWriter writer, void *arg);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BOOT_INIT_H_ */
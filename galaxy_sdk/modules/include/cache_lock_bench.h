@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _CACHE_LOCK_BENCH_H_
+#define _CACHE_LOCK_BENCH_H_
+
+#include <stdint.h>
+#include "vs_conf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup CACHE_LOCK_BENCH
+ *  Worst case timing of code with and without locked cache lines
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Bytes of code executed to evict the I-Cache, at least twice its size */
+#ifndef CONFIG_CACHE_BENCH_SWEEP_SIZE
+#define CONFIG_CACHE_BENCH_SWEEP_SIZE 65536
+#endif
+
+/**
+ * With CONFIG_CACHE_LOCK_ITEXT set, .itext is locked into the I-Cache after
+ * the kernel starts, within these budgets of hal_cache_lock_init
+ */
+#ifndef CONFIG_CACHE_LOCK_ICACHE_BUDGET
+#define CONFIG_CACHE_LOCK_ICACHE_BUDGET 8192
+#endif
+#ifndef CONFIG_CACHE_LOCK_DCACHE_BUDGET
+#define CONFIG_CACHE_LOCK_DCACHE_BUDGET 4096
+#endif
+
+/**
+ * @brief Code under test, e.g. the body of an ISR, and the memory it uses
+ */
+typedef struct CacheBenchCfg {
+    void (*func)(void *arg); /**< Function to time */
+    void *arg;               /**< Argument of func */
+    const void *code;        /**< Code to lock, usually func itself */
+    uint32_t code_size;      /**< Size of code, from the map file */
+    const void *data;        /**< Data to lock, e.g. a coefficient table, can be NULL */
+    uint32_t data_size;      /**< Size of data */
+    uint32_t runs;           /**< Runs of each phase */
+} CacheBenchCfg;
+
+/**
+ * @brief Timing of one phase in CPU cycles
+ */
+typedef struct CacheBenchStat {
+    uint32_t min;
+    uint32_t max;
+    uint32_t avg;
+} CacheBenchStat;
+
+/**
+ * @brief Timing without and with the code and data locked
+ */
+typedef struct CacheBenchResult {
+    CacheBenchStat unlocked;
+    CacheBenchStat locked;
+} CacheBenchResult;
+
+/**
+ * @brief Output function of the report
+ * @param line A text line, terminated by newline
+ * @param arg Argument given to cache_lock_report
+ */
+typedef void (*CacheBenchWriter)(const char *line, void *arg);
+
+/**
+ * @brief Time func after its lines were evicted, then with them locked
+ * @param cfg Code under test
+ * @param res Timing of both phases
+ * @note hal_cache_lock_init must be called before. Before each run of both
+ * phases twice the I-Cache size of code is executed and twice the D-Cache
+ * size of flash is read, as by other tasks. Only locked lines survive.
+ * Interrupts are disabled while timing
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int cache_lock_bench_run(const CacheBenchCfg *cfg, CacheBenchResult *res);
+
+/**
+ * @brief Print the locked set and the budget usage of both caches
+ * @param writer Output function
+ * @param arg Argument given to writer
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int cache_lock_report(CacheBenchWriter writer, void *arg);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CACHE_LOCK_BENCH_H_ */
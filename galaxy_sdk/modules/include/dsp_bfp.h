@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_BFP_H_
+#define _DSP_BFP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_BFP
+ *  Block floating point q15, one exponent shared by a block of samples
+ *  @ingroup VPI
+ *  @{
+ */
+
+/**
+ * A block is q15 data and an int32_t exponent exp, sample i stands for
+ * data[i] / 32768 * 2^exp. Compared to riscv_dsp q15, which scales down by
+ * a fixed amount per stage, the exponent follows the actual level so quiet
+ * blocks keep the full 16 bits of resolution
+ */
+
+/** Exponent returned for a block of zeros, above no other */
+#define BFP_EXP_ZERO INT16_MIN
+
+/** Supported CFFT lengths, powers of 2 */
+#define BFP_CFFT_LEN_MIN 16
+#define BFP_CFFT_LEN_MAX 4096
+
+/**
+ * Magnitude bits of the input of a radix-2 stage, the outputs of a larger
+ * input are shifted right by the excess. A butterfly grows a component by
+ * at most 1 + sqrt(2), so 13 bits cannot overflow
+ */
+#define BFP_CFFT_BITS 13
+
+/**
+ * @brief Get the number of bits of the largest magnitude in a block
+ * @param src Samples
+ * @param len Number of samples
+ * @return 0 to 15, -32768 counts as 15 bits
+ */
+uint32_t bfp_bits_q15(const q15_t *src, uint32_t len);
+
+/**
+ * @brief Shift a block so that its largest magnitude has bits bits
+ * @param data Samples, rescaled in place
+ * @param len Number of samples
+ * @param bits Magnitude bits, 1 to 15
+ * @return Exponent change, add it to the exponent of the block. 0 for a
+ * block of zeros
+ */
+int32_t bfp_norm_q15(q15_t *data, uint32_t len, uint32_t bits);
+
+/**
+ * @brief Shift a block, the right shifts round to nearest
+ * @param data Samples, rescaled in place
+ * @param len Number of samples
+ * @param shift Left shift, negative for right shifts, the samples must
+ * have the headroom for left shifts
+ */
+void bfp_shift_q15(q15_t *data, uint32_t len, int32_t shift);
+
+/**
+ * @brief Convert floats to a block at full scale
+ * @param src Inputs, finite
+ * @param dst Samples
+ * @param len Number of samples
+ * @return Exponent of the block, BFP_EXP_ZERO for zeros
+ */
+int32_t bfp_from_f32(const float32_t *src, q15_t *dst, uint32_t len);
+
+/**
+ * @brief Convert a block to floats
+ * @param src Samples
+ * @param exp Exponent of the block
+ * @param dst Outputs
+ * @param len Number of samples
+ */
+void bfp_to_f32(const q15_t *src, int32_t exp, float32_t *dst, uint32_t len);
+
+/**
+ * @brief Complex FFT of a block, radix-2 with a scaling decision per stage
+ * @note Each stage shifts its outputs right by the bits of its input above
+ * BFP_CFFT_BITS, with rounding, and counts the shift in the exponent. The
+ * butterflies use the packed DSP multiply-add of the P extension on
+ * (re, im) words. Noise stays near 0.5 LSB of the block per stage whatever
+ * the level, where riscv_cfft_q15 loses a bit per stage of quiet inputs
+ */
+typedef struct BfpCfftQ15 {
+    const q15_t *twiddle; /**< cos and sin of 2 pi k / len, from riscv_cfft_init_q15 */
+    uint16_t len;         /**< Complex samples */
+    uint8_t log2_len;
+} BfpCfftQ15;
+
+/**
+ * @brief Initialize a CFFT, the twiddle tables of riscv_dsp are shared
+ * @param fft The CFFT
+ * @param len Complex samples, BFP_CFFT_LEN_MIN to BFP_CFFT_LEN_MAX
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int bfp_cfft_init_q15(BfpCfftQ15 *fft, uint16_t len);
+
+/**
+ * @brief Transform a block in place, in and out in natural order
+ * @param fft The CFFT
+ * @param data len interleaved re and im, 4 byte aligned
+ * @param exp Exponent of the block, updated for the output. The forward
+ * transform is not scaled, the inverse one is scaled by 1 / len so that
+ * it restores the input
+ * @param inverse true for the inverse transform
+ */
+void bfp_cfft_q15(const BfpCfftQ15 *fft, q15_t *data, int32_t *exp, bool inverse);
+
+/**
+ * @brief FIR filter over blocks of varying exponents, on riscv_fir_q15
+ * @note The taps are stored at full scale as taps * 2^-gain, gain being
+ * the smallest integer with sum(|taps|) <= 2^gain, so the output cannot
+ * overflow. Each call brings the history and the new block to the
+ * exponent of the larger one at full scale, the output exponent is that
+ * plus gain. Quiet blocks after a loud one are lifted once the loud
+ * samples leave the history
+ */
+typedef struct BfpFirQ15 {
+    riscv_fir_instance_q15 fir;
+    uint32_t block;    /**< Max samples per call */
+    int32_t gain;      /**< Exponent of the stored taps */
+    int32_t state_exp; /**< Exponent of the history in the state */
+} BfpFirQ15;
+
+/**
+ * @brief Initialize a FIR filter
+ * @param fir The filter
+ * @param taps Number of taps, even and 4 or more as for riscv_fir_q15
+ * @param coeffs Taps in the order of riscv_fir_init_q15, time reversed
+ * @param coeff_buf taps q15_t for the scaled taps, owned by caller
+ * @param state taps + block - 1 q15_t, owned by caller
+ * @param block Max samples per call
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int bfp_fir_init_q15(BfpFirQ15 *fir, uint16_t taps, const float32_t *coeffs, q15_t *coeff_buf,
+                     q15_t *state, uint32_t block);
+
+/**
+ * @brief Drop the history
+ * @param fir The filter
+ */
+void bfp_fir_reset_q15(BfpFirQ15 *fir);
+
+/**
+ * @brief Filter a block
+ * @param fir The filter
+ * @param src Samples, rescaled in place to the common exponent
+ * @param exp Exponent of src
+ * @param dst Outputs, not src
+ * @param dst_exp Exponent of the outputs
+ * @param len Number of samples, up to the block of bfp_fir_init_q15
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int bfp_fir_q15(BfpFirQ15 *fir, q15_t *src, int32_t exp, q15_t *dst, int32_t *dst_exp,
+                uint32_t len);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_BFP_H_ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_BFP_BENCH_H_
+#define _DSP_BFP_BENCH_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_BFP_BENCH
+ *  SNR and cycles of the q15, q31, block floating point and f32 paths
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Samples per block, also the CFFT length */
+#define BFP_BENCH_BLOCK 256
+/** Taps of the low pass FIR, cutoff at fs / 8 */
+#define BFP_BENCH_TAPS 32
+/** Blocks per level of the synthetic signal */
+#define BFP_BENCH_RUNS 4
+/** Min SNR in dB of the block floating point paths on the synthetic signal */
+#define BFP_BENCH_SNR_MIN 55
+
+/**
+ * @brief Feed a signal block by block through the CFFT and the FIR in
+ * q15, q31, block floating point q15 and f32, and print per path the SNR
+ * against a double precision reference, the cycles of the kernel per
+ * block and the bytes per sample
+ * @param path File of little endian float32 samples, clipped to [-1, 1],
+ * read through semihosting so a recording on the host can be analyzed in
+ * QEMU. NULL for a synthetic signal of two tones and noise at 0, -20, -40
+ * and -60 dBFS
+ * @note Conversions to and from the formats are not counted. The CFFT
+ * takes the real block with a zero imaginary part. The reference is a
+ * direct DFT, slow without a double precision FPU
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_IO when the file cannot
+ * be read, VPI_ERR_BAD_DATA when a block floating point path is below
+ * BFP_BENCH_SNR_MIN on the synthetic signal
+ */
+int dsp_bfp_bench_run(const char *path);
+
+/**
+ * @brief Add the "bfp [file]" command to the shell, it calls
+ * dsp_bfp_bench_run
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ * @note CONFIG_DSP_BFP_BENCH analyzes the synthetic signal at boot. The
+ * command is left out if a block floating point path misses
+ * BFP_BENCH_SNR_MIN there
+ */
+int dsp_bfp_bench_init(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_BFP_BENCH_H_ */
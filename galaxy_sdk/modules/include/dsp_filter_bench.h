@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_FILTER_BENCH_H_
+#define _DSP_FILTER_BENCH_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_FILTER_BENCH
+ *  Generic riscv_dsp filters against the kernels of dsp_fixed_filter.h
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Sizes of the benchmarked filters */
+#define FILTER_BENCH_TAPS   32
+#define FILTER_BENCH_STAGES 4
+#define FILTER_BENCH_BLOCK  64
+
+/**
+ * @brief Run the generic and the fixed filters on the same pseudo-random
+ * blocks, full scale ones included so that the outputs saturate
+ * @return Return VPI_SUCCESS when all outputs are equal, VPI_ERR_BAD_DATA
+ * otherwise
+ */
+int dsp_filter_bench_check(void);
+
+/**
+ * @brief Add the benchmarks to the shell, one block per run: fir_q15,
+ * fir_q7 and biquad_q15 for riscv_dsp, the same with _fix for the kernels
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ * @note CONFIG_DSP_FILTER_BENCH adds them at boot, but only when the fixed
+ * kernels match riscv_dsp bit for bit
+ */
+int dsp_filter_bench_init(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_FILTER_BENCH_H_ */
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_FIXED_FILTER_H_
+#define _DSP_FIXED_FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_FIXED_FILTER
+ *  FIR and biquad kernels specialized for a tap count and block size
+ *  @ingroup VPI
+ *  @{
+ */
+
+/*
+ * The DEFINE macros generate a struct and two functions for constant sizes,
+ * the kernels below are always inlined into them so the tap and stage loops
+ * unroll completely and the coefficients are packed two (q15) or four (q7)
+ * per word for the 64-bit and 32-bit SIMD MACs:
+ *
+ *   DSP_FIR_Q15_DEFINE(ecg_lp, 32, 64);
+ *   static struct ecg_lp lp;
+ *   ecg_lp_init(&lp, coeffs);   // same coefficients as riscv_fir_init_q15
+ *   ecg_lp_run(&lp, in, out);   // 64 samples, in may equal out
+ *
+ * Outputs are bit-exact with riscv_fir_q15, riscv_fir_q7 and
+ * riscv_biquad_cascade_df1_q15 fed with the same blocks.
+ */
+
+/** Max stages of DSP_BIQUAD_Q15_DEFINE */
+#define DSP_BIQUAD_STAGES_MAX 8
+
+#define DSP_UNROLL _Pragma("GCC unroll 128")
+
+/* Words of samples loaded from q15_t and q7_t arrays */
+typedef uint32_t __attribute__((__may_alias__)) dsp_word_t;
+
+__STATIC_FORCEINLINE uint32_t dsp_pack16(int32_t lo, int32_t hi)
+{
+    return (uint16_t)lo | (uint32_t)(uint16_t)hi << 16;
+}
+
+__STATIC_FORCEINLINE uint32_t dsp_pack8(int32_t b0, int32_t b1, int32_t b2, int32_t b3)
+{
+    return (uint8_t)b0 | (uint32_t)(uint8_t)b1 << 8 | (uint32_t)(uint8_t)b2 << 16 |
+           (uint32_t)(uint8_t)b3 << 24;
+}
+
+/* t + a.h0 * b.h0 + a.h1 * b.h1 */
+__STATIC_FORCEINLINE int64_t dsp_smalda(int64_t t, uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SMALDA(t, a, b);
+#else
+    return t + (int16_t)a * (int16_t)b + (int16_t)(a >> 16) * (int16_t)(b >> 16);
+#endif
+}
+
+/* t + the four products of the signed bytes */
+__STATIC_FORCEINLINE int32_t dsp_smaqa(int32_t t, uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SMAQA(t, a, b);
+#else
+    for (uint32_t i = 0; i < 32; i += 8) {
+        t += (int8_t)(a >> i) * (int8_t)(b >> i);
+    }
+    return t;
+#endif
+}
+
+/* a.h0 moves to the top, b.h0 becomes the bottom */
+__STATIC_FORCEINLINE uint32_t dsp_pkbb16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_PKBB16(a, b);
+#else
+    return a << 16 | (uint16_t)b;
+#endif
+}
+
+/* Coefficient c[i] of riscv_fir order, 0 outside the taps */
+#define DSP_FIR_COEF(c, taps, i) ((i) >= 0 && (i) < (int32_t)(taps) ? (c)[i] : 0)
+
+/*
+ * y[n] = sum of c[i] * s[n + i] over the state s, oldest sample first.
+ * Even outputs start on a word of s and use the pairs (c[2j], c[2j + 1]),
+ * odd ones use (c[2j - 1], c[2j]) on the same words, so every load is
+ * aligned and two outputs share it
+ */
+__STATIC_FORCEINLINE void dsp_fir_q15_init(uint32_t *ce, uint32_t *co, q15_t *state,
+                                           const q15_t *coeffs, uint32_t taps, uint32_t len)
+{
+    for (int32_t j = 0; j < (int32_t)(taps + 1) / 2; j++) {
+        ce[j] = dsp_pack16(DSP_FIR_COEF(coeffs, taps, 2 * j),
+                           DSP_FIR_COEF(coeffs, taps, 2 * j + 1));
+    }
+    for (int32_t j = 0; j < (int32_t)taps / 2 + 1; j++) {
+        co[j] = dsp_pack16(DSP_FIR_COEF(coeffs, taps, 2 * j - 1),
+                           DSP_FIR_COEF(coeffs, taps, 2 * j));
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        state[i] = 0;
+    }
+}
+
+__STATIC_FORCEINLINE void dsp_fir_q15_run(q15_t *state, const uint32_t *ce, const uint32_t *co,
+                                          const q15_t *in, q15_t *out, uint32_t taps,
+                                          uint32_t block)
+{
+    const dsp_word_t *w = (const dsp_word_t *)state;
+
+    for (uint32_t i = 0; i < block; i++) {
+        state[taps - 1 + i] = in[i];
+    }
+    for (uint32_t n = 0; n < block; n += 2, w++) {
+        int64_t a0 = 0, a1 = 0;
+
+        DSP_UNROLL
+        for (uint32_t j = 0; j < (taps + 1) / 2; j++) {
+            a0 = dsp_smalda(a0, ce[j], w[j]);
+        }
+        DSP_UNROLL
+        for (uint32_t j = 0; j < taps / 2 + 1; j++) {
+            a1 = dsp_smalda(a1, co[j], w[j]);
+        }
+        /* riscv_fir_q15 truncates the 34.30 sum to 32 bits before saturating */
+        out[n]     = (q15_t)__SSAT((int32_t)(a0 >> 15), 16);
+        out[n + 1] = (q15_t)__SSAT((int32_t)(a1 >> 15), 16);
+    }
+    for (uint32_t i = 0; i < taps - 1; i++) {
+        state[i] = state[block + i];
+    }
+}
+
+/* As the q15 one with four phases of the coefficients, output 4q + p uses phase p */
+#define DSP_FIR_Q7_WORDS(taps) (((taps) + 6) / 4)
+
+__STATIC_FORCEINLINE void dsp_fir_q7_init(uint32_t *cp, q7_t *state, const q7_t *coeffs,
+                                          uint32_t taps, uint32_t len)
+{
+    for (int32_t p = 0; p < 4; p++) {
+        for (int32_t j = 0; j < (int32_t)DSP_FIR_Q7_WORDS(taps); j++) {
+            int32_t i = 4 * j - p;
+
+            cp[p * DSP_FIR_Q7_WORDS(taps) + j] =
+                dsp_pack8(DSP_FIR_COEF(coeffs, taps, i), DSP_FIR_COEF(coeffs, taps, i + 1),
+                          DSP_FIR_COEF(coeffs, taps, i + 2), DSP_FIR_COEF(coeffs, taps, i + 3));
+        }
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        state[i] = 0;
+    }
+}
+
+__STATIC_FORCEINLINE void dsp_fir_q7_run(q7_t *state, const uint32_t *cp, const q7_t *in,
+                                         q7_t *out, uint32_t taps, uint32_t block)
+{
+    const dsp_word_t *w = (const dsp_word_t *)state;
+
+    for (uint32_t i = 0; i < block; i++) {
+        state[taps - 1 + i] = in[i];
+    }
+    for (uint32_t n = 0; n < block; n += 4, w++) {
+        DSP_UNROLL
+        for (uint32_t p = 0; p < 4; p++) {
+            const uint32_t *c = cp + p * DSP_FIR_Q7_WORDS(taps);
+            int32_t acc       = 0;
+
+            DSP_UNROLL
+            for (uint32_t j = 0; j < DSP_FIR_Q7_WORDS(taps); j++) {
+                acc = dsp_smaqa(acc, c[j], w[j]);
+            }
+            out[n + p] = (q7_t)__SSAT(acc >> 7, 8);
+        }
+    }
+    for (uint32_t i = 0; i < taps - 1; i++) {
+        state[i] = state[block + i];
+    }
+}
+
+/*
+ * Direct form I as riscv_biquad_cascade_df1_q15: coefficients
+ * {b0, 0, b1, b2, a1, a2} and state {x[n-1], x[n-2], y[n-1], y[n-2]} per
+ * stage, the state words are the same bytes. All stages run per sample with
+ * their states in registers
+ */
+__STATIC_FORCEINLINE void dsp_biquad_q15_init(uint32_t *cf, uint32_t *state, const q15_t *coeffs,
+                                              uint32_t stages)
+{
+    for (uint32_t k = 0; k < stages; k++, coeffs += 6) {
+        cf[3 * k]     = dsp_pack16(coeffs[0], 0);
+        cf[3 * k + 1] = dsp_pack16(coeffs[2], coeffs[3]);
+        cf[3 * k + 2] = dsp_pack16(coeffs[4], coeffs[5]);
+        state[2 * k]     = 0;
+        state[2 * k + 1] = 0;
+    }
+}
+
+__STATIC_FORCEINLINE void dsp_biquad_q15_run(uint32_t *state, const uint32_t *cf, uint32_t shift,
+                                             const q15_t *in, q15_t *out, uint32_t stages,
+                                             uint32_t block)
+{
+    uint32_t xs[DSP_BIQUAD_STAGES_MAX], ys[DSP_BIQUAD_STAGES_MAX];
+
+    DSP_UNROLL
+    for (uint32_t k = 0; k < stages; k++) {
+        xs[k] = state[2 * k];
+        ys[k] = state[2 * k + 1];
+    }
+    for (uint32_t n = 0; n < block; n++) {
+        int32_t x = in[n];
+
+        DSP_UNROLL
+        for (uint32_t k = 0; k < stages; k++) {
+            int64_t acc = (int16_t)cf[3 * k] * x;
+            int32_t y;
+
+            acc   = dsp_smalda(acc, cf[3 * k + 1], xs[k]);
+            acc   = dsp_smalda(acc, cf[3 * k + 2], ys[k]);
+            y     = __SSAT((int32_t)(acc >> shift), 16);
+            xs[k] = dsp_pkbb16(xs[k], x);
+            ys[k] = dsp_pkbb16(ys[k], y);
+            x     = y;
+        }
+        out[n] = (q15_t)x;
+    }
+    DSP_UNROLL
+    for (uint32_t k = 0; k < stages; k++) {
+        state[2 * k]     = xs[k];
+        state[2 * k + 1] = ys[k];
+    }
+}
+
+/**
+ * @brief Define struct name and name_init(), name_run() for a q15 FIR
+ * @param name Name of the filter
+ * @param taps Number of taps, 2 or more
+ * @param block Samples per name_run(), even
+ * @note name_init(struct name *f, const q15_t *coeffs) takes the
+ * coefficients in riscv_fir_q15 order, name_run(struct name *f,
+ * const q15_t *in, q15_t *out) filters block samples
+ */
+#define DSP_FIR_Q15_DEFINE(name, taps, block)                                                  \
+    struct name {                                                                              \
+        uint32_t ce[((taps) + 1) / 2];                                                         \
+        uint32_t co[(taps) / 2 + 1];                                                           \
+        q15_t state[(taps) + (block) + 1] __attribute__((aligned(4)));                         \
+    };                                                                                         \
+    static inline void name##_init(struct name *f, const q15_t *coeffs)                        \
+    {                                                                                          \
+        dsp_fir_q15_init(f->ce, f->co, f->state, coeffs, (taps), (taps) + (block) + 1);       \
+    }                                                                                          \
+    static inline void name##_run(struct name *f, const q15_t *in, q15_t *out)                 \
+    {                                                                                          \
+        dsp_fir_q15_run(f->state, f->ce, f->co, in, out, (taps), (block));                     \
+    }                                                                                          \
+    _Static_assert((taps) >= 2 && (block) >= 2 && (block) % 2 == 0, #name ": taps or block")
+
+/**
+ * @brief Define struct name and name_init(), name_run() for a q7 FIR
+ * @param name Name of the filter
+ * @param taps Number of taps, 2 or more
+ * @param block Samples per name_run(), a multiple of 4
+ * @note As DSP_FIR_Q15_DEFINE with q7_t and the riscv_fir_q7 order
+ */
+#define DSP_FIR_Q7_DEFINE(name, taps, block)                                                   \
+    struct name {                                                                              \
+        uint32_t cp[4 * DSP_FIR_Q7_WORDS(taps)];                                               \
+        q7_t state[(block) + 4 * DSP_FIR_Q7_WORDS(taps)] __attribute__((aligned(4)));          \
+    };                                                                                         \
+    static inline void name##_init(struct name *f, const q7_t *coeffs)                         \
+    {                                                                                          \
+        dsp_fir_q7_init(f->cp, f->state, coeffs, (taps), sizeof(f->state));                   \
+    }                                                                                          \
+    static inline void name##_run(struct name *f, const q7_t *in, q7_t *out)                   \
+    {                                                                                          \
+        dsp_fir_q7_run(f->state, f->cp, in, out, (taps), (block));                             \
+    }                                                                                          \
+    _Static_assert((taps) >= 2 && (block) >= 4 && (block) % 4 == 0, #name ": taps or block")
+
+/**
+ * @brief Define struct name and name_init(), name_run() for a q15 biquad cascade
+ * @param name Name of the filter
+ * @param stages Number of second order stages, 1 to DSP_BIQUAD_STAGES_MAX
+ * @param block Samples per name_run()
+ * @param post_shift postShift of riscv_biquad_cascade_df1_init_q15
+ * @note name_init(struct name *f, const q15_t *coeffs) takes 6 coefficients
+ * per stage in riscv_biquad_cascade_df1_q15 order
+ */
+#define DSP_BIQUAD_Q15_DEFINE(name, stages, block, post_shift)                                 \
+    struct name {                                                                              \
+        uint32_t cf[3 * (stages)];                                                             \
+        uint32_t state[2 * (stages)];                                                          \
+    };                                                                                         \
+    static inline void name##_init(struct name *f, const q15_t *coeffs)                        \
+    {                                                                                          \
+        dsp_biquad_q15_init(f->cf, f->state, coeffs, (stages));                                \
+    }                                                                                          \
+    static inline void name##_run(struct name *f, const q15_t *in, q15_t *out)                 \
+    {                                                                                          \
+        dsp_biquad_q15_run(f->state, f->cf, 15 - (post_shift), in, out, (stages), (block));    \
+    }                                                                                          \
+    _Static_assert((stages) >= 1 && (stages) <= DSP_BIQUAD_STAGES_MAX && (block) >= 1 &&       \
+                       (post_shift) >= 0 && (post_shift) < 15,                                 \
+                   #name ": stages, block or post_shift")
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_FIXED_FILTER_H_ */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_RESAMPLE_H_
+#define _DSP_RESAMPLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_RESAMPLE
+ *  Polyphase resampling between unrelated sample rates
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Limits of ResampleCfg */
+#define RESAMPLE_TAPS_MAX   128
+#define RESAMPLE_PHASES_MAX 1024
+/** Input samples copied per step, the history buffer is taps + this */
+#define RESAMPLE_CHUNK 64
+
+/** Sample format */
+typedef enum ResampleFormat {
+    RESAMPLE_Q15 = 0,
+    RESAMPLE_F32,
+} ResampleFormat;
+
+/**
+ * @brief Configuration of a resampler
+ * @note The filter is a Kaiser windowed sinc of taps input samples stored
+ * as phases + 1 rows, each row normalized to a DC gain of 1. RAM from
+ * resample_init is (phases + 1) * taps coefficients plus taps +
+ * RESAMPLE_CHUNK samples, 2 bytes each for q15 and 4 for f32. Strong
+ * decimation needs more taps for the same stopband, the transition band is
+ * about 4 / taps of the input rate
+ */
+typedef struct ResampleCfg {
+    uint32_t in_rate;  /**< Input rate, any unit shared with out_rate */
+    uint32_t out_rate; /**< Output rate */
+    uint16_t taps;     /**< Taps per phase, even, 4 to RESAMPLE_TAPS_MAX */
+    /**
+     * 0 for the exact ratio in_rate / out_rate with out_rate / gcd rows,
+     * which must not exceed RESAMPLE_PHASES_MAX. Otherwise rows of the table,
+     * 2 to RESAMPLE_PHASES_MAX, outputs interpolate linearly between two
+     * rows and resample_adjust may change the ratio
+     */
+    uint16_t phases;
+    float32_t cutoff; /**< Passband edge, fraction of the lower Nyquist rate, 0 to 1 */
+    uint8_t format;   /**< @see ResampleFormat */
+} ResampleCfg;
+
+/**
+ * @brief Runtime state of a resampler, owned by caller
+ * @note Output k is the input interpolated at time k * step since the last
+ * reset, with step the input samples per output, so streams resampled to
+ * the same rate stay aligned. It is available taps / 2 input samples later
+ */
+typedef struct Resample {
+    ResampleCfg cfg;
+    void *coef;        /**< Rows of taps coefficients, q15_t or float32_t */
+    void *buf;         /**< Input history */
+    uint32_t rows;     /**< Phases of the table, the extra last row is time 1 */
+    bool exact;        /**< Rational time and nearest row */
+    uint32_t avail;    /**< Samples in buf */
+    uint32_t pos;      /**< Start of the next output window in buf */
+    uint32_t frac;     /**< Time of the next output after pos, 2^-32 samples */
+    uint32_t rem;      /**< Remainder of frac in 1 / den */
+    uint64_t step;     /**< Input samples per output, 32.32 */
+    uint32_t step_rem; /**< Remainder of step in 1 / den */
+    uint32_t den;      /**< out_rate / gcd */
+    uint64_t nominal;  /**< step without adjustment */
+} Resample;
+
+/**
+ * @brief Get the RAM allocated by resample_init for a configuration
+ * @param cfg Configuration
+ * @return Bytes, 0 for an invalid configuration
+ */
+uint32_t resample_mem_size(const ResampleCfg *cfg);
+
+/**
+ * @brief Allocate the buffers and compute the coefficient table
+ * @param rs The resampler
+ * @param cfg Configuration
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int resample_init(Resample *rs, const ResampleCfg *cfg);
+
+/**
+ * @brief Free the buffers
+ * @param rs The resampler
+ */
+void resample_deinit(Resample *rs);
+
+/**
+ * @brief Drop buffered samples and restart the time at 0, the adjustment
+ * of the ratio is kept
+ * @param rs The resampler
+ */
+void resample_reset(Resample *rs);
+
+/**
+ * @brief Correct the ratio for clock drift, e.g. from timestamps
+ * @param rs The resampler, configured with phases
+ * @param ppm Input samples consumed per output are multiplied by
+ * 1 + ppm / 1e6, positive when the input clock runs fast, +-100000 at most
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int resample_adjust(Resample *rs, float32_t ppm);
+
+/**
+ * @brief Get the max outputs of one call
+ * @param rs The resampler
+ * @param len Input samples of the call
+ * @return Outputs
+ */
+uint32_t resample_out_max(const Resample *rs, uint32_t len);
+
+/**
+ * @brief Resample a block, all inputs are consumed
+ * @param rs The resampler, of the format of the function
+ * @param in Samples
+ * @param len Number of samples
+ * @param out Outputs
+ * @param out_len Capacity of out, at least resample_out_max, then outputs
+ * written
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int resample_process_q15(Resample *rs, const q15_t *in, uint32_t len, q15_t *out,
+                         uint32_t *out_len);
+int resample_process_f32(Resample *rs, const float32_t *in, uint32_t len, float32_t *out,
+                         uint32_t *out_len);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_RESAMPLE_H_ */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_STFT_H_
+#define _DSP_STFT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_STFT
+ *  Streaming short-time Fourier transform over riscv_dsp
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Supported FFT lengths, powers of 2 */
+#define STFT_LEN_MIN 32
+#define STFT_LEN_MAX 4096
+
+/** Sample format of input and spectrum */
+typedef enum StftFormat {
+    STFT_F32 = 0, /**< float32_t, riscv_rfft_fast_f32 */
+    STFT_Q15,     /**< q15_t, riscv_cfft_q15 of half length and a split step */
+} StftFormat;
+
+/** Window applied to each frame */
+typedef enum StftWindow {
+    STFT_WIN_RECT = 0,
+    STFT_WIN_HANN,
+    STFT_WIN_HAMMING,
+} StftWindow;
+
+/**
+ * Spectrum given to the callback. For fft_len N, MAG and POWER have N/2 + 1
+ * bins from DC to Nyquist. COMPLEX has N values packed as in
+ * riscv_rfft_fast_f32: re(0), re(N/2), then re and im of bins 1 to N/2 - 1
+ * @note q15 spectra are scaled by 1/N. MAG is in 2.14 and POWER in 3.13,
+ * the formats of riscv_cmplx_mag_q15 and riscv_cmplx_mag_squared_q15
+ */
+typedef enum StftOutput {
+    STFT_OUT_COMPLEX = 0,
+    STFT_OUT_MAG,
+    STFT_OUT_POWER,
+} StftOutput;
+
+/**
+ * @brief Configuration of a STFT
+ * @note Peak RAM in samples, N being fft_len, as returned by stft_mem_size:
+ * | format | normal     | in_place   |
+ * | f32    | 4N         | 3N         |
+ * | q15    | 3.5N + 4   | 2.5N + 4   |
+ * It is the window table (N, none for STFT_WIN_RECT) and the ring (N), plus
+ * for f32 the rfft output (N) and a copy of the frame (N) as rfft overwrites
+ * its input, and for q15 the frame (N + 2) and the split twiddles (N / 2 + 2).
+ * In place windows and transforms the ring itself, so frames cannot overlap
+ * and hop must be at least fft_len, samples beyond fft_len are skipped
+ */
+typedef struct StftCfg {
+    uint16_t fft_len; /**< Frame length, STFT_LEN_MIN to STFT_LEN_MAX */
+    uint16_t hop;     /**< Samples between frame starts, 1 to 65535 */
+    uint8_t format;   /**< @see StftFormat */
+    uint8_t window;   /**< @see StftWindow */
+    uint8_t output;   /**< @see StftOutput */
+    bool in_place;    /**< Transform the ring, needs hop >= fft_len */
+} StftCfg;
+
+/**
+ * @brief Callback with the spectrum of a frame
+ * @param spectrum Spectrum in the format of the STFT, valid until it returns
+ * @param len Number of values, @see StftOutput
+ * @param arg Argument given to stft_push_*
+ */
+typedef void (*StftFrameCb)(const void *spectrum, uint32_t len, void *arg);
+
+/**
+ * @brief Runtime state of a STFT, owned by caller
+ */
+typedef struct Stft {
+    StftCfg cfg;
+    union {
+        riscv_rfft_fast_instance_f32 rfft;
+        riscv_cfft_instance_q15 cfft;
+    } fft;
+    void *ring;       /**< Last fft_len samples, circular unless in place */
+    void *window;     /**< Window table, NULL for STFT_WIN_RECT */
+    void *work;       /**< Spectrum, also the frame for q15 */
+    void *aux;        /**< Frame of f32, split twiddles of q15 */
+    uint32_t wr;      /**< Next write position in ring */
+    uint32_t pending; /**< Samples to receive before the next frame */
+    uint32_t skip;    /**< Samples to drop before filling, in place only */
+    uint32_t frames;  /**< Frames produced */
+} Stft;
+
+/**
+ * @brief Get the RAM allocated by stft_init for a configuration
+ * @param cfg Configuration
+ * @return Bytes, 0 for an invalid configuration
+ */
+uint32_t stft_mem_size(const StftCfg *cfg);
+
+/**
+ * @brief Allocate the buffers and precompute the window and twiddle tables
+ * @param stft The STFT
+ * @param cfg Configuration
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int stft_init(Stft *stft, const StftCfg *cfg);
+
+/**
+ * @brief Free the buffers
+ * @param stft The STFT
+ */
+void stft_deinit(Stft *stft);
+
+/**
+ * @brief Drop buffered samples, the next frame needs fft_len new samples
+ * @param stft The STFT
+ */
+void stft_reset(Stft *stft);
+
+/**
+ * @brief Add samples, cb is called for each frame completed by them
+ * @param stft The STFT, of format STFT_F32
+ * @param in Samples
+ * @param len Number of samples
+ * @param cb Frame callback
+ * @param arg Argument given to cb
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int stft_push_f32(Stft *stft, const float32_t *in, uint32_t len, StftFrameCb cb, void *arg);
+
+/**
+ * @brief Add samples, cb is called for each frame completed by them
+ * @param stft The STFT, of format STFT_Q15
+ * @param in Samples
+ * @param len Number of samples
+ * @param cb Frame callback
+ * @param arg Argument given to cb
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int stft_push_q15(Stft *stft, const q15_t *in, uint32_t len, StftFrameCb cb, void *arg);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_STFT_H_ */
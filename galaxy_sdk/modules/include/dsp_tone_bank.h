@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_TONE_BANK_H_
+#define _DSP_TONE_BANK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_TONE_BANK
+ *  Goertzel and sliding DFT trackers of a few frequency bins
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Max bins of a bank */
+#define TONE_BANK_MAX 16
+/** Max block or window length in samples */
+#define TONE_BANK_LEN_MAX 4096
+
+/**
+ * @brief Tracker algorithm
+ * @note Per sample and bin, TONE_GOERTZEL costs 1 multiply and gives a new
+ * result every len samples, TONE_SDFT costs 5 multiplies and gives a new
+ * result every sample. Against one real FFT of len every len samples,
+ * they pay off below about log2(len) and log2(len) / 3 bins
+ */
+typedef enum ToneBankMode {
+    TONE_GOERTZEL = 0, /**< Any frequency, results of consecutive blocks */
+    TONE_SDFT,         /**< Frequency rounded to a bin of len, sliding window */
+} ToneBankMode;
+
+/** Sample format */
+typedef enum ToneBankFormat {
+    TONE_Q15 = 0,
+    TONE_Q31,
+    TONE_F32,
+} ToneBankFormat;
+
+/**
+ * @brief Configuration of a bank
+ * @note TONE_SDFT allocates a ring of 4 * len bytes from tone_bank_init.
+ * The q15 and q31 trackers keep 32-bit states with enough headroom for
+ * len full scale samples, so a longer len or a bin close to 0 Hz costs
+ * input bits. The Goertzel q15 and q31 cosines resolve the frequency to
+ * about fs / (2^17 * pi * sin(2 * pi * f / fs)), tone_bank_init refuses
+ * bins moved by more than 1/8 of fs / len, except 0 Hz which is summed
+ * exactly
+ */
+typedef struct ToneBankCfg {
+    float32_t fs;           /**< Sample rate in Hz */
+    const float32_t *freq;  /**< Bin frequencies in Hz, 0 to fs / 2 */
+    uint16_t len;           /**< Block (Goertzel) or window (SDFT) length, 8 to TONE_BANK_LEN_MAX */
+    uint8_t num;            /**< Number of bins, 1 to TONE_BANK_MAX */
+    uint8_t mode;           /**< @see ToneBankMode */
+    uint8_t format;         /**< @see ToneBankFormat */
+} ToneBankCfg;
+
+/**
+ * @brief Runtime state of a bank, owned by caller
+ */
+typedef struct ToneBank {
+    ToneBankCfg cfg;
+    uint8_t shift;    /**< Right shift of q31 samples into the states */
+    uint16_t pos;     /**< Samples of the current block, or next ring slot */
+    uint16_t fill;    /**< Samples of the SDFT window */
+    uint16_t dc;      /**< Goertzel q15 and q31 DC bins, one bit per bin */
+    uint32_t updates; /**< Goertzel blocks, or SDFT samples, since reset */
+    /**
+     * Coefficients: Goertzel q15 cos of bins 2i and 2i + 1 packed
+     * (low | high << 16) for the 32x16 SIMD multiplies, SDFT q31 r·cos and
+     * r·sin of bin i, floats 2cos or r·cos and r·sin for TONE_F32
+     */
+    union {
+        uint32_t pk[TONE_BANK_MAX];
+        int32_t q31[2 * TONE_BANK_MAX];
+        float32_t f[2 * TONE_BANK_MAX];
+    } coef;
+    /** s1 and s2 (Goertzel), or re and im (SDFT) per bin */
+    union {
+        int32_t i[2 * TONE_BANK_MAX];
+        float32_t f[2 * TONE_BANK_MAX];
+    } st;
+    union {
+        int32_t i[TONE_BANK_MAX];
+        float32_t f[TONE_BANK_MAX];
+    } decay;                          /**< SDFT r^len per bin, q31 or float */
+    float32_t cosw[TONE_BANK_MAX];    /**< Goertzel cos as used by the states */
+    float32_t scale[TONE_BANK_MAX];   /**< Amplitude of |X| = 1 in input units */
+    float32_t power[TONE_BANK_MAX];   /**< Goertzel |X|^2 of the last block */
+    union {
+        int32_t *i;
+        float32_t *f;
+    } ring;
+} ToneBank;
+
+/**
+ * @brief Set up a bank, cfg->freq is copied into the coefficients
+ * @param tb The bank
+ * @param cfg Configuration
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int tone_bank_init(ToneBank *tb, const ToneBankCfg *cfg);
+
+/**
+ * @brief Free the bank
+ * @param tb The bank
+ */
+void tone_bank_deinit(ToneBank *tb);
+
+/**
+ * @brief Clear states and results
+ * @param tb The bank
+ */
+void tone_bank_reset(ToneBank *tb);
+
+/**
+ * @brief Feed a block of samples of any length
+ * @param tb The bank, of the format of the function
+ * @param in Samples
+ * @param len Number of samples
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int tone_bank_push_q15(ToneBank *tb, const q15_t *in, uint32_t len);
+int tone_bank_push_q31(ToneBank *tb, const q31_t *in, uint32_t len);
+int tone_bank_push_f32(ToneBank *tb, const float32_t *in, uint32_t len);
+
+/**
+ * @brief Get the amplitude of a sinusoid at each bin
+ * @param tb The bank
+ * @param amp Peak amplitudes in input units (full scale 1.0 for q15 and
+ * q31), cfg.num of them
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_NOT_READY before the first
+ * block or before len samples of SDFT, others for failure
+ */
+int tone_bank_amplitude(const ToneBank *tb, float32_t *amp);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_TONE_BANK_H_ */
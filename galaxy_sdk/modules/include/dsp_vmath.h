@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_VMATH_H_
+#define _DSP_VMATH_H_
+
+#include <stdint.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_VMATH
+ *  Block versions of the fast math functions
+ *  @ingroup VPI
+ *  @{
+ */
+
+/**
+ * @brief Precision of the f32 functions
+ * @note Both use the same tables, VMATH_FAST drops polynomial terms and
+ * the extended range reduction. Max errors against libm, in ulp of the
+ * result unless noted, are listed with each function and checked by
+ * dsp_vmath_bench
+ */
+typedef enum VMathPrec {
+    VMATH_FAST = 0, /**< About 1e-4 relative or better, for dB, angles and thresholds */
+    VMATH_PRECISE,  /**< A few ulp */
+} VMathPrec;
+
+/**
+ * @brief Sine and cosine, 64 entry table and short polynomials
+ * @param src Angles in radians. Beyond +-400 a slower double precision
+ * reduction is used, the errors below hold up to +-1e8
+ * @param dst Outputs, dst may be src
+ * @param num Number of samples
+ * @param prec Precision
+ * @note Absolute error: 4e-7 fast, 6e-8 (1 ulp of 0.5) precise
+ */
+void vmath_sin_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec);
+void vmath_cos_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec);
+
+/**
+ * @brief Sine and cosine in one pass
+ * @param src Angles in radians
+ * @param dsin Sines
+ * @param dcos Cosines
+ * @param num Number of samples
+ * @param prec Precision
+ */
+void vmath_sincos_f32(const float32_t *src, float32_t *dsin, float32_t *dcos, uint32_t num,
+                      VMathPrec prec);
+
+/**
+ * @brief Angle of (x, y) in [-pi, pi], one division and an odd polynomial
+ * on [-tan(pi / 8), tan(pi / 8)]
+ * @param y Ordinates
+ * @param x Abscissas
+ * @param dst Angles in radians
+ * @param num Number of samples
+ * @param prec Precision
+ * @note Error: 2e-5 relative fast, 3 ulp precise. (0, 0) gives 0, inputs
+ * must be finite
+ */
+void vmath_atan2_f32(const float32_t *y, const float32_t *x, float32_t *dst, uint32_t num,
+                     VMathPrec prec);
+
+/**
+ * @brief Base 2 logarithm, 32 entry table and a polynomial of x / c - 1
+ * @param src Inputs, 0 gives -inf, negative inputs NaN
+ * @param dst Outputs, dst may be src
+ * @param num Number of samples
+ * @param prec Precision
+ * @note Error: 1.5e-4 relative fast, 3 ulp precise. Scale by 3.0103f for
+ * dB of a power
+ */
+void vmath_log2_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec);
+
+/**
+ * @brief Natural exponential, 32 entry table of 2^(j / 32) and a
+ * polynomial of the remainder
+ * @param src Inputs, below -87.3 the outputs flush to 0
+ * @param dst Outputs, dst may be src
+ * @param num Number of samples
+ * @param prec Precision
+ * @note Error: 7e-5 relative fast, 2 ulp precise
+ */
+void vmath_exp_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec);
+
+/**
+ * @brief Square root on the FPU, negative inputs give 0 like riscv_sqrt_f32
+ * @param src Inputs
+ * @param dst Outputs, dst may be src
+ * @param num Number of samples
+ */
+void vmath_sqrt_f32(const float32_t *src, float32_t *dst, uint32_t num);
+
+/**
+ * @brief Magnitude of vectors given as one array per axis
+ * @param x First components
+ * @param y Second components
+ * @param z Third components, NULL for 2D vectors
+ * @param dst Magnitudes
+ * @param num Number of vectors
+ * @note Not scaled, components must stay below 1e18
+ */
+void vmath_mag_f32(const float32_t *x, const float32_t *y, const float32_t *z, float32_t *dst,
+                   uint32_t num);
+
+/**
+ * @brief Sine and cosine of q15 binary angles, two samples per SIMD word
+ * @param src Angles, full scale is pi so [-1, 1) covers the circle
+ * @param dst Outputs, dst may be src
+ * @param num Number of samples
+ * @note The angle unit differs from riscv_sin_q15 and matches
+ * vmath_atan2_q15, phases wrap with plain 16-bit arithmetic. Error: 3.5 LSB
+ */
+void vmath_sin_q15(const q15_t *src, q15_t *dst, uint32_t num);
+void vmath_cos_q15(const q15_t *src, q15_t *dst, uint32_t num);
+
+/**
+ * @brief Angle of (x, y) as a q15 binary angle, full scale is pi
+ * @param y Ordinates
+ * @param x Abscissas
+ * @param dst Angles, pi saturates to 0x7fff
+ * @param num Number of samples
+ * @note Error: 2 LSB, (0, 0) gives 0
+ */
+void vmath_atan2_q15(const q15_t *y, const q15_t *x, q15_t *dst, uint32_t num);
+
+/**
+ * @brief Square root, normalized with CLZ and refined from a 48 entry table
+ * @param src Inputs, negative ones give 0
+ * @param dst Outputs, dst may be src
+ * @param num Number of samples
+ * @note Error: 1 LSB for q15, 3 LSB for q31
+ */
+void vmath_sqrt_q15(const q15_t *src, q15_t *dst, uint32_t num);
+void vmath_sqrt_q31(const q31_t *src, q31_t *dst, uint32_t num);
+
+/**
+ * @brief Magnitude of (x, y), the squares are summed two lanes at a time
+ * @param x First components
+ * @param y Second components
+ * @param dst Magnitudes, saturated to 0x7fff
+ * @param num Number of samples
+ * @note Error: 1 LSB
+ */
+void vmath_mag_q15(const q15_t *x, const q15_t *y, q15_t *dst, uint32_t num);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_VMATH_H_ */
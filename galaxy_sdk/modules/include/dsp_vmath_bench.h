@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_VMATH_BENCH_H_
+#define _DSP_VMATH_BENCH_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_VMATH_BENCH
+ *  Errors of dsp_vmath.h against libm and cycles per sample
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Samples per call of the functions under test */
+#define VMATH_BENCH_BLOCK 256
+
+/**
+ * @brief Run every function and precision of dsp_vmath.h, and the scalar
+ * riscv_dsp functions they replace, on blocks of test inputs. Print the max
+ * error against the double precision libm result and the cycles per sample
+ * @note Errors are in ulp of the float result, in LSB for q15 and q31,
+ * absolute or relative where the header of the function says so. The
+ * inputs cover the documented ranges, all 65536 for the q15 sine
+ * @return Return VPI_SUCCESS when all errors are within the documented
+ * bounds, VPI_ERR_BAD_DATA otherwise
+ */
+int dsp_vmath_bench_check(void);
+
+/**
+ * @brief Add the "vmath" command to the shell, it prints the report of
+ * dsp_vmath_bench_check again
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ * @note CONFIG_DSP_VMATH_BENCH prints the report once while booting; the
+ * command is only added when no error exceeds its documented bound
+ */
+int dsp_vmath_bench_init(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_VMATH_BENCH_H_ */
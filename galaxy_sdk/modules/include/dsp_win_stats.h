@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSP_WIN_STATS_H_
+#define _DSP_WIN_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup DSP_WIN_STATS
+ *  Sliding window statistics updated per sample
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Max window length in samples */
+#define WIN_STATS_LEN_MAX 65535
+
+/** Sample format */
+typedef enum WinStatsFormat {
+    WIN_STATS_Q15 = 0,
+    WIN_STATS_Q31,
+    WIN_STATS_F32,
+} WinStatsFormat;
+
+/** Optional statistics, mean, var and rms are always kept */
+enum WinStatsFlag {
+    WIN_STATS_MINMAX = 0x01, /**< Monotonic deques, O(1) amortized per sample */
+    WIN_STATS_MEDIAN = 0x02, /**< Indexed min and max heaps, O(log n) per sample */
+};
+
+/**
+ * @brief Configuration of a sliding window
+ * @note RAM from win_stats_init is 4 bytes per sample, plus 4 for
+ * WIN_STATS_MINMAX and 4 for WIN_STATS_MEDIAN
+ */
+typedef struct WinStatsCfg {
+    uint32_t len;  /**< Window length, 2 to WIN_STATS_LEN_MAX */
+    uint8_t format; /**< @see WinStatsFormat */
+    uint8_t flags;  /**< Combination of WinStatsFlag */
+} WinStatsCfg;
+
+/**
+ * @brief Statistics of the samples in the window
+ * @note var is the sample variance (divided by n - 1) as riscv_var_*.
+ * The median of an even count is the mean of the two middle samples.
+ * min, max and median are 0 when their flag is not set
+ */
+typedef struct WinStatsQ15 {
+    uint32_t count;
+    q15_t mean, var, rms, min, max, median;
+} WinStatsQ15;
+
+typedef struct WinStatsQ31 {
+    uint32_t count;
+    q31_t mean, var, rms, min, max, median;
+} WinStatsQ31;
+
+typedef struct WinStatsF32 {
+    uint32_t count;
+    float32_t mean, var, rms, min, max, median;
+} WinStatsF32;
+
+/** Monotonic deque of ring slots */
+typedef struct WinStatsDeque {
+    uint16_t *slot;
+    uint16_t head;
+    uint16_t num;
+} WinStatsDeque;
+
+/**
+ * @brief Runtime state of a sliding window, owned by caller
+ */
+typedef struct WinStats {
+    WinStatsCfg cfg;
+    /** Samples, q15 and q31 as int32_t, f32 as float32_t */
+    union {
+        int32_t *i;
+        float32_t *f;
+    } ring;
+    uint32_t wr;    /**< Next slot to write */
+    uint32_t count; /**< Samples in window */
+    /** Integer sums are exact, float ones are recomputed every len samples */
+    union {
+        struct {
+            int64_t sum;
+            int64_t sumsq;
+        } i;
+        struct {
+            float32_t sum;
+            float32_t sumsq;
+            uint32_t since;
+        } f;
+    } acc;
+    WinStatsDeque min;
+    WinStatsDeque max;
+    /** Median heaps: low is a max heap, high a min heap, low has the extra one */
+    uint16_t *heap;
+    uint16_t *pos;
+    uint16_t low_num;
+    uint16_t high_num;
+} WinStats;
+
+/**
+ * @brief Get the RAM allocated by win_stats_init
+ * @param cfg Configuration
+ * @return Bytes, 0 for an invalid configuration
+ */
+uint32_t win_stats_mem_size(const WinStatsCfg *cfg);
+
+/**
+ * @brief Allocate the window
+ * @param ws The window
+ * @param cfg Configuration
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int win_stats_init(WinStats *ws, const WinStatsCfg *cfg);
+
+/**
+ * @brief Free the window
+ * @param ws The window
+ */
+void win_stats_deinit(WinStats *ws);
+
+/**
+ * @brief Drop all samples
+ * @param ws The window
+ */
+void win_stats_reset(WinStats *ws);
+
+/**
+ * @brief Add samples, the oldest ones leave the window once it is full
+ * @param ws The window, of the format of the function
+ * @param in Samples
+ * @param len Number of samples
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int win_stats_push_q15(WinStats *ws, const q15_t *in, uint32_t len);
+int win_stats_push_q31(WinStats *ws, const q31_t *in, uint32_t len);
+int win_stats_push_f32(WinStats *ws, const float32_t *in, uint32_t len);
+
+/**
+ * @brief Get the statistics of the window in O(1)
+ * @param ws The window, of the format of the function
+ * @param out Statistics
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_NOT_READY for an empty
+ * window, others for failure
+ */
+int win_stats_get_q15(const WinStats *ws, WinStatsQ15 *out);
+int win_stats_get_q31(const WinStats *ws, WinStatsQ31 *out);
+int win_stats_get_f32(const WinStats *ws, WinStatsF32 *out);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_WIN_STATS_H_ */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GPIO_CAPTURE_H_
+#define _GPIO_CAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_gpio.h"
+#include "vpi_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup GPIO_CAPTURE
+ *  Timestamped GPIO edge capture with debouncing
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Maximum number of pins captured at the same time */
+#define GPIO_CAPTURE_PIN_MAX 8
+
+/** Period of the shared debounce timer in millisecond */
+#define GPIO_CAPTURE_TICK_MS 5
+
+/**
+ * @brief A captured edge
+ */
+typedef struct GpioCaptureEvent {
+    uint64_t t_us; /**< SysTimer time of the edge in microseconds */
+    uint8_t group; /**< Gpio group id */
+    uint8_t port;  /**< Gpio port id in the group */
+    uint8_t level; /**< Level after the edge, invert of GpioPort applied */
+} GpioCaptureEvent;
+
+/**
+ * @brief Initialize edge capture
+ * @param queue_len Number of events the queue holds
+ * @param batch Wake up the reader when this many events are queued, 1 to
+ * wake up on every event. Debounced pins always wake up the reader
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int gpio_capture_init(uint32_t queue_len, uint32_t batch);
+
+/**
+ * @brief Start capturing the edges of a pin
+ * @param gpio The gpio pin, configured by hal_gpio_init as interrupt input,
+ * set irq_reload unless the group has irq_pending port operations
+ * @param debounce_ms 0 to report every edge (e.g. data ready), otherwise the
+ * level must be stable for this time before it is reported. The reported
+ * time is the one of the first edge
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int gpio_capture_add(const GpioPort *gpio, uint32_t debounce_ms);
+
+/**
+ * @brief Stop capturing the edges of a pin
+ * @param gpio The gpio pin
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int gpio_capture_remove(const GpioPort *gpio);
+
+/**
+ * @brief Read a batch of events
+ * @param evts Buffer of events
+ * @param max Maximum number of events to read
+ * @param timeout_ms Time to wait for the batch when the queue is empty,
+ * queued events are returned at once
+ * @return Number of events read, negative for failure
+ */
+int gpio_capture_read(GpioCaptureEvent *evts, uint32_t max, uint32_t timeout_ms);
+
+/**
+ * @brief Get the number of events lost because the queue was full
+ * @return Number of lost events
+ */
+uint32_t gpio_capture_get_lost(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GPIO_CAPTURE_H_ */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _IMU_FUSION_H_
+#define _IMU_FUSION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup IMU_FUSION
+ *  Attitude from accelerometer and gyroscope FIFO batches
+ *  @ingroup VPI
+ *  @{
+ */
+
+/**
+ * @brief Fusion algorithms
+ */
+typedef enum ImuFusionAlgo {
+    IMU_FUSION_MADGWICK = 0, /**< Gradient descent, gain beta */
+    IMU_FUSION_MAHONY,       /**< Complementary PI, gains kp and ki */
+    IMU_FUSION_ESKF,         /**< Error state Kalman filter of attitude and gyro bias */
+} ImuFusionAlgo;
+
+/**
+ * @brief Fusion configuration
+ */
+typedef struct ImuFusionCfg {
+    uint8_t algo;          /**< @see ImuFusionAlgo */
+    float32_t dt;          /**< Sample period in s */
+    float32_t gravity;     /**< Accelerometer norm at rest, 1 for g or 9.80665 for m/s^2 */
+    float32_t accel_gate;  /**< Accelerometer ignored when its norm differs from
+                                gravity by more than this ratio, 0 to always use it */
+    float32_t beta;        /**< Madgwick gain in rad/s */
+    float32_t kp;          /**< Mahony proportional gain in rad/s */
+    float32_t ki;          /**< Mahony integral gain in rad/s^2, 0 for no bias */
+    float32_t gyro_noise;  /**< ESKF gyro noise density in rad/s/sqrt(Hz) */
+    float32_t bias_noise;  /**< ESKF gyro bias random walk in rad/s^2/sqrt(Hz) */
+    float32_t accel_noise; /**< ESKF accelerometer direction noise in rad */
+} ImuFusionCfg;
+
+/**
+ * @brief A batch of samples as read from the sensor FIFO, one array per
+ * axis (structure of arrays)
+ */
+typedef struct ImuBatch {
+    const float32_t *acc[3];  /**< x, y, z in the unit of gravity */
+    const float32_t *gyro[3]; /**< x, y, z in rad/s */
+    uint32_t num;
+} ImuBatch;
+
+/**
+ * @brief Fusion state, the quaternion rotates the body frame to the world
+ * frame whose z axis points up
+ */
+typedef struct ImuFusion {
+    ImuFusionCfg cfg;
+    float32_t q[4];     /**< w, x, y, z */
+    float32_t bias[3];  /**< Gyro bias estimate in rad/s, not used by Madgwick */
+    float32_t P[36];    /**< ESKF covariance of attitude error and bias error */
+    bool aligned;       /**< Set once an accelerometer sample gave the initial tilt */
+    uint32_t rejected;  /**< Accelerometer samples out of the gate */
+} ImuFusion;
+
+/**
+ * @brief Initialize a fusion state
+ * @param fusion The state
+ * @param cfg The configuration, copied
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int imu_fusion_init(ImuFusion *fusion, const ImuFusionCfg *cfg);
+
+/**
+ * @brief Forget the attitude and the bias, the next accelerometer sample
+ * aligns the tilt again
+ * @param fusion The state
+ */
+void imu_fusion_reset(ImuFusion *fusion);
+
+/**
+ * @brief Run the filter over a batch
+ * @param fusion The state
+ * @param batch Samples, oldest first
+ * @param quat NULL, or w, x, y, z arrays of batch->num receiving the attitude
+ * after each sample
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int imu_fusion_update(ImuFusion *fusion, const ImuBatch *batch, float32_t *const quat[4]);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IMU_FUSION_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _IMU_FUSION_BENCH_H_
+#define _IMU_FUSION_BENCH_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup IMU_FUSION_BENCH
+ *  Fusion built from riscv_mat_*_f32 against the kernels of mat_fixed.h
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Samples per benchmarked FIFO batch, 100 Hz */
+#define IMU_BENCH_BATCH 32
+
+/**
+ * @brief Run the ESKF of imu_fusion and the same filter composed of
+ * riscv_mat_mult_f32 and riscv_quaternion_product_single_f32 on a simulated
+ * rotation with gyro bias, and all three algorithms against the true tilt
+ * @return Return VPI_SUCCESS when the filters agree and track the tilt,
+ * VPI_ERR_BAD_DATA otherwise
+ */
+int imu_fusion_bench_check(void);
+
+/**
+ * @brief Add the benchmarks to the shell, one batch per run: eskf_mat and
+ * quat_dsp for riscv_dsp, eskf_fix and quat_fix for the fixed kernels, and
+ * madgwick_fix and mahony_fix
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ * @note Setting CONFIG_IMU_FUSION_BENCH adds them at boot, unless the fixed
+ * ESKF drifts from the riscv_dsp one or a filter loses the tilt
+ */
+int imu_fusion_bench_init(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IMU_FUSION_BENCH_H_ */
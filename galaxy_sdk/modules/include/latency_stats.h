@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _LATENCY_STATS_H_
+#define _LATENCY_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup LATENCY_STATS
+ *  Critical section, scheduler lock and ISR duration statistics
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Number of log2 buckets, bucket n counts durations in [2^(n-1), 2^n) cycles */
+#define LATENCY_BUCKET_NUM 32
+/** Number of worst offenders kept per class */
+#define LATENCY_WORST_NUM 8
+
+/** Measured classes */
+typedef enum LatencyClass {
+    LATENCY_CRITICAL = 0, /**< portENTER_CRITICAL and portSET_INTERRUPT_MASK_FROM_ISR */
+    LATENCY_SCHED_LOCK,   /**< osal_suspend_all to osal_resume_all */
+    LATENCY_ISR,          /**< ISR run time from irq_entry, nested ISRs included */
+    LATENCY_CLASS_NUM,
+} LatencyClass;
+
+/**
+ * @brief A worst offender
+ * @note addr is the return address of the enter call, i.e. the code which
+ * entered the section, or the interrupt id for LATENCY_ISR
+ */
+typedef struct LatencyWorst {
+    uint32_t addr;
+    uint32_t cycles;
+} LatencyWorst;
+
+/**
+ * @brief Statistics of one class, durations in CPU cycles
+ */
+typedef struct LatencyHist {
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+    uint32_t bucket[LATENCY_BUCKET_NUM];
+    LatencyWorst worst[LATENCY_WORST_NUM];
+} LatencyHist;
+
+/**
+ * @brief Output function of the dump
+ * @param line A text line, terminated by newline
+ * @param arg Argument given to latency_stats_dump
+ */
+typedef void (*LatencyWriter)(const char *line, void *arg);
+
+/**
+ * @brief Enable or disable recording, sections already entered are dropped
+ * @param enable true to record
+ */
+void latency_stats_enable(bool enable);
+
+/**
+ * @brief Clear all statistics
+ */
+void latency_stats_reset(void);
+
+/**
+ * @brief Get a copy of the statistics of a class
+ * @param cls The class
+ * @param out Statistics
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int latency_stats_get(LatencyClass cls, LatencyHist *out);
+
+/**
+ * @brief Print histograms and worst offenders of all classes
+ * @param writer Output function
+ * @param arg Argument given to writer
+ * @note Offender addresses can be resolved with addr2line on the elf
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int latency_stats_dump(LatencyWriter writer, void *arg);
+
+/** Instrumented replacements, also declared by portmacro.h and osal_task_api.h */
+void latency_crit_enter(void);
+void latency_crit_exit(void);
+uint8_t latency_crit_enter_isr(void);
+void latency_crit_exit_isr(uint8_t mask);
+void latency_sched_lock(void);
+void latency_sched_unlock(void);
+
+/** Hooks called from portasm.S when CONFIG_LATENCY_STATS is set */
+void latency_port_isr_enter(uint32_t mcause);
+void latency_port_isr_exit(uint32_t mcause);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LATENCY_STATS_H_ */
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _MAT_FIXED_H_
+#define _MAT_FIXED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup MAT_FIXED
+ *  Matrix and quaternion kernels for the fixed sizes of attitude filters
+ *  @ingroup VPI
+ *  @{
+ */
+
+/*
+ * riscv_mat_*_f32 check the instance sizes and loop over any shape, which
+ * costs more than the arithmetic of a 3x3 or 6x6 product. These are always
+ * inlined with all loops unrolled, so the compiler keeps the operands in
+ * registers. Matrices are row major as in riscv_matrix_instance_f32 and
+ * quaternions are w, x, y, z as in riscv_quaternion_product_f32.
+ */
+
+#define MAT_UNROLL _Pragma("GCC unroll 36")
+
+/* c = a * b, n x n, c must not alias a or b */
+__STATIC_FORCEINLINE void mat_mul_n(const float32_t *a, const float32_t *b, float32_t *c,
+                                    uint32_t n)
+{
+    MAT_UNROLL
+    for (uint32_t i = 0; i < n; i++) {
+        MAT_UNROLL
+        for (uint32_t j = 0; j < n; j++) {
+            float32_t s = 0.0f;
+
+            MAT_UNROLL
+            for (uint32_t k = 0; k < n; k++) {
+                s += a[i * n + k] * b[k * n + j];
+            }
+            c[i * n + j] = s;
+        }
+    }
+}
+
+/* c = a * b^T, n x n, only the upper triangle is computed when c is symmetric */
+__STATIC_FORCEINLINE void mat_mul_trans_n(const float32_t *a, const float32_t *b, float32_t *c,
+                                          uint32_t n, bool sym)
+{
+    MAT_UNROLL
+    for (uint32_t i = 0; i < n; i++) {
+        MAT_UNROLL
+        for (uint32_t j = sym ? i : 0; j < n; j++) {
+            float32_t s = 0.0f;
+
+            MAT_UNROLL
+            for (uint32_t k = 0; k < n; k++) {
+                s += a[i * n + k] * b[j * n + k];
+            }
+            c[i * n + j] = s;
+            if (sym) {
+                c[j * n + i] = s;
+            }
+        }
+    }
+}
+
+/* y = a * x, n x n, y must not alias x */
+__STATIC_FORCEINLINE void mat_mul_vec_n(const float32_t *a, const float32_t *x, float32_t *y,
+                                        uint32_t n)
+{
+    MAT_UNROLL
+    for (uint32_t i = 0; i < n; i++) {
+        float32_t s = 0.0f;
+
+        MAT_UNROLL
+        for (uint32_t k = 0; k < n; k++) {
+            s += a[i * n + k] * x[k];
+        }
+        y[i] = s;
+    }
+}
+
+__STATIC_FORCEINLINE void mat3_mul(const float32_t *a, const float32_t *b, float32_t *c)
+{
+    mat_mul_n(a, b, c, 3);
+}
+
+__STATIC_FORCEINLINE void mat3_mul_vec(const float32_t *a, const float32_t *x, float32_t *y)
+{
+    mat_mul_vec_n(a, x, y, 3);
+}
+
+/**
+ * @brief Inverse of a symmetric 3x3 matrix by its adjugate
+ * @return false when the matrix is singular, inv is left unchanged
+ */
+__STATIC_FORCEINLINE bool mat3_inv_sym(const float32_t *a, float32_t *inv)
+{
+    float32_t c00 = a[4] * a[8] - a[5] * a[5];
+    float32_t c01 = a[2] * a[5] - a[1] * a[8];
+    float32_t c02 = a[1] * a[5] - a[2] * a[4];
+    float32_t det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+    float32_t r;
+
+    if (det == 0.0f) {
+        return false;
+    }
+    r      = 1.0f / det;
+    inv[0] = c00 * r;
+    inv[1] = inv[3] = c01 * r;
+    inv[2] = inv[6] = c02 * r;
+    inv[4] = (a[0] * a[8] - a[2] * a[2]) * r;
+    inv[5] = inv[7] = (a[1] * a[2] - a[0] * a[5]) * r;
+    inv[8] = (a[0] * a[4] - a[1] * a[1]) * r;
+    return true;
+}
+
+__STATIC_FORCEINLINE void mat4_mul(const float32_t *a, const float32_t *b, float32_t *c)
+{
+    mat_mul_n(a, b, c, 4);
+}
+
+__STATIC_FORCEINLINE void mat4_mul_vec(const float32_t *a, const float32_t *x, float32_t *y)
+{
+    mat_mul_vec_n(a, x, y, 4);
+}
+
+__STATIC_FORCEINLINE void mat6_mul(const float32_t *a, const float32_t *b, float32_t *c)
+{
+    mat_mul_n(a, b, c, 6);
+}
+
+/* c = a * b^T where the result is known to be symmetric, e.g. F * P * F^T */
+__STATIC_FORCEINLINE void mat6_mul_trans_sym(const float32_t *a, const float32_t *b,
+                                             float32_t *c)
+{
+    mat_mul_trans_n(a, b, c, 6, true);
+}
+
+__STATIC_FORCEINLINE float32_t mat_rsqrt(float32_t x)
+{
+    float32_t s;
+
+    riscv_sqrt_f32(x, &s);
+    return s > 0.0f ? 1.0f / s : 0.0f;
+}
+
+/* r = a * b, r may alias a or b */
+__STATIC_FORCEINLINE void quat_mul(const float32_t *a, const float32_t *b, float32_t *r)
+{
+    float32_t w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    float32_t x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    float32_t y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    float32_t z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+
+    r[0] = w;
+    r[1] = x;
+    r[2] = y;
+    r[3] = z;
+}
+
+__STATIC_FORCEINLINE void quat_normalize(float32_t *q)
+{
+    float32_t r = mat_rsqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+    q[0] *= r;
+    q[1] *= r;
+    q[2] *= r;
+    q[3] *= r;
+}
+
+/* q = normalize(q * (1, v / 2)), the rotation by the small angle vector v */
+__STATIC_FORCEINLINE void quat_rotate_small(float32_t *q, float32_t vx, float32_t vy,
+                                            float32_t vz)
+{
+    const float32_t d[4] = {1.0f, 0.5f * vx, 0.5f * vy, 0.5f * vz};
+
+    quat_mul(q, d, q);
+    quat_normalize(q);
+}
+
+/* Body frame direction of the world z axis, the third row of the rotation of q */
+__STATIC_FORCEINLINE void quat_up(const float32_t *q, float32_t *up)
+{
+    up[0] = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+    up[1] = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+    up[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MAT_FIXED_H_ */
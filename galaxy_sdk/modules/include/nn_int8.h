@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _NN_INT8_H_
+#define _NN_INT8_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform.h"
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup NN_INT8
+ *  Int8 inference of small 1D CNNs over a planned arena
+ *  @ingroup VPI
+ *  @{
+ */
+
+/**
+ * @brief Layer operations
+ * @note Tensors are [len][ch] int8, real = scale * (q - zero). Weights are
+ * int8 per output channel, their scale is folded into mult and shift
+ */
+typedef enum NnOp {
+    NN_CONV1D = 0, /**< weight [cout][ALIGN4(kernel * cin)] */
+    NN_DWCONV1D,   /**< Depthwise, multiplier 1, weight [kernel][ch] */
+    NN_DENSE,      /**< Input flattened, weight [cout][ALIGN4(len * ch)] */
+    NN_MAXPOOL,    /**< Window kernel, no padding */
+    NN_AVGPOOL,    /**< Window kernel, no padding */
+    NN_RELU,       /**< Clamp to act_min, act_max, may be in place */
+    NN_SOFTMAX,    /**< Per row, out scale 1/256 and zero -128 */
+    NN_OP_NUM,
+} NnOp;
+
+/**
+ * @brief A tensor placed in the arena
+ */
+typedef struct NnTensor {
+    uint32_t offset; /**< Byte offset in the arena, 4 byte aligned */
+    uint16_t len;    /**< Time steps, 1 for dense outputs */
+    uint16_t ch;     /**< Channels */
+    float32_t scale;
+    int8_t zero;
+} NnTensor;
+
+/**
+ * @brief A layer, generated by tools/nn_convert.py
+ */
+typedef struct NnLayer {
+    uint8_t op;      /**< @see NnOp */
+    uint8_t in;      /**< Input tensor index */
+    uint8_t out;     /**< Output tensor index */
+    uint8_t kernel;  /**< Taps or pool window */
+    uint8_t stride;
+    uint8_t pad;     /**< Zero points added before the first step */
+    int8_t act_min;  /**< Fused activation, -128 and 127 for none */
+    int8_t act_max;
+    uint32_t scratch;       /**< Arena offset of the im2col column of NN_CONV1D */
+    const int8_t *weight;   /**< 4 byte aligned */
+    const int32_t *bias;    /**< Per channel, minus in zero * sum of weights */
+    const int32_t *mult;    /**< Per channel q31 multiplier */
+    const int8_t *shift;    /**< Per channel exponent of the multiplier */
+    const uint32_t *lut;    /**< NN_SOFTMAX: exp(-d * in scale) * 2^16, 256 entries */
+} NnLayer;
+
+/**
+ * @brief A model, generated by tools/nn_convert.py
+ */
+typedef struct NnModel {
+    const NnTensor *tensors;
+    const NnLayer *layers;
+    uint32_t arena_size; /**< Bytes, buffers with disjoint lifetimes share space */
+    uint8_t tensor_num;
+    uint8_t layer_num;
+    uint8_t input;       /**< Index of the input tensor */
+    uint8_t output;      /**< Index of the output tensor */
+} NnModel;
+
+/**
+ * @brief Get a tensor in the arena, e.g. to fill the input
+ * @param model The model
+ * @param arena The arena, arena_size bytes, 4 byte aligned
+ * @param index Tensor index, model->input or model->output
+ * @return The data, NULL for an invalid index
+ */
+int8_t *nn_tensor(const NnModel *model, void *arena, uint8_t index);
+
+/**
+ * @brief Run all layers, from the input tensor to the output tensor
+ * @param model The model
+ * @param arena The arena holding the input tensor, 4 byte aligned
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ * @note Nothing is allocated, the arena is the only RAM besides the stack
+ */
+int nn_invoke(const NnModel *model, void *arena);
+
+/**
+ * @brief Quantize real values into a tensor format
+ * @param t The tensor
+ * @param in Real values
+ * @param out Quantized values, saturated
+ * @param num Number of values
+ */
+void nn_quantize(const NnTensor *t, const float32_t *in, int8_t *out, uint32_t num);
+
+/**
+ * @brief Convert quantized values of a tensor to real values
+ * @param t The tensor
+ * @param in Quantized values
+ * @param out Real values
+ * @param num Number of values
+ */
+void nn_dequantize(const NnTensor *t, const int8_t *in, float32_t *out, uint32_t num);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NN_INT8_H_ */
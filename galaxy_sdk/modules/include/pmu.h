@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _PMU_H_
+#define _PMU_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vs_conf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup PMU
+ *  Hardware performance counters with per task and per region accounting
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Number of programmable events, they use mhpmcounter3 to mhpmcounter6 */
+#define PMU_EVENT_NUM 4
+
+/** Tasks accounted separately, later tasks are summed in one extra slot */
+#define PMU_TASK_NUM 16
+
+/** Index of counters in PmuCounters */
+enum PmuCounterIdx {
+    PMU_CNT_CYCLE   = 0,
+    PMU_CNT_INSTRET = 1,
+    PMU_CNT_EVENT0  = 2,
+    PMU_CNT_NUM     = PMU_CNT_EVENT0 + PMU_EVENT_NUM,
+};
+
+/** Events which can be assigned to the programmable counters */
+typedef enum PmuEvent {
+    PMU_EVENT_NONE = 0,
+    PMU_EVENT_LOAD,
+    PMU_EVENT_STORE,
+    PMU_EVENT_BRANCH,
+    PMU_EVENT_BRANCH_TAKEN,
+    PMU_EVENT_BRANCH_MISS,
+    PMU_EVENT_JUMP_MISS,
+    PMU_EVENT_MUL,
+    PMU_EVENT_DIV,
+    PMU_EVENT_FP_LOAD,
+    PMU_EVENT_FP_STORE,
+    PMU_EVENT_FP_FMA,
+    PMU_EVENT_ICACHE_MISS,
+    PMU_EVENT_DCACHE_MISS,
+    PMU_EVENT_MAX,
+} PmuEvent;
+
+/**
+ * @brief Counter values, cycles and instructions retired first, then the
+ * programmable events in the order given to pmu_init
+ */
+typedef struct PmuCounters {
+    uint64_t val[PMU_CNT_NUM];
+} PmuCounters;
+
+/**
+ * @brief A measured code region, e.g. one stage of a DSP pipeline
+ * @note Counts are those of the calling task only, preemption is excluded.
+ * A region must be used by one task at a time
+ */
+typedef struct PmuRegion {
+    const char *name;
+    uint32_t calls;
+    PmuCounters sum;
+    PmuCounters start;
+} PmuRegion;
+
+/**
+ * @brief Output function of the report
+ * @param line A text line, terminated by newline
+ * @param arg Argument given to pmu_dump
+ */
+typedef void (*PmuWriter)(const char *line, void *arg);
+
+/** Define a region for pmu_region_begin and pmu_region_end */
+#define PMU_REGION_DEFINE(var) PmuRegion var = {.name = #var}
+
+/**
+ * @brief Program the event selectors and clear all statistics
+ * @param events PMU_EVENT_NUM events, NULL for load, store, branch and
+ * branch misprediction
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int pmu_init(const PmuEvent events[PMU_EVENT_NUM]);
+
+/**
+ * @brief Start per task accounting
+ * @note Tasks are only told apart when CONFIG_PMU_TASK_STATS is set,
+ * otherwise all counts go to the running task at the time of pmu_start
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int pmu_start(void);
+
+/**
+ * @brief Stop per task accounting, statistics are kept
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int pmu_stop(void);
+
+/**
+ * @brief Read the virtualized counters of a task
+ * @param task Task handle, NULL for the calling task
+ * @param out Counters accumulated while the task was running
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_NODEVICE if the task was
+ * not accounted
+ */
+int pmu_read_task(void *task, PmuCounters *out);
+
+/**
+ * @brief Read the physical counters, which run for all tasks and ISRs
+ * @param out Counter values
+ */
+void pmu_read(PmuCounters *out);
+
+/**
+ * @brief Mark the beginning of a region
+ * @param region The region
+ */
+void pmu_region_begin(PmuRegion *region);
+
+/**
+ * @brief Mark the end of a region and add its counts to the region
+ * @param region The region
+ */
+void pmu_region_end(PmuRegion *region);
+
+/**
+ * @brief Get the name of an event
+ * @param event The event
+ * @return Short name, e.g. "load"
+ */
+const char *pmu_event_name(PmuEvent event);
+
+/**
+ * @brief Report counters and IPC of each task and the given regions
+ * @param regions Regions to report, can be NULL
+ * @param num Number of regions
+ * @param writer Output function
+ * @param arg Argument given to writer
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int pmu_dump(PmuRegion *const *regions, uint32_t num, PmuWriter writer, void *arg);
+
+/** Hook called from portasm.S after each task switch when CONFIG_PMU_TASK_STATS is set */
+void pmu_port_switch(void *tcb);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PMU_H_ */
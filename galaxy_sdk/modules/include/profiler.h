@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vs_conf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup PROFILER
+ *  Statistical PC sampling profiler
+ *  @ingroup VPI
+ *  @{
+ */
+
+/**
+ * Interrupt of the spare timer used for sampling. The profiler owns its
+ * riscv_irqN_handler when CONFIG_PROFILER is set, default is TIMER32_4
+ */
+#ifndef CONFIG_PROFILER_TIMER_IRQ
+#define CONFIG_PROFILER_TIMER_IRQ 30
+#endif
+
+/** Number of (pc, task) slots of the histogram */
+#define PROFILER_SLOT_NUM 1024
+
+/** Task value of samples taken while an interrupt or exception was running */
+#define PROFILER_TASK_ISR 0
+
+/**
+ * @brief Operations of the sampling timer, provided by the board since the
+ * timer IP differs between SoCs
+ */
+typedef struct ProfilerTimerOps {
+    /** Start the timer with a periodic interrupt of hz */
+    int (*start)(uint32_t hz);
+    /** Stop the timer */
+    void (*stop)(void);
+    /** Clear the interrupt of the timer, called in ISR */
+    void (*clear)(void);
+} ProfilerTimerOps;
+
+/**
+ * @brief Output function of the profile dump
+ * @param line A text line, terminated by newline
+ * @param arg Argument given to profiler_dump
+ */
+typedef void (*ProfilerWriter)(const char *line, void *arg);
+
+/**
+ * @brief Set the timer used for sampling
+ * @param ops Timer operations
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int profiler_init(const ProfilerTimerOps *ops);
+
+/**
+ * @brief Clear the histogram and start sampling
+ * @param hz Sampling rate, 1 to 10 kHz is recommended
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int profiler_start(uint32_t hz);
+
+/**
+ * @brief Stop sampling, the histogram is kept for dump
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int profiler_stop(void);
+
+/**
+ * @brief Dump the histogram as text for tools/prof_report.py
+ * @param writer Output function, e.g. uart_printf("%s", line)
+ * @param arg Argument given to writer
+ * @note Lines are "# hz samples dropped", "T tcb name" for each task and
+ * "S pc tcb count" for each histogram slot, numbers in hex
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int profiler_dump(ProfilerWriter writer, void *arg);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PROFILER_H_ */
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _SHELL_H_
+#define _SHELL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vpi_error.h"
+#include "boot_init.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup SHELL
+ *  Command shell on the debug UART for runtime statistics
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** UART of the shell, @see UartDevIdDef */
+#ifndef CONFIG_SHELL_UART_ID
+#define CONFIG_SHELL_UART_ID 0
+#endif
+/** Max number of commands added by shell_add_cmd */
+#define SHELL_CMD_NUM 16
+/** Max number of benchmarks, the DSP and IMU series add 6 each */
+#ifndef CONFIG_SHELL_BENCH_NUM
+#define CONFIG_SHELL_BENCH_NUM 16
+#endif
+#define SHELL_BENCH_NUM CONFIG_SHELL_BENCH_NUM
+/** Max number of watched queues and watched timers */
+#define SHELL_WATCH_NUM 8
+/** Interrupt ids counted separately, others go to one bucket */
+#define SHELL_IRQ_NUM 64
+/** Max length of a command line */
+#define SHELL_LINE_LEN 64
+/** Max number of arguments, the command name included */
+#define SHELL_ARG_NUM 6
+
+/**
+ * @brief Configuration of the shell
+ */
+typedef struct ShellCfg {
+    uint8_t uart_id;    /**< UART device id, @see UartDevIdDef */
+    uint8_t priority;   /**< Task priority, keep it low, e.g. 1 */
+    uint16_t stack;     /**< Task stack in words */
+} ShellCfg;
+
+/**
+ * @brief A command
+ * @note fn gets the arguments split at spaces, argv[0] is the name
+ */
+typedef struct ShellCmd {
+    const char *name;
+    const char *help;
+    int (*fn)(int argc, char *argv[]);
+} ShellCmd;
+
+/**
+ * @brief A benchmark run by "bench <name> [n]"
+ * @note run is called n times, the shell reports cycles and instructions per run
+ */
+typedef struct ShellBench {
+    const char *name;
+    void (*run)(void *arg);
+    void *arg;
+} ShellBench;
+
+/**
+ * @brief Declare a BOOT_LEVEL_APPLICATION entry which runs a self test and
+ * adds commands or benchmarks to the shell only when it passes
+ * @param fn Name of the generated init function
+ * @param prio 0 to 99, lower runs first, see BOOT_INIT
+ * @param check Expression of the self test, VPI_SUCCESS when it passes
+ * @param init Function of type int (*)(void) adding to the shell
+ */
+#define SHELL_BENCH_BOOT(fn, prio, check, init)       \
+    static int fn(void)                               \
+    {                                                 \
+        int ret = (check);                            \
+                                                      \
+        return ret == VPI_SUCCESS ? init() : ret;     \
+    }                                                 \
+    BOOT_INIT(APPLICATION, prio, fn, 0)
+
+/**
+ * @brief Start the shell task, it only runs when characters are received
+ * @param cfg Configuration
+ * @note Commands: help, top [ms], heap, queues, timers, irq, bench [name [n]]
+ * @note The irq command needs CONFIG_SHELL for the hook in portasm.S.
+ * Vectored interrupts do not pass irq_entry and are not counted
+ * @note The "peak" column of queues is the deepest level seen when the
+ * command runs. Sends only raise it in between with a kernel built from
+ * source and CONFIG_TRACE_RECORDER unset, the prebuilt kernel has no
+ * trace hooks
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int shell_init(const ShellCfg *cfg);
+
+/**
+ * @brief Add a command, the command is referenced and not copied
+ * @param cmd The command
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int shell_add_cmd(const ShellCmd *cmd);
+
+/**
+ * @brief Add a benchmark, the benchmark is referenced and not copied
+ * @param bench The benchmark
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int shell_add_bench(const ShellBench *bench);
+
+/**
+ * @brief Show a queue in the queues command
+ * @param name Name shown, referenced and not copied
+ * @param queue QueueHandle_t of the queue, semaphores included
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int shell_watch_queue(const char *name, void *queue);
+
+/**
+ * @brief Show a timer in the timers command
+ * @param timer TimerHandle_t of the timer
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int shell_watch_timer(void *timer);
+
+/** Hooks of portasm.S and trace_hooks.h when CONFIG_SHELL is set */
+void shell_port_isr_enter(uint32_t mcause);
+void shell_queue_note(void *queue, uint32_t waiting);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_H_ */
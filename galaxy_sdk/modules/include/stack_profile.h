@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _STACK_PROFILE_H_
+#define _STACK_PROFILE_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup STACK_PROFILE
+ *  Stack high-water marks of tasks and of the interrupt stack
+ *  @ingroup VPI
+ *  @{
+ */
+
+/** Max number of tasks whose stack size is known */
+#ifndef CONFIG_STACK_PROFILE_TASK_NUM
+#define CONFIG_STACK_PROFILE_TASK_NUM 16
+#endif
+/** Margin added to the peak usage in the recommendation, in percent */
+#ifndef CONFIG_STACK_PROFILE_MARGIN
+#define CONFIG_STACK_PROFILE_MARGIN 25
+#endif
+/** Period of the sampling task started with CONFIG_STACK_PROFILE */
+#ifndef CONFIG_STACK_PROFILE_PERIOD_MS
+#define CONFIG_STACK_PROFILE_PERIOD_MS 1000
+#endif
+/** Bytes added on top of the margin, covers one saved task context */
+#define STACK_PROFILE_SLACK 128
+
+/**
+ * @brief Stack usage of a task or of the interrupt stack, in bytes
+ * @note size is 0 for tasks not created by osal_create_task, whose used value
+ * is then unknown and only free is valid. Deleted tasks keep their line
+ * until the slot is needed, the one deleted first is replaced first
+ */
+typedef struct StackUsage {
+    char name[16];
+    uint32_t size;
+    uint32_t used;
+    uint32_t free;
+    /** Tick count when the peak last grew */
+    uint32_t peak_tick;
+    /** Recommended size in words, as given to osal_create_task */
+    uint32_t recommended;
+} StackUsage;
+
+/**
+ * @brief Output function of the report
+ * @param line A text line, terminated by newline
+ * @param arg Argument given to stack_profile_dump
+ */
+typedef void (*StackWriter)(const char *line, void *arg);
+
+/**
+ * @brief Fill the unused part of the interrupt stack with the pattern and
+ * clear all peaks
+ * @note Run at BOOT_LEVEL_POST_KERNEL when CONFIG_STACK_PROFILE is set, which
+ * also starts a task calling stack_profile_sample every
+ * CONFIG_STACK_PROFILE_PERIOD_MS and adds the shell command "stack". Before
+ * the scheduler starts only the part below the stack pointer of main is filled
+ * @note Stack sizes are recorded by wrapping osal_create_task at link time,
+ * CMakeLists.txt adds --wrap=osal_create_task when vs_conf.h sets
+ * CONFIG_STACK_PROFILE
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int stack_profile_init(void);
+
+/**
+ * @brief Update the peaks of all tasks and of the interrupt stack
+ * @note Task stacks are filled by the kernel, the cost is one scan of the
+ * unused part of each stack, so call it from a low priority context
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int stack_profile_sample(void);
+
+/**
+ * @brief Get the usage of the interrupt stack
+ * @param out Usage, the name is "isr"
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int stack_profile_isr(StackUsage *out);
+
+/**
+ * @brief Sample and print a line per task and one for the interrupt stack
+ * @param writer Output function
+ * @param arg Argument given to writer
+ * @note Lines are "K <name> <size> <used> <free> <recommended words>" and can
+ * be combined with -fstack-usage results by tools/stack_report.py
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int stack_profile_dump(StackWriter writer, void *arg);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _STACK_PROFILE_H_ */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _TRACE_HOOKS_H_
+#define _TRACE_HOOKS_H_
+
+/*
+ * FreeRTOS trace macros, included at the end of FreeRTOSConfig.h. They take
+ * effect when the kernel is built from source with this configuration; task
+ * switches and interrupts are traced from portasm.S so that they also work
+ * with the prebuilt kernel.
+ */
+#include "vs_conf.h"
+
+#if CONFIG_TRACE_RECORDER
+#include "trace_recorder.h"
+
+#define traceTASK_CREATE(pxNewTCB) \
+    trace_record(TRACE_EVT_TASK_CREATE, (uint32_t)(pxNewTCB), 0)
+#define traceQUEUE_SEND(pxQueue) \
+    trace_record(TRACE_EVT_QUEUE_SEND, (uint32_t)(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+    trace_record(TRACE_EVT_QUEUE_SEND, (uint32_t)(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE(pxQueue) \
+    trace_record(TRACE_EVT_QUEUE_RECV, (uint32_t)(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) \
+    trace_record(TRACE_EVT_QUEUE_RECV, (uint32_t)(pxQueue), (pxQueue)->uxMessagesWaiting)
+#define traceMALLOC(pvAddress, uiSize) \
+    trace_record(TRACE_EVT_MALLOC, (uint32_t)(pvAddress), (uint32_t)(uiSize))
+#define traceFREE(pvAddress, uiSize) \
+    trace_record(TRACE_EVT_FREE, (uint32_t)(pvAddress), (uint32_t)(uiSize))
+#elif CONFIG_SHELL
+#include "shell.h"
+
+/* Called before the item is copied, so one more than the current depth */
+#define traceQUEUE_SEND(pxQueue) \
+    shell_queue_note((pxQueue), (pxQueue)->uxMessagesWaiting + 1)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+    shell_queue_note((pxQueue), (pxQueue)->uxMessagesWaiting + 1)
+#endif
+
+#endif /* _TRACE_HOOKS_H_ */
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _TRACE_RECORDER_H_
+#define _TRACE_RECORDER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup TRACE
+ *  Kernel trace recorder
+ *  @ingroup VPI
+ *  @{
+ */
+
+/**
+ * A trace is a sequence of blocks. Each block is a TraceBlockHdr followed by
+ * count entries of 16 bytes: TraceInfo for TRACE_BLK_INFO, TraceTaskName for
+ * TRACE_BLK_TASKS and TraceRecord for TRACE_BLK_RECORDS. A snapshot dump and
+ * a stream use the same format, tools/trace_to_perfetto.py converts it.
+ * Define CONFIG_TRACE_RECORDER in vs_conf.h to enable the kernel hooks.
+ * Task switches and interrupts are traced from portasm.S. The task create,
+ * queue and malloc events come from the trace macros of trace_hooks.h, which
+ * only a kernel built from source uses, so the prebuilt kernel never emits
+ * them.
+ */
+#define TRACE_MAGIC      0x43525456 /* "VTRC" */
+#define TRACE_ENTRY_SIZE 16
+#define TRACE_NAME_LEN   12
+
+/** @brief Type of trace blocks */
+enum TraceBlockType {
+    TRACE_BLK_INFO    = 0,
+    TRACE_BLK_TASKS   = 1,
+    TRACE_BLK_RECORDS = 2,
+};
+
+/** @brief Type of trace records */
+enum TraceEventType {
+    TRACE_EVT_TASK_IN     = 1,  /**< obj: TCB switched in */
+    TRACE_EVT_TASK_OUT    = 2,  /**< obj: TCB switched out */
+    TRACE_EVT_ISR_ENTER   = 3,  /**< obj: IRQ id */
+    TRACE_EVT_ISR_EXIT    = 4,  /**< obj: IRQ id */
+    TRACE_EVT_QUEUE_SEND  = 5,  /**< obj: queue, arg: messages waiting, kernel from source only */
+    TRACE_EVT_QUEUE_RECV  = 6,  /**< obj: queue, arg: messages waiting, kernel from source only */
+    TRACE_EVT_MALLOC      = 7,  /**< obj: address, arg: size, kernel from source only */
+    TRACE_EVT_FREE        = 8,  /**< obj: address, arg: size, kernel from source only */
+    TRACE_EVT_TASK_CREATE = 9,  /**< obj: TCB created, kernel from source only */
+    TRACE_EVT_USER        = 10, /**< obj: user id, arg: user value */
+};
+
+/** @brief Recording modes */
+enum TraceMode {
+    TRACE_MODE_SNAPSHOT, /**< Ring keeps the latest records, dumped on demand */
+    TRACE_MODE_STREAM,   /**< Ring is drained continuously, new records are dropped if full */
+};
+
+typedef struct TraceBlockHdr {
+    uint32_t magic; /**< TRACE_MAGIC */
+    uint16_t type;  /**< @see TraceBlockType */
+    uint16_t count; /**< Number of entries following */
+} TraceBlockHdr;
+
+typedef struct TraceInfo {
+    uint32_t cpu_hz;  /**< Frequency of mcycle */
+    uint32_t dropped; /**< Records dropped since start */
+    uint32_t rsvd[2];
+} TraceInfo;
+
+typedef struct TraceTaskName {
+    uint32_t tcb;              /**< Task handle */
+    char name[TRACE_NAME_LEN]; /**< Task name, may be not terminated */
+} TraceTaskName;
+
+typedef struct TraceRecord {
+    uint32_t ts_lo; /**< mcycle bits 31..0 */
+    uint16_t ts_hi; /**< mcycle bits 47..32 */
+    uint8_t type;   /**< @see TraceEventType */
+    uint8_t rsvd;
+    uint32_t obj;   /**< Object of the event */
+    uint32_t arg;   /**< Argument of the event */
+} TraceRecord;
+
+/**
+ * @brief Output function of trace dump
+ * @param data Data to be written
+ * @param len Length of data
+ * @param arg Argument given to trace_dump
+ */
+typedef void (*TraceWriter)(const void *data, uint32_t len, void *arg);
+
+/**
+ * @brief Initialize the trace recorder
+ * @param buf Ring of records
+ * @param num Number of records in ring, power of 2
+ * @param mode Recording mode, @see TraceMode
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int trace_init(TraceRecord *buf, uint32_t num, uint8_t mode);
+
+/**
+ * @brief Start recording, the ring is cleared
+ */
+void trace_start(void);
+
+/**
+ * @brief Stop recording, e.g. when the latency spike of interest is seen
+ */
+void trace_stop(void);
+
+/**
+ * @brief Add a record, can be called from any context
+ * @param type Event type, @see TraceEventType
+ * @param obj Object of the event
+ * @param arg Argument of the event
+ */
+void trace_record(uint8_t type, uint32_t obj, uint32_t arg);
+
+/**
+ * @brief Add a user record
+ * @param id User id of the event
+ * @param value Value of the event
+ */
+static inline void trace_user(uint32_t id, uint32_t value)
+{
+    trace_record(TRACE_EVT_USER, id, value);
+}
+
+/**
+ * @brief Dump info, task names and all records of the ring
+ * @param writer Output function, e.g. writes to UART or file
+ * @param arg Argument given to writer
+ * @note Recording is paused during the dump
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int trace_dump(TraceWriter writer, void *arg);
+
+/**
+ * @brief Read and remove the oldest records from the ring
+ * @param out Buffer of records
+ * @param max Maximum number of records
+ * @return Number of records read
+ */
+uint32_t trace_read(TraceRecord *out, uint32_t max);
+
+/**
+ * @brief Start a task which streams the ring through uart_stream
+ * @param stream Handle of uart_stream, its max_payload should be at least
+ * sizeof(TraceBlockHdr) + 32 * TRACE_ENTRY_SIZE
+ * @param channel Channel of uart_stream used for trace
+ * @param period_ms Period of draining the ring
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int trace_stream_start(void *stream, uint8_t channel, uint32_t period_ms);
+
+/** Hooks called from portasm.S when CONFIG_TRACE_RECORDER is set */
+void trace_port_switch_out(void *tcb);
+void trace_port_switch_in(void *tcb);
+void trace_port_isr_enter(uint32_t mcause);
+void trace_port_isr_exit(uint32_t mcause);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TRACE_RECORDER_H_ */
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _UART_STREAM_H_
+#define _UART_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vpi_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup UART_STREAM
+ *  Binary data streaming over UART
+ *  @ingroup VPI
+ *  @{
+ */
+
+/**
+ * Frames are COBS encoded and terminated by 0x00. Before encoding, a frame is
+ *  | seq (2, LE) | channel (1) | type (1) | payload (n) | crc16 (2, LE) |
+ * crc16 is CRC-16/CCITT-FALSE over seq..payload. seq increases by one for every
+ * frame given to uart_stream_send, including dropped ones, so the receiver
+ * detects loss from the gaps.
+ */
+#define UART_STREAM_HDR_LEN 4
+#define UART_STREAM_CRC_LEN 2
+
+/** @brief Type of stream frames */
+enum UartStreamFrameType {
+    UART_STREAM_DATA = 0, /**< Payload is channel data */
+    UART_STREAM_BAUD = 1, /**< Payload is the next baud rate, uint32 LE */
+    UART_STREAM_TEXT = 2, /**< Payload is a text message */
+};
+
+/**
+ * @brief Configuration of a UART stream
+ */
+typedef struct UartStreamCfg {
+    uint8_t uart_id;      /**< UART device id, @see UartDevIdDef */
+    uint8_t buf_num;      /**< Number of TX buffers in queue, at least 2 */
+    uint16_t max_payload; /**< Maximum payload of a frame in bytes */
+    uint32_t fifo_addr;   /**< Address of the TX data register, 0 to use base */
+} UartStreamCfg;
+
+/**
+ * @brief Statistics of a UART stream
+ */
+typedef struct UartStreamStats {
+    uint32_t frames;  /**< Frames queued for transmission */
+    uint32_t dropped; /**< Frames dropped because all buffers were busy */
+    uint32_t errors;  /**< Frames dropped because DMA failed to start */
+    uint32_t bytes;   /**< Bytes queued, after encoding */
+    uint16_t seq;     /**< Sequence number of the next frame */
+} UartStreamStats;
+
+/**
+ * @brief Open a UART stream
+ * @param cfg Configuration of the stream
+ * @return Stream handle for succeed, NULL for failure
+ */
+void *uart_stream_open(const UartStreamCfg *cfg);
+
+/**
+ * @brief Encode a frame and queue it for DMA transmission
+ * @param stream Stream handle
+ * @param channel Channel of the data, used by receiver to split the stream
+ * @param data Payload of the frame
+ * @param len Length of payload, no more than max_payload
+ * @note Never blocks, a frame is dropped if no buffer is free. Can be called
+ * from ISR
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_FULL if dropped, others
+ * for failure
+ */
+int uart_stream_send(void *stream, uint8_t channel, const void *data, uint32_t len);
+
+/**
+ * @brief Queue a text message, sent as a UART_STREAM_TEXT frame
+ * @param stream Stream handle
+ * @param channel Channel of the message
+ * @param text Null terminated string, no longer than max_payload
+ * @note Same as uart_stream_send, never blocks and can be called from ISR
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_FULL if dropped, others
+ * for failure
+ */
+int uart_stream_send_text(void *stream, uint8_t channel, const char *text);
+
+/**
+ * @brief Announce a new baud rate to the receiver and switch to it
+ * @param stream Stream handle
+ * @param baud_rate New baud rate, up to UART_BAUD_DIV32
+ * @param timeout_ms Time to wait for the queue to drain
+ * @note Must be called from task context
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int uart_stream_set_baud(void *stream, uint32_t baud_rate, uint32_t timeout_ms);
+
+/**
+ * @brief Get statistics of a stream
+ * @param stream Stream handle
+ * @param stats Statistics output
+ * @return Return VPI_SUCCESS for succeed, others for failure
+ */
+int uart_stream_get_stats(void *stream, UartStreamStats *stats);
+
+/**
+ * @brief Wait for the queue to drain and close the stream
+ * @param stream Stream handle
+ * @param timeout_ms Time to wait for the queue to drain
+ * @note The stream is closed even on timeout, the frames not sent are lost
+ * @return Return VPI_SUCCESS for succeed, VPI_ERR_TIMEOUT if frames were
+ * lost, others for failure
+ */
+int uart_stream_close(void *stream, uint32_t timeout_ms);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _UART_STREAM_H_ */
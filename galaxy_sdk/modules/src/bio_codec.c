@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "bio_codec.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+#define BIO_MAGIC 0xB0
+#define BIO_RAW   0x0F
+/* Rice adaptation: the mean of u over the last 16 to 32 samples */
+#define BIO_RICE_N0    4
+#define BIO_RICE_RESET 32
+#define BIO_RICE_K_MAX 24
+#define BIO_RICE_U_MAX (1u << 26)
+
+typedef struct BioWriter {
+    uint8_t *p;
+    uint8_t *end;
+    uint32_t acc;
+    uint32_t n;
+    bool over;
+} BioWriter;
+
+typedef struct BioReader {
+    const uint8_t *p;
+    const uint8_t *end;
+    uint32_t acc;
+    uint32_t n;
+    bool under;
+} BioReader;
+
+typedef struct BioRice {
+    uint32_t a;
+    uint32_t n;
+    uint32_t k;
+} BioRice;
+
+/* Append the n low bits of v, n up to 24 */
+static inline void bio_put(BioWriter *w, uint32_t v, uint32_t n)
+{
+    w->acc = w->acc << n | (v & ((1u << n) - 1));
+    w->n += n;
+    while (w->n >= 8) {
+        w->n -= 8;
+        if (w->p == w->end) {
+            w->over = true;
+        } else {
+            *w->p++ = (uint8_t)(w->acc >> w->n);
+        }
+    }
+}
+
+static inline uint32_t bio_get(BioReader *r, uint32_t n)
+{
+    while (r->n < n) {
+        if (r->p == r->end) {
+            r->under = true;
+            r->acc <<= 8;
+        } else {
+            r->acc = r->acc << 8 | *r->p++;
+        }
+        r->n += 8;
+    }
+    r->n -= n;
+    return (r->acc >> r->n) & ((1u << n) - 1);
+}
+
+static void bio_rice_init(BioRice *rice, uint32_t k0)
+{
+    rice->a = BIO_RICE_N0 << k0;
+    rice->n = BIO_RICE_N0;
+    rice->k = k0;
+}
+
+/* Smallest k with n * 2^k >= a, after adding u */
+static inline void bio_rice_update(BioRice *rice, uint32_t u)
+{
+    rice->a += MIN(u, BIO_RICE_U_MAX);
+    if (++rice->n == BIO_RICE_RESET) {
+        rice->a >>= 1;
+        rice->n >>= 1;
+    }
+    for (rice->k = 0; rice->k < BIO_RICE_K_MAX && (rice->n << rice->k) < rice->a; rice->k++) {
+    }
+}
+
+/* Prediction of order min(n, order) from the previous samples */
+static inline int32_t bio_predict(const int32_t *x, uint32_t n, uint32_t order)
+{
+    switch (MIN(n, order)) {
+    case 0:
+        return 0;
+    case 1:
+        return x[n - 1];
+    case 2:
+        return 2 * x[n - 1] - x[n - 2];
+    default:
+        return 3 * (x[n - 1] - x[n - 2]) + x[n - 3];
+    }
+}
+
+static bool bio_cfg_valid(const BioCodecCfg *cfg)
+{
+    return cfg && cfg->bits >= 8 && cfg->bits <= 24 &&
+           (cfg->order <= 3 || cfg->order == BIO_CODEC_ORDER_AUTO);
+}
+
+int bio_encoder_init(BioEncoder *enc, const BioCodecCfg *cfg)
+{
+    if (!enc || !bio_cfg_valid(cfg)) {
+        return VPI_ERR_INVALID;
+    }
+    memset(enc, 0, sizeof(*enc));
+    enc->cfg = *cfg;
+    return VPI_SUCCESS;
+}
+
+/* Sums of |residual| of the 4 orders, false when a sample is out of range */
+static bool bio_analyze(const int32_t *in, uint32_t num, uint32_t bits, uint64_t *sum)
+{
+    int32_t lo = -(1 << (bits - 1)), hi = (1 << (bits - 1)) - 1;
+    int32_t d1 = 0, d2 = 0, prev = 0;
+
+    sum[0] = sum[1] = sum[2] = sum[3] = 0;
+    for (uint32_t n = 0; n < num; n++) {
+        int32_t x = in[n], e1, e2, e3;
+
+        if (x < lo || x > hi) {
+            return false;
+        }
+        e1 = x - prev;
+        e2 = e1 - d1;
+        e3 = e2 - d2;
+        /* Residuals of the first samples would favour order 0 */
+        if (n >= 3) {
+            sum[0] += (uint32_t)(x < 0 ? -x : x);
+            sum[1] += (uint32_t)(e1 < 0 ? -e1 : e1);
+            sum[2] += (uint32_t)(e2 < 0 ? -e2 : e2);
+            sum[3] += (uint32_t)(e3 < 0 ? -e3 : e3);
+        }
+        prev = x;
+        d1   = e1;
+        d2   = e2;
+    }
+    return true;
+}
+
+static void bio_header(uint8_t *out, uint32_t mode, uint32_t bits, uint32_t num, uint32_t k0,
+                       uint8_t seq)
+{
+    out[0] = BIO_MAGIC | mode;
+    out[1] = (uint8_t)bits;
+    out[2] = (uint8_t)num;
+    out[3] = (uint8_t)(num >> 8);
+    out[4] = (uint8_t)k0;
+    out[5] = seq;
+}
+
+int bio_encode(BioEncoder *enc, const int32_t *in, uint32_t num, uint8_t *out, uint32_t size,
+               uint32_t *used)
+{
+    uint32_t bits, order, bound, k0 = 0;
+    uint64_t sum[4];
+    BioWriter w;
+    BioRice rice;
+
+    if (!enc || !in || !out || !used || !num || num > BIO_CODEC_BLOCK_MAX) {
+        return VPI_ERR_INVALID;
+    }
+    bits  = enc->cfg.bits;
+    bound = BIO_CODEC_BOUND(num, bits);
+    if (size < bound || !bio_analyze(in, num, bits, sum)) {
+        return VPI_ERR_INVALID;
+    }
+    order = enc->cfg.order;
+    if (order == BIO_CODEC_ORDER_AUTO) {
+        order = 0;
+        for (uint32_t i = 1; i < 4; i++) {
+            order = sum[i] < sum[order] ? i : order;
+        }
+    }
+    /* Mean of u is about twice the mean |residual| */
+    while (k0 < BIO_RICE_K_MAX && ((uint64_t)num << k0) < 2 * sum[order]) {
+        k0++;
+    }
+    /* Coded blocks must end before the raw size */
+    w = (BioWriter){out + BIO_CODEC_HEADER, out + bound - 1, 0, 0, false};
+    bio_rice_init(&rice, k0);
+    for (uint32_t n = 0; n < num && !w.over; n++) {
+        int32_t r  = in[n] - bio_predict(in, n, order);
+        uint32_t u = r >= 0 ? (uint32_t)r << 1 : ((uint32_t)(-(r + 1)) << 1) | 1;
+        uint32_t q = u >> rice.k;
+
+        if (q < BIO_CODEC_ESCAPE) {
+            bio_put(&w, 1, q + 1);
+            bio_put(&w, u, rice.k);
+        } else {
+            bio_put(&w, 1, BIO_CODEC_ESCAPE + 1);
+            bio_put(&w, u >> 12, bits - 8);
+            bio_put(&w, u, 12);
+        }
+        bio_rice_update(&rice, u);
+    }
+    if (w.n) {
+        bio_put(&w, 0, 8 - w.n);
+    }
+    if (w.over) {
+        w = (BioWriter){out + BIO_CODEC_HEADER, out + bound, 0, 0, false};
+        for (uint32_t n = 0; n < num; n++) {
+            bio_put(&w, (uint32_t)in[n], bits);
+        }
+        if (w.n) {
+            bio_put(&w, 0, 8 - w.n);
+        }
+        order = BIO_RAW;
+    }
+    bio_header(out, order, bits, num, k0, enc->seq++);
+    *used = w.p - out;
+    enc->samples += num;
+    enc->bytes += *used;
+    return VPI_SUCCESS;
+}
+
+int bio_decode(const uint8_t *in, uint32_t size, int32_t *out, uint32_t num_max, uint32_t *num,
+               uint32_t *used, uint8_t *seq)
+{
+    uint32_t mode, bits, count, k0;
+    int32_t lo, hi;
+    BioReader r;
+    BioRice rice;
+
+    if (!in || !out || !num || !used) {
+        return VPI_ERR_INVALID;
+    }
+    if (size < BIO_CODEC_HEADER) {
+        return VPI_ERR_BAD_DATA;
+    }
+    mode  = in[0] & 0x0F;
+    bits  = in[1];
+    count = in[2] | (uint32_t)in[3] << 8;
+    k0    = in[4];
+    if ((in[0] & 0xF0) != BIO_MAGIC || (mode > 3 && mode != BIO_RAW) || bits < 8 || bits > 24 ||
+        !count || count > BIO_CODEC_BLOCK_MAX || k0 > BIO_RICE_K_MAX) {
+        return VPI_ERR_BAD_DATA;
+    }
+    if (count > num_max) {
+        return VPI_ERR_INVALID;
+    }
+    lo = -(1 << (bits - 1));
+    hi = (1 << (bits - 1)) - 1;
+    r  = (BioReader){in + BIO_CODEC_HEADER, in + size, 0, 0, false};
+    bio_rice_init(&rice, k0);
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t u, q = 0;
+        int32_t x;
+
+        if (mode == BIO_RAW) {
+            /* Sign extend the bits wide value */
+            out[n] = (int32_t)(bio_get(&r, bits) << (32 - bits)) >> (32 - bits);
+            continue;
+        }
+        while (q < BIO_CODEC_ESCAPE && !bio_get(&r, 1) && !r.under) {
+            q++;
+        }
+        if (q == BIO_CODEC_ESCAPE) {
+            if (!bio_get(&r, 1)) {
+                return VPI_ERR_BAD_DATA;
+            }
+            u = bio_get(&r, bits - 8) << 12;
+            u |= bio_get(&r, 12);
+        } else {
+            u = q << rice.k | bio_get(&r, rice.k);
+        }
+        if (r.under) {
+            return VPI_ERR_BAD_DATA;
+        }
+        bio_rice_update(&rice, u);
+        x = (int32_t)(u >> 1 ^ -(u & 1)) + bio_predict(out, n, mode);
+        if (x < lo || x > hi) {
+            return VPI_ERR_BAD_DATA;
+        }
+        out[n] = x;
+    }
+    if (r.under) {
+        return VPI_ERR_BAD_DATA;
+    }
+    *num  = count;
+    *used = r.p - in;
+    if (seq) {
+        *seq = in[5];
+    }
+    return VPI_SUCCESS;
+}
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "boot_init.h"
+#include "vpi_error.h"
+#include "platform.h"
+#include "soc_sysctl.h"
+#include "uart_printf.h"
+#include "vs_logging.h"
+#include "osal_task_api.h"
+#include "osal_semaphore_api.h"
+
+#define BOOT_WORKER_STACK   512
+#define BOOT_WORKER_PRIO    2
+#define BOOT_WORKER_POLL_MS 10
+#define BOOT_LINE_LEN       80
+
+enum BootState {
+    BOOT_STATE_PENDING = 0,
+    BOOT_STATE_RUNNING,
+    BOOT_STATE_DONE,
+};
+
+typedef struct BootMark {
+    const char *name;
+    uint64_t cycles;
+} BootMark;
+
+typedef struct BootEntryState {
+    uint8_t state;
+    uint8_t worker;
+    int result;
+    void *runner;
+    uint64_t start;
+    uint64_t end;
+} BootEntryState;
+
+typedef struct BootCtx {
+    BootMark marks[BOOT_MARK_NUM];
+    uint32_t mark_num;
+    BootEntryState entry[BOOT_INIT_MAX];
+    OsalSemaphore wake;
+    OsalSemaphore done;
+    uint32_t workers;
+    bool app_started;
+} BootCtx;
+
+extern const BootInitEntry __init_start[];
+extern const BootInitEntry __init_PRE_KERNEL_1_start[];
+extern const BootInitEntry __init_PRE_KERNEL_2_start[];
+extern const BootInitEntry __init_POST_KERNEL_start[];
+extern const BootInitEntry __init_APPLICATION_start[];
+extern const BootInitEntry __init_end[];
+extern void *volatile pxCurrentTCB;
+
+static const BootInitEntry *const g_boot_level[BOOT_LEVEL_NUM + 1] = {
+    __init_PRE_KERNEL_1_start, __init_PRE_KERNEL_2_start, __init_POST_KERNEL_start,
+    __init_APPLICATION_start,  __init_end,
+};
+
+static const char *const g_boot_level_name[BOOT_LEVEL_NUM] = {
+    "pre1",
+    "pre2",
+    "post",
+    "app",
+};
+
+static BootCtx g_boot;
+
+static inline uint32_t boot_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void boot_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+static inline uint32_t boot_entry_num(void)
+{
+    return MIN((uint32_t)(__init_end - __init_start), BOOT_INIT_MAX);
+}
+
+static int boot_find(const char *name)
+{
+    uint32_t i;
+
+    for (i = 0; i < boot_entry_num(); i++) {
+        if (!strcmp(__init_start[i].name, name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static BootLevel boot_level_of(uint32_t idx)
+{
+    BootLevel level = BOOT_LEVEL_PRE_KERNEL_1;
+
+    while (level < BOOT_LEVEL_APPLICATION && &__init_start[idx] >= g_boot_level[level + 1]) {
+        level++;
+    }
+    return level;
+}
+
+void boot_mark(const char *name)
+{
+    uint64_t now = __get_rv_cycle();
+    uint32_t mie;
+
+    mie = boot_lock();
+    if (g_boot.mark_num < BOOT_MARK_NUM) {
+        g_boot.marks[g_boot.mark_num].name   = name;
+        g_boot.marks[g_boot.mark_num].cycles = now;
+        g_boot.mark_num++;
+    }
+    boot_unlock(mie);
+}
+
+static int boot_run_entry(uint32_t idx, uint8_t worker);
+
+/* Run or wait for the dependencies of an entry, in the calling context */
+static int boot_run_deps(uint32_t idx, uint8_t worker)
+{
+    const BootInitEntry *entry = &__init_start[idx];
+    uint32_t i;
+    int dep, ret;
+
+    for (i = 1; i <= entry->dep_num; i++) {
+        dep = boot_find(entry->deps[i]);
+        if (dep < 0) {
+            vs_logging(LOG_LVL_ERROR, "boot: %s needs unknown %s\r\n", entry->name,
+                       entry->deps[i]);
+            return VPI_ERR_NODEVICE;
+        }
+        ret = boot_run_entry(dep, worker);
+        if (ret != VPI_SUCCESS) {
+            return VPI_ERR_NOT_READY;
+        }
+    }
+    return VPI_SUCCESS;
+}
+
+static int boot_run_entry(uint32_t idx, uint8_t worker)
+{
+    BootEntryState *st = &g_boot.entry[idx];
+    uint32_t mie;
+    int ret;
+
+    mie = boot_lock();
+    if (st->state == BOOT_STATE_PENDING) {
+        st->state  = BOOT_STATE_RUNNING;
+        st->runner = pxCurrentTCB;
+        boot_unlock(mie);
+
+        ret = boot_run_deps(idx, worker);
+        if (ret == VPI_SUCCESS) {
+            st->worker = worker;
+            st->start  = __get_rv_cycle();
+            ret        = __init_start[idx].init();
+            st->end    = __get_rv_cycle();
+        }
+        if (ret != VPI_SUCCESS) {
+            vs_logging(LOG_LVL_ERROR, "boot: %s failed %d\r\n", __init_start[idx].name, ret);
+        }
+        st->result = ret;
+        st->state  = BOOT_STATE_DONE;
+        if (g_boot.app_started) {
+            osal_sem_post(&g_boot.wake);
+        }
+        return ret;
+    }
+    boot_unlock(mie);
+
+    /* The same context reaching a running entry again is a dependency loop */
+    while (st->state == BOOT_STATE_RUNNING) {
+        if (st->runner == pxCurrentTCB || !g_boot.app_started) {
+            vs_logging(LOG_LVL_ERROR, "boot: dependency loop at %s\r\n", __init_start[idx].name);
+            return VPI_ERR_INVALID;
+        }
+        osal_sleep(1);
+    }
+    return st->result;
+}
+
+/* Application entries whose dependencies are done or can be run inline */
+static bool boot_entry_ready(uint32_t idx)
+{
+    const BootInitEntry *entry = &__init_start[idx];
+    uint32_t i;
+    int dep;
+
+    for (i = 1; i <= entry->dep_num; i++) {
+        dep = boot_find(entry->deps[i]);
+        if (dep < 0) {
+            return true;
+        }
+        if (g_boot.entry[dep].state == BOOT_STATE_RUNNING) {
+            return false;
+        }
+        if (g_boot.entry[dep].state == BOOT_STATE_PENDING &&
+            !(__init_start[dep].flags & BOOT_INIT_LAZY)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void boot_worker_task(void *param)
+{
+    uint8_t worker = (uint8_t)(uintptr_t)param;
+    uint32_t first, last, i;
+    bool pending;
+    int pick;
+
+    first = __init_APPLICATION_start - __init_start;
+    last  = boot_entry_num();
+    while (1) {
+        pick    = -1;
+        pending = false;
+        for (i = first; i < last; i++) {
+            if (g_boot.entry[i].state != BOOT_STATE_PENDING ||
+                (__init_start[i].flags & BOOT_INIT_LAZY)) {
+                continue;
+            }
+            pending = true;
+            if (boot_entry_ready(i)) {
+                pick = i;
+                break;
+            }
+        }
+        if (!pending) {
+            break;
+        }
+        if (pick < 0) {
+            osal_sem_wait(&g_boot.wake, BOOT_WORKER_POLL_MS);
+            continue;
+        }
+        /* Another worker may claim it first, then the entry is only waited for */
+        boot_run_entry(pick, worker);
+    }
+
+    if (__atomic_sub_fetch(&g_boot.workers, 1, __ATOMIC_SEQ_CST) == 0) {
+        boot_mark("app_init_done");
+        osal_sem_post(&g_boot.done);
+    }
+    osal_delete_task(NULL);
+}
+
+int boot_init_run(BootLevel level)
+{
+    const BootInitEntry *entry;
+    uint32_t idx, i;
+    int ret = VPI_SUCCESS;
+    int err;
+
+    if (level >= BOOT_LEVEL_NUM) {
+        return VPI_ERR_INVALID;
+    }
+    if ((uint32_t)(__init_end - __init_start) > BOOT_INIT_MAX) {
+        vs_logging(LOG_LVL_ERROR, "boot: more than %d init entries\r\n", BOOT_INIT_MAX);
+    }
+
+    if (level == BOOT_LEVEL_APPLICATION) {
+        if (g_boot.app_started) {
+            return VPI_ERR_BUSY;
+        }
+        if (osal_create_sem(&g_boot.wake) != OSAL_TRUE ||
+            osal_create_sem(&g_boot.done) != OSAL_TRUE) {
+            return VPI_ERR_NOMEM;
+        }
+        g_boot.workers     = BOOT_INIT_WORKERS;
+        g_boot.app_started = true;
+        for (i = 0; i < BOOT_INIT_WORKERS; i++) {
+            if (!osal_create_task(boot_worker_task, "boot_init", BOOT_WORKER_STACK,
+                                  BOOT_WORKER_PRIO, (void *)(uintptr_t)(i + 1))) {
+                ret = VPI_ERR_NOMEM;
+                if (__atomic_sub_fetch(&g_boot.workers, 1, __ATOMIC_SEQ_CST) == 0) {
+                    osal_sem_post(&g_boot.done);
+                }
+            }
+        }
+        return ret;
+    }
+
+    for (entry = g_boot_level[level]; entry < g_boot_level[level + 1]; entry++) {
+        idx = entry - __init_start;
+        if (idx >= BOOT_INIT_MAX || (entry->flags & BOOT_INIT_LAZY)) {
+            continue;
+        }
+        err = boot_run_entry(idx, 0);
+        if (err != VPI_SUCCESS && ret == VPI_SUCCESS) {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+int boot_init_require(const char *name)
+{
+    int idx = boot_find(name);
+
+    if (idx < 0) {
+        return VPI_ERR_INVALID;
+    }
+    return boot_run_entry(idx, 0);
+}
+
+int boot_init_wait(uint32_t timeout_ms)
+{
+    if (!g_boot.app_started) {
+        return VPI_SUCCESS;
+    }
+    if (!g_boot.workers) {
+        return VPI_SUCCESS;
+    }
+    if (osal_sem_wait(&g_boot.done, timeout_ms) != OSAL_TRUE) {
+        return VPI_ERR_TIMEOUT;
+    }
+    /* Let other waiters pass too */
+    osal_sem_post(&g_boot.done);
+    return VPI_SUCCESS;
+}
+
+static inline uint32_t boot_cycles_to_us(uint64_t cycles, uint32_t mhz)
+{
+    return (uint32_t)(cycles / mhz);
+}
+
+int boot_init_dump(BootWriter writer, void *arg)
+{
+    const BootEntryState *st;
+    char line[BOOT_LINE_LEN];
+    uint32_t mhz, i, us;
+    uint64_t prev = 0;
+
+    if (!writer) {
+        return VPI_ERR_INVALID;
+    }
+
+    /* Cycles are converted with the current clock, PLL changes in soc_init skew early marks */
+    mhz = soc_cpu_clock_get_freq() / 1000000;
+    if (!mhz) {
+        mhz = 1;
+    }
+    for (i = 0; i < g_boot.mark_num; i++) {
+        us = boot_cycles_to_us(g_boot.marks[i].cycles, mhz);
+        uart_sprintf(line, "mark %-20s %8u us  +%u us\n", g_boot.marks[i].name, (unsigned int)us,
+                     (unsigned int)boot_cycles_to_us(g_boot.marks[i].cycles - prev, mhz));
+        writer(line, arg);
+        prev = g_boot.marks[i].cycles;
+    }
+    for (i = 0; i < boot_entry_num(); i++) {
+        st = &g_boot.entry[i];
+        if (st->state != BOOT_STATE_DONE) {
+            uart_sprintf(line, "init %-4s %-20s %s\n", g_boot_level_name[boot_level_of(i)],
+                         __init_start[i].name,
+                         st->state == BOOT_STATE_RUNNING ? "running" : "not run");
+        } else {
+            uart_sprintf(line, "init %-4s %-20s %8u us %6u us w%u ret %d\n",
+                         g_boot_level_name[boot_level_of(i)], __init_start[i].name,
+                         (unsigned int)boot_cycles_to_us(st->start, mhz),
+                         (unsigned int)boot_cycles_to_us(st->end - st->start, mhz),
+                         (unsigned int)st->worker, st->result);
+        }
+        writer(line, arg);
+    }
+    return VPI_SUCCESS;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "cache_lock_bench.h"
+#include "hal_cache.h"
+#include "vpi_error.h"
+#include "vsd_error.h"
+#include "platform.h"
+#include "bsp_common.h"
+#include "uart_printf.h"
+#include "boot_init.h"
+
+#define CACHE_BENCH_LINE_LEN 80
+#define CACHE_BENCH_CODE     "bench_code"
+#define CACHE_BENCH_DATA     "bench_data"
+#define CACHE_BENCH_SWEEP_BLK 32
+
+extern char _text[];
+
+/*
+ * I-Cache sweep, one jump per 32 bytes block. Entering it n blocks before
+ * the end fetches n blocks of code, lines of 32 bytes and more are all hit
+ */
+extern char cache_bench_sweep[];
+extern char cache_bench_sweep_end[];
+__asm__(".pushsection .text.cache_bench_sweep, \"ax\", @progbits\n"
+        ".balign 32\n"
+        "cache_bench_sweep:\n"
+        ".rept " STRINGIFY(CONFIG_CACHE_BENCH_SWEEP_SIZE / CACHE_BENCH_SWEEP_BLK) "\n"
+        "    j 1f\n"
+        "    .balign 32\n"
+        "1:\n"
+        ".endr\n"
+        "cache_bench_sweep_end:\n"
+        "    ret\n"
+        ".popsection\n");
+
+static inline uint32_t bench_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void bench_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+/* Read twice the D-Cache size of flash so that every unlocked line is replaced */
+static void bench_thrash_dcache(void)
+{
+    const volatile uint32_t *p = (const volatile uint32_t *)_text;
+    CacheLockUsage usage;
+    uint32_t i, step;
+
+    if (hal_cache_lock_usage(CACHE_TYPE_DCACHE, &usage) != VSD_SUCCESS || !usage.line_size) {
+        return;
+    }
+    step = usage.line_size / sizeof(uint32_t);
+    for (i = 0; i < usage.size * 2 / sizeof(uint32_t); i += step) {
+        (void)p[i];
+    }
+}
+
+/* Execute twice the I-Cache size of code so that every unlocked line is replaced */
+static void bench_thrash_icache(void)
+{
+    CacheLockUsage usage;
+    uint32_t size;
+
+    if (hal_cache_lock_usage(CACHE_TYPE_ICACHE, &usage) != VSD_SUCCESS || !usage.line_size) {
+        return;
+    }
+    size = MIN(usage.size * 2, (uint32_t)CONFIG_CACHE_BENCH_SWEEP_SIZE);
+    ((void (*)(void))(cache_bench_sweep_end - size))();
+}
+
+static void bench_phase(const CacheBenchCfg *cfg, CacheBenchStat *stat)
+{
+    uint64_t start, sum = 0;
+    uint32_t i, cycles, mie;
+
+    stat->min = UINT32_MAX;
+    stat->max = 0;
+    for (i = 0; i < cfg->runs; i++) {
+        mie = bench_lock();
+        bench_thrash_icache();
+        bench_thrash_dcache();
+        start = __get_rv_cycle();
+        cfg->func(cfg->arg);
+        cycles = (uint32_t)(__get_rv_cycle() - start);
+        bench_unlock(mie);
+
+        sum += cycles;
+        stat->min = MIN(stat->min, cycles);
+        stat->max = MAX(stat->max, cycles);
+    }
+    stat->avg = (uint32_t)(sum / cfg->runs);
+}
+
+int cache_lock_bench_run(const CacheBenchCfg *cfg, CacheBenchResult *res)
+{
+    int ret;
+
+    if (!cfg || !res || !cfg->func || !cfg->code || !cfg->code_size || !cfg->runs) {
+        return VPI_ERR_INVALID;
+    }
+
+    bench_phase(cfg, &res->unlocked);
+
+    ret = hal_cache_lock_region(CACHE_BENCH_CODE, CACHE_TYPE_ICACHE, cfg->code, cfg->code_size);
+    if (ret == VSD_SUCCESS && cfg->data) {
+        ret = hal_cache_lock_region(CACHE_BENCH_DATA, CACHE_TYPE_DCACHE, cfg->data,
+                                    cfg->data_size);
+    }
+    if (ret == VSD_SUCCESS) {
+        /* The first run fills the locked lines, it is not part of the result */
+        cfg->func(cfg->arg);
+        bench_phase(cfg, &res->locked);
+    }
+    hal_cache_unlock_region(CACHE_BENCH_CODE);
+    hal_cache_unlock_region(CACHE_BENCH_DATA);
+    return vsd_to_vpi(ret);
+}
+
+int cache_lock_report(CacheBenchWriter writer, void *arg)
+{
+    static const char *const type_name[CACHE_TYPE_MAX] = {"icache", "dcache"};
+    CacheLockRegion regions[CACHE_LOCK_REGION_MAX];
+    char line[CACHE_BENCH_LINE_LEN];
+    CacheLockUsage usage;
+    uint32_t num, i;
+
+    if (!writer) {
+        return VPI_ERR_INVALID;
+    }
+
+    for (i = 0; i < CACHE_TYPE_MAX; i++) {
+        if (hal_cache_lock_usage(i, &usage) != VSD_SUCCESS || !usage.line_size) {
+            continue;
+        }
+        uart_sprintf(line, "%s: %u of %u bytes locked, budget %u, line %u\n", type_name[i],
+                     (unsigned int)usage.locked, (unsigned int)usage.size,
+                     (unsigned int)usage.budget, (unsigned int)usage.line_size);
+        writer(line, arg);
+    }
+    num = hal_cache_lock_get(regions, CACHE_LOCK_REGION_MAX);
+    for (i = 0; i < num; i++) {
+        hal_cache_lock_usage(regions[i].type, &usage);
+        uart_sprintf(line, "  %s %-20s 0x%08x %u bytes\n", type_name[regions[i].type],
+                     regions[i].name, (unsigned int)regions[i].start,
+                     (unsigned int)(regions[i].lines * usage.line_size));
+        writer(line, arg);
+    }
+    return VPI_SUCCESS;
+}
+
+#if CONFIG_CACHE_LOCK_ITEXT
+/*
+ * .itext holds the CRITICAL_SECTION and DRV_ISR_SECTION code, which runs
+ * from flash. Locked, a task thrashing the I-Cache no longer lengthens
+ * the interrupt paths
+ */
+static int cache_lock_itext_boot(void)
+{
+    int ret;
+
+    ret = hal_cache_lock_init(CONFIG_CACHE_LOCK_ICACHE_BUDGET, CONFIG_CACHE_LOCK_DCACHE_BUDGET);
+    if (ret == VSD_SUCCESS) {
+        ret = hal_cache_lock_section(".itext");
+    }
+    return vsd_to_vpi(ret);
+}
+
+BOOT_INIT(POST_KERNEL, 1, cache_lock_itext_boot, 0);
+#endif
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "dsp_bfp.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+__STATIC_FORCEINLINE int16_t bfp_h0(uint32_t a)
+{
+    return (int16_t)a;
+}
+
+__STATIC_FORCEINLINE int16_t bfp_h1(uint32_t a)
+{
+    return (int16_t)(a >> 16);
+}
+
+__STATIC_FORCEINLINE uint32_t bfp_pack(int32_t h0, int32_t h1)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_PKBB16(h1, h0);
+#else
+    return (uint16_t)h0 | (uint32_t)h1 << 16;
+#endif
+}
+
+/* Ones complement of the negative lanes, so that -2^n has n bits */
+__STATIC_FORCEINLINE uint32_t bfp_mag16(uint32_t a)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return a ^ __RV_SRAI16(a, 15);
+#else
+    return a ^ ((a >> 15 & 0x00010001u) * 0xffffu);
+#endif
+}
+
+/* Bits of the larger lane of ORed bfp_mag16 words */
+__STATIC_FORCEINLINE uint32_t bfp_mag_bits(uint32_t mag)
+{
+    mag = (mag | mag >> 16) & 0xffffu;
+    return mag ? 32 - __builtin_clz(mag) : 0;
+}
+
+/* Rounding arithmetic right shift of both lanes, s < 16 */
+__STATIC_FORCEINLINE uint32_t bfp_sra16(uint32_t a, uint32_t s)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SRA16_U(a, s);
+#else
+    int32_t r = (1 << s) >> 1;
+
+    return bfp_pack((bfp_h0(a) + r) >> s, (bfp_h1(a) + r) >> s);
+#endif
+}
+
+/* Saturating left shift of both lanes, s < 16 */
+__STATIC_FORCEINLINE uint32_t bfp_sll16(uint32_t a, uint32_t s)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KSLL16(a, s);
+#else
+    return bfp_pack(__SSAT(bfp_h0(a) * (1 << s), 16), __SSAT(bfp_h1(a) * (1 << s), 16));
+#endif
+}
+
+__STATIC_FORCEINLINE uint32_t bfp_kadd16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KADD16(a, b);
+#else
+    return bfp_pack(__SSAT(bfp_h0(a) + bfp_h0(b), 16), __SSAT(bfp_h1(a) + bfp_h1(b), 16));
+#endif
+}
+
+__STATIC_FORCEINLINE uint32_t bfp_ksub16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KSUB16(a, b);
+#else
+    return bfp_pack(__SSAT(bfp_h0(a) - bfp_h0(b), 16), __SSAT(bfp_h1(a) - bfp_h1(b), 16));
+#endif
+}
+
+/*
+ * b times the twiddle w = (cos, sin) conjugated for the forward transform,
+ * both as (re, im) words, rounded and shifted right by s more
+ */
+__STATIC_FORCEINLINE uint32_t bfp_cmul(uint32_t b, uint32_t w, uint32_t s, bool inverse)
+{
+    int32_t re, im, r = 1 << (14 + s);
+
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    re = inverse ? __RV_SMDRS(b, w) : __RV_KMDA(b, w);
+    im = inverse ? __RV_KMXDA(b, w) : __RV_SMXDS(b, w);
+#else
+    if (inverse) {
+        re = bfp_h0(b) * bfp_h0(w) - bfp_h1(b) * bfp_h1(w);
+        im = bfp_h1(b) * bfp_h0(w) + bfp_h0(b) * bfp_h1(w);
+    } else {
+        re = bfp_h0(b) * bfp_h0(w) + bfp_h1(b) * bfp_h1(w);
+        im = bfp_h1(b) * bfp_h0(w) - bfp_h0(b) * bfp_h1(w);
+    }
+#endif
+    return bfp_pack((re + r) >> (15 + s), (im + r) >> (15 + s));
+}
+
+uint32_t bfp_bits_q15(const q15_t *src, uint32_t len)
+{
+    uint32_t mag = 0, i = 0;
+
+    for (; i + 2 <= len; i += 2) {
+        mag |= bfp_mag16((uint32_t)read_q15x2(src + i));
+    }
+    if (i < len) {
+        mag |= bfp_mag16((uint16_t)src[i]);
+    }
+    return bfp_mag_bits(mag);
+}
+
+void bfp_shift_q15(q15_t *data, uint32_t len, int32_t shift)
+{
+    uint32_t i = 0;
+
+    if (shift <= -16) {
+        memset(data, 0, len * sizeof(q15_t));
+        return;
+    }
+    if (!shift) {
+        return;
+    }
+    shift = MIN(shift, 15);
+    for (; i + 2 <= len; i += 2) {
+        uint32_t a = (uint32_t)read_q15x2(data + i);
+
+        write_q15x2(data + i, (q31_t)(shift > 0 ? bfp_sll16(a, shift) : bfp_sra16(a, -shift)));
+    }
+    if (i < len) {
+        data[i] = bfp_h0(shift > 0 ? bfp_sll16((uint16_t)data[i], shift)
+                                   : bfp_sra16((uint16_t)data[i], -shift));
+    }
+}
+
+int32_t bfp_norm_q15(q15_t *data, uint32_t len, uint32_t bits)
+{
+    uint32_t now = bfp_bits_q15(data, len);
+
+    if (!now) {
+        return 0;
+    }
+    bfp_shift_q15(data, len, (int32_t)bits - (int32_t)now);
+    return (int32_t)now - (int32_t)bits;
+}
+
+int32_t bfp_from_f32(const float32_t *src, q15_t *dst, uint32_t len)
+{
+    float32_t peak = 0.0f, scale, pre, v;
+    int exp;
+
+    for (uint32_t i = 0; i < len; i++) {
+        peak = MAX(peak, fabsf(src[i]));
+    }
+    if (peak == 0.0f) {
+        memset(dst, 0, len * sizeof(q15_t));
+        return BFP_EXP_ZERO;
+    }
+    /* peak < 2^exp, the scale of tiny blocks is split to stay finite */
+    frexpf(peak, &exp);
+    scale = ldexpf(1.0f, MIN(15 - exp, 127));
+    pre   = ldexpf(1.0f, 15 - exp - MIN(15 - exp, 127));
+    for (uint32_t i = 0; i < len; i++) {
+        v      = src[i] * pre * scale;
+        dst[i] = (q15_t)__SSAT((int32_t)(v + (v < 0.0f ? -0.5f : 0.5f)), 16);
+    }
+    return exp;
+}
+
+void bfp_to_f32(const q15_t *src, int32_t exp, float32_t *dst, uint32_t len)
+{
+    float32_t scale = ldexpf(1.0f, MAX(exp, -200) - 15);
+
+    for (uint32_t i = 0; i < len; i++) {
+        dst[i] = src[i] * scale;
+    }
+}
+
+int bfp_cfft_init_q15(BfpCfftQ15 *fft, uint16_t len)
+{
+    riscv_cfft_instance_q15 cfft;
+
+    if (!fft || len < BFP_CFFT_LEN_MIN || len > BFP_CFFT_LEN_MAX || (len & (len - 1))) {
+        return VPI_ERR_INVALID;
+    }
+    if (riscv_cfft_init_q15(&cfft, len) != RISCV_MATH_SUCCESS) {
+        return VPI_ERR_INVALID;
+    }
+    fft->twiddle  = cfft.pTwiddle;
+    fft->len      = len;
+    fft->log2_len = (uint8_t)__builtin_ctz(len);
+    return VPI_SUCCESS;
+}
+
+/* Swap the complex words to bit reversed order */
+static void bfp_bitrev(q15_t *data, uint32_t n)
+{
+    for (uint32_t i = 1, j = 0, bit; i < n; i++) {
+        for (bit = n >> 1; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            q31_t a = read_q15x2(data + 2 * i);
+
+            write_q15x2(data + 2 * i, read_q15x2(data + 2 * j));
+            write_q15x2(data + 2 * j, a);
+        }
+    }
+}
+
+/*
+ * Radix-2 stages in decimation in time, each one scaled by the bits of the
+ * previous outputs. Returns the total right shift
+ */
+__STATIC_FORCEINLINE int32_t bfp_stages(const BfpCfftQ15 *fft, q15_t *data, uint32_t bits,
+                                        bool inverse)
+{
+    uint32_t n = fft->len, s, mag;
+    int32_t shift = 0;
+
+    for (uint32_t half = 1, step = n / 2; half < n; half <<= 1, step >>= 1) {
+        s   = bits > BFP_CFFT_BITS ? bits - BFP_CFFT_BITS : 0;
+        mag = 0;
+        for (uint32_t k = 0; k < half; k++) {
+            uint32_t w = (uint32_t)read_q15x2(fft->twiddle + 2 * k * step);
+
+            for (uint32_t j = k; j < n; j += 2 * half) {
+                q15_t *pa  = data + 2 * j, *pb = pa + 2 * half;
+                uint32_t a = bfp_sra16((uint32_t)read_q15x2(pa), s);
+                uint32_t t = bfp_cmul((uint32_t)read_q15x2(pb), w, s, inverse);
+                uint32_t x = bfp_kadd16(a, t), y = bfp_ksub16(a, t);
+
+                write_q15x2(pa, (q31_t)x);
+                write_q15x2(pb, (q31_t)y);
+                mag |= bfp_mag16(x) | bfp_mag16(y);
+            }
+        }
+        shift += s;
+        bits = bfp_mag_bits(mag);
+    }
+    return shift;
+}
+
+void bfp_cfft_q15(const BfpCfftQ15 *fft, q15_t *data, int32_t *exp, bool inverse)
+{
+    uint32_t n = fft->len, bits = bfp_bits_q15(data, 2 * n);
+    int32_t e  = *exp;
+
+    if (!bits) {
+        return;
+    }
+    /* Quiet inputs are lifted to use the rounding room of the first stages */
+    if (bits < BFP_CFFT_BITS) {
+        bfp_shift_q15(data, 2 * n, BFP_CFFT_BITS - bits);
+        e -= BFP_CFFT_BITS - bits;
+        bits = BFP_CFFT_BITS;
+    }
+    bfp_bitrev(data, n);
+    if (inverse) {
+        e += bfp_stages(fft, data, bits, true) - fft->log2_len;
+    } else {
+        e += bfp_stages(fft, data, bits, false);
+    }
+    *exp = e;
+}
+
+int bfp_fir_init_q15(BfpFirQ15 *fir, uint16_t taps, const float32_t *coeffs, q15_t *coeff_buf,
+                     q15_t *state, uint32_t block)
+{
+    float32_t sum = 0.0f, scale, v;
+    int gain;
+
+    if (!fir || !coeffs || !coeff_buf || !state || !block || taps < 4 || (taps & 1)) {
+        return VPI_ERR_INVALID;
+    }
+    for (uint32_t i = 0; i < taps; i++) {
+        sum += fabsf(coeffs[i]);
+    }
+    if (!(sum > 0.0f) || sum > 1e30f) {
+        return VPI_ERR_INVALID;
+    }
+    /* sum <= 2^gain, one less when sum is a power of 2 */
+    if (frexpf(sum, &gain) == 0.5f) {
+        gain--;
+    }
+    scale = ldexpf(1.0f, 15 - gain);
+    for (uint32_t i = 0; i < taps; i++) {
+        v            = coeffs[i] * scale;
+        coeff_buf[i] = (q15_t)__SSAT((int32_t)(v + (v < 0.0f ? -0.5f : 0.5f)), 16);
+    }
+    if (riscv_fir_init_q15(&fir->fir, taps, coeff_buf, state, block) != RISCV_MATH_SUCCESS) {
+        return VPI_ERR_INVALID;
+    }
+    fir->block = block;
+    fir->gain  = gain;
+    bfp_fir_reset_q15(fir);
+    return VPI_SUCCESS;
+}
+
+void bfp_fir_reset_q15(BfpFirQ15 *fir)
+{
+    memset(fir->fir.pState, 0, (fir->fir.numTaps + fir->block - 1) * sizeof(q15_t));
+    fir->state_exp = BFP_EXP_ZERO;
+}
+
+/* Exponent of a block of bits bits once at full scale */
+__STATIC_FORCEINLINE int32_t bfp_top(int32_t exp, uint32_t bits)
+{
+    return bits ? exp - 15 + (int32_t)bits : BFP_EXP_ZERO;
+}
+
+int bfp_fir_q15(BfpFirQ15 *fir, q15_t *src, int32_t exp, q15_t *dst, int32_t *dst_exp,
+                uint32_t len)
+{
+    q15_t *hist  = fir->fir.pState;
+    uint32_t num = fir->fir.numTaps - 1;
+    int32_t e;
+
+    if (!src || !dst || src == dst || !dst_exp || len > fir->block) {
+        return VPI_ERR_INVALID;
+    }
+    e = MAX(bfp_top(exp, bfp_bits_q15(src, len)), bfp_top(fir->state_exp, bfp_bits_q15(hist, num)));
+    if (e == BFP_EXP_ZERO) {
+        /* Zeros everywhere, nothing to align */
+        e = exp;
+    } else {
+        bfp_shift_q15(src, len, exp - e);
+        bfp_shift_q15(hist, num, fir->state_exp - e);
+    }
+    riscv_fir_q15(&fir->fir, src, dst, len);
+    fir->state_exp = e;
+    *dst_exp       = e + fir->gain;
+    return VPI_SUCCESS;
+}
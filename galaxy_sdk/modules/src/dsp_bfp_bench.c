@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "platform.h"
+#include "dsp_bfp_bench.h"
+#include "dsp_bfp.h"
+#include "shell.h"
+#include "uart_printf.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+#define BB_N BFP_BENCH_BLOCK
+#define BB_T BFP_BENCH_TAPS
+
+typedef struct BfpBench {
+    float32_t in[BB_N];        /* Real block */
+    float32_t cin[2 * BB_N];   /* Complex block for the CFFT */
+    float32_t out[2 * BB_N];   /* Output of a path in signal units */
+    float32_t work[2 * BB_N];  /* f32 data of a path */
+    q15_t q15[2 * BB_N];
+    q15_t q15_out[BB_N];
+    q31_t q31[2 * BB_N];
+    q31_t q31_out[BB_N];
+    double ref_fft[2 * BB_N];
+    double ref_fir[BB_N];
+    double hist[BB_T - 1 + BB_N]; /* Reference FIR history then block */
+    double cosine[BB_N];          /* cos(2 pi k / BB_N) */
+    float32_t taps[BB_T];
+    q15_t taps_q15[BB_T];
+    q31_t taps_q31[BB_T];
+    q15_t taps_bfp[BB_T];
+    q15_t state_q15[BB_T + BB_N - 1];
+    q31_t state_q31[BB_T + BB_N - 1];
+    float32_t state_f32[BB_T + BB_N - 1];
+    q15_t state_bfp[BB_T + BB_N - 1];
+    riscv_cfft_instance_q15 cfft_q15;
+    riscv_cfft_instance_q31 cfft_q31;
+    riscv_cfft_instance_f32 cfft_f32;
+    BfpCfftQ15 cfft_bfp;
+    riscv_fir_instance_q15 fir_q15;
+    riscv_fir_instance_q31 fir_q31;
+    riscv_fir_instance_f32 fir_f32;
+    BfpFirQ15 fir_bfp;
+    uint32_t seed;
+} BfpBench;
+
+/* One path, run converts g_bb.in or cin, times the kernel and fills g_bb.out */
+typedef struct BfpPath {
+    const char *stage;
+    const char *format;
+    uint8_t bytes;  /* Per real sample of the data path */
+    bool fft;       /* Compared to ref_fft, otherwise ref_fir */
+    bool bfp;       /* Checked against BFP_BENCH_SNR_MIN */
+    uint32_t (*run)(void);
+} BfpPath;
+
+/* Totals of a path over the blocks of a signal */
+typedef struct BfpTotal {
+    double sig;
+    double err;
+    uint64_t cycles;
+} BfpTotal;
+
+static BfpBench g_bb;
+
+/* Uniform in [-1, 1) */
+static float32_t bb_noise(void)
+{
+    g_bb.seed = g_bb.seed * 1664525 + 1013904223;
+    return (float32_t)(g_bb.seed >> 8) / 8388608.0f - 1.0f;
+}
+
+static uint32_t bb_cfft_q15(void)
+{
+    uint64_t start;
+
+    riscv_float_to_q15(g_bb.cin, g_bb.q15, 2 * BB_N);
+    start = __get_rv_cycle();
+    riscv_cfft_q15(&g_bb.cfft_q15, g_bb.q15, 0, 1);
+    start = __get_rv_cycle() - start;
+    /* Scaled by 1 / N */
+    riscv_q15_to_float(g_bb.q15, g_bb.out, 2 * BB_N);
+    riscv_scale_f32(g_bb.out, (float32_t)BB_N, g_bb.out, 2 * BB_N);
+    return (uint32_t)start;
+}
+
+static uint32_t bb_cfft_q31(void)
+{
+    uint64_t start;
+
+    riscv_float_to_q31(g_bb.cin, g_bb.q31, 2 * BB_N);
+    start = __get_rv_cycle();
+    riscv_cfft_q31(&g_bb.cfft_q31, g_bb.q31, 0, 1);
+    start = __get_rv_cycle() - start;
+    riscv_q31_to_float(g_bb.q31, g_bb.out, 2 * BB_N);
+    riscv_scale_f32(g_bb.out, (float32_t)BB_N, g_bb.out, 2 * BB_N);
+    return (uint32_t)start;
+}
+
+static uint32_t bb_cfft_bfp(void)
+{
+    uint64_t start;
+    int32_t exp = bfp_from_f32(g_bb.cin, g_bb.q15, 2 * BB_N);
+
+    start = __get_rv_cycle();
+    bfp_cfft_q15(&g_bb.cfft_bfp, g_bb.q15, &exp, false);
+    start = __get_rv_cycle() - start;
+    bfp_to_f32(g_bb.q15, exp, g_bb.out, 2 * BB_N);
+    return (uint32_t)start;
+}
+
+static uint32_t bb_cfft_f32(void)
+{
+    uint64_t start;
+
+    memcpy(g_bb.out, g_bb.cin, sizeof(g_bb.cin));
+    start = __get_rv_cycle();
+    riscv_cfft_f32(&g_bb.cfft_f32, g_bb.out, 0, 1);
+    return (uint32_t)(__get_rv_cycle() - start);
+}
+
+static uint32_t bb_fir_q15(void)
+{
+    uint64_t start;
+
+    riscv_float_to_q15(g_bb.in, g_bb.q15, BB_N);
+    start = __get_rv_cycle();
+    riscv_fir_q15(&g_bb.fir_q15, g_bb.q15, g_bb.q15_out, BB_N);
+    start = __get_rv_cycle() - start;
+    riscv_q15_to_float(g_bb.q15_out, g_bb.out, BB_N);
+    return (uint32_t)start;
+}
+
+static uint32_t bb_fir_q31(void)
+{
+    uint64_t start;
+
+    riscv_float_to_q31(g_bb.in, g_bb.q31, BB_N);
+    start = __get_rv_cycle();
+    riscv_fir_q31(&g_bb.fir_q31, g_bb.q31, g_bb.q31_out, BB_N);
+    start = __get_rv_cycle() - start;
+    riscv_q31_to_float(g_bb.q31_out, g_bb.out, BB_N);
+    return (uint32_t)start;
+}
+
+static uint32_t bb_fir_bfp(void)
+{
+    uint64_t start;
+    int32_t exp = bfp_from_f32(g_bb.in, g_bb.q15, BB_N), out_exp;
+
+    start = __get_rv_cycle();
+    bfp_fir_q15(&g_bb.fir_bfp, g_bb.q15, exp, g_bb.q15_out, &out_exp, BB_N);
+    start = __get_rv_cycle() - start;
+    bfp_to_f32(g_bb.q15_out, out_exp, g_bb.out, BB_N);
+    return (uint32_t)start;
+}
+
+static uint32_t bb_fir_f32(void)
+{
+    uint64_t start = __get_rv_cycle();
+
+    riscv_fir_f32(&g_bb.fir_f32, g_bb.in, g_bb.out, BB_N);
+    return (uint32_t)(__get_rv_cycle() - start);
+}
+
+static const BfpPath g_bb_paths[] = {
+    {"cfft", "q15", 2, true, false, bb_cfft_q15},  {"cfft", "q31", 4, true, false, bb_cfft_q31},
+    {"cfft", "bfp15", 2, true, true, bb_cfft_bfp}, {"cfft", "f32", 4, true, false, bb_cfft_f32},
+    {"fir", "q15", 2, false, false, bb_fir_q15},   {"fir", "q31", 4, false, false, bb_fir_q31},
+    {"fir", "bfp15", 2, false, true, bb_fir_bfp},  {"fir", "f32", 4, false, false, bb_fir_f32},
+};
+
+/* Hamming windowed sinc at fs / 8, DC gain 0.9 to leave room for fixed point */
+static void bb_design(void)
+{
+    double sum = 0.0, x;
+    uint32_t i, k;
+
+    for (i = 0; i < BB_T; i++) {
+        x            = i - (BB_T - 1) / 2.0;
+        g_bb.hist[i] = sin(PI_F64 / 4 * x) / (PI_F64 * x) *
+                       (0.54 - 0.46 * cos(2 * PI_F64 * i / (BB_T - 1)));
+        sum += g_bb.hist[i];
+    }
+    for (i = 0; i < BB_T; i++) {
+        g_bb.taps[i] = (float32_t)(g_bb.hist[i] * 0.9 / sum);
+    }
+    for (k = 0; k < BB_N; k++) {
+        g_bb.cosine[k] = cos(2 * PI_F64 * k / BB_N);
+    }
+}
+
+static int bb_setup(void)
+{
+    int ret;
+
+    memset(&g_bb, 0, sizeof(g_bb));
+    bb_design();
+    memset(g_bb.hist, 0, sizeof(g_bb.hist));
+    riscv_float_to_q15(g_bb.taps, g_bb.taps_q15, BB_T);
+    riscv_float_to_q31(g_bb.taps, g_bb.taps_q31, BB_T);
+    if (riscv_cfft_init_q15(&g_bb.cfft_q15, BB_N) != RISCV_MATH_SUCCESS ||
+        riscv_cfft_init_q31(&g_bb.cfft_q31, BB_N) != RISCV_MATH_SUCCESS ||
+        riscv_cfft_init_f32(&g_bb.cfft_f32, BB_N) != RISCV_MATH_SUCCESS ||
+        riscv_fir_init_q15(&g_bb.fir_q15, BB_T, g_bb.taps_q15, g_bb.state_q15, BB_N) !=
+            RISCV_MATH_SUCCESS) {
+        return VPI_ERR_INVALID;
+    }
+    riscv_fir_init_q31(&g_bb.fir_q31, BB_T, g_bb.taps_q31, g_bb.state_q31, BB_N);
+    riscv_fir_init_f32(&g_bb.fir_f32, BB_T, g_bb.taps, g_bb.state_f32, BB_N);
+    ret = bfp_cfft_init_q15(&g_bb.cfft_bfp, BB_N);
+    if (ret == VPI_SUCCESS) {
+        ret = bfp_fir_init_q15(&g_bb.fir_bfp, BB_T, g_bb.taps, g_bb.taps_bfp, g_bb.state_bfp,
+                               BB_N);
+    }
+    return ret;
+}
+
+/* Restart the filters and the reference between signals */
+static void bb_reset(void)
+{
+    memset(g_bb.state_q15, 0, sizeof(g_bb.state_q15));
+    memset(g_bb.state_q31, 0, sizeof(g_bb.state_q31));
+    memset(g_bb.state_f32, 0, sizeof(g_bb.state_f32));
+    memset(g_bb.hist, 0, sizeof(g_bb.hist));
+    bfp_fir_reset_q15(&g_bb.fir_bfp);
+}
+
+/* Direct DFT and convolution of the block in double precision */
+static void bb_reference(void)
+{
+    double *x = g_bb.hist + BB_T - 1, re, im;
+    uint32_t i, k, n, t;
+
+    for (i = 0; i < BB_N; i++) {
+        x[i]                = g_bb.in[i];
+        g_bb.cin[2 * i]     = g_bb.in[i];
+        g_bb.cin[2 * i + 1] = 0.0f;
+    }
+    for (k = 0; k < BB_N; k++) {
+        re = im = 0.0;
+        for (n = 0; n < BB_N; n++) {
+            uint32_t p = k * n % BB_N;
+
+            re += x[n] * g_bb.cosine[p];
+            im -= x[n] * g_bb.cosine[(p + 3 * BB_N / 4) % BB_N];
+        }
+        g_bb.ref_fft[2 * k]     = re;
+        g_bb.ref_fft[2 * k + 1] = im;
+    }
+    /* Taps are time reversed as for riscv_fir */
+    for (i = 0; i < BB_N; i++) {
+        re = 0.0;
+        for (t = 0; t < BB_T; t++) {
+            re += g_bb.taps[t] * g_bb.hist[i + t];
+        }
+        g_bb.ref_fir[i] = re;
+    }
+    memmove(g_bb.hist, g_bb.hist + BB_N, (BB_T - 1) * sizeof(double));
+}
+
+static void bb_block(BfpTotal *total)
+{
+    uint32_t p, i;
+
+    bb_reference();
+    for (p = 0; p < ARRAY_SIZE(g_bb_paths); p++) {
+        const BfpPath *path = &g_bb_paths[p];
+        const double *ref   = path->fft ? g_bb.ref_fft : g_bb.ref_fir;
+        uint32_t num        = path->fft ? 2 * BB_N : BB_N;
+
+        total[p].cycles += path->run();
+        for (i = 0; i < num; i++) {
+            total[p].sig += ref[i] * ref[i];
+            total[p].err += (g_bb.out[i] - ref[i]) * (g_bb.out[i] - ref[i]);
+        }
+    }
+}
+
+/* Print the table of a signal, returns false when a bfp path is below the min */
+static bool bb_report(const char *name, const BfpTotal *total, uint32_t blocks)
+{
+    bool pass = true;
+    uint32_t p;
+
+    uart_printf("%s, %u blocks of %u\r\n", name, (unsigned int)blocks, BB_N);
+    uart_printf("stage format bytes   snr dB     cycles\r\n");
+    for (p = 0; p < ARRAY_SIZE(g_bb_paths); p++) {
+        double snr = total[p].err > 0.0 ? 10.0 * log10(total[p].sig / total[p].err) : 200.0;
+        /* Tenths of dB, uart_printf has no %f. Worse than 0 dB prints 0 */
+        uint32_t t = (uint32_t)(MIN(MAX(snr, 0.0), 200.0) * 10.0 + 0.5);
+
+        uart_printf("%-5s %-6s %5u %6u.%u %10u\r\n", g_bb_paths[p].stage, g_bb_paths[p].format,
+                    g_bb_paths[p].bytes, (unsigned int)(t / 10), (unsigned int)(t % 10),
+                    (unsigned int)(total[p].cycles / MAX(blocks, 1)));
+        if (g_bb_paths[p].bfp && snr < BFP_BENCH_SNR_MIN) {
+            pass = false;
+        }
+    }
+    return pass;
+}
+
+static int bb_run_file(const char *path)
+{
+    BfpTotal total[ARRAY_SIZE(g_bb_paths)] = {0};
+    FILE *fp = fopen(path, "rb");
+    uint32_t blocks = 0;
+    size_t got;
+
+    if (!fp) {
+        uart_printf("cannot open %s\r\n", path);
+        return VPI_ERR_IO;
+    }
+    while ((got = fread(g_bb.in, sizeof(float32_t), BB_N, fp)) > 0) {
+        /* Zeros after the last sample */
+        memset(g_bb.in + got, 0, (BB_N - got) * sizeof(float32_t));
+        riscv_clip_f32(g_bb.in, g_bb.in, -1.0f, 1.0f, BB_N);
+        bb_block(total);
+        blocks++;
+    }
+    fclose(fp);
+    if (!blocks) {
+        uart_printf("no samples in %s\r\n", path);
+        return VPI_ERR_IO;
+    }
+    bb_report(path, total, blocks);
+    return VPI_SUCCESS;
+}
+
+static int bb_run_synthetic(void)
+{
+    uint32_t l, b, i;
+
+    static const char *const names[] = {"0 dBFS", "-20 dBFS", "-40 dBFS", "-60 dBFS"};
+    int ret         = VPI_SUCCESS;
+    float32_t level = 1.0f;
+
+    for (l = 0; l < ARRAY_SIZE(names); l++, level *= 0.1f) {
+        BfpTotal total[ARRAY_SIZE(g_bb_paths)] = {0};
+
+        bb_reset();
+        g_bb.seed = 1;
+        for (b = 0; b < BFP_BENCH_RUNS; b++) {
+            for (i = 0; i < BB_N; i++) {
+                double n = b * BB_N + i;
+
+                g_bb.in[i] = level * (float32_t)(0.5 * sin(0.061 * n) + 0.3 * sin(1.3 * n) +
+                                                 0.15 * bb_noise());
+            }
+            bb_block(total);
+        }
+        if (!bb_report(names[l], total, BFP_BENCH_RUNS)) {
+            ret = VPI_ERR_BAD_DATA;
+        }
+    }
+    return ret;
+}
+
+int dsp_bfp_bench_run(const char *path)
+{
+    int ret = bb_setup();
+
+    if (ret != VPI_SUCCESS) {
+        return ret;
+    }
+    return path ? bb_run_file(path) : bb_run_synthetic();
+}
+
+static int bb_cmd(int argc, char *argv[])
+{
+    return dsp_bfp_bench_run(argc > 1 ? argv[1] : NULL);
+}
+
+static const ShellCmd g_bb_cmd = {"bfp", "bfp [file]: SNR and cycles of q15, q31, bfp and f32",
+                                  bb_cmd};
+
+int dsp_bfp_bench_init(void)
+{
+    return shell_add_cmd(&g_bb_cmd);
+}
+
+#if CONFIG_SHELL && CONFIG_DSP_BFP_BENCH
+SHELL_BENCH_BOOT(dsp_bfp_bench_boot, 94, dsp_bfp_bench_run(NULL), dsp_bfp_bench_init);
+#endif
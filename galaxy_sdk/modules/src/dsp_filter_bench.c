@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "dsp_filter_bench.h"
+#include "dsp_fixed_filter.h"
+#include "shell.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+#define FILTER_BENCH_RUNS 8
+
+DSP_FIR_Q15_DEFINE(bench_fir_q15, FILTER_BENCH_TAPS, FILTER_BENCH_BLOCK);
+DSP_FIR_Q7_DEFINE(bench_fir_q7, FILTER_BENCH_TAPS, FILTER_BENCH_BLOCK);
+DSP_BIQUAD_Q15_DEFINE(bench_biquad_q15, FILTER_BENCH_STAGES, FILTER_BENCH_BLOCK, 1);
+
+/* 8th order Butterworth low pass at fs / 20, q14 with postShift 1 */
+static const q15_t g_biquad_coeffs[6 * FILTER_BENCH_STAGES] = {
+    378, 0, 756, 378, 29392, -14521,
+    342, 0, 684, 342, 26598, -11583,
+    319, 0, 638, 319, 24794, -9686,
+    308, 0, 615, 308, 23916, -8763,
+};
+
+typedef struct FilterBench {
+    q15_t fir_coeffs[FILTER_BENCH_TAPS];
+    q7_t fir7_coeffs[FILTER_BENCH_TAPS];
+    q15_t fir_state[FILTER_BENCH_TAPS + FILTER_BENCH_BLOCK - 1];
+    q7_t fir7_state[FILTER_BENCH_TAPS + FILTER_BENCH_BLOCK - 1];
+    q15_t biquad_state[4 * FILTER_BENCH_STAGES];
+    riscv_fir_instance_q15 fir;
+    riscv_fir_instance_q7 fir7;
+    riscv_biquad_casd_df1_inst_q15 biquad;
+    struct bench_fir_q15 fir_fix;
+    struct bench_fir_q7 fir7_fix;
+    struct bench_biquad_q15 biquad_fix;
+    q15_t in[FILTER_BENCH_BLOCK];
+    q15_t out[FILTER_BENCH_BLOCK];
+    q15_t ref[FILTER_BENCH_BLOCK];
+    q7_t in7[FILTER_BENCH_BLOCK];
+    q7_t out7[FILTER_BENCH_BLOCK];
+    q7_t ref7[FILTER_BENCH_BLOCK];
+    uint32_t seed;
+} FilterBench;
+
+static FilterBench g_bench;
+
+static uint32_t bench_rand(void)
+{
+    g_bench.seed = g_bench.seed * 1664525 + 1013904223;
+    return g_bench.seed >> 8;
+}
+
+/* Full scale or quiet blocks, so that both saturation and small values occur */
+static void bench_fill(uint32_t block)
+{
+    uint32_t shift = block & 1 ? 4 : 0;
+    uint32_t i;
+
+    for (i = 0; i < FILTER_BENCH_BLOCK; i++) {
+        uint32_t r = bench_rand();
+
+        g_bench.in[i]  = (q15_t)((int16_t)r >> shift);
+        g_bench.in7[i] = (q7_t)((int8_t)(r >> 16) >> shift);
+    }
+}
+
+static void bench_setup(void)
+{
+    uint32_t i;
+
+    g_bench.seed = 1;
+    for (i = 0; i < FILTER_BENCH_TAPS; i++) {
+        uint32_t r = bench_rand();
+
+        g_bench.fir_coeffs[i]  = (q15_t)((int16_t)r >> 3);
+        g_bench.fir7_coeffs[i] = (q7_t)((int8_t)(r >> 16) >> 2);
+    }
+    riscv_fir_init_q15(&g_bench.fir, FILTER_BENCH_TAPS, g_bench.fir_coeffs, g_bench.fir_state,
+                       FILTER_BENCH_BLOCK);
+    riscv_fir_init_q7(&g_bench.fir7, FILTER_BENCH_TAPS, g_bench.fir7_coeffs, g_bench.fir7_state,
+                      FILTER_BENCH_BLOCK);
+    riscv_biquad_cascade_df1_init_q15(&g_bench.biquad, FILTER_BENCH_STAGES, g_biquad_coeffs,
+                                      g_bench.biquad_state, 1);
+    bench_fir_q15_init(&g_bench.fir_fix, g_bench.fir_coeffs);
+    bench_fir_q7_init(&g_bench.fir7_fix, g_bench.fir7_coeffs);
+    bench_biquad_q15_init(&g_bench.biquad_fix, g_biquad_coeffs);
+}
+
+int dsp_filter_bench_check(void)
+{
+    uint32_t block;
+
+    bench_setup();
+    for (block = 0; block < FILTER_BENCH_RUNS; block++) {
+        bench_fill(block);
+        riscv_fir_q15(&g_bench.fir, g_bench.in, g_bench.ref, FILTER_BENCH_BLOCK);
+        bench_fir_q15_run(&g_bench.fir_fix, g_bench.in, g_bench.out);
+        if (memcmp(g_bench.ref, g_bench.out, sizeof(g_bench.out))) {
+            return VPI_ERR_BAD_DATA;
+        }
+        riscv_fir_q7(&g_bench.fir7, g_bench.in7, g_bench.ref7, FILTER_BENCH_BLOCK);
+        bench_fir_q7_run(&g_bench.fir7_fix, g_bench.in7, g_bench.out7);
+        if (memcmp(g_bench.ref7, g_bench.out7, sizeof(g_bench.out7))) {
+            return VPI_ERR_BAD_DATA;
+        }
+        riscv_biquad_cascade_df1_q15(&g_bench.biquad, g_bench.in, g_bench.ref, FILTER_BENCH_BLOCK);
+        bench_biquad_q15_run(&g_bench.biquad_fix, g_bench.in, g_bench.out);
+        if (memcmp(g_bench.ref, g_bench.out, sizeof(g_bench.out))) {
+            return VPI_ERR_BAD_DATA;
+        }
+    }
+    return VPI_SUCCESS;
+}
+
+static void bench_fir_q15(void *arg)
+{
+    riscv_fir_q15(&g_bench.fir, g_bench.in, g_bench.out, FILTER_BENCH_BLOCK);
+}
+
+static void bench_fir_q15_fix(void *arg)
+{
+    bench_fir_q15_run(&g_bench.fir_fix, g_bench.in, g_bench.out);
+}
+
+static void bench_fir_q7(void *arg)
+{
+    riscv_fir_q7(&g_bench.fir7, g_bench.in7, g_bench.out7, FILTER_BENCH_BLOCK);
+}
+
+static void bench_fir_q7_fix(void *arg)
+{
+    bench_fir_q7_run(&g_bench.fir7_fix, g_bench.in7, g_bench.out7);
+}
+
+static void bench_biquad_q15(void *arg)
+{
+    riscv_biquad_cascade_df1_q15(&g_bench.biquad, g_bench.in, g_bench.out, FILTER_BENCH_BLOCK);
+}
+
+static void bench_biquad_q15_fix(void *arg)
+{
+    bench_biquad_q15_run(&g_bench.biquad_fix, g_bench.in, g_bench.out);
+}
+
+static const ShellBench g_benches[] = {
+    {"fir_q15", bench_fir_q15, NULL},       {"fir_q15_fix", bench_fir_q15_fix, NULL},
+    {"fir_q7", bench_fir_q7, NULL},         {"fir_q7_fix", bench_fir_q7_fix, NULL},
+    {"biquad_q15", bench_biquad_q15, NULL}, {"biquad_q15_fix", bench_biquad_q15_fix, NULL},
+};
+
+int dsp_filter_bench_init(void)
+{
+    int ret = VPI_SUCCESS;
+    uint32_t i;
+
+    bench_setup();
+    bench_fill(0);
+    for (i = 0; i < ARRAY_SIZE(g_benches) && ret == VPI_SUCCESS; i++) {
+        ret = shell_add_bench(&g_benches[i]);
+    }
+    return ret;
+}
+
+#if CONFIG_SHELL && CONFIG_DSP_FILTER_BENCH
+SHELL_BENCH_BOOT(dsp_filter_bench_boot, 91, dsp_filter_bench_check(), dsp_filter_bench_init);
+#endif
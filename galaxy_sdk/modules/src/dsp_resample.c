@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "dsp_resample.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+#include "osal_heap_api.h"
+
+/* Kaiser window beta, about 90 dB sidelobes */
+#define RESAMPLE_BETA    8.6
+#define RESAMPLE_PPM_MAX 100000.0f
+
+static uint32_t rs_gcd(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Rows of the table, 0 for an invalid configuration */
+static uint32_t rs_rows(const ResampleCfg *cfg)
+{
+    uint32_t rows;
+
+    if (!cfg->in_rate || !cfg->out_rate || cfg->taps < 4 || cfg->taps > RESAMPLE_TAPS_MAX ||
+        (cfg->taps & 1) || cfg->phases == 1 || cfg->phases > RESAMPLE_PHASES_MAX) {
+        return 0;
+    }
+    if (!(cfg->cutoff > 0.0f && cfg->cutoff < 1.0f) || cfg->format > RESAMPLE_F32) {
+        return 0;
+    }
+    rows = cfg->phases ? cfg->phases : cfg->out_rate / rs_gcd(cfg->in_rate, cfg->out_rate);
+    return rows <= RESAMPLE_PHASES_MAX ? rows : 0;
+}
+
+static uint32_t rs_sample_size(const ResampleCfg *cfg)
+{
+    return cfg->format == RESAMPLE_Q15 ? sizeof(q15_t) : sizeof(float32_t);
+}
+
+/* sin(pi x) / (pi x) in double, the table is built once at init */
+static double rs_sinc(double x)
+{
+    double r, s, term, y;
+
+    if (x < 0) {
+        x = -x;
+    }
+    if (x < 1e-9) {
+        return 1.0;
+    }
+    /* sin(pi x) = +-sin(pi r) with r in [-0.5, 0.5] */
+    r = x - 2.0 * (double)(int32_t)(x / 2.0);
+    s = 1.0;
+    if (r > 1.0) {
+        r -= 1.0;
+        s = -1.0;
+    }
+    if (r > 0.5) {
+        r = 1.0 - r;
+    }
+    y    = PI * r;
+    term = y;
+    r    = 0.0;
+    for (uint32_t k = 1; k < 12; k++) {
+        r += term;
+        term *= -y * y / ((2 * k) * (2 * k + 1));
+    }
+    return s * r / (PI * x);
+}
+
+static double rs_bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+
+    for (uint32_t k = 1; term > 1e-12 * sum; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+static float32_t rs_kaiser(double x)
+{
+    float32_t s;
+
+    riscv_sqrt_f32((float32_t)(1.0 - x * x), &s);
+    return (float32_t)(rs_bessel_i0(RESAMPLE_BETA * s) / rs_bessel_i0(RESAMPLE_BETA));
+}
+
+/*
+ * Row p is the filter for an output at time p / rows after the sample
+ * before the middle of the window, each row has unity DC gain
+ */
+static void rs_design(Resample *rs)
+{
+    uint32_t taps = rs->cfg.taps;
+    double fc     = rs->cfg.cutoff;
+    float32_t row[RESAMPLE_TAPS_MAX];
+
+    if (rs->cfg.out_rate < rs->cfg.in_rate) {
+        fc = fc * rs->cfg.out_rate / rs->cfg.in_rate;
+    }
+    for (uint32_t p = 0; p <= rs->rows; p++) {
+        double sum = 0.0;
+
+        for (uint32_t k = 0; k < taps; k++) {
+            double u = (double)k - (taps / 2 - 1) - (double)p / rs->rows;
+
+            row[k] = (float32_t)(fc * rs_sinc(fc * u)) * rs_kaiser(u / (taps / 2));
+            sum += row[k];
+        }
+        for (uint32_t k = 0; k < taps; k++) {
+            float32_t c = (float32_t)(row[k] / sum);
+
+            if (rs->cfg.format == RESAMPLE_Q15) {
+                ((q15_t *)rs->coef)[p * taps + k] = (q15_t)__SSAT((int32_t)(c * 32768.0f +
+                                                                  (c < 0 ? -0.5f : 0.5f)), 16);
+            } else {
+                ((float32_t *)rs->coef)[p * taps + k] = c;
+            }
+        }
+    }
+}
+
+uint32_t resample_mem_size(const ResampleCfg *cfg)
+{
+    uint32_t rows = cfg ? rs_rows(cfg) : 0;
+
+    if (!rows) {
+        return 0;
+    }
+    return ((rows + 1) * cfg->taps + cfg->taps + RESAMPLE_CHUNK) * rs_sample_size(cfg);
+}
+
+int resample_init(Resample *rs, const ResampleCfg *cfg)
+{
+    uint32_t size = resample_mem_size(cfg);
+    uint32_t g;
+    uint8_t *mem;
+
+    if (!rs || !size) {
+        return VPI_ERR_INVALID;
+    }
+    mem = osal_malloc(size);
+    if (!mem) {
+        return VPI_ERR_NOMEM;
+    }
+    memset(rs, 0, sizeof(*rs));
+    rs->cfg   = *cfg;
+    rs->rows  = rs_rows(cfg);
+    rs->exact = !cfg->phases;
+    rs->coef  = mem;
+    rs->buf   = mem + (rs->rows + 1) * cfg->taps * rs_sample_size(cfg);
+    g         = rs_gcd(cfg->in_rate, cfg->out_rate);
+    rs->den   = cfg->out_rate / g;
+    /* in / out as 32.32 plus a remainder in 1 / den, exact over any run */
+    rs->nominal  = ((uint64_t)(cfg->in_rate / g) << 32) / rs->den;
+    rs->step     = rs->nominal;
+    rs->step_rem = (uint32_t)((((uint64_t)(cfg->in_rate / g) << 32)) % rs->den);
+    rs_design(rs);
+    resample_reset(rs);
+    return VPI_SUCCESS;
+}
+
+void resample_deinit(Resample *rs)
+{
+    if (rs && rs->coef) {
+        osal_free(rs->coef);
+        rs->coef = NULL;
+        rs->buf  = NULL;
+    }
+}
+
+void resample_reset(Resample *rs)
+{
+    /* Output 0 is at input 0, the samples before are zeros */
+    rs->avail = rs->cfg.taps / 2 - 1;
+    memset(rs->buf, 0, rs->avail * rs_sample_size(&rs->cfg));
+    rs->pos  = 0;
+    rs->frac = 0;
+    rs->rem  = 0;
+}
+
+int resample_adjust(Resample *rs, float32_t ppm)
+{
+    if (!rs || !rs->coef || rs->exact || !(ppm >= -RESAMPLE_PPM_MAX && ppm <= RESAMPLE_PPM_MAX)) {
+        return VPI_ERR_INVALID;
+    }
+    rs->step     = (uint64_t)((double)rs->nominal * (1.0 + ppm * 1e-6) + 0.5);
+    rs->step_rem = 0;
+    return VPI_SUCCESS;
+}
+
+uint32_t resample_out_max(const Resample *rs, uint32_t len)
+{
+    return rs && rs->step ? (uint32_t)(((uint64_t)len << 32) / rs->step) + 2 : 0;
+}
+
+__STATIC_FORCEINLINE void rs_advance(Resample *rs)
+{
+    uint64_t t = (uint64_t)rs->frac + (uint32_t)rs->step;
+
+    rs->rem += rs->step_rem;
+    if (rs->rem >= rs->den) {
+        rs->rem -= rs->den;
+        t++;
+    }
+    rs->pos += (uint32_t)(rs->step >> 32) + (uint32_t)(t >> 32);
+    rs->frac = (uint32_t)t;
+}
+
+/* Row of the next output, mu is the weight of the row after it */
+__STATIC_FORCEINLINE uint32_t rs_row(const Resample *rs, uint32_t *mu)
+{
+    uint64_t x = (uint64_t)rs->frac * rs->rows;
+
+    if (rs->exact) {
+        /* frac is k / den rounded down, den being rows */
+        *mu = 0;
+        return (uint32_t)((x + (1u << 31)) >> 32);
+    }
+    *mu = (uint32_t)x;
+    return (uint32_t)(x >> 32);
+}
+
+/* Drop consumed history, then take as many inputs as fit, returns them */
+static uint32_t rs_fill(Resample *rs, const void *in, uint32_t len)
+{
+    uint32_t size = rs_sample_size(&rs->cfg);
+    uint32_t drop = MIN(rs->pos, rs->avail);
+    uint32_t n;
+
+    if (drop) {
+        memmove(rs->buf, (uint8_t *)rs->buf + drop * size, (rs->avail - drop) * size);
+        rs->avail -= drop;
+        rs->pos -= drop;
+    }
+    if (rs->pos) {
+        /* Decimation may step over whole inputs */
+        n = MIN(len, rs->pos);
+        rs->pos -= n;
+        return n;
+    }
+    n = MIN(len, rs->cfg.taps + RESAMPLE_CHUNK - rs->avail);
+    memcpy((uint8_t *)rs->buf + rs->avail * size, in, n * size);
+    rs->avail += n;
+    return n;
+}
+
+static bool rs_check(const Resample *rs, const void *in, uint32_t len, const void *out,
+                     const uint32_t *out_len, uint8_t format)
+{
+    return rs && rs->coef && rs->cfg.format == format && (in || !len) && out && out_len &&
+           *out_len >= resample_out_max(rs, len);
+}
+
+int resample_process_q15(Resample *rs, const q15_t *in, uint32_t len, q15_t *out,
+                         uint32_t *out_len)
+{
+    uint32_t taps = rs ? rs->cfg.taps : 0;
+    uint32_t num  = 0;
+
+    if (!rs_check(rs, in, len, out, out_len, RESAMPLE_Q15)) {
+        return VPI_ERR_INVALID;
+    }
+    while (len) {
+        uint32_t n = rs_fill(rs, in, len);
+
+        in += n;
+        len -= n;
+        while (rs->pos + taps <= rs->avail) {
+            const q15_t *x = (const q15_t *)rs->buf + rs->pos;
+            uint32_t mu;
+            const q15_t *c = (const q15_t *)rs->coef + rs_row(rs, &mu) * taps;
+            q63_t y, y1;
+
+            riscv_dot_prod_q15(x, c, taps, &y);
+            if (mu) {
+                riscv_dot_prod_q15(x, c + taps, taps, &y1);
+                y += ((y1 - y) * (int64_t)(mu >> 16)) >> 16;
+            }
+            out[num++] = (q15_t)__SSAT((int32_t)((y + (1 << 14)) >> 15), 16);
+            rs_advance(rs);
+        }
+    }
+    *out_len = num;
+    return VPI_SUCCESS;
+}
+
+int resample_process_f32(Resample *rs, const float32_t *in, uint32_t len, float32_t *out,
+                         uint32_t *out_len)
+{
+    uint32_t taps = rs ? rs->cfg.taps : 0;
+    uint32_t num  = 0;
+
+    if (!rs_check(rs, in, len, out, out_len, RESAMPLE_F32)) {
+        return VPI_ERR_INVALID;
+    }
+    while (len) {
+        uint32_t n = rs_fill(rs, in, len);
+
+        in += n;
+        len -= n;
+        while (rs->pos + taps <= rs->avail) {
+            const float32_t *x = (const float32_t *)rs->buf + rs->pos;
+            uint32_t mu;
+            const float32_t *c = (const float32_t *)rs->coef + rs_row(rs, &mu) * taps;
+            float32_t y, y1;
+
+            riscv_dot_prod_f32(x, c, taps, &y);
+            if (mu) {
+                riscv_dot_prod_f32(x, c + taps, taps, &y1);
+                y += (y1 - y) * ((float32_t)mu * 2.3283064e-10f);
+            }
+            out[num++] = y;
+            rs_advance(rs);
+        }
+    }
+    *out_len = num;
+    return VPI_SUCCESS;
+}
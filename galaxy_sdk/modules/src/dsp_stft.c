@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "dsp_stft.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+#include "osal_heap_api.h"
+
+static bool stft_cfg_valid(const StftCfg *cfg)
+{
+    uint32_t n = cfg->fft_len;
+
+    if (n < STFT_LEN_MIN || n > STFT_LEN_MAX || (n & (n - 1)) || !cfg->hop) {
+        return false;
+    }
+    if (cfg->format > STFT_Q15 || cfg->window > STFT_WIN_HAMMING || cfg->output > STFT_OUT_POWER) {
+        return false;
+    }
+    return !cfg->in_place || cfg->hop >= n;
+}
+
+/* Sizes in samples, see the table of StftCfg */
+static uint32_t stft_window_len(const StftCfg *cfg)
+{
+    return cfg->window == STFT_WIN_RECT ? 0 : cfg->fft_len;
+}
+
+static uint32_t stft_ring_len(const StftCfg *cfg)
+{
+    /* The q15 ring in place is also the frame, with room for the split */
+    return cfg->in_place && cfg->format == STFT_Q15 ? cfg->fft_len + 2 : cfg->fft_len;
+}
+
+static uint32_t stft_work_len(const StftCfg *cfg)
+{
+    if (cfg->format == STFT_F32) {
+        return cfg->fft_len;
+    }
+    return cfg->in_place ? 0 : cfg->fft_len + 2;
+}
+
+static uint32_t stft_aux_len(const StftCfg *cfg)
+{
+    if (cfg->format == STFT_F32) {
+        return cfg->in_place ? 0 : cfg->fft_len;
+    }
+    return cfg->fft_len / 2 + 2;
+}
+
+uint32_t stft_mem_size(const StftCfg *cfg)
+{
+    uint32_t size;
+
+    if (!cfg || !stft_cfg_valid(cfg)) {
+        return 0;
+    }
+    size = stft_window_len(cfg) + stft_ring_len(cfg) + stft_work_len(cfg) + stft_aux_len(cfg);
+    return size * (cfg->format == STFT_F32 ? sizeof(float32_t) : sizeof(q15_t));
+}
+
+static int stft_window_init(Stft *stft)
+{
+    uint32_t n = stft->cfg.fft_len;
+    float32_t *tmp;
+
+    if (!stft->window) {
+        return VPI_SUCCESS;
+    }
+    /* The q15 table is converted from a float one, only needed during init */
+    tmp = stft->cfg.format == STFT_F32 ? stft->window : osal_malloc(n * sizeof(float32_t));
+    if (!tmp) {
+        return VPI_ERR_NOMEM;
+    }
+    if (stft->cfg.window == STFT_WIN_HANN) {
+        riscv_hanning_f32(tmp, n);
+    } else {
+        riscv_hamming_f32(tmp, n);
+    }
+    if (stft->cfg.format == STFT_Q15) {
+        riscv_float_to_q15(tmp, stft->window, n);
+        osal_free(tmp);
+    }
+    return VPI_SUCCESS;
+}
+
+/* W^k = cos(2 pi k / N) - j sin(2 pi k / N) for k = 0 to N / 4, as cos, sin */
+static void stft_twiddle_init(q15_t *tw, uint32_t n)
+{
+    float32_t phase;
+    uint32_t k;
+
+    for (k = 0; k <= n / 4; k++) {
+        phase = 2.0f * PI * k / n;
+        riscv_float_to_q15((float32_t[]){riscv_cos_f32(phase), riscv_sin_f32(phase)}, &tw[2 * k], 2);
+    }
+}
+
+int stft_init(Stft *stft, const StftCfg *cfg)
+{
+    uint32_t size = cfg ? stft_mem_size(cfg) : 0;
+    uint32_t elem;
+    uint8_t *mem;
+    int ret;
+
+    if (!stft || !size) {
+        return VPI_ERR_INVALID;
+    }
+    memset(stft, 0, sizeof(*stft));
+    stft->cfg = *cfg;
+    if (cfg->format == STFT_F32) {
+        ret = riscv_rfft_fast_init_f32(&stft->fft.rfft, cfg->fft_len);
+    } else {
+        ret = riscv_cfft_init_q15(&stft->fft.cfft, cfg->fft_len / 2);
+    }
+    if (ret != RISCV_MATH_SUCCESS) {
+        return VPI_ERR_INVALID;
+    }
+
+    /* One block, every part keeps 4 bytes alignment as all lengths are even */
+    mem = osal_malloc(size);
+    if (!mem) {
+        return VPI_ERR_NOMEM;
+    }
+    elem         = cfg->format == STFT_F32 ? sizeof(float32_t) : sizeof(q15_t);
+    stft->ring   = mem;
+    mem         += stft_ring_len(cfg) * elem;
+    stft->work   = stft_work_len(cfg) ? mem : stft->ring;
+    mem         += stft_work_len(cfg) * elem;
+    stft->aux    = stft_aux_len(cfg) ? mem : stft->ring;
+    mem         += stft_aux_len(cfg) * elem;
+    stft->window = stft_window_len(cfg) ? mem : NULL;
+
+    ret = stft_window_init(stft);
+    if (ret != VPI_SUCCESS) {
+        osal_free(stft->ring);
+        stft->ring = NULL;
+        return ret;
+    }
+    if (cfg->format == STFT_Q15) {
+        stft_twiddle_init(stft->aux, cfg->fft_len);
+    }
+    stft_reset(stft);
+    return VPI_SUCCESS;
+}
+
+void stft_deinit(Stft *stft)
+{
+    if (stft && stft->ring) {
+        osal_free(stft->ring);
+        stft->ring = NULL;
+    }
+}
+
+void stft_reset(Stft *stft)
+{
+    if (stft) {
+        stft->wr      = 0;
+        stft->pending = stft->cfg.fft_len;
+        stft->skip    = 0;
+    }
+}
+
+static inline q15_t stft_sat_q15(int32_t v)
+{
+    return (q15_t)MAX(MIN(v, INT16_MAX), INT16_MIN);
+}
+
+/*
+ * Turn the half length transform Z of z[n] = x[2n] + j x[2n + 1] into X / 2,
+ * packed as rfft_fast_f32. With E = (Z[k] + Z*[m - k]) / 2 and
+ * O = (Z[k] - Z*[m - k]) / 2j: X[k] = E + W^k O, X[m - k] = (E - W^k O)*
+ */
+static void stft_split_q15(q15_t *buf, const q15_t *tw, uint32_t m)
+{
+    int32_t ar, ai, br, bi, er, ei, xr, xi, wr, wi;
+    q15_t *a, *b;
+    uint32_t k;
+
+    ar     = buf[0];
+    ai     = buf[1];
+    buf[0] = (q15_t)((ar + ai) >> 1);
+    buf[1] = (q15_t)((ar - ai) >> 1);
+    for (k = 1; k < m / 2; k++) {
+        a  = &buf[2 * k];
+        b  = &buf[2 * (m - k)];
+        ar = a[0];
+        ai = a[1];
+        br = b[0];
+        bi = b[1];
+        er = (ar + br) >> 2;
+        ei = (ai - bi) >> 2;
+        xr = (ai + bi) >> 2;
+        xi = (br - ar) >> 2;
+        wr = (tw[2 * k] * xr + tw[2 * k + 1] * xi) >> 15;
+        wi = (tw[2 * k] * xi - tw[2 * k + 1] * xr) >> 15;
+        a[0] = stft_sat_q15(er + wr);
+        a[1] = stft_sat_q15(ei + wi);
+        b[0] = stft_sat_q15(er - wr);
+        b[1] = stft_sat_q15(wi - ei);
+    }
+    a    = &buf[m];
+    a[0] = (q15_t)(a[0] >> 1);
+    a[1] = (q15_t)(-(a[1] >> 1));
+}
+
+/* Magnitude or power over the packed spectrum, in place from bin 0 upwards */
+static uint32_t stft_output_f32(float32_t *spec, uint32_t n, uint8_t output)
+{
+    float32_t dc = spec[0], nyq = spec[1];
+
+    if (output == STFT_OUT_MAG) {
+        riscv_cmplx_mag_f32(&spec[2], &spec[1], n / 2 - 1);
+        spec[0]     = fabsf(dc);
+        spec[n / 2] = fabsf(nyq);
+    } else if (output == STFT_OUT_POWER) {
+        riscv_cmplx_mag_squared_f32(&spec[2], &spec[1], n / 2 - 1);
+        spec[0]     = dc * dc;
+        spec[n / 2] = nyq * nyq;
+    } else {
+        return n;
+    }
+    return n / 2 + 1;
+}
+
+static uint32_t stft_output_q15(q15_t *spec, uint32_t n, uint8_t output)
+{
+    int32_t dc = spec[0], nyq = spec[1];
+
+    if (output == STFT_OUT_MAG) {
+        /* 2.14 as riscv_cmplx_mag_q15 */
+        riscv_cmplx_mag_q15(&spec[2], &spec[1], n / 2 - 1);
+        spec[0]     = (q15_t)(abs(dc) >> 1);
+        spec[n / 2] = (q15_t)(abs(nyq) >> 1);
+    } else if (output == STFT_OUT_POWER) {
+        /* 3.13 as riscv_cmplx_mag_squared_q15 */
+        riscv_cmplx_mag_squared_q15(&spec[2], &spec[1], n / 2 - 1);
+        spec[0]     = (q15_t)((dc * dc) >> 17);
+        spec[n / 2] = (q15_t)((nyq * nyq) >> 17);
+    } else {
+        return n;
+    }
+    return n / 2 + 1;
+}
+
+static void stft_frame_f32(Stft *stft, StftFrameCb cb, void *arg)
+{
+    const float32_t *win = stft->window;
+    float32_t *ring = stft->ring, *frame = stft->aux;
+    uint32_t n = stft->cfg.fft_len, head = n - stft->wr;
+
+    /* Window while unrolling the ring, the only copy of the samples */
+    if (stft->cfg.in_place) {
+        frame = ring;
+        if (win) {
+            riscv_mult_f32(ring, win, ring, n);
+        }
+    } else if (win) {
+        riscv_mult_f32(&ring[stft->wr], win, frame, head);
+        riscv_mult_f32(ring, &win[head], &frame[head], stft->wr);
+    } else {
+        memcpy(frame, &ring[stft->wr], head * sizeof(float32_t));
+        memcpy(&frame[head], ring, stft->wr * sizeof(float32_t));
+    }
+    riscv_rfft_fast_f32(&stft->fft.rfft, frame, stft->work, 0);
+    stft->frames++;
+    cb(stft->work, stft_output_f32(stft->work, n, stft->cfg.output), arg);
+}
+
+static void stft_frame_q15(Stft *stft, StftFrameCb cb, void *arg)
+{
+    const q15_t *win = stft->window;
+    q15_t *ring = stft->ring, *frame = stft->work;
+    uint32_t n = stft->cfg.fft_len, head = n - stft->wr;
+
+    if (stft->cfg.in_place) {
+        if (win) {
+            riscv_mult_q15(ring, win, ring, n);
+        }
+    } else if (win) {
+        riscv_mult_q15(&ring[stft->wr], win, frame, head);
+        riscv_mult_q15(ring, &win[head], &frame[head], stft->wr);
+    } else {
+        memcpy(frame, &ring[stft->wr], head * sizeof(q15_t));
+        memcpy(&frame[head], ring, stft->wr * sizeof(q15_t));
+    }
+    /* The real frame is read as n / 2 complex values */
+    riscv_cfft_q15(&stft->fft.cfft, frame, 0, 1);
+    stft_split_q15(frame, stft->aux, n / 2);
+    stft->frames++;
+    cb(frame, stft_output_q15(frame, n, stft->cfg.output), arg);
+}
+
+static int stft_push(Stft *stft, const void *in, uint32_t len, uint32_t elem, StftFrameCb cb,
+                     void *arg)
+{
+    const uint8_t *src = in;
+    uint32_t n, cnt;
+
+    if (!stft || !stft->ring || (!in && len) || !cb) {
+        return VPI_ERR_INVALID;
+    }
+    n = stft->cfg.fft_len;
+    while (len) {
+        if (stft->skip) {
+            cnt         = MIN(len, stft->skip);
+            stft->skip -= cnt;
+            src        += cnt * elem;
+            len        -= cnt;
+            continue;
+        }
+        cnt = MIN(MIN(len, stft->pending), n - stft->wr);
+        memcpy((uint8_t *)stft->ring + stft->wr * elem, src, cnt * elem);
+        stft->wr      += cnt;
+        stft->pending -= cnt;
+        src           += cnt * elem;
+        len           -= cnt;
+        if (stft->cfg.in_place) {
+            if (stft->pending) {
+                continue;
+            }
+            /* The ring is linear and full, wr = n makes the frame start at 0 */
+            stft->wr = 0;
+        } else if (stft->wr == n) {
+            stft->wr = 0;
+            if (stft->pending) {
+                continue;
+            }
+        } else if (stft->pending) {
+            continue;
+        }
+        if (elem == sizeof(float32_t)) {
+            stft_frame_f32(stft, cb, arg);
+        } else {
+            stft_frame_q15(stft, cb, arg);
+        }
+        if (stft->cfg.in_place) {
+            stft->pending = n;
+            stft->skip    = stft->cfg.hop - n;
+        } else {
+            stft->pending = stft->cfg.hop;
+        }
+    }
+    return VPI_SUCCESS;
+}
+
+int stft_push_f32(Stft *stft, const float32_t *in, uint32_t len, StftFrameCb cb, void *arg)
+{
+    if (stft && stft->cfg.format != STFT_F32) {
+        return VPI_ERR_INVALID;
+    }
+    return stft_push(stft, in, len, sizeof(float32_t), cb, arg);
+}
+
+int stft_push_q15(Stft *stft, const q15_t *in, uint32_t len, StftFrameCb cb, void *arg)
+{
+    if (stft && stft->cfg.format != STFT_Q15) {
+        return VPI_ERR_INVALID;
+    }
+    return stft_push(stft, in, len, sizeof(q15_t), cb, arg);
+}
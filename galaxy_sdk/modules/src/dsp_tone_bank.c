@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "dsp_tone_bank.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+#include "osal_heap_api.h"
+
+/* Samples converted per pass, the bins then run over them from registers */
+#define TONE_CHUNK 32
+/* SDFT pole radius, keeps the rotation stable against coefficient rounding */
+#define TONE_R (1.0f - 1.0f / 65536)
+
+/*
+ * 32x16 multiplies with rounding, q15 coefficient in the bottom or top half
+ * of p. With the P extension one instruction each, the top and bottom forms
+ * let two bins share a coefficient word
+ */
+static inline int32_t tb_sat(int64_t v)
+{
+    return (int32_t)MAX(MIN(v, (int64_t)INT32_MAX), (int64_t)INT32_MIN);
+}
+
+static inline int32_t tb_mul_b(int32_t a, uint32_t p)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KMMWB2_U(a, p);
+#else
+    return tb_sat(((int64_t)a * (int16_t)p + (1 << 14)) >> 15);
+#endif
+}
+
+static inline int32_t tb_mul_t(int32_t a, uint32_t p)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KMMWT2_U(a, p);
+#else
+    return tb_sat(((int64_t)a * (int16_t)(p >> 16) + (1 << 14)) >> 15);
+#endif
+}
+
+static inline int32_t tb_mac_b(int32_t t, int32_t a, uint32_t p)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KMMAWB2_U(t, a, p);
+#else
+    return tb_sat((int64_t)t + tb_mul_b(a, p));
+#endif
+}
+
+static inline int32_t tb_mac_t(int32_t t, int32_t a, uint32_t p)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KMMAWT2_U(t, a, p);
+#else
+    return tb_sat((int64_t)t + tb_mul_t(a, p));
+#endif
+}
+
+/* a * b for b in q31 */
+static inline int32_t tb_mul_q31(int32_t a, int32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SMMUL_U(a * 2, b);
+#else
+    return (int32_t)(((int64_t)a * b + (1 << 30)) >> 31);
+#endif
+}
+
+static inline uint16_t tb_q15(float32_t v)
+{
+    int32_t q = (int32_t)(v * 32768.0f + (v < 0 ? -0.5f : 0.5f));
+
+    return (uint16_t)MAX(MIN(q, 32767), -32768);
+}
+
+static inline int32_t tb_q31(float32_t v)
+{
+    return (int32_t)MAX(MIN(v * 2147483648.0f, 2147483647.0f), -2147483648.0f);
+}
+
+static double tb_powi(double r, uint32_t n)
+{
+    double v = 1.0;
+
+    for (; n; n >>= 1, r *= r) {
+        if (n & 1) {
+            v *= r;
+        }
+    }
+    return v;
+}
+
+/* Smallest shift with 2^shift >= 4 * bound, 2 bits stay free above the states */
+static uint8_t tb_headroom(float32_t bound)
+{
+    uint8_t shift = 2;
+
+    while (shift < 31 && (float32_t)(1u << (shift - 2)) < bound) {
+        shift++;
+    }
+    return shift;
+}
+
+static bool tb_cfg_valid(const ToneBankCfg *cfg)
+{
+    if (!cfg->freq || !(cfg->fs > 0) || !cfg->num || cfg->num > TONE_BANK_MAX ||
+        cfg->len < 8 || cfg->len > TONE_BANK_LEN_MAX || cfg->mode > TONE_SDFT ||
+        cfg->format > TONE_F32) {
+        return false;
+    }
+    for (uint32_t i = 0; i < cfg->num; i++) {
+        if (!(cfg->freq[i] >= 0) || cfg->freq[i] > cfg->fs / 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int tb_setup_goertzel(ToneBank *tb, const float32_t *freq)
+{
+    uint32_t n      = tb->cfg.len;
+    float32_t bound = 0;
+
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        float32_t w = 2 * PI * freq[i] / tb->cfg.fs;
+        float32_t c = riscv_cos_f32(w);
+        float32_t s, b;
+
+        if (tb->cfg.format == TONE_F32) {
+            tb->coef.f[i] = 2 * c;
+        } else {
+            uint16_t q   = tb_q15(c);
+            float32_t cq = (int16_t)q / 32768.0f;
+
+            /*
+             * DC is summed exactly by tb_goertzel_q, refuse other bins the
+             * q15 cosine moves by more than 1/8 of a bin
+             */
+            if (freq[i] == 0) {
+                tb->dc |= 1u << i;
+                cq = 1.0f;
+            } else if (4 * n * fabsf(acosf(cq) - w) > PI) {
+                return VPI_ERR_INVALID;
+            }
+            tb->coef.pk[i >> 1] |= (uint32_t)q << (i & 1 ? 16 : 0);
+            c = cq;
+        }
+        tb->cosw[i] = c;
+        /* |s| <= sum of |sin(k * w) / sin(w)| <= sum of min(k, 1 / sin(w)) */
+        riscv_sqrt_f32(MAX(1 - c * c, 0.0f), &s);
+        b     = (float32_t)n * (n + 1) / 2;
+        b     = s > 0 ? MIN(b, n / s) : b;
+        bound = MAX(bound, b);
+        /* The two sided DC and Nyquist bins hold the whole amplitude */
+        tb->scale[i] = (freq[i] > 0 && freq[i] < tb->cfg.fs / 2 ? 2.0f : 1.0f) / n;
+    }
+    tb->shift = tb_headroom(bound);
+    return VPI_SUCCESS;
+}
+
+static void tb_setup_sdft(ToneBank *tb, const float32_t *freq)
+{
+    uint32_t n = tb->cfg.len;
+
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        uint32_t k  = (uint32_t)(freq[i] * n / tb->cfg.fs + 0.5f);
+        float32_t w = 2 * PI * k / n;
+        float32_t c = TONE_R * riscv_cos_f32(w);
+        float32_t s = TONE_R * riscv_sin_f32(w);
+        float32_t r, rn;
+        double r2;
+
+        if (tb->cfg.format == TONE_F32) {
+            tb->coef.f[2 * i]     = c;
+            tb->coef.f[2 * i + 1] = s;
+            r2                    = (double)c * c + (double)s * s;
+        } else {
+            int32_t qc = tb_q31(c), qs = tb_q31(s);
+
+            tb->coef.q31[2 * i]     = qc;
+            tb->coef.q31[2 * i + 1] = qs;
+            r2 = ((double)qc * qc + (double)qs * qs) / 4611686018427387904.0;
+        }
+        /*
+         * The leaving sample only cancels with the radius the coefficients
+         * really have, so r^len is taken per bin from the rounded values
+         */
+        riscv_sqrt_f32((float32_t)r2, &r);
+        riscv_sqrt_f32((float32_t)tb_powi(r2, n), &rn);
+        if (tb->cfg.format == TONE_F32) {
+            tb->decay.f[i] = rn;
+        } else {
+            tb->decay.i[i] = tb_q31(rn);
+        }
+        /* On bin gain of the damped window, r * (1 - r^len) / (1 - r) */
+        tb->scale[i] = (k > 0 && 2 * k < n ? 2.0f : 1.0f) * (float32_t)((1 - r2) / (1 + r)) /
+                       (r * (1 - rn));
+    }
+    /* |X| stays below len samples, plus the new one and the leaving one */
+    tb->shift = tb_headroom(n + 2);
+}
+
+int tone_bank_init(ToneBank *tb, const ToneBankCfg *cfg)
+{
+    int ret = VPI_SUCCESS;
+
+    if (!tb || !cfg || !tb_cfg_valid(cfg)) {
+        return VPI_ERR_INVALID;
+    }
+    memset(tb, 0, sizeof(*tb));
+    tb->cfg      = *cfg;
+    tb->cfg.freq = NULL;
+    if (cfg->mode == TONE_SDFT) {
+        tb->ring.i = osal_malloc(cfg->len * sizeof(int32_t));
+        if (!tb->ring.i) {
+            return VPI_ERR_NOMEM;
+        }
+        tb_setup_sdft(tb, cfg->freq);
+    } else {
+        ret = tb_setup_goertzel(tb, cfg->freq);
+    }
+    tone_bank_reset(tb);
+    return ret;
+}
+
+void tone_bank_deinit(ToneBank *tb)
+{
+    if (tb && tb->ring.i) {
+        osal_free(tb->ring.i);
+        tb->ring.i = NULL;
+    }
+}
+
+void tone_bank_reset(ToneBank *tb)
+{
+    if (!tb) {
+        return;
+    }
+    tb->pos     = 0;
+    tb->fill    = 0;
+    tb->updates = 0;
+    memset(&tb->st, 0, sizeof(tb->st));
+    memset(tb->power, 0, sizeof(tb->power));
+    if (tb->ring.i) {
+        /* All zero bits are 0.0f as well */
+        memset(tb->ring.i, 0, tb->cfg.len * sizeof(int32_t));
+    }
+}
+
+/* s = x + 2 * cos * s1 - s2, bins in pairs sharing one coefficient word */
+static void tb_goertzel_q(ToneBank *tb, const int32_t *x, uint32_t n)
+{
+    int32_t *st = tb->st.i;
+    int32_t dc[TONE_BANK_MAX];
+    int32_t sum = 0;
+
+    /* cos(0) = 1 has no q15 form, the DC state is the plain sum instead */
+    if (tb->dc) {
+        for (uint32_t k = 0; k < n; k++) {
+            sum += x[k];
+        }
+        for (uint32_t i = 0; i < tb->cfg.num; i++) {
+            dc[i] = tb->st.i[2 * i] + sum;
+        }
+    }
+    for (uint32_t i = 0; i < tb->cfg.num; i += 2, st += 4) {
+        uint32_t p = tb->coef.pk[i >> 1];
+        int32_t a1 = st[0], a2 = st[1], b1 = st[2], b2 = st[3];
+
+        for (uint32_t k = 0; k < n; k++) {
+            int32_t a = tb_mac_b(x[k] - a2, a1 * 2, p);
+            int32_t b = tb_mac_t(x[k] - b2, b1 * 2, p);
+
+            a2 = a1;
+            a1 = a;
+            b2 = b1;
+            b1 = b;
+        }
+        st[0] = a1;
+        st[1] = a2;
+        st[2] = b1;
+        st[3] = b2;
+    }
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        if (tb->dc & (1u << i)) {
+            tb->st.i[2 * i]     = dc[i];
+            tb->st.i[2 * i + 1] = 0;
+        }
+    }
+}
+
+static void tb_goertzel_f32(ToneBank *tb, const float32_t *x, uint32_t n)
+{
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        float32_t c2 = tb->coef.f[i];
+        float32_t s1 = tb->st.f[2 * i], s2 = tb->st.f[2 * i + 1];
+
+        for (uint32_t k = 0; k < n; k++) {
+            float32_t s = x[k] + c2 * s1 - s2;
+
+            s2 = s1;
+            s1 = s;
+        }
+        tb->st.f[2 * i]     = s1;
+        tb->st.f[2 * i + 1] = s2;
+    }
+}
+
+/* End of a Goertzel block, |X|^2 = s1^2 + s2^2 - 2 * cos * s1 * s2 */
+static void tb_goertzel_latch(ToneBank *tb)
+{
+    float32_t unit = 1.0f;
+
+    if (tb->cfg.format != TONE_F32) {
+        unit = (float32_t)(1u << tb->shift) / 2147483648.0f;
+    }
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        float32_t s1, s2;
+
+        if (tb->cfg.format == TONE_F32) {
+            s1 = tb->st.f[2 * i];
+            s2 = tb->st.f[2 * i + 1];
+        } else {
+            s1 = tb->st.i[2 * i] * unit;
+            s2 = tb->st.i[2 * i + 1] * unit;
+        }
+        tb->power[i] = s1 * s1 + s2 * s2 - 2 * tb->cosw[i] * s1 * s2;
+    }
+    memset(&tb->st, 0, sizeof(tb->st));
+    tb->updates++;
+}
+
+/* Put the new samples in the ring, old gets the ones leaving the window */
+static void tb_sdft_ring_q(ToneBank *tb, const int32_t *x, int32_t *old, uint32_t n)
+{
+    for (uint32_t k = 0; k < n; k++) {
+        old[k]              = tb->ring.i[tb->pos];
+        tb->ring.i[tb->pos] = x[k];
+        if (++tb->pos == tb->cfg.len) {
+            tb->pos = 0;
+        }
+    }
+}
+
+static void tb_sdft_ring_f32(ToneBank *tb, const float32_t *x, float32_t *old, uint32_t n)
+{
+    for (uint32_t k = 0; k < n; k++) {
+        old[k]              = tb->ring.f[tb->pos];
+        tb->ring.f[tb->pos] = x[k];
+        if (++tb->pos == tb->cfg.len) {
+            tb->pos = 0;
+        }
+    }
+}
+
+/* X = r * e^(jw) * (X + x - r^len * old) */
+static void tb_sdft_q(ToneBank *tb, const int32_t *x, const int32_t *old, uint32_t n)
+{
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        int32_t c = tb->coef.q31[2 * i], s = tb->coef.q31[2 * i + 1];
+        int32_t rn = tb->decay.i[i];
+        int32_t re = tb->st.i[2 * i], im = tb->st.i[2 * i + 1];
+
+        for (uint32_t k = 0; k < n; k++) {
+            int32_t a = re + x[k] - tb_mul_q31(old[k], rn);
+
+            re = tb_mul_q31(a, c) - tb_mul_q31(im, s);
+            im = tb_mul_q31(a, s) + tb_mul_q31(im, c);
+        }
+        tb->st.i[2 * i]     = re;
+        tb->st.i[2 * i + 1] = im;
+    }
+}
+
+static void tb_sdft_f32(ToneBank *tb, const float32_t *x, const float32_t *old, uint32_t n)
+{
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        float32_t c = tb->coef.f[2 * i], s = tb->coef.f[2 * i + 1];
+        float32_t rn = tb->decay.f[i];
+        float32_t re = tb->st.f[2 * i], im = tb->st.f[2 * i + 1];
+
+        for (uint32_t k = 0; k < n; k++) {
+            float32_t a = re + x[k] - rn * old[k];
+
+            re = c * a - s * im;
+            im = s * a + c * im;
+        }
+        tb->st.f[2 * i]     = re;
+        tb->st.f[2 * i + 1] = im;
+    }
+}
+
+static int tb_push(ToneBank *tb, const void *in, uint32_t len, uint8_t format)
+{
+    union {
+        int32_t i[TONE_CHUNK];
+        float32_t f[TONE_CHUNK];
+    } buf, old;
+    const uint8_t *src = in;
+    uint32_t size      = format == TONE_Q15 ? sizeof(q15_t) : sizeof(q31_t);
+
+    if (!tb || (!in && len) || tb->cfg.format != format || !tb->cfg.num) {
+        return VPI_ERR_INVALID;
+    }
+    while (len) {
+        uint32_t n = MIN(len, TONE_CHUNK);
+
+        if (tb->cfg.mode == TONE_GOERTZEL) {
+            n = MIN(n, (uint32_t)(tb->cfg.len - tb->pos));
+        }
+        if (format == TONE_Q15) {
+            for (uint32_t k = 0; k < n; k++) {
+                buf.i[k] = ((int32_t)((const q15_t *)src)[k] << 16) >> tb->shift;
+            }
+        } else if (format == TONE_Q31) {
+            for (uint32_t k = 0; k < n; k++) {
+                buf.i[k] = ((const q31_t *)src)[k] >> tb->shift;
+            }
+        } else {
+            memcpy(buf.f, src, n * size);
+        }
+
+        if (tb->cfg.mode == TONE_GOERTZEL) {
+            if (format == TONE_F32) {
+                tb_goertzel_f32(tb, buf.f, n);
+            } else {
+                tb_goertzel_q(tb, buf.i, n);
+            }
+            tb->pos += n;
+            if (tb->pos == tb->cfg.len) {
+                tb_goertzel_latch(tb);
+                tb->pos = 0;
+            }
+        } else {
+            if (format == TONE_F32) {
+                tb_sdft_ring_f32(tb, buf.f, old.f, n);
+                tb_sdft_f32(tb, buf.f, old.f, n);
+            } else {
+                tb_sdft_ring_q(tb, buf.i, old.i, n);
+                tb_sdft_q(tb, buf.i, old.i, n);
+            }
+            tb->fill     = MIN(tb->fill + n, (uint32_t)tb->cfg.len);
+            tb->updates += n;
+        }
+        src += n * size;
+        len -= n;
+    }
+    return VPI_SUCCESS;
+}
+
+int tone_bank_push_q15(ToneBank *tb, const q15_t *in, uint32_t len)
+{
+    return tb_push(tb, in, len, TONE_Q15);
+}
+
+int tone_bank_push_q31(ToneBank *tb, const q31_t *in, uint32_t len)
+{
+    return tb_push(tb, in, len, TONE_Q31);
+}
+
+int tone_bank_push_f32(ToneBank *tb, const float32_t *in, uint32_t len)
+{
+    return tb_push(tb, in, len, TONE_F32);
+}
+
+int tone_bank_amplitude(const ToneBank *tb, float32_t *amp)
+{
+    float32_t unit = 1.0f;
+
+    if (!tb || !amp || !tb->cfg.num) {
+        return VPI_ERR_INVALID;
+    }
+    if (tb->cfg.mode == TONE_GOERTZEL ? !tb->updates : tb->fill < tb->cfg.len) {
+        return VPI_ERR_NOT_READY;
+    }
+    if (tb->cfg.format != TONE_F32) {
+        unit = (float32_t)(1u << tb->shift) / 2147483648.0f;
+    }
+    for (uint32_t i = 0; i < tb->cfg.num; i++) {
+        float32_t power = tb->power[i];
+
+        if (tb->cfg.mode == TONE_SDFT) {
+            float32_t re, im;
+
+            if (tb->cfg.format == TONE_F32) {
+                re = tb->st.f[2 * i];
+                im = tb->st.f[2 * i + 1];
+            } else {
+                re = tb->st.i[2 * i] * unit;
+                im = tb->st.i[2 * i + 1] * unit;
+            }
+            power = re * re + im * im;
+        }
+        riscv_sqrt_f32(MAX(power, 0.0f), &amp[i]);
+        amp[i] *= tb->scale[i];
+    }
+    return VPI_SUCCESS;
+}
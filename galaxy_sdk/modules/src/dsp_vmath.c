@@ -0,0 +1,693 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include "dsp_vmath.h"
+#include "bsp_common.h"
+
+/* Adding 1.5 * 2^23 rounds |v| < 2^22 to an integer kept in the low bits */
+#define VM_ROUND 12582912.0f
+
+/*
+ * 64 / (2 pi) and the split of 2 pi / 64 with k * hi and k * mid exact for
+ * |k| < 4096, tail is the nearest float to 2 pi / 64 - hi
+ */
+#define VM_SIN_SCALE 10.1859159f
+#define VM_SIN_HI    0.09814453125f
+#define VM_SIN_TAIL  3.02391745e-05f
+/* Larger angles take vm_sin_reduce, |k| of the split stays below 4096 */
+#define VM_SIN_BIG   400.0f
+#define VM_2PI_D     6.283185307179586
+#define VM_SIN_MID   3.0234456062316895e-05f
+#define VM_SIN_LO    4.7186188290027076e-09f
+
+/* 32 / ln(2), ln(2) / 32 and its split with k * hi exact for |k| <= 4096 */
+#define VM_EXP_SCALE 46.1662407f
+#define VM_EXP_STEP  0.0216608495f
+#define VM_EXP_HI    0.0216522216796875f
+#define VM_EXP_LO    8.627713214082178e-06f
+/* Inputs of the main path of vm_exp, the scale stays a normal float */
+#define VM_EXP_MIN (-87.3f)
+#define VM_EXP_MAX 87.0f
+#define VM_EXP_INF 88.7228394f
+
+/* First float of the log2 table, 0x3f330000 is about 0.6992 */
+#define VM_LOG2_OFF 0x3f330000u
+
+#define VM_PI_4       0.785398185f
+#define VM_PI_2       1.57079637f
+#define VM_PI         3.14159274f
+#define VM_TAN_PI_8   0.414213568f
+#define VM_TAN_PI_8_Q 13573
+
+/* q15 coefficients fitted with the rounding of the SIMD steps */
+#define VM_SIN_K1  25734
+#define VM_SIN_K3  (-10580)
+#define VM_SIN_K5  1303
+#define VM_SIN_K7  (-72)
+#define VM_ATAN_A1 10431
+#define VM_ATAN_A3 (-3455)
+#define VM_ATAN_A5 1727
+
+/* sin(2 pi k / 64), k up to 79 so that the cosine is entry k + 16 */
+static const float32_t g_vm_sin[80] = {
+    0.0f,          0.0980171412f,  0.195090324f,  0.290284663f,  0.382683426f,  0.471396744f,
+    0.555570245f,  0.634393275f,   0.707106769f,  0.773010433f,  0.831469595f,  0.881921291f,
+    0.923879504f,  0.956940353f,   0.980785251f,  0.99518472f,   1.0f,          0.99518472f,
+    0.980785251f,  0.956940353f,   0.923879504f,  0.881921291f,  0.831469595f,  0.773010433f,
+    0.707106769f,  0.634393275f,   0.555570245f,  0.471396744f,  0.382683426f,  0.290284663f,
+    0.195090324f,  0.0980171412f,  0.0f,          -0.0980171412f, -0.195090324f, -0.290284663f,
+    -0.382683426f, -0.471396744f,  -0.555570245f, -0.634393275f, -0.707106769f, -0.773010433f,
+    -0.831469595f, -0.881921291f,  -0.923879504f, -0.956940353f, -0.980785251f, -0.99518472f,
+    -1.0f,         -0.99518472f,   -0.980785251f, -0.956940353f, -0.923879504f, -0.881921291f,
+    -0.831469595f, -0.773010433f,  -0.707106769f, -0.634393275f, -0.555570245f, -0.471396744f,
+    -0.382683426f, -0.290284663f,  -0.195090324f, -0.0980171412f, 0.0f,          0.0980171412f,
+    0.195090324f,  0.290284663f,   0.382683426f,  0.471396744f,  0.555570245f,  0.634393275f,
+    0.707106769f,  0.773010433f,   0.831469595f,  0.881921291f,  0.923879504f,  0.956940353f,
+    0.980785251f,  0.99518472f,
+};
+
+/*
+ * Float 1 / c of the centers c of 32 equal parts of [OFF, 2 OFF) and
+ * -log2 of that float, so that z / c - 1 has no table error. The part
+ * holding 1.0 uses c = 1 against cancellation
+ */
+static const struct {
+    float32_t invc;
+    float32_t logc;
+} g_vm_log2[32] = {
+    {1.4143647f, -0.500154197f},   {1.38378382f, -0.468618572f},  {1.35449731f, -0.437757522f},
+    {1.32642484f, -0.407542914f},  {1.29949236f, -0.377948165f},  {1.27363181f, -0.34894827f},
+    {1.24878049f, -0.320519894f},  {1.22488034f, -0.292640805f},  {1.20187795f, -0.265290409f},
+    {1.1797235f, -0.238448769f},   {1.15837109f, -0.212097496f},  {1.13777781f, -0.186218843f},
+    {1.11790395f, -0.16079624f},   {1.09871244f, -0.135813847f},  {1.08016872f, -0.111256681f},
+    {1.06224072f, -0.0871107429f}, {1.04489791f, -0.0633619949f}, {1.02811241f, -0.0399980135f},
+    {1.01185775f, -0.0170064829f}, {1.0f, 0.0f},                  {0.962406039f, 0.0552823991f},
+    {0.934306562f, 0.0980320945f}, {0.90780139f, 0.139551401f},   {0.882758617f, 0.179909095f},
+    {0.859060407f, 0.219168514f},  {0.836601317f, 0.257387817f},  {0.815286636f, 0.294620723f},
+    {0.795031071f, 0.330916852f},  {0.775757551f, 0.366322249f},  {0.75739646f, 0.400879413f},
+    {0.739884377f, 0.434628248f},  {0.723163843f, 0.467605561f},
+};
+
+/* 2^(j / 32) */
+static const float32_t g_vm_exp[32] = {
+    1.0f,        1.0218972f,  1.04427373f, 1.06714046f, 1.09050775f, 1.1143868f,
+    1.13878858f, 1.1637249f,  1.18920708f, 1.21524739f, 1.24185777f, 1.26905096f,
+    1.29683959f, 1.32523668f, 1.35425556f, 1.38390994f, 1.41421354f, 1.44518077f,
+    1.47682619f, 1.50916445f, 1.54221082f, 1.5759809f,  1.61049032f, 1.64575553f,
+    1.68179286f, 1.71861935f, 1.75625217f, 1.79470909f, 1.8340081f,  1.87416768f,
+    1.91520655f, 1.95714414f,
+};
+
+/* 0.5 / sqrt(m) in q15 at m = (16 + i) / 64, interpolated between entries */
+static const uint16_t g_vm_rsqrt[49] = {
+    32768, 31790, 30894, 30070, 29309, 28602, 27945, 27330, 26755, 26214, 25705, 25225,
+    24770, 24339, 23930, 23541, 23170, 22817, 22479, 22155, 21845, 21548, 21263, 20988,
+    20724, 20470, 20225, 19988, 19760, 19539, 19326, 19119, 18919, 18725, 18536, 18354,
+    18176, 18004, 17837, 17674, 17515, 17361, 17211, 17064, 16921, 16782, 16646, 16514,
+    16384,
+};
+
+typedef union VmFloat {
+    float32_t f;
+    uint32_t u;
+} VmFloat;
+
+__STATIC_FORCEINLINE uint32_t vm_bits(float32_t f)
+{
+    VmFloat v = {.f = f};
+
+    return v.u;
+}
+
+__STATIC_FORCEINLINE float32_t vm_float(uint32_t u)
+{
+    VmFloat v = {.u = u};
+
+    return v.f;
+}
+
+/*
+ * k and r of a large angle in double precision, fmod is exact so the error
+ * only comes from the double 2 pi, about 4e-17 |x|
+ */
+static uint32_t vm_sin_reduce(float32_t x, float32_t *r)
+{
+    double y = fmod(x, VM_2PI_D);
+    int32_t k;
+
+    if (y != y) {
+        /* inf or NaN */
+        *r = (float32_t)y;
+        return 0;
+    }
+    k  = (int32_t)(y * (64 / VM_2PI_D) + (y < 0.0 ? -0.5 : 0.5));
+    *r = (float32_t)(y - k * (VM_2PI_D / 64));
+    return (uint32_t)k & 63;
+}
+
+/* sin(x) and cos(x) = table at k 2 pi / 64 rotated by r */
+__STATIC_FORCEINLINE void vm_sincos(float32_t x, bool precise, float32_t *ps, float32_t *pc)
+{
+    float32_t kd = x * VM_SIN_SCALE + VM_ROUND, r, r2, s, c, sr, cm;
+    uint32_t k   = vm_bits(kd) & 63;
+
+    kd -= VM_ROUND;
+    if (fabsf(x) > VM_SIN_BIG) {
+        k = vm_sin_reduce(x, &r);
+    } else if (precise) {
+        r = x - kd * VM_SIN_HI;
+        r -= kd * VM_SIN_MID;
+        r -= kd * VM_SIN_LO;
+    } else {
+        r = x - kd * VM_SIN_HI;
+        r -= kd * VM_SIN_TAIL;
+    }
+    s  = g_vm_sin[k];
+    c  = g_vm_sin[k + 16];
+    r2 = r * r;
+    /* sin(r) and cos(r) - 1 */
+    if (precise) {
+        sr = r + r * r2 * (-0.166666667f + r2 * 0.00833333333f);
+        cm = r2 * (-0.5f + r2 * 0.0416666667f);
+    } else {
+        sr = r - r * r2 * 0.166666667f;
+        cm = -0.5f * r2;
+    }
+    *ps = s + (s * cm + c * sr);
+    *pc = c + (c * cm - s * sr);
+}
+
+/* atan(min / max), or pi / 4 + atan((min - max) / (min + max)) above tan(pi / 8) */
+__STATIC_FORCEINLINE float32_t vm_atan2(float32_t y, float32_t x, bool precise)
+{
+    float32_t ax = fabsf(x), ay = fabsf(y), mn = MIN(ax, ay), mx = MAX(ax, ay);
+    float32_t num = mn, den = mx, a = 0.0f, t, t2, p;
+
+    if (mn > VM_TAN_PI_8 * mx) {
+        num = mn - mx;
+        den = mn + mx;
+        a   = VM_PI_4;
+    }
+    t  = den > 0.0f ? num / den : 0.0f;
+    t2 = t * t;
+    if (precise) {
+        p = 0.999999982f +
+            t2 * (-0.333327992f + t2 * (0.199744704f + t2 * (-0.138520883f + t2 * 0.0798673674f)));
+    } else {
+        p = 0.999981978f + t2 * (-0.331390679f + t2 * 0.168229315f);
+    }
+    a += t * p;
+    if (ay > ax) {
+        a = VM_PI_2 - a;
+    }
+    if (x < 0.0f) {
+        a = VM_PI - a;
+    }
+    return vm_bits(y) >> 31 ? -a : a;
+}
+
+/* 0, negatives, inf and NaN */
+static float32_t vm_log2_special(float32_t x)
+{
+    uint32_t u = vm_bits(x);
+
+    if (!(u << 1)) {
+        return -INFINITY;
+    }
+    return u >> 31 ? NAN : x;
+}
+
+/* x = 2^k z with z in [OFF, 2 OFF), log2(z) = log2(c) + log2(1 + (z / c - 1)) */
+__STATIC_FORCEINLINE float32_t vm_log2(float32_t x, bool precise)
+{
+    uint32_t ix = vm_bits(x), tmp, i;
+    float32_t e = 0.0f, z, r, p;
+
+    if (ix - 0x00800000u >= 0x7f000000u) {
+        if (ix - 1u >= 0x007fffffu) {
+            return vm_log2_special(x);
+        }
+        /* Positive subnormal */
+        ix = vm_bits(x * 8388608.0f);
+        e  = -23.0f;
+    }
+    tmp = ix - VM_LOG2_OFF;
+    i   = (tmp >> 18) & 31;
+    e += (float32_t)((int32_t)tmp >> 23);
+    z = vm_float(ix - (tmp & 0xff800000u));
+    /* The fused multiply-add keeps r exact near 1 */
+    r = fmaf(z, g_vm_log2[i].invc, -1.0f);
+    if (precise) {
+        p = r * (1.44269503f + r * (-0.721347515f + r * (0.481059257f + r * -0.36087039f)));
+    } else {
+        p = r * (1.44282707f + r * -0.721413351f);
+    }
+    return (e + g_vm_log2[i].logc) + p;
+}
+
+/* exp(x) = 2^(n / 32) exp(r) with the scale 2^(n / 32 - bias) built in the exponent */
+__STATIC_FORCEINLINE float32_t vm_exp_scaled(float32_t x, bool precise, uint32_t bias)
+{
+    float32_t kd = x * VM_EXP_SCALE + VM_ROUND, r, p, s;
+    int32_t n    = (int32_t)(vm_bits(kd) - vm_bits(VM_ROUND));
+
+    kd -= VM_ROUND;
+    if (precise) {
+        r = x - kd * VM_EXP_HI;
+        r -= kd * VM_EXP_LO;
+        p = r + r * r * (0.5f + r * 0.166666667f);
+    } else {
+        r = x - kd * VM_EXP_STEP;
+        p = r;
+    }
+    s = vm_float(vm_bits(g_vm_exp[n & 31]) + ((uint32_t)((n >> 5) - (int32_t)bias) << 23));
+    return s + s * p;
+}
+
+static float32_t vm_exp_special(float32_t x, bool precise)
+{
+    if (x > VM_EXP_INF) {
+        return INFINITY;
+    }
+    if (x > 0.0f) {
+        return vm_exp_scaled(x, precise, 1) * 2.0f;
+    }
+    return x < 0.0f ? 0.0f : x;
+}
+
+__STATIC_FORCEINLINE float32_t vm_exp(float32_t x, bool precise)
+{
+    if (!(x >= VM_EXP_MIN && x <= VM_EXP_MAX)) {
+        return vm_exp_special(x, precise);
+    }
+    return vm_exp_scaled(x, precise, 0);
+}
+
+void vmath_sin_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec)
+{
+    float32_t c;
+
+    if (prec == VMATH_PRECISE) {
+        for (uint32_t i = 0; i < num; i++) {
+            vm_sincos(src[i], true, &dst[i], &c);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            vm_sincos(src[i], false, &dst[i], &c);
+        }
+    }
+}
+
+void vmath_cos_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec)
+{
+    float32_t s;
+
+    if (prec == VMATH_PRECISE) {
+        for (uint32_t i = 0; i < num; i++) {
+            vm_sincos(src[i], true, &s, &dst[i]);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            vm_sincos(src[i], false, &s, &dst[i]);
+        }
+    }
+}
+
+void vmath_sincos_f32(const float32_t *src, float32_t *dsin, float32_t *dcos, uint32_t num,
+                      VMathPrec prec)
+{
+    if (prec == VMATH_PRECISE) {
+        for (uint32_t i = 0; i < num; i++) {
+            vm_sincos(src[i], true, &dsin[i], &dcos[i]);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            vm_sincos(src[i], false, &dsin[i], &dcos[i]);
+        }
+    }
+}
+
+void vmath_atan2_f32(const float32_t *y, const float32_t *x, float32_t *dst, uint32_t num,
+                     VMathPrec prec)
+{
+    if (prec == VMATH_PRECISE) {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = vm_atan2(y[i], x[i], true);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = vm_atan2(y[i], x[i], false);
+        }
+    }
+}
+
+void vmath_log2_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec)
+{
+    if (prec == VMATH_PRECISE) {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = vm_log2(src[i], true);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = vm_log2(src[i], false);
+        }
+    }
+}
+
+void vmath_exp_f32(const float32_t *src, float32_t *dst, uint32_t num, VMathPrec prec)
+{
+    if (prec == VMATH_PRECISE) {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = vm_exp(src[i], true);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = vm_exp(src[i], false);
+        }
+    }
+}
+
+void vmath_sqrt_f32(const float32_t *src, float32_t *dst, uint32_t num)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        dst[i] = src[i] > 0.0f ? sqrtf(src[i]) : 0.0f;
+    }
+}
+
+void vmath_mag_f32(const float32_t *x, const float32_t *y, const float32_t *z, float32_t *dst,
+                   uint32_t num)
+{
+    if (z) {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        }
+    } else {
+        for (uint32_t i = 0; i < num; i++) {
+            dst[i] = sqrtf(x[i] * x[i] + y[i] * y[i]);
+        }
+    }
+}
+
+/* SIMD helpers on two q15 lanes, h0 in the low half */
+
+__STATIC_FORCEINLINE int16_t vm_h0(uint32_t a)
+{
+    return (int16_t)a;
+}
+
+__STATIC_FORCEINLINE int16_t vm_h1(uint32_t a)
+{
+    return (int16_t)(a >> 16);
+}
+
+__STATIC_FORCEINLINE uint32_t vm_pack(int32_t h0, int32_t h1)
+{
+    return (uint16_t)h0 | (uint32_t)h1 << 16;
+}
+
+/* Saturated (a * b) >> 15 */
+__STATIC_FORCEINLINE uint32_t vm_khm16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KHM16(a, b);
+#else
+    return vm_pack(__SSAT((vm_h0(a) * vm_h0(b)) >> 15, 16),
+                   __SSAT((vm_h1(a) * vm_h1(b)) >> 15, 16));
+#endif
+}
+
+__STATIC_FORCEINLINE uint32_t vm_kadd16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KADD16(a, b);
+#else
+    return vm_pack(__SSAT(vm_h0(a) + vm_h0(b), 16), __SSAT(vm_h1(a) + vm_h1(b), 16));
+#endif
+}
+
+/* Wrapping add */
+__STATIC_FORCEINLINE uint32_t vm_add16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_ADD16(a, b);
+#else
+    return vm_pack(vm_h0(a) + vm_h0(b), vm_h1(a) + vm_h1(b));
+#endif
+}
+
+/* All ones in the lanes with a negative sign */
+__STATIC_FORCEINLINE uint32_t vm_sign16(uint32_t a)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SRAI16(a, 15);
+#else
+    return vm_pack(vm_h0(a) >> 15, vm_h1(a) >> 15);
+#endif
+}
+
+/* Saturated a * 2 */
+__STATIC_FORCEINLINE uint32_t vm_kdouble16(uint32_t a)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KSLLI16(a, 1);
+#else
+    return vm_pack(__SSAT(vm_h0(a) * 2, 16), __SSAT(vm_h1(a) * 2, 16));
+#endif
+}
+
+/* Saturated round(a * b / 2^14), on the full products */
+__STATIC_FORCEINLINE uint32_t vm_mul14(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    int32_t lo = __RV_SMBB16(a, b), hi = __RV_SMTT16(a, b);
+#else
+    int32_t lo = vm_h0(a) * vm_h0(b), hi = vm_h1(a) * vm_h1(b);
+#endif
+
+    return vm_pack(__SSAT((lo + (1 << 13)) >> 14, 16), __SSAT((hi + (1 << 13)) >> 14, 16));
+}
+
+/* sin(pi a) on both lanes */
+__STATIC_FORCEINLINE uint32_t vm_sin_q15x2(uint32_t a)
+{
+    /* Lanes above pi / 2 in magnitude fold to +-pi - a: (a ^ m) + 0x8001 */
+    uint32_t m = vm_sign16(a ^ (a << 1));
+    uint32_t s = vm_kdouble16(vm_add16(a ^ m, m & 0x80018001u));
+    uint32_t s2 = vm_khm16(s, s), p;
+
+    /* sin(pi s / 2) / 2 = s (k1 + k3 s^2 + k5 s^4 + k7 s^6) */
+    p = vm_kadd16(vm_khm16(vm_pack(VM_SIN_K7, VM_SIN_K7), s2), vm_pack(VM_SIN_K5, VM_SIN_K5));
+    p = vm_kadd16(vm_khm16(p, s2), vm_pack(VM_SIN_K3, VM_SIN_K3));
+    p = vm_kadd16(vm_khm16(p, s2), vm_pack(VM_SIN_K1, VM_SIN_K1));
+    return vm_mul14(p, s);
+}
+
+static void vm_sin_q15(const q15_t *src, q15_t *dst, uint32_t num, uint32_t shift)
+{
+    uint32_t i = 0;
+
+    for (; i + 2 <= num; i += 2) {
+        write_q15x2(dst + i, (q31_t)vm_sin_q15x2(vm_add16((uint32_t)read_q15x2(src + i), shift)));
+    }
+    if (i < num) {
+        dst[i] = vm_h0(vm_sin_q15x2(vm_add16((uint16_t)src[i], shift)));
+    }
+}
+
+void vmath_sin_q15(const q15_t *src, q15_t *dst, uint32_t num)
+{
+    vm_sin_q15(src, dst, num, 0);
+}
+
+void vmath_cos_q15(const q15_t *src, q15_t *dst, uint32_t num)
+{
+    /* cos(pi a) = sin(pi (a + 1 / 2)) */
+    vm_sin_q15(src, dst, num, 0x40004000u);
+}
+
+/* atan(t) / pi on both lanes, |t| <= tan(pi / 8) */
+__STATIC_FORCEINLINE uint32_t vm_atan_q15x2(uint32_t t)
+{
+    uint32_t t2 = vm_khm16(t, t), p;
+
+    p = vm_kadd16(vm_khm16(vm_pack(VM_ATAN_A5, VM_ATAN_A5), t2), vm_pack(VM_ATAN_A3, VM_ATAN_A3));
+    p = vm_kadd16(vm_khm16(p, t2), vm_pack(VM_ATAN_A1, VM_ATAN_A1));
+    return vm_khm16(p, t);
+}
+
+/* Reduced argument of atan2 like vm_atan2, the octant is kept in oct */
+__STATIC_FORCEINLINE int32_t vm_atan2_reduce(int32_t y, int32_t x, uint32_t *oct)
+{
+    int32_t ax = MIN(x < 0 ? -x : x, 0x7fff), ay = MIN(y < 0 ? -y : y, 0x7fff);
+    int32_t mn = MIN(ax, ay), mx = MAX(ax, ay), num = mn, den = mx;
+
+    *oct = (ay > ax) | (x < 0) << 1 | (y < 0) << 2;
+    if (mn << 15 > VM_TAN_PI_8_Q * mx) {
+        num = mn - mx;
+        den = mn + mx;
+        *oct |= 8;
+    }
+    return den ? num * 32768 / den : 0;
+}
+
+__STATIC_FORCEINLINE q15_t vm_atan2_unfold(int32_t a, uint32_t oct)
+{
+    if (oct & 8) {
+        a += 0x2000;
+    }
+    if (oct & 1) {
+        a = 0x4000 - a;
+    }
+    if (oct & 2) {
+        a = 0x8000 - a;
+    }
+    return (q15_t)__SSAT(oct & 4 ? -a : a, 16);
+}
+
+void vmath_atan2_q15(const q15_t *y, const q15_t *x, q15_t *dst, uint32_t num)
+{
+    uint32_t i = 0, o0, o1, a;
+
+    for (; i + 2 <= num; i += 2) {
+        int32_t t0 = vm_atan2_reduce(y[i], x[i], &o0);
+        int32_t t1 = vm_atan2_reduce(y[i + 1], x[i + 1], &o1);
+
+        a = vm_atan_q15x2(vm_pack(t0, t1));
+        dst[i]     = vm_atan2_unfold(vm_h0(a), o0);
+        dst[i + 1] = vm_atan2_unfold(vm_h1(a), o1);
+    }
+    if (i < num) {
+        a      = vm_atan_q15x2((uint16_t)vm_atan2_reduce(y[i], x[i], &o0));
+        dst[i] = vm_atan2_unfold(vm_h0(a), o0);
+    }
+}
+
+__STATIC_FORCEINLINE uint32_t vm_clz(uint32_t v)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_CLZ32(v);
+#else
+    return __builtin_clz(v);
+#endif
+}
+
+__STATIC_FORCEINLINE uint32_t vm_mulhu(uint32_t a, uint32_t b)
+{
+    return (uint32_t)(((uint64_t)a * b) >> 32);
+}
+
+/*
+ * round(sqrt(v) * 2^(16 - shift)), v > 0 and shift > 0. With v = 2^-e M
+ * and M in [1 / 4, 1) as Q32, g = sqrt(M) and h = 1 / (2 sqrt(M)) in Q31
+ * start from the table and each iteration squares their relative error
+ */
+__STATIC_FORCEINLINE uint32_t vm_sqrt(uint32_t v, uint32_t shift, uint32_t iters)
+{
+    uint32_t e = vm_clz(v) & ~1u, m = v << e, i = (m >> 26) - 16, g, h;
+    int32_t d = (int32_t)g_vm_rsqrt[i + 1] - g_vm_rsqrt[i], r;
+
+    h = ((uint32_t)g_vm_rsqrt[i] << 16) + d * (int32_t)((m >> 10) & 0xffff);
+    g = vm_mulhu(m, h) << 1;
+    for (uint32_t k = 0; k < iters; k++) {
+        /* 1 / 2 - g h in Q30 */
+        r = (int32_t)((1u << 29) - vm_mulhu(g, h));
+        g += (int32_t)(((int64_t)g * r) >> 30);
+        h += (int32_t)(((int64_t)h * r) >> 30);
+    }
+    shift += e / 2 - 1;
+    return shift ? (g + (1u << (shift - 1))) >> shift : g;
+}
+
+void vmath_sqrt_q15(const q15_t *src, q15_t *dst, uint32_t num)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        /* sqrt(x 2^15) = sqrt(x 2^17) / 2 */
+        dst[i] = src[i] > 0 ? (q15_t)MIN(vm_sqrt((uint32_t)src[i] << 17, 17, 1), 0x7fff) : 0;
+    }
+}
+
+void vmath_sqrt_q31(const q31_t *src, q31_t *dst, uint32_t num)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        /* sqrt(x 2^31) = sqrt(2 x) 2^15 */
+        dst[i] = src[i] > 0 ? (q31_t)MIN(vm_sqrt((uint32_t)src[i] << 1, 1, 2), 0x7fffffffu) : 0;
+    }
+}
+
+/* a.h0 moves to the top, b.h0 becomes the bottom */
+__STATIC_FORCEINLINE uint32_t vm_pkbb16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_PKBB16(a, b);
+#else
+    return a << 16 | (uint16_t)b;
+#endif
+}
+
+/* a.h1 stays on top, b.h1 becomes the bottom */
+__STATIC_FORCEINLINE uint32_t vm_pktt16(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_PKTT16(a, b);
+#else
+    return (a & 0xffff0000u) | b >> 16;
+#endif
+}
+
+/* a.h0^2 + a.h1^2, saturated to 2^31 - 1 on the DSP */
+__STATIC_FORCEINLINE uint32_t vm_sumsq16(uint32_t a)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KMDA(a, a);
+#else
+    return (uint32_t)(vm_h0(a) * vm_h0(a)) + (uint32_t)(vm_h1(a) * vm_h1(a));
+#endif
+}
+
+__STATIC_FORCEINLINE q15_t vm_mag_q15(uint32_t sum)
+{
+    return sum ? (q15_t)MIN(vm_sqrt(sum, 16, 1), 0x7fff) : 0;
+}
+
+void vmath_mag_q15(const q15_t *x, const q15_t *y, q15_t *dst, uint32_t num)
+{
+    uint32_t i = 0, xs, ys;
+
+    for (; i + 2 <= num; i += 2) {
+        xs = (uint32_t)read_q15x2(x + i);
+        ys = (uint32_t)read_q15x2(y + i);
+        /* (x0, y0) and (x1, y1) in one word each */
+        dst[i]     = vm_mag_q15(vm_sumsq16(vm_pkbb16(ys, xs)));
+        dst[i + 1] = vm_mag_q15(vm_sumsq16(vm_pktt16(ys, xs)));
+    }
+    if (i < num) {
+        dst[i] = vm_mag_q15(vm_sumsq16(vm_pack(x[i], y[i])));
+    }
+}
@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include "platform.h"
+#include "dsp_vmath_bench.h"
+#include "dsp_vmath.h"
+#include "shell.h"
+#include "uart_printf.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+/* Tiers of the report besides VMathPrec */
+#define VB_NONE 2 /* Fixed point, no tier */
+#define VB_BASE 3 /* Scalar riscv_dsp function */
+
+#define VB_N VMATH_BENCH_BLOCK
+
+typedef enum VbUnit {
+    VB_ULP = 0,
+    VB_ABS,
+    VB_REL,
+    VB_LSB,
+} VbUnit;
+
+typedef struct VmathBench {
+    float32_t a[VB_N];
+    float32_t b[VB_N];
+    float32_t c[VB_N];
+    float32_t out[VB_N];
+    q15_t qa[VB_N];
+    q15_t qb[VB_N];
+    q15_t qout[VB_N];
+    q31_t la[VB_N];
+    q31_t lout[VB_N];
+    uint32_t seed;
+} VmathBench;
+
+/* One line of the report, ref gives output i in the unit of the output */
+typedef struct VmathCase {
+    const char *name;
+    void (*fill)(uint32_t run);
+    void (*run)(VMathPrec prec);
+    double (*ref)(uint32_t i);
+    uint16_t runs;   /* Blocks of inputs */
+    uint8_t prec;    /* VMathPrec, VB_NONE or VB_BASE */
+    uint8_t unit;    /* VbUnit */
+    float32_t bound; /* Max error accepted, 0 to only report */
+} VmathCase;
+
+static VmathBench g_vb;
+
+/* Uniform in [-1, 1) */
+static float32_t vb_noise(void)
+{
+    g_vb.seed = g_vb.seed * 1664525 + 1013904223;
+    return (float32_t)(g_vb.seed >> 8) / 8388608.0f - 1.0f;
+}
+
+static int32_t vb_rand(uint32_t bits)
+{
+    g_vb.seed = g_vb.seed * 1664525 + 1013904223;
+    return (int32_t)g_vb.seed >> (32 - bits);
+}
+
+/* Random magnitude over 2^-range to 2^range */
+static float32_t vb_wide(float32_t range)
+{
+    return (float32_t)exp2(vb_noise() * range);
+}
+
+static void vb_fill_angle(uint32_t run)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        /* Every fourth one near a zero of sin or cos, one in 16 large */
+        g_vb.a[i] = i & 3    ? 400.0f * vb_noise()
+                    : i & 15 ? (float32_t)(vb_rand(8) * (PI_F64 / 2)) + 1e-5f * vb_noise()
+                             : vb_wide(26.0f) * vb_noise();
+    }
+}
+
+static void vb_fill_pair(uint32_t run)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        float32_t s = vb_wide(20.0f);
+
+        g_vb.a[i] = s * vb_noise();
+        g_vb.b[i] = (i & 7 ? s : s * vb_wide(20.0f)) * vb_noise();
+        g_vb.c[i] = s * vb_noise();
+    }
+}
+
+static void vb_fill_log(uint32_t run)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        /* Every fourth one near 1 */
+        g_vb.a[i] = i & 3 ? vb_wide(100.0f) : 1.0f + 0.01f * vb_noise();
+    }
+}
+
+static void vb_fill_exp(uint32_t run)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        g_vb.a[i] = i & 3 ? 87.0f * vb_noise() : 0.01f * vb_noise();
+    }
+}
+
+/* All q15 values, VB_N per run */
+static void vb_fill_q15_all(uint32_t run)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        g_vb.qa[i] = (q15_t)(run * VB_N + i);
+    }
+}
+
+static void vb_fill_q15_pair(uint32_t run)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        uint32_t bits = 4 + (run + i) % 13;
+
+        g_vb.qa[i] = (q15_t)vb_rand(bits);
+        g_vb.qb[i] = (q15_t)vb_rand(bits);
+    }
+}
+
+static void vb_fill_q31(uint32_t run)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        g_vb.la[i] = (q31_t)((uint32_t)vb_rand(32) >> (1 + (run + i) % 31));
+    }
+}
+
+static void vb_sin(VMathPrec prec)
+{
+    vmath_sin_f32(g_vb.a, g_vb.out, VB_N, prec);
+}
+
+static void vb_cos(VMathPrec prec)
+{
+    vmath_cos_f32(g_vb.a, g_vb.out, VB_N, prec);
+}
+
+static void vb_atan2(VMathPrec prec)
+{
+    vmath_atan2_f32(g_vb.a, g_vb.b, g_vb.out, VB_N, prec);
+}
+
+static void vb_log2(VMathPrec prec)
+{
+    vmath_log2_f32(g_vb.a, g_vb.out, VB_N, prec);
+}
+
+static void vb_exp(VMathPrec prec)
+{
+    vmath_exp_f32(g_vb.a, g_vb.out, VB_N, prec);
+}
+
+static void vb_sqrt(VMathPrec prec)
+{
+    vmath_sqrt_f32(g_vb.c, g_vb.out, VB_N);
+}
+
+static void vb_mag(VMathPrec prec)
+{
+    vmath_mag_f32(g_vb.a, g_vb.b, g_vb.c, g_vb.out, VB_N);
+}
+
+static void vb_sin_q15(VMathPrec prec)
+{
+    vmath_sin_q15(g_vb.qa, g_vb.qout, VB_N);
+}
+
+static void vb_cos_q15(VMathPrec prec)
+{
+    vmath_cos_q15(g_vb.qa, g_vb.qout, VB_N);
+}
+
+static void vb_atan2_q15(VMathPrec prec)
+{
+    vmath_atan2_q15(g_vb.qa, g_vb.qb, g_vb.qout, VB_N);
+}
+
+static void vb_sqrt_q15(VMathPrec prec)
+{
+    vmath_sqrt_q15(g_vb.qa, g_vb.qout, VB_N);
+}
+
+static void vb_sqrt_q31(VMathPrec prec)
+{
+    vmath_sqrt_q31(g_vb.la, g_vb.lout, VB_N);
+}
+
+static void vb_mag_q15(VMathPrec prec)
+{
+    vmath_mag_q15(g_vb.qa, g_vb.qb, g_vb.qout, VB_N);
+}
+
+static void vb_base_sin(VMathPrec prec)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        g_vb.out[i] = riscv_sin_f32(g_vb.a[i]);
+    }
+}
+
+static void vb_base_atan2(VMathPrec prec)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        riscv_atan2_f32(g_vb.a[i], g_vb.b[i], &g_vb.out[i]);
+    }
+}
+
+static void vb_base_log(VMathPrec prec)
+{
+    riscv_vlog_f32(g_vb.a, g_vb.out, VB_N);
+}
+
+static void vb_base_exp(VMathPrec prec)
+{
+    riscv_vexp_f32(g_vb.a, g_vb.out, VB_N);
+}
+
+static void vb_base_sqrt_q15(VMathPrec prec)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        riscv_sqrt_q15(g_vb.qa[i], &g_vb.qout[i]);
+    }
+}
+
+static void vb_base_sqrt_q31(VMathPrec prec)
+{
+    uint32_t i;
+
+    for (i = 0; i < VB_N; i++) {
+        riscv_sqrt_q31(g_vb.la[i], &g_vb.lout[i]);
+    }
+}
+
+/* Fixed point references in LSB, saturated like the outputs */
+static double vb_lsb(double v, double scale)
+{
+    v *= scale;
+    return v > scale - 1.0 ? scale - 1.0 : (v < -scale ? -scale : v);
+}
+
+static double vb_ref_sin(uint32_t i)
+{
+    return sin(g_vb.a[i]);
+}
+
+static double vb_ref_cos(uint32_t i)
+{
+    return cos(g_vb.a[i]);
+}
+
+static double vb_ref_atan2(uint32_t i)
+{
+    return atan2(g_vb.a[i], g_vb.b[i]);
+}
+
+static double vb_ref_log2(uint32_t i)
+{
+    return log2(g_vb.a[i]);
+}
+
+static double vb_ref_log(uint32_t i)
+{
+    return log(g_vb.a[i]);
+}
+
+static double vb_ref_exp(uint32_t i)
+{
+    return exp(g_vb.a[i]);
+}
+
+static double vb_ref_sqrt(uint32_t i)
+{
+    return g_vb.c[i] > 0.0f ? sqrt(g_vb.c[i]) : 0.0;
+}
+
+static double vb_ref_mag(uint32_t i)
+{
+    double x = g_vb.a[i], y = g_vb.b[i], z = g_vb.c[i];
+
+    return sqrt(x * x + y * y + z * z);
+}
+
+static double vb_ref_sin_q15(uint32_t i)
+{
+    return vb_lsb(sin(g_vb.qa[i] * (PI_F64 / 32768)), 32768.0);
+}
+
+static double vb_ref_cos_q15(uint32_t i)
+{
+    return vb_lsb(cos(g_vb.qa[i] * (PI_F64 / 32768)), 32768.0);
+}
+
+static double vb_ref_atan2_q15(uint32_t i)
+{
+    return vb_lsb(atan2(g_vb.qa[i], g_vb.qb[i]) / PI_F64, 32768.0);
+}
+
+static double vb_ref_sqrt_q15(uint32_t i)
+{
+    return g_vb.qa[i] > 0 ? vb_lsb(sqrt(g_vb.qa[i] / 32768.0), 32768.0) : 0.0;
+}
+
+static double vb_ref_sqrt_q31(uint32_t i)
+{
+    return vb_lsb(sqrt(g_vb.la[i] / 2147483648.0), 2147483648.0);
+}
+
+static double vb_ref_mag_q15(uint32_t i)
+{
+    double x = g_vb.qa[i], y = g_vb.qb[i];
+
+    return vb_lsb(sqrt(x * x + y * y) / 32768.0, 32768.0);
+}
+
+/* Float ulp at v, subnormals included */
+static double vb_ulp(double v)
+{
+    int e;
+
+    frexp(v, &e);
+    return ldexp(1.0, MAX(e, -125) - 24);
+}
+
+/* Bounds are the errors documented in dsp_vmath.h */
+static const VmathCase g_vb_cases[] = {
+    {"sin_f32", vb_fill_angle, vb_sin, vb_ref_sin, 64, VMATH_FAST, VB_ABS, 4e-7f},
+    {"sin_f32", vb_fill_angle, vb_sin, vb_ref_sin, 64, VMATH_PRECISE, VB_ABS, 6e-8f},
+    {"riscv_sin_f32", vb_fill_angle, vb_base_sin, vb_ref_sin, 64, VB_BASE, VB_ABS, 0.0f},
+    {"cos_f32", vb_fill_angle, vb_cos, vb_ref_cos, 64, VMATH_FAST, VB_ABS, 4e-7f},
+    {"cos_f32", vb_fill_angle, vb_cos, vb_ref_cos, 64, VMATH_PRECISE, VB_ABS, 6e-8f},
+    {"atan2_f32", vb_fill_pair, vb_atan2, vb_ref_atan2, 64, VMATH_FAST, VB_REL, 2e-5f},
+    {"atan2_f32", vb_fill_pair, vb_atan2, vb_ref_atan2, 64, VMATH_PRECISE, VB_ULP, 3.0f},
+    {"riscv_atan2_f32", vb_fill_pair, vb_base_atan2, vb_ref_atan2, 64, VB_BASE, VB_ULP, 0.0f},
+    {"log2_f32", vb_fill_log, vb_log2, vb_ref_log2, 64, VMATH_FAST, VB_REL, 1.5e-4f},
+    {"log2_f32", vb_fill_log, vb_log2, vb_ref_log2, 64, VMATH_PRECISE, VB_ULP, 3.0f},
+    {"riscv_vlog_f32", vb_fill_log, vb_base_log, vb_ref_log, 64, VB_BASE, VB_ULP, 0.0f},
+    {"exp_f32", vb_fill_exp, vb_exp, vb_ref_exp, 64, VMATH_FAST, VB_REL, 7e-5f},
+    {"exp_f32", vb_fill_exp, vb_exp, vb_ref_exp, 64, VMATH_PRECISE, VB_ULP, 2.0f},
+    {"riscv_vexp_f32", vb_fill_exp, vb_base_exp, vb_ref_exp, 64, VB_BASE, VB_ULP, 0.0f},
+    {"sqrt_f32", vb_fill_pair, vb_sqrt, vb_ref_sqrt, 16, VB_NONE, VB_ULP, 0.5f},
+    {"mag_f32", vb_fill_pair, vb_mag, vb_ref_mag, 16, VB_NONE, VB_ULP, 2.0f},
+    {"sin_q15", vb_fill_q15_all, vb_sin_q15, vb_ref_sin_q15, 65536 / VB_N, VB_NONE, VB_LSB, 3.5f},
+    {"cos_q15", vb_fill_q15_all, vb_cos_q15, vb_ref_cos_q15, 65536 / VB_N, VB_NONE, VB_LSB, 3.5f},
+    {"atan2_q15", vb_fill_q15_pair, vb_atan2_q15, vb_ref_atan2_q15, 64, VB_NONE, VB_LSB, 2.0f},
+    {"sqrt_q15", vb_fill_q15_all, vb_sqrt_q15, vb_ref_sqrt_q15, 32768 / VB_N, VB_NONE, VB_LSB, 1.0f},
+    {"riscv_sqrt_q15", vb_fill_q15_all, vb_base_sqrt_q15, vb_ref_sqrt_q15, 32768 / VB_N, VB_BASE,
+     VB_LSB, 0.0f},
+    {"sqrt_q31", vb_fill_q31, vb_sqrt_q31, vb_ref_sqrt_q31, 64, VB_NONE, VB_LSB, 3.0f},
+    {"riscv_sqrt_q31", vb_fill_q31, vb_base_sqrt_q31, vb_ref_sqrt_q31, 64, VB_BASE, VB_LSB, 0.0f},
+    {"mag_q15", vb_fill_q15_pair, vb_mag_q15, vb_ref_mag_q15, 64, VB_NONE, VB_LSB, 1.0f},
+};
+
+/* Error of output i in the unit of the case */
+static double vb_error(const VmathCase *vc, uint32_t i)
+{
+    double ref = vc->ref(i), out;
+
+    if (vc->unit == VB_LSB) {
+        out = vc->run == vb_sqrt_q31 || vc->run == vb_base_sqrt_q31 ? g_vb.lout[i] : g_vb.qout[i];
+        return fabs(out - ref);
+    }
+    out = g_vb.out[i];
+    if (out == ref || (isnan(out) && isnan(ref))) {
+        return 0.0;
+    }
+    switch (vc->unit) {
+    case VB_ULP:
+        return fabs(out - ref) / vb_ulp(ref);
+    case VB_ABS:
+        return fabs(out - ref);
+    default:
+        return fabs(out - ref) / fabs(ref);
+    }
+}
+
+/* Tenths of v, clamped for printing */
+static uint32_t vb_tenths(double v)
+{
+    return (uint32_t)MIN(v * 10.0 + 0.5, 4e9);
+}
+
+int dsp_vmath_bench_check(void)
+{
+    uint32_t k, run, i;
+
+    static const char *const tiers[] = {"fast", "precise", "", "riscv"};
+    static const char *const units[] = {"ulp", "e-9", "e-9 rel", "lsb"};
+    int ret = VPI_SUCCESS;
+    uint32_t err, cyc;
+
+    uart_printf("%-16s %-7s %12s %-7s %8s\r\n", "function", "tier", "max err", "unit",
+                "cyc/smp");
+    for (k = 0; k < ARRAY_SIZE(g_vb_cases); k++) {
+        const VmathCase *vc = &g_vb_cases[k];
+        double worst = 0.0, scale = vc->unit == VB_ABS || vc->unit == VB_REL ? 1e9 : 1.0;
+        uint64_t cycles = 0, start;
+        bool fail;
+
+        g_vb.seed = 1;
+        for (run = 0; run < vc->runs; run++) {
+            vc->fill(run);
+            start = __get_rv_cycle();
+            vc->run((VMathPrec)vc->prec);
+            cycles += __get_rv_cycle() - start;
+            for (i = 0; i < VB_N; i++) {
+                worst = MAX(worst, vb_error(vc, i));
+            }
+        }
+        fail = vc->bound > 0.0f && !(worst <= vc->bound);
+        err  = vb_tenths(worst * scale);
+        cyc  = vb_tenths((double)cycles / (vc->runs * VB_N));
+        uart_printf("%-16s %-7s %10u.%u %-7s %6u.%u%s\r\n", vc->name, tiers[vc->prec],
+                    (unsigned int)(err / 10), (unsigned int)(err % 10), units[vc->unit],
+                    (unsigned int)(cyc / 10), (unsigned int)(cyc % 10), fail ? " over bound" : "");
+        if (fail) {
+            ret = VPI_ERR_BAD_DATA;
+        }
+    }
+    return ret;
+}
+
+static int vb_cmd(int argc, char *argv[])
+{
+    return dsp_vmath_bench_check();
+}
+
+static const ShellCmd g_vb_cmd = {"vmath", "errors and cycles of dsp_vmath", vb_cmd};
+
+int dsp_vmath_bench_init(void)
+{
+    return shell_add_cmd(&g_vb_cmd);
+}
+
+#if CONFIG_SHELL && CONFIG_DSP_VMATH_BENCH
+SHELL_BENCH_BOOT(dsp_vmath_bench_boot, 93, dsp_vmath_bench_check(), dsp_vmath_bench_init);
+#endif
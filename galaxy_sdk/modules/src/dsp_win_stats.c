@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "dsp_win_stats.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+#include "osal_heap_api.h"
+
+/* q31 squares are taken on 23 bits so that 65535 of them fit in int64_t */
+#define WIN_Q31_SQ_SHIFT 8
+
+static bool ws_cfg_valid(const WinStatsCfg *cfg)
+{
+    return cfg->len >= 2 && cfg->len <= WIN_STATS_LEN_MAX && cfg->format <= WIN_STATS_F32 &&
+           !(cfg->flags & ~(WIN_STATS_MINMAX | WIN_STATS_MEDIAN));
+}
+
+uint32_t win_stats_mem_size(const WinStatsCfg *cfg)
+{
+    uint32_t size;
+
+    if (!cfg || !ws_cfg_valid(cfg)) {
+        return 0;
+    }
+    size = cfg->len * sizeof(int32_t);
+    if (cfg->flags & WIN_STATS_MINMAX) {
+        size += 2 * cfg->len * sizeof(uint16_t);
+    }
+    if (cfg->flags & WIN_STATS_MEDIAN) {
+        size += 2 * cfg->len * sizeof(uint16_t);
+    }
+    return size;
+}
+
+int win_stats_init(WinStats *ws, const WinStatsCfg *cfg)
+{
+    uint32_t size = cfg ? win_stats_mem_size(cfg) : 0;
+    uint16_t *idx;
+
+    if (!ws || !size) {
+        return VPI_ERR_INVALID;
+    }
+    memset(ws, 0, sizeof(*ws));
+    ws->cfg    = *cfg;
+    ws->ring.i = osal_malloc(size);
+    if (!ws->ring.i) {
+        return VPI_ERR_NOMEM;
+    }
+    idx = (uint16_t *)&ws->ring.i[cfg->len];
+    if (cfg->flags & WIN_STATS_MINMAX) {
+        ws->min.slot = idx;
+        ws->max.slot = idx + cfg->len;
+        idx         += 2 * cfg->len;
+    }
+    if (cfg->flags & WIN_STATS_MEDIAN) {
+        ws->heap = idx;
+        ws->pos  = idx + cfg->len;
+    }
+    win_stats_reset(ws);
+    return VPI_SUCCESS;
+}
+
+void win_stats_deinit(WinStats *ws)
+{
+    if (ws && ws->ring.i) {
+        osal_free(ws->ring.i);
+        ws->ring.i = NULL;
+    }
+}
+
+void win_stats_reset(WinStats *ws)
+{
+    if (!ws) {
+        return;
+    }
+    ws->wr       = 0;
+    ws->count    = 0;
+    memset(&ws->acc, 0, sizeof(ws->acc));
+    ws->min.num  = 0;
+    ws->max.num  = 0;
+    ws->low_num  = 0;
+    ws->high_num = 0;
+}
+
+static inline bool ws_less(const WinStats *ws, uint16_t a, uint16_t b)
+{
+    if (ws->cfg.format == WIN_STATS_F32) {
+        return ws->ring.f[a] < ws->ring.f[b];
+    }
+    return ws->ring.i[a] < ws->ring.i[b];
+}
+
+/* Monotonic deque, the front is the min (or max) of the window */
+static void ws_deque_push(const WinStats *ws, WinStatsDeque *dq, uint16_t slot, bool max)
+{
+    uint32_t len = ws->cfg.len;
+    uint16_t back;
+
+    /* The slot being overwritten is the oldest sample, only the front can hold it */
+    if (dq->num && dq->slot[dq->head] == slot && ws->count == len) {
+        dq->head = (dq->head + 1) % len;
+        dq->num--;
+    }
+    while (dq->num) {
+        back = dq->slot[(dq->head + dq->num - 1) % len];
+        if (max ? ws_less(ws, slot, back) : ws_less(ws, back, slot)) {
+            break;
+        }
+        dq->num--;
+    }
+    dq->slot[(dq->head + dq->num) % len] = slot;
+    dq->num++;
+}
+
+/*
+ * Median heaps share one array: the low max heap from 0, the high min heap
+ * from (len + 1) / 2. pos gives the array index of each ring slot
+ */
+static inline uint32_t ws_high_base(const WinStats *ws)
+{
+    return (ws->cfg.len + 1) / 2;
+}
+
+static inline bool ws_heap_before(const WinStats *ws, uint16_t a, uint16_t b, bool low)
+{
+    return low ? ws_less(ws, b, a) : ws_less(ws, a, b);
+}
+
+static inline void ws_heap_set(WinStats *ws, uint32_t idx, uint16_t slot)
+{
+    ws->heap[idx] = slot;
+    ws->pos[slot] = (uint16_t)idx;
+}
+
+static void ws_heap_sift(WinStats *ws, uint32_t i, bool low)
+{
+    uint32_t base = low ? 0 : ws_high_base(ws);
+    uint32_t num  = low ? ws->low_num : ws->high_num;
+    uint16_t slot = ws->heap[base + i];
+    uint32_t child;
+
+    while (i && ws_heap_before(ws, slot, ws->heap[base + (i - 1) / 2], low)) {
+        ws_heap_set(ws, base + i, ws->heap[base + (i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    while ((child = 2 * i + 1) < num) {
+        if (child + 1 < num &&
+            ws_heap_before(ws, ws->heap[base + child + 1], ws->heap[base + child], low)) {
+            child++;
+        }
+        if (!ws_heap_before(ws, ws->heap[base + child], slot, low)) {
+            break;
+        }
+        ws_heap_set(ws, base + i, ws->heap[base + child]);
+        i = child;
+    }
+    ws_heap_set(ws, base + i, slot);
+}
+
+/* Keep every low sample below every high sample, one swap of the tops is enough */
+static void ws_heap_cross(WinStats *ws)
+{
+    uint32_t high = ws_high_base(ws);
+    uint16_t top;
+
+    if (!ws->low_num || !ws->high_num || !ws_less(ws, ws->heap[high], ws->heap[0])) {
+        return;
+    }
+    top = ws->heap[0];
+    ws_heap_set(ws, 0, ws->heap[high]);
+    ws_heap_set(ws, high, top);
+    ws_heap_sift(ws, 0, true);
+    ws_heap_sift(ws, 0, false);
+}
+
+static void ws_median_push(WinStats *ws, uint16_t slot)
+{
+    uint32_t high = ws_high_base(ws);
+    bool low;
+
+    if (ws->count == ws->cfg.len) {
+        /* The new sample takes the heap node of the one it replaces */
+        low = ws->pos[slot] < high;
+        ws_heap_sift(ws, ws->pos[slot] - (low ? 0 : high), low);
+    } else if (ws->low_num == ws->high_num) {
+        ws_heap_set(ws, ws->low_num, slot);
+        ws_heap_sift(ws, ws->low_num++, true);
+    } else {
+        ws_heap_set(ws, high + ws->high_num, slot);
+        ws_heap_sift(ws, ws->high_num++, false);
+    }
+    ws_heap_cross(ws);
+}
+
+static void ws_order_push(WinStats *ws, uint16_t slot)
+{
+    if (ws->cfg.flags & WIN_STATS_MINMAX) {
+        ws_deque_push(ws, &ws->min, slot, false);
+        ws_deque_push(ws, &ws->max, slot, true);
+    }
+    if (ws->cfg.flags & WIN_STATS_MEDIAN) {
+        ws_median_push(ws, slot);
+    }
+}
+
+static inline int64_t ws_square(const WinStats *ws, int32_t v)
+{
+    if (ws->cfg.format == WIN_STATS_Q31) {
+        v >>= WIN_Q31_SQ_SHIFT;
+    }
+    return (int64_t)v * v;
+}
+
+static void ws_push_int(WinStats *ws, int32_t v)
+{
+    uint16_t slot = (uint16_t)ws->wr;
+    int32_t old;
+
+    if (ws->count == ws->cfg.len) {
+        old               = ws->ring.i[slot];
+        ws->acc.i.sum    -= old;
+        ws->acc.i.sumsq  -= ws_square(ws, old);
+    }
+    ws->ring.i[slot]  = v;
+    ws->acc.i.sum    += v;
+    ws->acc.i.sumsq  += ws_square(ws, v);
+    ws_order_push(ws, slot);
+    ws->wr    = ws->wr + 1 == ws->cfg.len ? 0 : ws->wr + 1;
+    ws->count = MIN(ws->count + 1, ws->cfg.len);
+}
+
+static void ws_push_float(WinStats *ws, float32_t v)
+{
+    uint16_t slot = (uint16_t)ws->wr;
+    float32_t old, sum, sumsq;
+    uint32_t i;
+
+    if (ws->count == ws->cfg.len) {
+        old               = ws->ring.f[slot];
+        ws->acc.f.sum    -= old;
+        ws->acc.f.sumsq  -= old * old;
+    }
+    ws->ring.f[slot]  = v;
+    ws->acc.f.sum    += v;
+    ws->acc.f.sumsq  += v * v;
+    ws_order_push(ws, slot);
+    ws->wr    = ws->wr + 1 == ws->cfg.len ? 0 : ws->wr + 1;
+    ws->count = MIN(ws->count + 1, ws->cfg.len);
+
+    /* Rounding of the running sums drifts, rebuild them once per window */
+    if (++ws->acc.f.since >= ws->cfg.len) {
+        sum   = 0.0f;
+        sumsq = 0.0f;
+        for (i = 0; i < ws->count; i++) {
+            sum   += ws->ring.f[i];
+            sumsq += ws->ring.f[i] * ws->ring.f[i];
+        }
+        ws->acc.f.sum   = sum;
+        ws->acc.f.sumsq = sumsq;
+        ws->acc.f.since = 0;
+    }
+}
+
+int win_stats_push_q15(WinStats *ws, const q15_t *in, uint32_t len)
+{
+    uint32_t i;
+
+    if (!ws || !ws->ring.i || ws->cfg.format != WIN_STATS_Q15 || (!in && len)) {
+        return VPI_ERR_INVALID;
+    }
+    for (i = 0; i < len; i++) {
+        ws_push_int(ws, in[i]);
+    }
+    return VPI_SUCCESS;
+}
+
+int win_stats_push_q31(WinStats *ws, const q31_t *in, uint32_t len)
+{
+    uint32_t i;
+
+    if (!ws || !ws->ring.i || ws->cfg.format != WIN_STATS_Q31 || (!in && len)) {
+        return VPI_ERR_INVALID;
+    }
+    for (i = 0; i < len; i++) {
+        ws_push_int(ws, in[i]);
+    }
+    return VPI_SUCCESS;
+}
+
+int win_stats_push_f32(WinStats *ws, const float32_t *in, uint32_t len)
+{
+    uint32_t i;
+
+    if (!ws || !ws->ring.f || ws->cfg.format != WIN_STATS_F32 || (!in && len)) {
+        return VPI_ERR_INVALID;
+    }
+    for (i = 0; i < len; i++) {
+        ws_push_float(ws, in[i]);
+    }
+    return VPI_SUCCESS;
+}
+
+static int ws_check(const WinStats *ws, const void *out, uint8_t format)
+{
+    if (!ws || !ws->ring.i || !out || ws->cfg.format != format) {
+        return VPI_ERR_INVALID;
+    }
+    return ws->count ? VPI_SUCCESS : VPI_ERR_NOT_READY;
+}
+
+/* Ring slots of min, max and the two middle samples, the last two equal for odd counts */
+static void ws_order_slots(const WinStats *ws, uint16_t slot[4])
+{
+    memset(slot, 0, 4 * sizeof(uint16_t));
+    if (ws->cfg.flags & WIN_STATS_MINMAX) {
+        slot[0] = ws->min.slot[ws->min.head];
+        slot[1] = ws->max.slot[ws->max.head];
+    }
+    if (ws->cfg.flags & WIN_STATS_MEDIAN) {
+        slot[2] = ws->heap[0];
+        slot[3] = ws->high_num < ws->low_num ? slot[2] : ws->heap[ws_high_base(ws)];
+    }
+}
+
+static inline int64_t ws_sat(int64_t v, int64_t lo, int64_t hi)
+{
+    return MAX(MIN(v, hi), lo);
+}
+
+int win_stats_get_q15(const WinStats *ws, WinStatsQ15 *out)
+{
+    int ret = ws_check(ws, out, WIN_STATS_Q15);
+    int64_t n, sum, sumsq;
+    uint16_t slot[4];
+
+    if (ret != VPI_SUCCESS) {
+        return ret;
+    }
+    n          = ws->count;
+    sum        = ws->acc.i.sum;
+    sumsq      = ws->acc.i.sumsq;
+    out->count = ws->count;
+    out->mean  = (q15_t)(sum / n);
+    /* Exact in q30: n * sumsq and sum * sum stay below 2^62 */
+    out->var = n > 1 ? (q15_t)ws_sat(((n * sumsq - sum * sum) / (n * (n - 1))) >> 15, 0, INT16_MAX)
+                     : 0;
+    riscv_sqrt_q15((q15_t)ws_sat((sumsq / n) >> 15, 0, INT16_MAX), &out->rms);
+
+    ws_order_slots(ws, slot);
+    out->min    = 0;
+    out->max    = 0;
+    out->median = 0;
+    if (ws->cfg.flags & WIN_STATS_MINMAX) {
+        out->min = (q15_t)ws->ring.i[slot[0]];
+        out->max = (q15_t)ws->ring.i[slot[1]];
+    }
+    if (ws->cfg.flags & WIN_STATS_MEDIAN) {
+        out->median = (q15_t)((ws->ring.i[slot[2]] + ws->ring.i[slot[3]]) >> 1);
+    }
+    return VPI_SUCCESS;
+}
+
+int win_stats_get_q31(const WinStats *ws, WinStatsQ31 *out)
+{
+    int ret = ws_check(ws, out, WIN_STATS_Q31);
+    int64_t n, sum, sumsq, mean, var;
+    uint16_t slot[4];
+
+    if (ret != VPI_SUCCESS) {
+        return ret;
+    }
+    n          = ws->count;
+    sum        = ws->acc.i.sum;
+    sumsq      = ws->acc.i.sumsq;
+    mean       = sum / n;
+    out->count = ws->count;
+    out->mean  = (q31_t)mean;
+    /* Squares are in q46, n * mean^2 is taken as sum * mean on 23 bits each */
+    var = sumsq - (sum >> WIN_Q31_SQ_SHIFT) * (mean >> WIN_Q31_SQ_SHIFT);
+    out->var = n > 1 ? (q31_t)ws_sat((var / (n - 1)) >> (2 * (31 - WIN_Q31_SQ_SHIFT) - 31), 0,
+                                     INT32_MAX)
+                     : 0;
+    riscv_sqrt_q31((q31_t)ws_sat((sumsq / n) >> (2 * (31 - WIN_Q31_SQ_SHIFT) - 31), 0, INT32_MAX),
+                   &out->rms);
+
+    ws_order_slots(ws, slot);
+    out->min    = 0;
+    out->max    = 0;
+    out->median = 0;
+    if (ws->cfg.flags & WIN_STATS_MINMAX) {
+        out->min = ws->ring.i[slot[0]];
+        out->max = ws->ring.i[slot[1]];
+    }
+    if (ws->cfg.flags & WIN_STATS_MEDIAN) {
+        out->median = (q31_t)(((int64_t)ws->ring.i[slot[2]] + ws->ring.i[slot[3]]) >> 1);
+    }
+    return VPI_SUCCESS;
+}
+
+int win_stats_get_f32(const WinStats *ws, WinStatsF32 *out)
+{
+    int ret = ws_check(ws, out, WIN_STATS_F32);
+    float32_t n, var;
+    uint16_t slot[4];
+
+    if (ret != VPI_SUCCESS) {
+        return ret;
+    }
+    n          = (float32_t)ws->count;
+    out->count = ws->count;
+    out->mean  = ws->acc.f.sum / n;
+    var        = ws->count > 1 ? (ws->acc.f.sumsq - ws->acc.f.sum * out->mean) / (n - 1.0f) : 0.0f;
+    out->var   = MAX(var, 0.0f);
+    riscv_sqrt_f32(MAX(ws->acc.f.sumsq / n, 0.0f), &out->rms);
+
+    ws_order_slots(ws, slot);
+    out->min    = 0.0f;
+    out->max    = 0.0f;
+    out->median = 0.0f;
+    if (ws->cfg.flags & WIN_STATS_MINMAX) {
+        out->min = ws->ring.f[slot[0]];
+        out->max = ws->ring.f[slot[1]];
+    }
+    if (ws->cfg.flags & WIN_STATS_MEDIAN) {
+        out->median = 0.5f * (ws->ring.f[slot[2]] + ws->ring.f[slot[3]]);
+    }
+    return VPI_SUCCESS;
+}
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "gpio_capture.h"
+#include "vsd_error.h"
+#include "hal_common.h"
+#include "vpi_sw_timer.h"
+#include "soc_sysctl.h"
+#include "platform.h"
+#include "osal_heap_api.h"
+#include "osal_semaphore_api.h"
+
+enum GpioCaptureState {
+    CAPTURE_PIN_UNUSED,
+    CAPTURE_PIN_STABLE,
+    CAPTURE_PIN_BOUNCING,
+};
+
+typedef struct GpioCapturePin {
+    const GpioPort *gpio;
+    uint64_t first_edge; /* SysTimer ticks of the first edge of a bounce */
+    uint64_t deadline;   /* SysTimer ticks when the level is considered stable */
+    uint32_t debounce;   /* Debounce time in SysTimer ticks */
+    volatile uint8_t state;
+    uint8_t level; /* Last reported level */
+} GpioCapturePin;
+
+typedef struct GpioCaptureRaw {
+    uint64_t ticks;
+    uint8_t group;
+    uint8_t port;
+    uint8_t level;
+} GpioCaptureRaw;
+
+typedef struct GpioCaptureCtx {
+    GpioCapturePin pins[GPIO_CAPTURE_PIN_MAX];
+    GpioCaptureRaw *queue;
+    uint32_t queue_len;
+    uint32_t batch;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t lost;
+    uint32_t bouncing;
+    bool timer_on;
+    void *timer;
+    OsalSemaphore sem;
+} GpioCaptureCtx;
+
+static GpioCaptureCtx *g_capture;
+
+static inline uint32_t capture_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void capture_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+static uint8_t capture_level(const GpioPort *gpio)
+{
+    uint32_t value = 0;
+
+    hal_gpio_input_get(gpio, &value);
+    return value ? 1 : 0;
+}
+
+/* Must be called with interrupts masked, returns true if the reader should wake up */
+static bool capture_push(GpioCaptureCtx *ctx, const GpioPort *gpio, uint8_t level,
+                         uint64_t ticks)
+{
+    GpioCaptureRaw *raw;
+    uint32_t next = (ctx->head + 1) % ctx->queue_len;
+
+    if (next == ctx->tail) {
+        ctx->lost++;
+        return false;
+    }
+    raw        = &ctx->queue[ctx->head];
+    raw->ticks = ticks;
+    raw->group = gpio->group;
+    raw->port  = gpio->port;
+    raw->level = level;
+    ctx->head  = next;
+    return ((ctx->head + ctx->queue_len - ctx->tail) % ctx->queue_len) >= ctx->batch;
+}
+
+DRV_ISR_SECTION
+static void capture_isr(void *arg, uint8_t port)
+{
+    GpioCapturePin *pin = (GpioCapturePin *)arg;
+    GpioCaptureCtx *ctx = g_capture;
+    uint64_t ticks      = SysTimer_GetLoadValue();
+    bool wake           = false;
+    bool start          = false;
+    uint32_t mie;
+
+    (void)port;
+    mie = capture_lock();
+    if (!pin->debounce) {
+        wake = capture_push(ctx, pin->gpio, capture_level(pin->gpio), ticks);
+    } else {
+        if (pin->state != CAPTURE_PIN_BOUNCING) {
+            pin->state      = CAPTURE_PIN_BOUNCING;
+            pin->first_edge = ticks;
+            ctx->bouncing++;
+        }
+        /* Every edge restarts the stable window */
+        pin->deadline = ticks + pin->debounce;
+        if (!ctx->timer_on) {
+            ctx->timer_on = true;
+            start         = true;
+        }
+    }
+    capture_unlock(mie);
+
+    if (wake) {
+        osal_sem_post_isr(&ctx->sem);
+    }
+    if (start) {
+        vpi_timer_start_from_isr(ctx->timer);
+    }
+}
+
+/* One timer serves the debounce of all pins, it only runs while a pin bounces */
+static void capture_debounce(void *self)
+{
+    GpioCaptureCtx *ctx = g_capture;
+    GpioCapturePin *pin;
+    uint64_t now = SysTimer_GetLoadValue();
+    bool wake    = false;
+    bool stop, restart;
+    uint32_t mie, i;
+    uint8_t level;
+
+    (void)self;
+    for (i = 0; i < GPIO_CAPTURE_PIN_MAX; i++) {
+        pin = &ctx->pins[i];
+        if (pin->state != CAPTURE_PIN_BOUNCING || (int64_t)(now - pin->deadline) < 0) {
+            continue;
+        }
+        level = capture_level(pin->gpio);
+        mie   = capture_lock();
+        if (pin->state == CAPTURE_PIN_BOUNCING && (int64_t)(now - pin->deadline) >= 0) {
+            pin->state = CAPTURE_PIN_STABLE;
+            ctx->bouncing--;
+            if (level != pin->level) {
+                pin->level = level;
+                wake |= capture_push(ctx, pin->gpio, level, pin->first_edge);
+            }
+        }
+        capture_unlock(mie);
+    }
+
+    mie  = capture_lock();
+    stop = !ctx->bouncing;
+    capture_unlock(mie);
+
+    /*
+     * Stop before clearing timer_on, an edge that starts the timer in between
+     * would be stopped here. An edge after the stop is seen by the re-check
+     */
+    if (stop) {
+        vpi_timer_stop(ctx->timer, 0);
+        mie           = capture_lock();
+        restart       = ctx->bouncing != 0;
+        ctx->timer_on = restart;
+        capture_unlock(mie);
+        if (restart) {
+            vpi_timer_start(ctx->timer, 0);
+        }
+    }
+    if (wake) {
+        osal_sem_post(&ctx->sem);
+    }
+}
+
+int gpio_capture_init(uint32_t queue_len, uint32_t batch)
+{
+    GpioCaptureCtx *ctx;
+
+    if (g_capture) {
+        return VPI_SUCCESS;
+    }
+    if (queue_len < 2 || !batch || batch >= queue_len) {
+        return VPI_ERR_INVALID;
+    }
+
+    ctx = osal_malloc(sizeof(GpioCaptureCtx));
+    if (!ctx) {
+        return VPI_ERR_NOMEM;
+    }
+    memset(ctx, 0, sizeof(GpioCaptureCtx));
+    ctx->queue     = osal_malloc(queue_len * sizeof(GpioCaptureRaw));
+    ctx->queue_len = queue_len;
+    ctx->batch     = batch;
+    if (!ctx->queue) {
+        goto err_free;
+    }
+    if (osal_create_sem(&ctx->sem) != OSAL_TRUE) {
+        goto err_free;
+    }
+    ctx->timer = vpi_timer_create("gpio_capture", VS_TIMER_SW_REPEAT, NULL, GPIO_CAPTURE_TICK_MS,
+                                  capture_debounce);
+    if (ctx->timer == INVALID_TIMER) {
+        osal_delete_sem(&ctx->sem);
+        goto err_free;
+    }
+    g_capture = ctx;
+    return VPI_SUCCESS;
+
+err_free:
+    if (ctx->queue) {
+        osal_free(ctx->queue);
+    }
+    osal_free(ctx);
+    return VPI_ERR_NOMEM;
+}
+
+int gpio_capture_add(const GpioPort *gpio, uint32_t debounce_ms)
+{
+    GpioCaptureCtx *ctx = g_capture;
+    GpioCapturePin *pin = NULL;
+    uint32_t i;
+    int ret;
+
+    if (!ctx || !gpio) {
+        return VPI_ERR_INVALID;
+    }
+
+    for (i = 0; i < GPIO_CAPTURE_PIN_MAX; i++) {
+        if (ctx->pins[i].state == CAPTURE_PIN_UNUSED) {
+            pin = &ctx->pins[i];
+            break;
+        }
+    }
+    if (!pin) {
+        return VPI_ERR_FULL;
+    }
+
+    pin->gpio     = gpio;
+    pin->debounce = (uint32_t)((uint64_t)debounce_ms * soc_rtc_clock_get_freq() / 1000);
+    pin->level    = capture_level(gpio);
+    pin->state    = CAPTURE_PIN_STABLE;
+    ret           = hal_gpio_set_pin_handler(gpio, capture_isr, pin);
+    if (ret != VSD_SUCCESS) {
+        pin->state = CAPTURE_PIN_UNUSED;
+        return vsd_to_vpi(ret);
+    }
+    return VPI_SUCCESS;
+}
+
+int gpio_capture_remove(const GpioPort *gpio)
+{
+    GpioCaptureCtx *ctx = g_capture;
+    GpioCapturePin *pin;
+    uint32_t mie, i;
+
+    if (!ctx || !gpio) {
+        return VPI_ERR_INVALID;
+    }
+
+    for (i = 0; i < GPIO_CAPTURE_PIN_MAX; i++) {
+        pin = &ctx->pins[i];
+        if (pin->state != CAPTURE_PIN_UNUSED && pin->gpio == gpio) {
+            hal_gpio_set_pin_handler(gpio, NULL, NULL);
+            mie = capture_lock();
+            if (pin->state == CAPTURE_PIN_BOUNCING) {
+                ctx->bouncing--;
+            }
+            pin->state = CAPTURE_PIN_UNUSED;
+            capture_unlock(mie);
+            return VPI_SUCCESS;
+        }
+    }
+    return VPI_ERR_NODEVICE;
+}
+
+static int capture_drain(GpioCaptureCtx *ctx, GpioCaptureEvent *evts, uint32_t max)
+{
+    GpioCaptureRaw raw;
+    uint32_t freq = soc_rtc_clock_get_freq();
+    uint32_t mie, num = 0;
+
+    while (num < max) {
+        mie = capture_lock();
+        if (ctx->head == ctx->tail) {
+            capture_unlock(mie);
+            break;
+        }
+        raw       = ctx->queue[ctx->tail];
+        ctx->tail = (ctx->tail + 1) % ctx->queue_len;
+        capture_unlock(mie);
+
+        evts[num].t_us  = raw.ticks / freq * 1000000 + (raw.ticks % freq) * 1000000 / freq;
+        evts[num].group = raw.group;
+        evts[num].port  = raw.port;
+        evts[num].level = raw.level;
+        num++;
+    }
+    return num;
+}
+
+int gpio_capture_read(GpioCaptureEvent *evts, uint32_t max, uint32_t timeout_ms)
+{
+    GpioCaptureCtx *ctx = g_capture;
+    int num;
+
+    if (!ctx || !evts || !max) {
+        return VPI_ERR_INVALID;
+    }
+
+    /* Only block when nothing is queued, a stale post just returns 0 events */
+    num = capture_drain(ctx, evts, max);
+    if (!num && timeout_ms) {
+        osal_sem_wait(&ctx->sem, timeout_ms);
+        num = capture_drain(ctx, evts, max);
+    }
+    return num;
+}
+
+uint32_t gpio_capture_get_lost(void)
+{
+    return g_capture ? g_capture->lost : 0;
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "imu_fusion.h"
+#include "mat_fixed.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+/* Initial ESKF variances, the tilt comes from one accelerometer sample */
+#define ESKF_P0_ATT  1e-2f /* rad^2 */
+#define ESKF_P0_BIAS 1e-4f /* (rad/s)^2 */
+
+/* Unit accelerometer vector of sample i, false when it is out of the gate */
+__STATIC_FORCEINLINE bool imu_acc_unit(ImuFusion *f, const ImuBatch *b, uint32_t i,
+                                       float32_t *a)
+{
+    float32_t ax = b->acc[0][i], ay = b->acc[1][i], az = b->acc[2][i];
+    float32_t n2 = ax * ax + ay * ay + az * az;
+    float32_t r  = mat_rsqrt(n2);
+
+    if (r == 0.0f) {
+        return false;
+    }
+    if (f->cfg.accel_gate > 0.0f && fabsf(n2 * r / f->cfg.gravity - 1.0f) > f->cfg.accel_gate) {
+        f->rejected++;
+        return false;
+    }
+    a[0] = ax * r;
+    a[1] = ay * r;
+    a[2] = az * r;
+    return true;
+}
+
+/* Shortest rotation taking the measured up direction to the world z axis */
+static void imu_align(float32_t *q, const float32_t *a)
+{
+    if (a[2] < -0.9999f) {
+        q[0] = 0.0f;
+        q[1] = 1.0f;
+        q[2] = q[3] = 0.0f;
+        return;
+    }
+    q[0] = 1.0f + a[2];
+    q[1] = a[1];
+    q[2] = -a[0];
+    q[3] = 0.0f;
+    quat_normalize(q);
+}
+
+/* q += (q * (0, g) / 2 - beta * grad / |grad|) * dt, the gradient of |up(q) - a|^2 */
+__STATIC_FORCEINLINE void madgwick_step(float32_t *q, const float32_t *a, const float32_t *g,
+                                        const ImuFusionCfg *cfg)
+{
+    float32_t d[4] = {
+        0.5f * (-q[1] * g[0] - q[2] * g[1] - q[3] * g[2]),
+        0.5f * (q[0] * g[0] + q[2] * g[2] - q[3] * g[1]),
+        0.5f * (q[0] * g[1] - q[1] * g[2] + q[3] * g[0]),
+        0.5f * (q[0] * g[2] + q[1] * g[1] - q[2] * g[0]),
+    };
+
+    if (a) {
+        float32_t f0 = 2.0f * (q[1] * q[3] - q[0] * q[2]) - a[0];
+        float32_t f1 = 2.0f * (q[0] * q[1] + q[2] * q[3]) - a[1];
+        float32_t f2 = 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]) - a[2];
+        float32_t s[4];
+        float32_t r;
+
+        s[0] = 2.0f * (-q[2] * f0 + q[1] * f1);
+        s[1] = 2.0f * (q[3] * f0 + q[0] * f1) - 4.0f * q[1] * f2;
+        s[2] = 2.0f * (-q[0] * f0 + q[3] * f1) - 4.0f * q[2] * f2;
+        s[3] = 2.0f * (q[1] * f0 + q[2] * f1);
+        r    = cfg->beta * mat_rsqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2] + s[3] * s[3]);
+        for (uint32_t i = 0; i < 4; i++) {
+            d[i] -= r * s[i];
+        }
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        q[i] += d[i] * cfg->dt;
+    }
+    quat_normalize(q);
+}
+
+/* Gyro corrected by kp times the tilt error, its integral is the bias */
+__STATIC_FORCEINLINE void mahony_step(float32_t *q, float32_t *bias, const float32_t *a,
+                                      const float32_t *g, const ImuFusionCfg *cfg)
+{
+    float32_t w[3] = {g[0] - bias[0], g[1] - bias[1], g[2] - bias[2]};
+
+    if (a) {
+        float32_t v[3], e[3];
+
+        quat_up(q, v);
+        e[0] = a[1] * v[2] - a[2] * v[1];
+        e[1] = a[2] * v[0] - a[0] * v[2];
+        e[2] = a[0] * v[1] - a[1] * v[0];
+        for (uint32_t i = 0; i < 3; i++) {
+            bias[i] -= cfg->ki * cfg->dt * e[i];
+            w[i] += cfg->kp * e[i];
+        }
+    }
+    quat_rotate_small(q, w[0] * cfg->dt, w[1] * cfg->dt, w[2] * cfg->dt);
+}
+
+/*
+ * Error state [attitude error, bias error] with q_true = q * (1, dtheta / 2):
+ * F = [I - [w dt]x, -I dt; 0, I], P = F * P * F^T + Q
+ */
+__STATIC_FORCEINLINE void eskf_predict(float32_t *q, const float32_t *bias, float32_t *P,
+                                       const float32_t *g, const ImuFusionCfg *cfg)
+{
+    float32_t dt    = cfg->dt;
+    float32_t t[3]  = {(g[0] - bias[0]) * dt, (g[1] - bias[1]) * dt, (g[2] - bias[2]) * dt};
+    float32_t F[36] = {
+        1.0f,  t[2],  -t[1], -dt,  0.0f, 0.0f,
+        -t[2], 1.0f,  t[0],  0.0f, -dt,  0.0f,
+        t[1],  -t[0], 1.0f,  0.0f, 0.0f, -dt,
+        0.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f,
+        0.0f,  0.0f,  0.0f,  0.0f, 1.0f, 0.0f,
+        0.0f,  0.0f,  0.0f,  0.0f, 0.0f, 1.0f,
+    };
+    float32_t qa = cfg->gyro_noise * cfg->gyro_noise * dt;
+    float32_t qb = cfg->bias_noise * cfg->bias_noise * dt;
+    float32_t T[36];
+
+    quat_rotate_small(q, t[0], t[1], t[2]);
+    mat6_mul(F, P, T);
+    mat6_mul_trans_sym(T, F, P);
+    for (uint32_t i = 0; i < 3; i++) {
+        P[i * 7] += qa;
+        P[(i + 3) * 7] += qb;
+    }
+}
+
+/* Measurement a = up(q) with H = [[up]x, 0], the zero half is never multiplied */
+__STATIC_FORCEINLINE void eskf_correct(float32_t *q, float32_t *bias, float32_t *P,
+                                       const float32_t *a, const ImuFusionCfg *cfg)
+{
+    float32_t h[3], y[3], PH[18], S[9], Si[9], K[18], dx[6];
+
+    quat_up(q, h);
+    for (uint32_t i = 0; i < 3; i++) {
+        y[i] = a[i] - h[i];
+    }
+    /* PH = P * H^T, 6x3 */
+    MAT_UNROLL
+    for (uint32_t i = 0; i < 6; i++) {
+        const float32_t *p = &P[i * 6];
+
+        PH[i * 3 + 0] = p[2] * h[1] - p[1] * h[2];
+        PH[i * 3 + 1] = p[0] * h[2] - p[2] * h[0];
+        PH[i * 3 + 2] = p[1] * h[0] - p[0] * h[1];
+    }
+    /* S = H * PH + R */
+    MAT_UNROLL
+    for (uint32_t j = 0; j < 3; j++) {
+        S[j]     = h[1] * PH[6 + j] - h[2] * PH[3 + j];
+        S[3 + j] = h[2] * PH[j] - h[0] * PH[6 + j];
+        S[6 + j] = h[0] * PH[3 + j] - h[1] * PH[j];
+    }
+    S[0] += cfg->accel_noise * cfg->accel_noise;
+    S[4] += cfg->accel_noise * cfg->accel_noise;
+    S[8] += cfg->accel_noise * cfg->accel_noise;
+    if (!mat3_inv_sym(S, Si)) {
+        return;
+    }
+    /* K = PH * S^-1, dx = K * y */
+    MAT_UNROLL
+    for (uint32_t i = 0; i < 6; i++) {
+        mat3_mul_vec(Si, &PH[i * 3], &K[i * 3]);
+        dx[i] = K[i * 3] * y[0] + K[i * 3 + 1] * y[1] + K[i * 3 + 2] * y[2];
+    }
+    /* P -= K * PH^T, symmetric */
+    MAT_UNROLL
+    for (uint32_t i = 0; i < 6; i++) {
+        MAT_UNROLL
+        for (uint32_t j = i; j < 6; j++) {
+            float32_t v = P[i * 6 + j] - K[i * 3] * PH[j * 3] - K[i * 3 + 1] * PH[j * 3 + 1] -
+                          K[i * 3 + 2] * PH[j * 3 + 2];
+
+            P[i * 6 + j] = P[j * 6 + i] = v;
+        }
+    }
+    quat_rotate_small(q, dx[0], dx[1], dx[2]);
+    for (uint32_t i = 0; i < 3; i++) {
+        bias[i] += dx[i + 3];
+    }
+}
+
+/* One instance per algorithm, q and the bias stay in registers over the batch */
+__STATIC_FORCEINLINE void imu_run(ImuFusion *f, const ImuBatch *b, float32_t *const quat[4],
+                                  const uint8_t algo)
+{
+    float32_t q[4]    = {f->q[0], f->q[1], f->q[2], f->q[3]};
+    float32_t bias[3] = {f->bias[0], f->bias[1], f->bias[2]};
+
+    for (uint32_t i = 0; i < b->num; i++) {
+        float32_t g[3] = {b->gyro[0][i], b->gyro[1][i], b->gyro[2][i]};
+        float32_t a[3];
+        bool valid = imu_acc_unit(f, b, i, a);
+
+        if (valid && !f->aligned) {
+            imu_align(q, a);
+            f->aligned = true;
+        } else if (algo == IMU_FUSION_MADGWICK) {
+            madgwick_step(q, valid ? a : NULL, g, &f->cfg);
+        } else if (algo == IMU_FUSION_MAHONY) {
+            mahony_step(q, bias, valid ? a : NULL, g, &f->cfg);
+        } else {
+            eskf_predict(q, bias, f->P, g, &f->cfg);
+            if (valid) {
+                eskf_correct(q, bias, f->P, a, &f->cfg);
+            }
+        }
+        if (quat) {
+            quat[0][i] = q[0];
+            quat[1][i] = q[1];
+            quat[2][i] = q[2];
+            quat[3][i] = q[3];
+        }
+    }
+    memcpy(f->q, q, sizeof(q));
+    memcpy(f->bias, bias, sizeof(bias));
+}
+
+int imu_fusion_init(ImuFusion *fusion, const ImuFusionCfg *cfg)
+{
+    if (!fusion || !cfg || cfg->algo > IMU_FUSION_ESKF || !(cfg->dt > 0.0f) ||
+        !(cfg->gravity > 0.0f) || cfg->accel_gate < 0.0f) {
+        return VPI_ERR_INVALID;
+    }
+    if (cfg->algo == IMU_FUSION_ESKF && !(cfg->accel_noise > 0.0f)) {
+        return VPI_ERR_INVALID;
+    }
+    fusion->cfg = *cfg;
+    imu_fusion_reset(fusion);
+    return VPI_SUCCESS;
+}
+
+void imu_fusion_reset(ImuFusion *fusion)
+{
+    memset(fusion->q, 0, sizeof(fusion->q));
+    memset(fusion->bias, 0, sizeof(fusion->bias));
+    memset(fusion->P, 0, sizeof(fusion->P));
+    fusion->q[0] = 1.0f;
+    for (uint32_t i = 0; i < 3; i++) {
+        fusion->P[i * 7]       = ESKF_P0_ATT;
+        fusion->P[(i + 3) * 7] = ESKF_P0_BIAS;
+    }
+    fusion->aligned  = false;
+    fusion->rejected = 0;
+}
+
+int imu_fusion_update(ImuFusion *fusion, const ImuBatch *batch, float32_t *const quat[4])
+{
+    if (!fusion || !batch) {
+        return VPI_ERR_INVALID;
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        if (!batch->acc[i] || !batch->gyro[i]) {
+            return VPI_ERR_INVALID;
+        }
+    }
+    if (quat && (!quat[0] || !quat[1] || !quat[2] || !quat[3])) {
+        return VPI_ERR_INVALID;
+    }
+    switch (fusion->cfg.algo) {
+    case IMU_FUSION_MADGWICK:
+        imu_run(fusion, batch, quat, IMU_FUSION_MADGWICK);
+        break;
+    case IMU_FUSION_MAHONY:
+        imu_run(fusion, batch, quat, IMU_FUSION_MAHONY);
+        break;
+    default:
+        imu_run(fusion, batch, quat, IMU_FUSION_ESKF);
+        break;
+    }
+    return VPI_SUCCESS;
+}
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "imu_fusion_bench.h"
+#include "imu_fusion.h"
+#include "mat_fixed.h"
+#include "shell.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+#define IMU_BENCH_RUNS 16
+/* Agreement of the two ESKF and tilt error after IMU_BENCH_RUNS batches */
+#define IMU_BENCH_EPS  1e-3f
+#define IMU_BENCH_TILT 0.05f
+
+/* The ESKF of imu_fusion.c written with the generic functions */
+typedef struct BenchEskf {
+    float32_t q[4];
+    float32_t bias[3];
+    float32_t P[36];
+} BenchEskf;
+
+typedef struct ImuBench {
+    float32_t acc[3][IMU_BENCH_BATCH];
+    float32_t gyro[3][IMU_BENCH_BATCH];
+    float32_t out[4][IMU_BENCH_BATCH];
+    float32_t *quat[4];
+    float32_t truth[4];
+    float32_t qdsp[4];
+    float32_t qfix[4];
+    ImuBatch batch;
+    ImuFusion fusion[3]; /* Indexed by ImuFusionAlgo */
+    BenchEskf ref;
+    uint32_t seed;
+} ImuBench;
+
+static ImuBench g_bench;
+
+static const float32_t g_rate[3] = {0.3f, -0.2f, 0.5f};   /* rad/s */
+static const float32_t g_bias[3] = {0.004f, -0.005f, 0.003f};
+
+static const ImuFusionCfg g_cfgs[3] = {
+    {.algo = IMU_FUSION_MADGWICK, .dt = 0.01f, .gravity = 1.0f, .accel_gate = 0.2f, .beta = 0.2f},
+    {.algo = IMU_FUSION_MAHONY, .dt = 0.01f, .gravity = 1.0f, .accel_gate = 0.2f, .kp = 1.0f,
+     .ki = 0.05f},
+    {.algo = IMU_FUSION_ESKF, .dt = 0.01f, .gravity = 1.0f, .accel_gate = 0.2f,
+     .gyro_noise = 0.01f, .bias_noise = 1e-4f, .accel_noise = 0.05f},
+};
+
+/* Uniform in [-1, 1) */
+static float32_t bench_noise(void)
+{
+    g_bench.seed = g_bench.seed * 1664525 + 1013904223;
+    return (float32_t)(g_bench.seed >> 8) / 8388608.0f - 1.0f;
+}
+
+/* Next batch of a constant rate rotation seen by a biased gyro */
+static void bench_fill(void)
+{
+    float32_t up[3];
+    uint32_t i, k;
+
+    for (i = 0; i < IMU_BENCH_BATCH; i++) {
+        quat_rotate_small(g_bench.truth, g_rate[0] * 0.01f, g_rate[1] * 0.01f,
+                          g_rate[2] * 0.01f);
+        quat_up(g_bench.truth, up);
+        for (k = 0; k < 3; k++) {
+            g_bench.gyro[k][i] = g_rate[k] + g_bias[k] + 0.01f * bench_noise();
+            g_bench.acc[k][i]  = up[k] + 0.02f * bench_noise();
+        }
+    }
+}
+
+static void bench_setup(void)
+{
+    uint32_t i, k;
+
+    memset(&g_bench, 0, sizeof(g_bench));
+    g_bench.seed     = 1;
+    g_bench.truth[0] = 1.0f;
+    for (k = 0; k < 3; k++) {
+        g_bench.batch.acc[k]  = g_bench.acc[k];
+        g_bench.batch.gyro[k] = g_bench.gyro[k];
+    }
+    g_bench.batch.num = IMU_BENCH_BATCH;
+    for (k = 0; k < 4; k++) {
+        g_bench.quat[k] = g_bench.out[k];
+    }
+    /* All filters start at the true attitude so that they see the same samples */
+    for (i = 0; i < ARRAY_SIZE(g_cfgs); i++) {
+        imu_fusion_init(&g_bench.fusion[i], &g_cfgs[i]);
+        g_bench.fusion[i].aligned = true;
+    }
+    memcpy(g_bench.ref.q, g_bench.fusion[IMU_FUSION_ESKF].q, sizeof(g_bench.ref.q));
+    memcpy(g_bench.ref.P, g_bench.fusion[IMU_FUSION_ESKF].P, sizeof(g_bench.ref.P));
+    g_bench.qdsp[0] = g_bench.qfix[0] = 1.0f;
+    bench_fill();
+}
+
+static void bench_mat(riscv_matrix_instance_f32 *m, uint16_t rows, uint16_t cols, float32_t *data)
+{
+    riscv_mat_init_f32(m, rows, cols, data);
+}
+
+static void bench_quat_small(float32_t *q, float32_t vx, float32_t vy, float32_t vz)
+{
+    float32_t d[4] = {1.0f, 0.5f * vx, 0.5f * vy, 0.5f * vz};
+    float32_t r[4];
+
+    riscv_quaternion_product_single_f32(q, d, r);
+    riscv_quaternion_normalize_f32(r, q, 1);
+}
+
+static void bench_eskf_step(BenchEskf *s, const ImuFusionCfg *cfg, uint32_t i)
+{
+    float32_t dt = cfg->dt, R = cfg->accel_noise * cfg->accel_noise;
+    float32_t t[3], F[36], Ft[36], T[36], Q[36] = {0}, Rot[9], H[18] = {0}, Ht[18], PHt[18];
+    float32_t S[9], Si[9], K[18], KH[36], y[3], dx[6], a[3], n;
+    riscv_matrix_instance_f32 mF, mFt, mT, mQ, mP, mH, mHt, mPHt, mS, mSi, mK, mKH, my, mdx;
+    uint32_t k;
+
+    bench_mat(&mF, 6, 6, F);
+    bench_mat(&mFt, 6, 6, Ft);
+    bench_mat(&mT, 6, 6, T);
+    bench_mat(&mQ, 6, 6, Q);
+    bench_mat(&mP, 6, 6, s->P);
+    bench_mat(&mH, 3, 6, H);
+    bench_mat(&mHt, 6, 3, Ht);
+    bench_mat(&mPHt, 6, 3, PHt);
+    bench_mat(&mS, 3, 3, S);
+    bench_mat(&mSi, 3, 3, Si);
+    bench_mat(&mK, 6, 3, K);
+    bench_mat(&mKH, 6, 6, KH);
+    bench_mat(&my, 3, 1, y);
+    bench_mat(&mdx, 6, 1, dx);
+
+    for (k = 0; k < 3; k++) {
+        t[k] = (g_bench.gyro[k][i] - s->bias[k]) * dt;
+    }
+    bench_quat_small(s->q, t[0], t[1], t[2]);
+    memset(F, 0, sizeof(F));
+    for (k = 0; k < 6; k++) {
+        F[k * 7] = 1.0f;
+        Q[k * 7] = k < 3 ? cfg->gyro_noise * cfg->gyro_noise * dt
+                         : cfg->bias_noise * cfg->bias_noise * dt;
+    }
+    F[1]  = t[2];
+    F[2]  = -t[1];
+    F[6]  = -t[2];
+    F[8]  = t[0];
+    F[12] = t[1];
+    F[13] = -t[0];
+    F[3] = F[10] = F[17] = -dt;
+    riscv_mat_mult_f32(&mF, &mP, &mT);
+    riscv_mat_trans_f32(&mF, &mFt);
+    riscv_mat_mult_f32(&mT, &mFt, &mKH);
+    riscv_mat_add_f32(&mKH, &mQ, &mP);
+
+    n = g_bench.acc[0][i] * g_bench.acc[0][i] + g_bench.acc[1][i] * g_bench.acc[1][i] +
+        g_bench.acc[2][i] * g_bench.acc[2][i];
+    for (k = 0; k < 3; k++) {
+        a[k] = g_bench.acc[k][i] * mat_rsqrt(n);
+    }
+    /* h is the last row of the rotation, H = [[h]x, 0] */
+    riscv_quaternion2rotation_f32(s->q, Rot, 1);
+    H[1]  = -Rot[8];
+    H[2]  = Rot[7];
+    H[6]  = Rot[8];
+    H[8]  = -Rot[6];
+    H[12] = -Rot[7];
+    H[13] = Rot[6];
+    for (k = 0; k < 3; k++) {
+        y[k] = a[k] - Rot[6 + k];
+    }
+    riscv_mat_trans_f32(&mH, &mHt);
+    riscv_mat_mult_f32(&mP, &mHt, &mPHt);
+    riscv_mat_mult_f32(&mH, &mPHt, &mS);
+    S[0] += R;
+    S[4] += R;
+    S[8] += R;
+    if (riscv_mat_inverse_f32(&mS, &mSi) != RISCV_MATH_SUCCESS) {
+        return;
+    }
+    riscv_mat_mult_f32(&mPHt, &mSi, &mK);
+    riscv_mat_mult_f32(&mK, &my, &mdx);
+    /* P = P - K * H * P */
+    riscv_mat_mult_f32(&mK, &mH, &mKH);
+    riscv_mat_mult_f32(&mKH, &mP, &mT);
+    riscv_mat_sub_f32(&mP, &mT, &mF);
+    memcpy(s->P, F, sizeof(F));
+    bench_quat_small(s->q, dx[0], dx[1], dx[2]);
+    for (k = 0; k < 3; k++) {
+        s->bias[k] += dx[k + 3];
+    }
+}
+
+static bool bench_near(const float32_t *a, const float32_t *b, uint32_t num, float32_t eps)
+{
+    uint32_t i;
+
+    for (i = 0; i < num; i++) {
+        if (!(fabsf(a[i] - b[i]) <= eps)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_quat_dsp(void *arg)
+{
+    uint32_t i;
+
+    for (i = 0; i < IMU_BENCH_BATCH; i++) {
+        bench_quat_small(g_bench.qdsp, g_bench.gyro[0][i] * 0.01f, g_bench.gyro[1][i] * 0.01f,
+                         g_bench.gyro[2][i] * 0.01f);
+    }
+}
+
+static void bench_quat_fix(void *arg)
+{
+    uint32_t i;
+
+    for (i = 0; i < IMU_BENCH_BATCH; i++) {
+        quat_rotate_small(g_bench.qfix, g_bench.gyro[0][i] * 0.01f, g_bench.gyro[1][i] * 0.01f,
+                          g_bench.gyro[2][i] * 0.01f);
+    }
+}
+
+int imu_fusion_bench_check(void)
+{
+    float32_t up[3], est[3];
+    uint32_t run, i;
+
+    bench_setup();
+    bench_quat_dsp(NULL);
+    bench_quat_fix(NULL);
+    if (!bench_near(g_bench.qdsp, g_bench.qfix, 4, 1e-5f)) {
+        return VPI_ERR_BAD_DATA;
+    }
+    for (run = 0; run < IMU_BENCH_RUNS; run++) {
+        if (run) {
+            bench_fill();
+        }
+        for (i = 0; i < ARRAY_SIZE(g_cfgs); i++) {
+            imu_fusion_update(&g_bench.fusion[i], &g_bench.batch, NULL);
+        }
+        for (i = 0; i < IMU_BENCH_BATCH; i++) {
+            bench_eskf_step(&g_bench.ref, &g_cfgs[IMU_FUSION_ESKF], i);
+        }
+        if (!bench_near(g_bench.ref.q, g_bench.fusion[IMU_FUSION_ESKF].q, 4, IMU_BENCH_EPS) ||
+            !bench_near(g_bench.ref.bias, g_bench.fusion[IMU_FUSION_ESKF].bias, 3,
+                        IMU_BENCH_EPS)) {
+            return VPI_ERR_BAD_DATA;
+        }
+    }
+    quat_up(g_bench.truth, up);
+    for (i = 0; i < ARRAY_SIZE(g_cfgs); i++) {
+        quat_up(g_bench.fusion[i].q, est);
+        if (!bench_near(up, est, 3, IMU_BENCH_TILT)) {
+            return VPI_ERR_BAD_DATA;
+        }
+    }
+    return VPI_SUCCESS;
+}
+
+static void bench_eskf_mat(void *arg)
+{
+    uint32_t i;
+
+    for (i = 0; i < IMU_BENCH_BATCH; i++) {
+        bench_eskf_step(&g_bench.ref, &g_cfgs[IMU_FUSION_ESKF], i);
+    }
+}
+
+static void bench_fusion(void *arg)
+{
+    imu_fusion_update(arg, &g_bench.batch, g_bench.quat);
+}
+
+static const ShellBench g_benches[] = {
+    {"eskf_mat", bench_eskf_mat, NULL},
+    {"eskf_fix", bench_fusion, &g_bench.fusion[IMU_FUSION_ESKF]},
+    {"quat_dsp", bench_quat_dsp, NULL},
+    {"quat_fix", bench_quat_fix, NULL},
+    {"madgwick_fix", bench_fusion, &g_bench.fusion[IMU_FUSION_MADGWICK]},
+    {"mahony_fix", bench_fusion, &g_bench.fusion[IMU_FUSION_MAHONY]},
+};
+
+int imu_fusion_bench_init(void)
+{
+    int ret = VPI_SUCCESS;
+    uint32_t i;
+
+    bench_setup();
+    for (i = 0; i < ARRAY_SIZE(g_benches) && ret == VPI_SUCCESS; i++) {
+        ret = shell_add_bench(&g_benches[i]);
+    }
+    return ret;
+}
+
+#if CONFIG_SHELL && CONFIG_IMU_FUSION_BENCH
+SHELL_BENCH_BOOT(imu_fusion_bench_boot, 92, imu_fusion_bench_check(), imu_fusion_bench_init);
+#endif
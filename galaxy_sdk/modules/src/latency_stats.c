@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "latency_stats.h"
+#include "vpi_error.h"
+#include "sys_common.h"
+#include "bsp_common.h"
+#include "platform.h"
+#include "soc_sysctl.h"
+#include "uart_printf.h"
+#include "osal_task_api.h"
+#if CONFIG_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#define LATENCY_ISR_NEST_MAX 8
+#define LATENCY_LINE_LEN     64
+
+typedef struct LatencySection {
+    uint32_t depth;
+    uint32_t start;
+    uint32_t addr;
+    bool valid;
+} LatencySection;
+
+typedef struct LatencyCtx {
+    LatencyHist hist[LATENCY_CLASS_NUM];
+    LatencySection crit;
+    LatencySection sched;
+    uint32_t isr_depth;
+    uint32_t isr_start[LATENCY_ISR_NEST_MAX];
+    volatile bool enabled;
+} LatencyCtx;
+
+static LatencyCtx g_lat;
+
+static const char *const g_lat_class_name[LATENCY_CLASS_NUM] = {
+    "critical",
+    "sched_lock",
+    "isr",
+};
+
+static inline uint32_t lat_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void lat_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+__STATIC_FORCEINLINE uint32_t lat_now(void)
+{
+    return __RV_CSR_READ(CSR_MCYCLE);
+}
+
+CRITICAL_SECTION
+static void lat_record(LatencyClass cls, uint32_t cycles, uint32_t addr)
+{
+    LatencyHist *hist = &g_lat.hist[cls];
+    uint32_t mie, i, slot, bucket;
+
+    mie    = lat_lock();
+    bucket = cycles ? 32 - __builtin_clz(cycles) : 0;
+    hist->bucket[MIN(bucket, LATENCY_BUCKET_NUM - 1)]++;
+    hist->count++;
+    hist->total += cycles;
+    if (cycles > hist->max) {
+        hist->max = cycles;
+    }
+    /* One entry per site, otherwise replace the smallest one */
+    slot = 0;
+    for (i = 0; i < LATENCY_WORST_NUM; i++) {
+        if (hist->worst[i].addr == addr && hist->worst[i].cycles) {
+            slot = i;
+            break;
+        }
+        if (hist->worst[i].cycles < hist->worst[slot].cycles) {
+            slot = i;
+        }
+    }
+    if (cycles > hist->worst[slot].cycles) {
+        hist->worst[slot].addr   = addr;
+        hist->worst[slot].cycles = cycles;
+    }
+    lat_unlock(mie);
+}
+
+CRITICAL_SECTION
+static void lat_section_enter(LatencySection *sec, uint32_t addr)
+{
+    if (sec->depth++ == 0) {
+        sec->valid = g_lat.enabled;
+        sec->addr  = addr;
+        sec->start = lat_now();
+    }
+}
+
+CRITICAL_SECTION
+static void lat_section_exit(LatencySection *sec, LatencyClass cls)
+{
+    if (!sec->depth) {
+        return;
+    }
+    if (--sec->depth == 0 && sec->valid && g_lat.enabled) {
+        lat_record(cls, lat_now() - sec->start, sec->addr);
+    }
+}
+
+__attribute__((noinline)) CRITICAL_SECTION void latency_crit_enter(void)
+{
+    vPortEnterCritical();
+    lat_section_enter(&g_lat.crit, (uint32_t)(uintptr_t)__builtin_return_address(0));
+}
+
+__attribute__((noinline)) CRITICAL_SECTION void latency_crit_exit(void)
+{
+    lat_section_exit(&g_lat.crit, LATENCY_CRITICAL);
+    vPortExitCritical();
+}
+
+/*
+ * Interrupts which may call FreeRTOS APIs are masked in both kinds of
+ * section, so they never interleave and share one nesting count
+ */
+__attribute__((noinline)) CRITICAL_SECTION uint8_t latency_crit_enter_isr(void)
+{
+    uint8_t mask = ulPortRaiseBASEPRI();
+
+    lat_section_enter(&g_lat.crit, (uint32_t)(uintptr_t)__builtin_return_address(0));
+    return mask;
+}
+
+__attribute__((noinline)) CRITICAL_SECTION void latency_crit_exit_isr(uint8_t mask)
+{
+    lat_section_exit(&g_lat.crit, LATENCY_CRITICAL);
+    vPortSetBASEPRI(mask);
+}
+
+__attribute__((noinline)) void latency_sched_lock(void)
+{
+    (osal_suspend_all)();
+    lat_section_enter(&g_lat.sched, (uint32_t)(uintptr_t)__builtin_return_address(0));
+}
+
+__attribute__((noinline)) void latency_sched_unlock(void)
+{
+    lat_section_exit(&g_lat.sched, LATENCY_SCHED_LOCK);
+    (osal_resume_all)();
+}
+
+CRITICAL_SECTION
+void latency_port_isr_enter(uint32_t mcause)
+{
+    (void)mcause;
+    if (g_lat.isr_depth < LATENCY_ISR_NEST_MAX) {
+        g_lat.isr_start[g_lat.isr_depth] = lat_now();
+    }
+    g_lat.isr_depth++;
+}
+
+CRITICAL_SECTION
+void latency_port_isr_exit(uint32_t mcause)
+{
+    uint32_t now = lat_now();
+
+    if (!g_lat.isr_depth) {
+        return;
+    }
+    g_lat.isr_depth--;
+    if (g_lat.enabled && g_lat.isr_depth < LATENCY_ISR_NEST_MAX) {
+        lat_record(LATENCY_ISR, now - g_lat.isr_start[g_lat.isr_depth], mcause & MCAUSE_CAUSE);
+    }
+}
+
+void latency_stats_enable(bool enable)
+{
+    g_lat.enabled = enable;
+}
+
+void latency_stats_reset(void)
+{
+    uint32_t mie;
+
+    mie = lat_lock();
+    memset(g_lat.hist, 0, sizeof(g_lat.hist));
+    lat_unlock(mie);
+}
+
+int latency_stats_get(LatencyClass cls, LatencyHist *out)
+{
+    uint32_t mie;
+
+    if (cls >= LATENCY_CLASS_NUM || !out) {
+        return VPI_ERR_INVALID;
+    }
+
+    mie  = lat_lock();
+    *out = g_lat.hist[cls];
+    lat_unlock(mie);
+    return VPI_SUCCESS;
+}
+
+int latency_stats_dump(LatencyWriter writer, void *arg)
+{
+    char line[LATENCY_LINE_LEN];
+    LatencyHist hist;
+    uint32_t mhz, cls, i;
+    uint64_t avg;
+
+    if (!writer) {
+        return VPI_ERR_INVALID;
+    }
+
+    mhz = soc_cpu_clock_get_freq() / 1000000;
+    if (!mhz) {
+        mhz = 1;
+    }
+    for (cls = 0; cls < LATENCY_CLASS_NUM; cls++) {
+        latency_stats_get(cls, &hist);
+        avg = hist.count ? hist.total / hist.count : 0;
+        uart_sprintf(line, "%s: count %u max %u cyc (%u us) avg %u cyc\n",
+                     g_lat_class_name[cls], (unsigned int)hist.count, (unsigned int)hist.max,
+                     (unsigned int)(hist.max / mhz), (unsigned int)avg);
+        writer(line, arg);
+        for (i = 0; i < LATENCY_BUCKET_NUM; i++) {
+            if (hist.bucket[i]) {
+                uart_sprintf(line, "  < %10u cyc: %u\n",
+                             (unsigned int)(i < LATENCY_BUCKET_NUM - 1 ? 1U << i : UINT32_MAX),
+                             (unsigned int)hist.bucket[i]);
+                writer(line, arg);
+            }
+        }
+        for (i = 0; i < LATENCY_WORST_NUM; i++) {
+            if (hist.worst[i].cycles) {
+                uart_sprintf(line, "  %s 0x%08x: %u cyc (%u us)\n",
+                             cls == LATENCY_ISR ? "irq " : "from",
+                             (unsigned int)hist.worst[i].addr, (unsigned int)hist.worst[i].cycles,
+                             (unsigned int)(hist.worst[i].cycles / mhz));
+                writer(line, arg);
+            }
+        }
+    }
+    return VPI_SUCCESS;
+}
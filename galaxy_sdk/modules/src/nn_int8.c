@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "nn_int8.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+
+#define NN_ALIGN4(x) (((x) + 3) & ~3u)
+
+/* Words of int8 data, tensors and weights are 4 byte aligned */
+typedef uint32_t __attribute__((__may_alias__)) nn_word_t;
+
+/* t + the four products of the signed bytes */
+static inline int32_t nn_smaqa(int32_t t, uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SMAQA(t, a, b);
+#else
+    for (uint32_t i = 0; i < 32; i += 8) {
+        t += (int8_t)(a >> i) * (int8_t)(b >> i);
+    }
+    return t;
+#endif
+}
+
+/* Bytes 0, 1 (lo) or 2, 3 (hi) sign extended to 16-bit lanes */
+static inline uint32_t nn_unpack_lo(uint32_t a)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SUNPKD810(a);
+#else
+    return (uint16_t)(int8_t)a | (uint32_t)(uint16_t)(int8_t)(a >> 8) << 16;
+#endif
+}
+
+static inline uint32_t nn_unpack_hi(uint32_t a)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SUNPKD832(a);
+#else
+    return nn_unpack_lo(a >> 16);
+#endif
+}
+
+/* t + a.h0 * b.h0 and t + a.h1 * b.h1 */
+static inline int32_t nn_mac_bb(int32_t t, uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KMABB(t, a, b);
+#else
+    return t + (int16_t)a * (int16_t)b;
+#endif
+}
+
+static inline int32_t nn_mac_tt(int32_t t, uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KMATT(t, a, b);
+#else
+    return t + (int16_t)(a >> 16) * (int16_t)(b >> 16);
+#endif
+}
+
+static inline uint32_t nn_max8(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SMAX8(a, b);
+#else
+    uint32_t r = 0;
+
+    for (uint32_t i = 0; i < 32; i += 8) {
+        r |= (uint32_t)(uint8_t)MAX((int8_t)(a >> i), (int8_t)(b >> i)) << i;
+    }
+    return r;
+#endif
+}
+
+static inline uint32_t nn_min8(uint32_t a, uint32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_SMIN8(a, b);
+#else
+    uint32_t r = 0;
+
+    for (uint32_t i = 0; i < 32; i += 8) {
+        r |= (uint32_t)(uint8_t)MIN((int8_t)(a >> i), (int8_t)(b >> i)) << i;
+    }
+    return r;
+#endif
+}
+
+/* round(a * b / 2^31), saturated */
+static inline int32_t nn_mulh(int32_t a, int32_t b)
+{
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+    return __RV_KWMMUL_U(a, b);
+#else
+    if (a == INT32_MIN && b == INT32_MIN) {
+        return INT32_MAX;
+    }
+    return (int32_t)(((int64_t)a * b + (1 << 30)) >> 31);
+#endif
+}
+
+/* acc * mult * 2^shift rounded, as the multipliers of nn_convert.py */
+static inline int8_t nn_requant(int32_t acc, int32_t mult, int32_t shift, int32_t zero,
+                                const NnLayer *l)
+{
+    int32_t v;
+
+    if (shift > 0) {
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+        acc = __RV_KSLLW(acc, shift);
+#else
+        acc = (int32_t)MAX(MIN((int64_t)acc << shift, (int64_t)INT32_MAX), (int64_t)INT32_MIN);
+#endif
+    }
+    v = nn_mulh(acc, mult);
+    if (shift < 0) {
+#if defined(__DSP_PRESENT) && (__DSP_PRESENT == 1)
+        v = __RV_SRA_U(v, -shift);
+#else
+        v = (int32_t)(((int64_t)v + (1 << (-shift - 1))) >> -shift);
+#endif
+    }
+    v = MAX(MIN(v, 256), -256) + zero;
+    return (int8_t)MAX(MIN(v, l->act_max), l->act_min);
+}
+
+/* One output row, two channels share each load of the input */
+static void nn_rows(const NnLayer *l, const nn_word_t *in, uint32_t words, int8_t *y,
+                    const NnTensor *to)
+{
+    const nn_word_t *w = (const nn_word_t *)l->weight;
+    uint32_t o;
+
+    for (o = 0; o + 2 <= to->ch; o += 2, w += 2 * words) {
+        int32_t a0 = l->bias[o], a1 = l->bias[o + 1];
+
+        for (uint32_t i = 0; i < words; i++) {
+            uint32_t v = in[i];
+
+            a0 = nn_smaqa(a0, v, w[i]);
+            a1 = nn_smaqa(a1, v, w[words + i]);
+        }
+        y[o]     = nn_requant(a0, l->mult[o], l->shift[o], to->zero, l);
+        y[o + 1] = nn_requant(a1, l->mult[o + 1], l->shift[o + 1], to->zero, l);
+    }
+    if (o < to->ch) {
+        int32_t a = l->bias[o];
+
+        for (uint32_t i = 0; i < words; i++) {
+            a = nn_smaqa(a, in[i], w[i]);
+        }
+        y[o] = nn_requant(a, l->mult[o], l->shift[o], to->zero, l);
+    }
+}
+
+/*
+ * Each output step copies its window into an aligned column, padding
+ * steps as the input zero point so the folded bias stays exact
+ */
+static void nn_conv1d(const NnTensor *ti, const NnTensor *to, const NnLayer *l, uint8_t *arena)
+{
+    const int8_t *x = (const int8_t *)arena + ti->offset;
+    int8_t *y       = (int8_t *)arena + to->offset;
+    int8_t *col     = (int8_t *)arena + l->scratch;
+    uint32_t span   = l->kernel * ti->ch;
+
+    memset(col + span, 0, NN_ALIGN4(span) - span);
+    for (uint32_t t = 0; t < to->len; t++, y += to->ch) {
+        int32_t pos = (int32_t)(t * l->stride) - l->pad;
+
+        for (uint32_t k = 0; k < l->kernel; k++, pos++) {
+            if (pos < 0 || pos >= ti->len) {
+                memset(col + k * ti->ch, ti->zero, ti->ch);
+            } else {
+                memcpy(col + k * ti->ch, x + pos * ti->ch, ti->ch);
+            }
+        }
+        nn_rows(l, (const nn_word_t *)col, NN_ALIGN4(span) / 4, y, to);
+    }
+}
+
+static void nn_dense(const NnTensor *ti, const NnTensor *to, const NnLayer *l, uint8_t *arena)
+{
+    /* Bytes after the input in its last word meet zero weights */
+    nn_rows(l, (const nn_word_t *)(arena + ti->offset), NN_ALIGN4(ti->len * ti->ch) / 4,
+            (int8_t *)arena + to->offset, to);
+}
+
+/* Four channels per step as 16-bit lanes when ch is a multiple of 4 */
+static void nn_dwconv1d(const NnTensor *ti, const NnTensor *to, const NnLayer *l, uint8_t *arena)
+{
+    const int8_t *x = (const int8_t *)arena + ti->offset;
+    int8_t *y       = (int8_t *)arena + to->offset;
+    uint32_t ch     = ti->ch;
+    uint32_t step   = ch & 3 ? 1 : 4;
+
+    for (uint32_t t = 0; t < to->len; t++, y += ch) {
+        int32_t start = (int32_t)(t * l->stride) - l->pad;
+
+        for (uint32_t c = 0; c < ch; c += step) {
+            int32_t a[4] = {0};
+
+            for (uint32_t i = 0; i < step; i++) {
+                a[i] = l->bias[c + i];
+            }
+            for (uint32_t k = 0; k < l->kernel; k++) {
+                int32_t pos      = start + (int32_t)k;
+                const int8_t *w  = l->weight + k * ch + c;
+
+                if (pos < 0 || pos >= ti->len) {
+                    for (uint32_t i = 0; i < step; i++) {
+                        a[i] += ti->zero * w[i];
+                    }
+                } else if (step == 4) {
+                    uint32_t xv = *(const nn_word_t *)(x + pos * ch + c);
+                    uint32_t wv = *(const nn_word_t *)w;
+
+                    a[0] = nn_mac_bb(a[0], nn_unpack_lo(xv), nn_unpack_lo(wv));
+                    a[1] = nn_mac_tt(a[1], nn_unpack_lo(xv), nn_unpack_lo(wv));
+                    a[2] = nn_mac_bb(a[2], nn_unpack_hi(xv), nn_unpack_hi(wv));
+                    a[3] = nn_mac_tt(a[3], nn_unpack_hi(xv), nn_unpack_hi(wv));
+                } else {
+                    a[0] += x[pos * ch + c] * w[0];
+                }
+            }
+            for (uint32_t i = 0; i < step; i++) {
+                y[c + i] = nn_requant(a[i], l->mult[c + i], l->shift[c + i], to->zero, l);
+            }
+        }
+    }
+}
+
+static void nn_pool(const NnTensor *ti, const NnTensor *to, const NnLayer *l, uint8_t *arena)
+{
+    const int8_t *x = (const int8_t *)arena + ti->offset;
+    int8_t *y       = (int8_t *)arena + to->offset;
+    uint32_t ch     = ti->ch;
+
+    for (uint32_t t = 0; t < to->len; t++, y += ch) {
+        const int8_t *w = x + t * l->stride * ch;
+
+        if (l->op == NN_MAXPOOL && !(ch & 3)) {
+            for (uint32_t c = 0; c < ch; c += 4) {
+                uint32_t m = *(const nn_word_t *)(w + c);
+
+                for (uint32_t k = 1; k < l->kernel; k++) {
+                    m = nn_max8(m, *(const nn_word_t *)(w + k * ch + c));
+                }
+                *(nn_word_t *)(y + c) = m;
+            }
+            continue;
+        }
+        for (uint32_t c = 0; c < ch; c++) {
+            int32_t v = w[c];
+
+            for (uint32_t k = 1; k < l->kernel; k++) {
+                v = l->op == NN_MAXPOOL ? MAX(v, w[k * ch + c]) : v + w[k * ch + c];
+            }
+            if (l->op == NN_AVGPOOL) {
+                v = (v + (v < 0 ? -(int32_t)l->kernel : (int32_t)l->kernel) / 2) / (int32_t)l->kernel;
+            }
+            y[c] = (int8_t)v;
+        }
+    }
+}
+
+static void nn_relu(const NnTensor *ti, const NnTensor *to, const NnLayer *l, uint8_t *arena)
+{
+    const nn_word_t *x = (const nn_word_t *)(arena + ti->offset);
+    nn_word_t *y       = (nn_word_t *)(arena + to->offset);
+    uint32_t lo        = (uint8_t)l->act_min * 0x01010101u;
+    uint32_t hi        = (uint8_t)l->act_max * 0x01010101u;
+
+    for (uint32_t i = 0; i < NN_ALIGN4(ti->len * ti->ch) / 4; i++) {
+        y[i] = nn_min8(nn_max8(x[i], lo), hi);
+    }
+}
+
+/* exp(x - max) from the table, outputs sum to 256 at scale 1/256 */
+static void nn_softmax(const NnTensor *ti, const NnTensor *to, const NnLayer *l, uint8_t *arena)
+{
+    const int8_t *x = (const int8_t *)arena + ti->offset;
+    int8_t *y       = (int8_t *)arena + to->offset;
+
+    for (uint32_t t = 0; t < ti->len; t++, x += ti->ch, y += ti->ch) {
+        int32_t max  = x[0];
+        uint32_t sum = 0;
+
+        for (uint32_t c = 1; c < ti->ch; c++) {
+            max = MAX(max, x[c]);
+        }
+        for (uint32_t c = 0; c < ti->ch; c++) {
+            sum += l->lut[max - x[c]];
+        }
+        for (uint32_t c = 0; c < ti->ch; c++) {
+            int32_t v = (int32_t)((l->lut[max - x[c]] * 256 + sum / 2) / sum) - 128;
+
+            y[c] = (int8_t)MIN(v, 127);
+        }
+    }
+}
+
+static bool nn_tensor_valid(const NnModel *model, uint8_t index)
+{
+    const NnTensor *t = &model->tensors[index];
+
+    if (index >= model->tensor_num) {
+        return false;
+    }
+    return !(t->offset & 3) && t->offset + NN_ALIGN4(t->len * t->ch) <= model->arena_size;
+}
+
+static bool nn_layer_valid(const NnModel *model, const NnLayer *l)
+{
+    bool weighted = l->op == NN_CONV1D || l->op == NN_DWCONV1D || l->op == NN_DENSE;
+
+    if (l->op >= NN_OP_NUM || !nn_tensor_valid(model, l->in) || !nn_tensor_valid(model, l->out)) {
+        return false;
+    }
+    if (weighted && (!l->weight || ((uintptr_t)l->weight & 3) || !l->bias || !l->mult ||
+                     !l->shift)) {
+        return false;
+    }
+    if (l->op == NN_CONV1D && ((l->scratch & 3) || l->scratch +
+                               NN_ALIGN4(l->kernel * model->tensors[l->in].ch) > model->arena_size)) {
+        return false;
+    }
+    return l->op != NN_SOFTMAX || l->lut;
+}
+
+int8_t *nn_tensor(const NnModel *model, void *arena, uint8_t index)
+{
+    if (!model || !arena || index >= model->tensor_num) {
+        return NULL;
+    }
+    return (int8_t *)arena + model->tensors[index].offset;
+}
+
+int nn_invoke(const NnModel *model, void *arena)
+{
+    static void (*const run[NN_OP_NUM])(const NnTensor *, const NnTensor *, const NnLayer *,
+                                        uint8_t *) = {
+        [NN_CONV1D] = nn_conv1d, [NN_DWCONV1D] = nn_dwconv1d, [NN_DENSE] = nn_dense,
+        [NN_MAXPOOL] = nn_pool,  [NN_AVGPOOL] = nn_pool,      [NN_RELU] = nn_relu,
+        [NN_SOFTMAX] = nn_softmax,
+    };
+
+    if (!model || !model->tensors || !model->layers || !arena || ((uintptr_t)arena & 3)) {
+        return VPI_ERR_INVALID;
+    }
+    for (uint32_t i = 0; i < model->layer_num; i++) {
+        if (!nn_layer_valid(model, &model->layers[i])) {
+            return VPI_ERR_INVALID;
+        }
+    }
+    for (uint32_t i = 0; i < model->layer_num; i++) {
+        const NnLayer *l = &model->layers[i];
+
+        run[l->op](&model->tensors[l->in], &model->tensors[l->out], l, arena);
+    }
+    return VPI_SUCCESS;
+}
+
+void nn_quantize(const NnTensor *t, const float32_t *in, int8_t *out, uint32_t num)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        float32_t v = in[i] / t->scale;
+        int32_t q   = (int32_t)MAX(MIN(v + (v < 0 ? -0.5f : 0.5f), 255.0f), -256.0f) + t->zero;
+
+        out[i] = (int8_t)MAX(MIN(q, 127), -128);
+    }
+}
+
+void nn_dequantize(const NnTensor *t, const int8_t *in, float32_t *out, uint32_t num)
+{
+    for (uint32_t i = 0; i < num; i++) {
+        out[i] = t->scale * (in[i] - t->zero);
+    }
+}
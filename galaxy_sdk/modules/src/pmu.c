@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "pmu.h"
+#include "vpi_error.h"
+#include "sys_common.h"
+#include "platform.h"
+#include "osal_heap_api.h"
+#include "uart_printf.h"
+#include "nmsis_bench.h"
+#if CONFIG_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pmp_stack_guard.h"
+#endif
+
+#define PMU_HPM_FIRST    3
+#define PMU_SLOT_OTHERS  PMU_TASK_NUM
+#define PMU_LINE_LEN     160
+#define PMU_NAME_LEN     16
+
+/* hi, lo, hi again, so that a carry between the two reads is not missed */
+#define PMU_CSR_READ64(v, lo, hi)                            \
+    do {                                                     \
+        uint32_t hi_;                                        \
+        do {                                                 \
+            hi_ = __RV_CSR_READ(hi);                         \
+            (v) = ((uint64_t)hi_ << 32) | __RV_CSR_READ(lo); \
+        } while (hi_ != __RV_CSR_READ(hi));                  \
+    } while (0)
+
+typedef struct PmuTaskSlot {
+    void *task;
+    uint64_t val[PMU_CNT_NUM];
+} PmuTaskSlot;
+
+typedef struct PmuCtx {
+    PmuEvent events[PMU_EVENT_NUM];
+    /* The last slot takes tasks beyond PMU_TASK_NUM */
+    PmuTaskSlot slots[PMU_TASK_NUM + 1];
+    /* Counters when the current slot was switched in */
+    uint64_t last[PMU_CNT_NUM];
+    uint32_t cur;
+    volatile bool running;
+} PmuCtx;
+
+extern void *volatile pxCurrentTCB;
+
+static PmuCtx g_pmu;
+
+static const uint32_t g_pmu_event_sel[PMU_EVENT_MAX] = {
+    [PMU_EVENT_LOAD] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                 EVENT_INSTRUCTION_COMMIT_INTEGER_LOAD, MSU_EVENT_ENABLE),
+    [PMU_EVENT_STORE] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                  EVENT_INSTRUCTION_COMMIT_INTEGER_STORE, MSU_EVENT_ENABLE),
+    [PMU_EVENT_BRANCH] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                   EVENT_INSTRUCTION_COMMIT_CONDITIONAL_BRANCH, MSU_EVENT_ENABLE),
+    [PMU_EVENT_BRANCH_TAKEN] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                         EVENT_INSTRUCTION_COMMIT_TAKEN_CONDITIONAL_BRANCH,
+                                         MSU_EVENT_ENABLE),
+    [PMU_EVENT_BRANCH_MISS] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                        EVENT_INSTRUCTION_COMMIT_CONDITIONAL_BRANCH_PREDICTION_FAIL,
+                                        MSU_EVENT_ENABLE),
+    [PMU_EVENT_JUMP_MISS] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                      EVENT_INSTRUCTION_COMMIT_JALR_PREDICTION_FAIL,
+                                      MSU_EVENT_ENABLE),
+    [PMU_EVENT_MUL] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                EVENT_INSTRUCTION_COMMIT_INTEGER_MULTIPLICATION, MSU_EVENT_ENABLE),
+    [PMU_EVENT_DIV] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                EVENT_INSTRUCTION_COMMIT_INTEGER_DIVISION_REMAINDER,
+                                MSU_EVENT_ENABLE),
+    [PMU_EVENT_FP_LOAD] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                    EVENT_INSTRUCTION_COMMIT_FLOATING_POINT_LOAD, MSU_EVENT_ENABLE),
+    [PMU_EVENT_FP_STORE] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                     EVENT_INSTRUCTION_COMMIT_FLOATING_POINT_STORE,
+                                     MSU_EVENT_ENABLE),
+    [PMU_EVENT_FP_FMA] = HPM_EVENT(EVENT_SEL_INSTRUCTION_COMMIT,
+                                   EVENT_INSTRUCTION_COMMIT_FLOATING_POINT_FUSED_MULTIPLY_ADD_SUB,
+                                   MSU_EVENT_ENABLE),
+    [PMU_EVENT_ICACHE_MISS] = HPM_EVENT(EVENT_SEL_MEMORY_ACCESS, EVENT_MEMORY_ACCESS_ICACHE_MISS,
+                                        MSU_EVENT_ENABLE),
+    [PMU_EVENT_DCACHE_MISS] = HPM_EVENT(EVENT_SEL_MEMORY_ACCESS, EVENT_MEMORY_ACCESS_DCACHE_MISS,
+                                        MSU_EVENT_ENABLE),
+};
+
+static const char *const g_pmu_event_name[PMU_EVENT_MAX] = {
+    [PMU_EVENT_NONE] = "none",         [PMU_EVENT_LOAD] = "load",
+    [PMU_EVENT_STORE] = "store",       [PMU_EVENT_BRANCH] = "branch",
+    [PMU_EVENT_BRANCH_TAKEN] = "taken", [PMU_EVENT_BRANCH_MISS] = "br_miss",
+    [PMU_EVENT_JUMP_MISS] = "jr_miss", [PMU_EVENT_MUL] = "mul",
+    [PMU_EVENT_DIV] = "div",           [PMU_EVENT_FP_LOAD] = "fp_load",
+    [PMU_EVENT_FP_STORE] = "fp_store", [PMU_EVENT_FP_FMA] = "fp_fma",
+    [PMU_EVENT_ICACHE_MISS] = "i_miss", [PMU_EVENT_DCACHE_MISS] = "d_miss",
+};
+
+static const PmuEvent g_pmu_default_events[PMU_EVENT_NUM] = {
+    PMU_EVENT_LOAD,
+    PMU_EVENT_STORE,
+    PMU_EVENT_BRANCH,
+    PMU_EVENT_BRANCH_MISS,
+};
+
+static inline uint32_t pmu_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void pmu_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+/*
+ * The full counters are read on the switch path, a task that runs 2^32
+ * cycles without a switch (43 s at 100 MHz, e.g. idle) must not lose counts
+ */
+__STATIC_FORCEINLINE void pmu_read_csr(uint64_t *v)
+{
+    PMU_CSR_READ64(v[PMU_CNT_CYCLE], CSR_MCYCLE, CSR_MCYCLEH);
+    PMU_CSR_READ64(v[PMU_CNT_INSTRET], CSR_MINSTRET, CSR_MINSTRETH);
+    PMU_CSR_READ64(v[PMU_CNT_EVENT0], CSR_MHPMCOUNTER3, CSR_MHPMCOUNTER3H);
+    PMU_CSR_READ64(v[PMU_CNT_EVENT0 + 1], CSR_MHPMCOUNTER4, CSR_MHPMCOUNTER4H);
+    PMU_CSR_READ64(v[PMU_CNT_EVENT0 + 2], CSR_MHPMCOUNTER5, CSR_MHPMCOUNTER5H);
+    PMU_CSR_READ64(v[PMU_CNT_EVENT0 + 3], CSR_MHPMCOUNTER6, CSR_MHPMCOUNTER6H);
+}
+
+CRITICAL_SECTION
+static void pmu_charge(uint32_t slot, const uint64_t *now)
+{
+    uint32_t i;
+
+    for (i = 0; i < PMU_CNT_NUM; i++) {
+        g_pmu.slots[slot].val[i] += now[i] - g_pmu.last[i];
+        g_pmu.last[i] = now[i];
+    }
+}
+
+CRITICAL_SECTION
+static uint32_t pmu_slot_get(void *task)
+{
+    uint32_t i;
+
+    for (i = 0; i < PMU_TASK_NUM; i++) {
+        if (g_pmu.slots[i].task == task) {
+            return i;
+        }
+        if (!g_pmu.slots[i].task) {
+            g_pmu.slots[i].task = task;
+            return i;
+        }
+    }
+    return PMU_SLOT_OTHERS;
+}
+
+static int pmu_slot_find(void *task)
+{
+    uint32_t i;
+
+    for (i = 0; i < PMU_TASK_NUM && g_pmu.slots[i].task; i++) {
+        if (g_pmu.slots[i].task == task) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int pmu_init(const PmuEvent events[PMU_EVENT_NUM])
+{
+    uint32_t i;
+
+    if (!events) {
+        events = g_pmu_default_events;
+    }
+    for (i = 0; i < PMU_EVENT_NUM; i++) {
+        if (events[i] >= PMU_EVENT_MAX) {
+            return VPI_ERR_INVALID;
+        }
+    }
+
+    pmu_stop();
+    memset(&g_pmu, 0, sizeof(g_pmu));
+    for (i = 0; i < PMU_EVENT_NUM; i++) {
+        g_pmu.events[i] = events[i];
+        __set_hpm_event(PMU_HPM_FIRST + i, g_pmu_event_sel[events[i]]);
+        __set_hpm_counter(PMU_HPM_FIRST + i, 0);
+        __enable_mhpm_counter(PMU_HPM_FIRST + i);
+    }
+    __enable_mcycle_counter();
+    __enable_minstret_counter();
+    return VPI_SUCCESS;
+}
+
+int pmu_start(void)
+{
+    uint32_t mie;
+
+    mie       = pmu_lock();
+    g_pmu.cur = pmu_slot_get(pxCurrentTCB);
+    pmu_read_csr(g_pmu.last);
+    g_pmu.running = true;
+    pmu_unlock(mie);
+    return VPI_SUCCESS;
+}
+
+int pmu_stop(void)
+{
+    uint64_t now[PMU_CNT_NUM];
+    uint32_t mie;
+
+    mie = pmu_lock();
+    if (g_pmu.running) {
+        pmu_read_csr(now);
+        pmu_charge(g_pmu.cur, now);
+        g_pmu.running = false;
+    }
+    pmu_unlock(mie);
+    return VPI_SUCCESS;
+}
+
+int pmu_read_task(void *task, PmuCounters *out)
+{
+    uint64_t now[PMU_CNT_NUM];
+    uint32_t mie, i;
+    int slot;
+
+    if (!out) {
+        return VPI_ERR_INVALID;
+    }
+
+    mie = pmu_lock();
+    if (!task) {
+        task = pxCurrentTCB;
+    }
+    slot = pmu_slot_find(task);
+    if (slot < 0) {
+        pmu_unlock(mie);
+        return VPI_ERR_NODEVICE;
+    }
+    /* Bring the running task up to date so that regions see live counts */
+    if (g_pmu.running && (uint32_t)slot == g_pmu.cur) {
+        pmu_read_csr(now);
+        pmu_charge(g_pmu.cur, now);
+    }
+    for (i = 0; i < PMU_CNT_NUM; i++) {
+        out->val[i] = g_pmu.slots[slot].val[i];
+    }
+    pmu_unlock(mie);
+    return VPI_SUCCESS;
+}
+
+void pmu_read(PmuCounters *out)
+{
+    uint32_t i;
+
+    out->val[PMU_CNT_CYCLE]   = __get_rv_cycle();
+    out->val[PMU_CNT_INSTRET] = __get_rv_instret();
+    for (i = 0; i < PMU_EVENT_NUM; i++) {
+        out->val[PMU_CNT_EVENT0 + i] = __get_hpm_counter(PMU_HPM_FIRST + i);
+    }
+}
+
+/* Counts of the calling task while accounting runs, the physical ones otherwise */
+static void pmu_read_self(PmuCounters *out)
+{
+    if (!g_pmu.running || pmu_read_task(NULL, out) != VPI_SUCCESS) {
+        pmu_read(out);
+    }
+}
+
+void pmu_region_begin(PmuRegion *region)
+{
+    pmu_read_self(&region->start);
+}
+
+void pmu_region_end(PmuRegion *region)
+{
+    PmuCounters now;
+    uint32_t i;
+
+    pmu_read_self(&now);
+    for (i = 0; i < PMU_CNT_NUM; i++) {
+        region->sum.val[i] += now.val[i] - region->start.val[i];
+    }
+    region->calls++;
+}
+
+const char *pmu_event_name(PmuEvent event)
+{
+    return event < PMU_EVENT_MAX ? g_pmu_event_name[event] : "unknown";
+}
+
+/* uart_sprintf has no 64 bit conversion, print counts in decimal by hand */
+static char *pmu_fmt_u64(char *p, uint64_t v)
+{
+    char tmp[21];
+    int n = 0;
+
+    do {
+        tmp[n++] = '0' + (char)(v % 10);
+        v /= 10;
+    } while (v);
+    *p++ = ' ';
+    while (n) {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+static void pmu_write_line(PmuWriter writer, void *arg, const char *name, const uint64_t *val,
+                           uint32_t calls)
+{
+    char line[PMU_LINE_LEN];
+    uint64_t ipc;
+    uint32_t i;
+    char *p;
+
+    p = line + uart_sprintf(line, "%-16.16s %6u", name, (unsigned int)calls);
+    for (i = 0; i < PMU_CNT_NUM; i++) {
+        p = pmu_fmt_u64(p, val[i]);
+    }
+    ipc = val[PMU_CNT_CYCLE] ? val[PMU_CNT_INSTRET] * 1000 / val[PMU_CNT_CYCLE] : 0;
+    uart_sprintf(p, " %u.%03u\n", (unsigned int)(ipc / 1000), (unsigned int)(ipc % 1000));
+    writer(line, arg);
+}
+
+static const char *pmu_task_name(void *task, char *buf)
+{
+    if (!task) {
+        return "others";
+    }
+#if CONFIG_FREERTOS
+    {
+        TaskStatus_t *status;
+        UBaseType_t num, i;
+
+        /* A deleted task keeps its slot, only alive tasks are asked for names */
+        num    = uxTaskGetNumberOfTasks();
+        status = osal_malloc(num * sizeof(TaskStatus_t));
+        if (status) {
+            pmp_stack_guard_open();
+            num = uxTaskGetSystemState(status, num, NULL);
+            pmp_stack_guard_close();
+            for (i = 0; i < num; i++) {
+                if ((void *)status[i].xHandle == task) {
+                    strncpy(buf, status[i].pcTaskName, PMU_NAME_LEN - 1);
+                    buf[PMU_NAME_LEN - 1] = '\0';
+                    osal_free(status);
+                    return buf;
+                }
+            }
+            osal_free(status);
+        }
+    }
+#endif
+    uart_sprintf(buf, "%08x", (unsigned int)(uintptr_t)task);
+    return buf;
+}
+
+int pmu_dump(PmuRegion *const *regions, uint32_t num, PmuWriter writer, void *arg)
+{
+    char line[PMU_LINE_LEN];
+    char name[PMU_NAME_LEN];
+    PmuTaskSlot slot;
+    uint32_t i, mie;
+    int len;
+
+    if (!writer || (num && !regions)) {
+        return VPI_ERR_INVALID;
+    }
+
+    len = uart_sprintf(line, "%-16s %6s cycles instret", "name", "calls");
+    for (i = 0; i < PMU_EVENT_NUM; i++) {
+        len += uart_sprintf(line + len, " %s", pmu_event_name(g_pmu.events[i]));
+    }
+    uart_sprintf(line + len, " ipc\n");
+    writer(line, arg);
+
+    for (i = 0; i <= PMU_TASK_NUM; i++) {
+        mie = pmu_lock();
+        if (g_pmu.running && i == g_pmu.cur) {
+            uint64_t now[PMU_CNT_NUM];
+
+            pmu_read_csr(now);
+            pmu_charge(g_pmu.cur, now);
+        }
+        slot = g_pmu.slots[i];
+        pmu_unlock(mie);
+        if (i < PMU_TASK_NUM && !slot.task) {
+            continue;
+        }
+        if (i == PMU_SLOT_OTHERS && !slot.val[PMU_CNT_CYCLE]) {
+            continue;
+        }
+        pmu_write_line(writer, arg, pmu_task_name(slot.task, name), slot.val, 0);
+    }
+    for (i = 0; i < num; i++) {
+        pmu_write_line(writer, arg, regions[i]->name, regions[i]->sum.val, regions[i]->calls);
+    }
+    return VPI_SUCCESS;
+}
+
+CRITICAL_SECTION
+void pmu_port_switch(void *tcb)
+{
+    uint64_t now[PMU_CNT_NUM];
+
+    if (!g_pmu.running) {
+        return;
+    }
+    /* Time of the switch itself and of ISRs is charged to the task they interrupted */
+    pmu_read_csr(now);
+    pmu_charge(g_pmu.cur, now);
+    g_pmu.cur = pmu_slot_get(tcb);
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "profiler.h"
+#include "vpi_error.h"
+#include "sys_common.h"
+#include "platform.h"
+#include "osal_heap_api.h"
+#include "uart_printf.h"
+#if CONFIG_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pmp_stack_guard.h"
+#endif
+
+/* Linear probing stops after this many slots, the sample is dropped */
+#define PROFILER_MAX_PROBE 8
+#define PROFILER_LINE_LEN  48
+#define PROFILER_IRQ_LEVEL 1
+
+#if CONFIG_PROFILER
+#define IS_ENABLED_PROFILER 1
+#else
+#define IS_ENABLED_PROFILER 0
+#endif
+
+#define PROFILER_IRQ_HANDLER_NAME(n) riscv_irq##n##_handler
+#define PROFILER_IRQ_HANDLER(n)      PROFILER_IRQ_HANDLER_NAME(n)
+
+typedef struct ProfilerSlot {
+    uint32_t pc;
+    uint32_t task;
+    uint32_t count;
+} ProfilerSlot;
+
+typedef struct ProfilerCtx {
+    const ProfilerTimerOps *ops;
+    ProfilerSlot slots[PROFILER_SLOT_NUM];
+    uint32_t hz;
+    uint32_t samples;
+    uint32_t dropped;
+    volatile bool running;
+} ProfilerCtx;
+
+extern void *volatile pxCurrentTCB;
+
+static ProfilerCtx g_prof;
+
+CRITICAL_SECTION
+static void profiler_sample(uint32_t pc, uint32_t task)
+{
+    ProfilerSlot *slot;
+    uint32_t idx, i;
+
+    /* pc is at least 2 bytes aligned, mix in the task so that it spreads */
+    idx = ((pc >> 1) ^ (task >> 4)) * 2654435761U;
+    for (i = 0; i < PROFILER_MAX_PROBE; i++) {
+        slot = &g_prof.slots[(idx + i) % PROFILER_SLOT_NUM];
+        if (slot->count && (slot->pc != pc || slot->task != task)) {
+            continue;
+        }
+        slot->pc   = pc;
+        slot->task = task;
+        slot->count++;
+        g_prof.samples++;
+        return;
+    }
+    g_prof.dropped++;
+}
+
+#if CONFIG_PROFILER
+/* Called by irq_entry through JALMNXTI, mepc and msubm still describe the interrupted code */
+CRITICAL_SECTION
+void PROFILER_IRQ_HANDLER(CONFIG_PROFILER_TIMER_IRQ)(void)
+{
+    uint32_t pc    = __RV_CSR_READ(CSR_MEPC);
+    uint32_t subm  = __RV_CSR_READ(CSR_MSUBM);
+    uint32_t task  = PROFILER_TASK_ISR;
+
+    if (!(subm & MSUBM_PTYP)) {
+        task = (uint32_t)(uintptr_t)pxCurrentTCB;
+    }
+    if (g_prof.ops) {
+        g_prof.ops->clear();
+    }
+    if (g_prof.running) {
+        profiler_sample(pc, task);
+    }
+}
+#endif
+
+int profiler_init(const ProfilerTimerOps *ops)
+{
+    if (!ops || !ops->start || !ops->stop || !ops->clear) {
+        return VPI_ERR_INVALID;
+    }
+
+    memset(&g_prof, 0, sizeof(g_prof));
+    g_prof.ops = ops;
+    ECLIC_SetShvIRQ(CONFIG_PROFILER_TIMER_IRQ, ECLIC_NON_VECTOR_INTERRUPT);
+    ECLIC_SetTrigIRQ(CONFIG_PROFILER_TIMER_IRQ, ECLIC_LEVEL_TRIGGER);
+    ECLIC_SetLevelIRQ(CONFIG_PROFILER_TIMER_IRQ, PROFILER_IRQ_LEVEL);
+    return VPI_SUCCESS;
+}
+
+int profiler_start(uint32_t hz)
+{
+    int ret;
+
+    if (!g_prof.ops || !hz) {
+        return VPI_ERR_INVALID;
+    }
+    /* Without CONFIG_PROFILER the timer IRQ keeps its weak handler */
+    if (!IS_ENABLED_PROFILER) {
+        return VPI_ERR_NOT_READY;
+    }
+
+    profiler_stop();
+    memset(g_prof.slots, 0, sizeof(g_prof.slots));
+    g_prof.hz      = hz;
+    g_prof.samples = 0;
+    g_prof.dropped = 0;
+    g_prof.running = true;
+    ret            = g_prof.ops->start(hz);
+    if (ret) {
+        g_prof.running = false;
+        return VPI_ERR_IO;
+    }
+    ECLIC_EnableIRQ(CONFIG_PROFILER_TIMER_IRQ);
+    return VPI_SUCCESS;
+}
+
+int profiler_stop(void)
+{
+    if (!g_prof.ops) {
+        return VPI_ERR_INVALID;
+    }
+
+    g_prof.running = false;
+    ECLIC_DisableIRQ(CONFIG_PROFILER_TIMER_IRQ);
+    g_prof.ops->stop();
+    return VPI_SUCCESS;
+}
+
+static void profiler_dump_tasks(ProfilerWriter writer, void *arg)
+{
+#if CONFIG_FREERTOS
+    char line[PROFILER_LINE_LEN];
+    TaskStatus_t *status;
+    UBaseType_t num, i;
+
+    num    = uxTaskGetNumberOfTasks();
+    status = osal_malloc(num * sizeof(TaskStatus_t));
+    if (!status) {
+        return;
+    }
+    pmp_stack_guard_open();
+    num = uxTaskGetSystemState(status, num, NULL);
+    pmp_stack_guard_close();
+    for (i = 0; i < num; i++) {
+        uart_sprintf(line, "T %x %s\n", (unsigned int)(uintptr_t)status[i].xHandle,
+                     status[i].pcTaskName);
+        writer(line, arg);
+    }
+    osal_free(status);
+#else
+    (void)writer;
+    (void)arg;
+#endif
+}
+
+int profiler_dump(ProfilerWriter writer, void *arg)
+{
+    char line[PROFILER_LINE_LEN];
+    const ProfilerSlot *slot;
+    bool running;
+    uint32_t i;
+
+    if (!writer) {
+        return VPI_ERR_INVALID;
+    }
+
+    /* Samples keep their slots, only counts move, so a pause is enough */
+    running        = g_prof.running;
+    g_prof.running = false;
+    uart_sprintf(line, "# %x %x %x\n", (unsigned int)g_prof.hz, (unsigned int)g_prof.samples,
+                 (unsigned int)g_prof.dropped);
+    writer(line, arg);
+    profiler_dump_tasks(writer, arg);
+    for (i = 0; i < PROFILER_SLOT_NUM; i++) {
+        slot = &g_prof.slots[i];
+        if (slot->count) {
+            uart_sprintf(line, "S %x %x %x\n", (unsigned int)slot->pc,
+                         (unsigned int)slot->task, (unsigned int)slot->count);
+            writer(line, arg);
+        }
+    }
+    g_prof.running = running;
+    return VPI_SUCCESS;
+}
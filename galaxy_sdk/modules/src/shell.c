@@ -0,0 +1,596 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "shell.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+#include "platform.h"
+#include "hal_uart.h"
+#include "vsd_error.h"
+#include "uart_printf.h"
+#include "osal_task_api.h"
+#include "osal_heap_api.h"
+#include "osal_semaphore_api.h"
+#include "boot_init.h"
+#if CONFIG_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+#include "pmp_stack_guard.h"
+#endif
+
+#define SHELL_RX_LEN      64
+#define SHELL_TOP_MS      1000
+#define SHELL_PROMPT      "> "
+
+typedef struct ShellQueue {
+    const char *name;
+    void *queue;
+    volatile uint32_t peak;
+} ShellQueue;
+
+typedef struct Shell {
+    const UartDevice *dev;
+    UartAyncRecvParam recv;
+    OsalSemaphore sem;
+    char recv_buf[SHELL_LINE_LEN];
+    /* Written by the receive callback, read by the task */
+    char rx[SHELL_RX_LEN];
+    volatile uint32_t rx_wr;
+    uint32_t rx_rd;
+    char line[SHELL_LINE_LEN];
+    uint32_t len;
+    const ShellCmd *cmds[SHELL_CMD_NUM];
+    const ShellBench *benches[SHELL_BENCH_NUM];
+    ShellQueue queues[SHELL_WATCH_NUM];
+    void *timers[SHELL_WATCH_NUM];
+    volatile uint32_t irq[SHELL_IRQ_NUM + 1];
+    uint32_t irq_last[SHELL_IRQ_NUM + 1];
+    bool started;
+} Shell;
+
+static Shell g_shell;
+
+static inline uint32_t shell_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void shell_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+static char *shell_fmt_u64(char *p, uint64_t v)
+{
+    char tmp[21];
+    int n = 0;
+
+    do {
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    while (n) {
+        *p++ = tmp[--n];
+    }
+    *p = '\0';
+    return p;
+}
+
+CRITICAL_SECTION
+void shell_port_isr_enter(uint32_t mcause)
+{
+    uint32_t irq = mcause & MCAUSE_CAUSE;
+
+    g_shell.irq[MIN(irq, SHELL_IRQ_NUM)]++;
+}
+
+CRITICAL_SECTION
+void shell_queue_note(void *queue, uint32_t waiting)
+{
+    uint32_t i;
+
+    for (i = 0; i < SHELL_WATCH_NUM; i++) {
+        if (g_shell.queues[i].queue == queue) {
+            if (waiting > g_shell.queues[i].peak) {
+                g_shell.queues[i].peak = waiting;
+            }
+            return;
+        }
+    }
+}
+
+#if CONFIG_FREERTOS
+static TaskStatus_t *shell_snapshot(UBaseType_t *num, uint32_t *total)
+{
+    TaskStatus_t *status;
+    UBaseType_t n = uxTaskGetNumberOfTasks();
+
+    status = osal_malloc(n * sizeof(TaskStatus_t));
+    if (status) {
+        pmp_stack_guard_open();
+        n = uxTaskGetSystemState(status, n, total);
+        pmp_stack_guard_close();
+    }
+    *num = status ? n : 0;
+    return status;
+}
+
+static char shell_task_state(eTaskState state)
+{
+    switch (state) {
+    case eRunning:
+        return 'X';
+    case eReady:
+        return 'R';
+    case eBlocked:
+        return 'B';
+    case eSuspended:
+        return 'S';
+    default:
+        return 'D';
+    }
+}
+#endif
+
+static int shell_cmd_top(int argc, char *argv[])
+{
+#if CONFIG_FREERTOS
+    TaskStatus_t *before, *after;
+    UBaseType_t num_before, num_after, i, j;
+    uint32_t total_before, total_after, total, delta, permille, ms;
+
+    ms = argc > 1 ? (uint32_t)atoi(argv[1]) : 0;
+    ms = ms ? ms : SHELL_TOP_MS;
+    before = shell_snapshot(&num_before, &total_before);
+    if (!before) {
+        return VPI_ERR_NOMEM;
+    }
+    osal_sleep(ms);
+    after = shell_snapshot(&num_after, &total_after);
+    if (!after) {
+        osal_free(before);
+        return VPI_ERR_NOMEM;
+    }
+    total = total_after - total_before;
+    uart_printf("%-16s %4s %2s %8s %6s %6s\r\n", "task", "prio", "st", "delta", "cpu%", "free");
+    for (i = 0; i < num_after; i++) {
+        delta = after[i].ulRunTimeCounter;
+        /* Tasks created during the interval count from zero */
+        for (j = 0; j < num_before; j++) {
+            if (before[j].xHandle == after[i].xHandle) {
+                delta -= before[j].ulRunTimeCounter;
+                break;
+            }
+        }
+        permille = total ? (uint32_t)((uint64_t)delta * 1000 / total) : 0;
+        uart_printf("%-16s %4u %2c %8u %4u.%u %6u\r\n", after[i].pcTaskName,
+                    (unsigned int)after[i].uxCurrentPriority,
+                    shell_task_state(after[i].eCurrentState), (unsigned int)delta,
+                    (unsigned int)(permille / 10), (unsigned int)(permille % 10),
+                    (unsigned int)(after[i].usStackHighWaterMark * sizeof(StackType_t)));
+    }
+    uart_printf("%u ms, %u counts\r\n", (unsigned int)ms, (unsigned int)total);
+    osal_free(after);
+    osal_free(before);
+    return VPI_SUCCESS;
+#else
+    return VPI_ERR_NODEVICE;
+#endif
+}
+
+static int shell_cmd_heap(int argc, char *argv[])
+{
+#if CONFIG_FREERTOS
+    HeapStats_t stats;
+
+    vPortGetHeapStats(&stats);
+    uart_printf("%-8s %7s %7s %7s %7s %7s %6s %6s\r\n", "heap", "total", "free", "min", "largest",
+                "blocks", "allocs", "frees");
+    uart_printf("%-8s %7u %7u %7u %7u %7u %6u %6u\r\n", "cached",
+                (unsigned int)configTOTAL_HEAP_SIZE, (unsigned int)stats.xAvailableHeapSpaceInBytes,
+                (unsigned int)stats.xMinimumEverFreeBytesRemaining,
+                (unsigned int)stats.xSizeOfLargestFreeBlockInBytes,
+                (unsigned int)stats.xNumberOfFreeBlocks,
+                (unsigned int)stats.xNumberOfSuccessfulAllocations,
+                (unsigned int)stats.xNumberOfSuccessfulFrees);
+    return VPI_SUCCESS;
+#else
+    return VPI_ERR_NODEVICE;
+#endif
+}
+
+static int shell_cmd_queues(int argc, char *argv[])
+{
+#if CONFIG_FREERTOS
+    const ShellQueue *q;
+    uint32_t i, waiting, space;
+
+    uart_printf("%-16s %6s %6s %6s\r\n", "queue", "length", "used", "peak");
+    for (i = 0; i < SHELL_WATCH_NUM; i++) {
+        q = &g_shell.queues[i];
+        if (!q->queue) {
+            continue;
+        }
+        waiting = uxQueueMessagesWaiting(q->queue);
+        space   = uxQueueSpacesAvailable(q->queue);
+        shell_queue_note(q->queue, waiting);
+        uart_printf("%-16s %6u %6u %6u\r\n", q->name, (unsigned int)(waiting + space),
+                    (unsigned int)waiting, (unsigned int)q->peak);
+    }
+    return VPI_SUCCESS;
+#else
+    return VPI_ERR_NODEVICE;
+#endif
+}
+
+static int shell_cmd_timers(int argc, char *argv[])
+{
+#if CONFIG_FREERTOS
+    TimerHandle_t timer;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t i;
+    bool active;
+
+    uart_printf("%-16s %6s %8s %8s\r\n", "timer", "state", "period", "left");
+    for (i = 0; i < SHELL_WATCH_NUM; i++) {
+        timer = g_shell.timers[i];
+        if (!timer) {
+            continue;
+        }
+        active = xTimerIsTimerActive(timer) != pdFALSE;
+        uart_printf("%-16s %6s %8u %8u\r\n", pcTimerGetName(timer),
+                    active ? (uxTimerGetReloadMode(timer) ? "repeat" : "once") : "idle",
+                    (unsigned int)xTimerGetPeriod(timer),
+                    active ? (unsigned int)(xTimerGetExpiryTime(timer) - now) : 0U);
+    }
+    uart_printf("ticks in %u ms\r\n", (unsigned int)portTICK_PERIOD_MS);
+    return VPI_SUCCESS;
+#else
+    return VPI_ERR_NODEVICE;
+#endif
+}
+
+static int shell_cmd_irq(int argc, char *argv[])
+{
+    uint32_t i, count;
+
+#if !CONFIG_SHELL
+    uart_printf("build with CONFIG_SHELL to count interrupts\r\n");
+#endif
+    uart_printf("%-6s %10s %10s\r\n", "irq", "count", "delta");
+    for (i = 0; i <= SHELL_IRQ_NUM; i++) {
+        count = g_shell.irq[i];
+        if (!count) {
+            continue;
+        }
+        if (i < SHELL_IRQ_NUM) {
+            uart_printf("%-6u %10u %10u\r\n", (unsigned int)i, (unsigned int)count,
+                        (unsigned int)(count - g_shell.irq_last[i]));
+        } else {
+            uart_printf("%-6s %10u %10u\r\n", "other", (unsigned int)count,
+                        (unsigned int)(count - g_shell.irq_last[i]));
+        }
+        g_shell.irq_last[i] = count;
+    }
+    return VPI_SUCCESS;
+}
+
+static int shell_cmd_bench(int argc, char *argv[])
+{
+    const ShellBench *bench = NULL;
+    uint64_t cycles, instret;
+    uint32_t i, n;
+    char num[2][24];
+
+    for (i = 0; i < SHELL_BENCH_NUM && g_shell.benches[i]; i++) {
+        if (argc < 2) {
+            uart_printf("%s\r\n", g_shell.benches[i]->name);
+        } else if (!strcmp(argv[1], g_shell.benches[i]->name)) {
+            bench = g_shell.benches[i];
+        }
+    }
+    if (argc < 2) {
+        return VPI_SUCCESS;
+    }
+    if (!bench) {
+        return VPI_ERR_INVALID;
+    }
+    n = argc > 2 ? MAX(atoi(argv[2]), 1) : 1;
+
+    cycles  = __get_rv_cycle();
+    instret = __get_rv_instret();
+    for (i = 0; i < n; i++) {
+        bench->run(bench->arg);
+    }
+    cycles  = (__get_rv_cycle() - cycles) / n;
+    instret = (__get_rv_instret() - instret) / n;
+    shell_fmt_u64(num[0], cycles);
+    shell_fmt_u64(num[1], instret);
+    uart_printf("%s: %s cycles %s instret per run, %u runs\r\n", bench->name, num[0], num[1],
+                (unsigned int)n);
+    return VPI_SUCCESS;
+}
+
+static int shell_cmd_help(int argc, char *argv[]);
+
+static const ShellCmd g_shell_builtin[] = {
+    {"help", "list commands", shell_cmd_help},
+    {"top", "[ms] cpu usage of tasks over an interval", shell_cmd_top},
+    {"heap", "heap usage", shell_cmd_heap},
+    {"queues", "watched queues with high-water marks", shell_cmd_queues},
+    {"timers", "watched timers", shell_cmd_timers},
+    {"irq", "interrupt counts since boot and since last call", shell_cmd_irq},
+    {"bench", "[name [n]] run a benchmark n times", shell_cmd_bench},
+};
+
+static int shell_cmd_help(int argc, char *argv[])
+{
+    uint32_t i;
+
+    for (i = 0; i < ARRAY_SIZE(g_shell_builtin); i++) {
+        uart_printf("%-8s %s\r\n", g_shell_builtin[i].name, g_shell_builtin[i].help);
+    }
+    for (i = 0; i < SHELL_CMD_NUM && g_shell.cmds[i]; i++) {
+        uart_printf("%-8s %s\r\n", g_shell.cmds[i]->name, g_shell.cmds[i]->help);
+    }
+    return VPI_SUCCESS;
+}
+
+static const ShellCmd *shell_find(const char *name)
+{
+    uint32_t i;
+
+    for (i = 0; i < ARRAY_SIZE(g_shell_builtin); i++) {
+        if (!strcmp(name, g_shell_builtin[i].name)) {
+            return &g_shell_builtin[i];
+        }
+    }
+    for (i = 0; i < SHELL_CMD_NUM && g_shell.cmds[i]; i++) {
+        if (!strcmp(name, g_shell.cmds[i]->name)) {
+            return g_shell.cmds[i];
+        }
+    }
+    return NULL;
+}
+
+static void shell_exec(char *line)
+{
+    char *argv[SHELL_ARG_NUM];
+    const ShellCmd *cmd;
+    int argc = 0;
+    int ret;
+
+    while (*line && argc < SHELL_ARG_NUM) {
+        while (*line == ' ') {
+            *line++ = '\0';
+        }
+        if (*line) {
+            argv[argc++] = line;
+        }
+        while (*line && *line != ' ') {
+            line++;
+        }
+    }
+    if (!argc) {
+        return;
+    }
+    cmd = shell_find(argv[0]);
+    if (!cmd) {
+        uart_printf("unknown command %s, try help\r\n", argv[0]);
+        return;
+    }
+    ret = cmd->fn(argc, argv);
+    if (ret != VPI_SUCCESS) {
+        uart_printf("%s failed: %d\r\n", argv[0], ret);
+    }
+}
+
+static void shell_recv_cb(const void *device, uint32_t len, char *data)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        /* Full ring drops input, typing is far slower than the task */
+        if (g_shell.rx_wr - g_shell.rx_rd < SHELL_RX_LEN) {
+            g_shell.rx[g_shell.rx_wr % SHELL_RX_LEN] = data[i];
+            g_shell.rx_wr++;
+        }
+    }
+    osal_sem_post_isr(&g_shell.sem);
+}
+
+static void shell_input(char c)
+{
+    if (c == '\r' || c == '\n') {
+        uart_printf("\r\n");
+        g_shell.line[g_shell.len] = '\0';
+        shell_exec(g_shell.line);
+        g_shell.len = 0;
+        uart_printf(SHELL_PROMPT);
+    } else if (c == '\b' || c == 0x7F) {
+        if (g_shell.len) {
+            g_shell.len--;
+            uart_printf("\b \b");
+        }
+    } else if (c >= ' ' && g_shell.len < SHELL_LINE_LEN - 1) {
+        g_shell.line[g_shell.len++] = c;
+        uart_printf("%c", c);
+    }
+}
+
+static void shell_task(void *param)
+{
+    uart_printf("\r\n" SHELL_PROMPT);
+    while (1) {
+        /* Blocked until the receive callback posts, no polling when idle */
+        osal_sem_wait(&g_shell.sem, OSAL_WAIT_FOREVER);
+        while (g_shell.rx_rd != g_shell.rx_wr) {
+            shell_input(g_shell.rx[g_shell.rx_rd % SHELL_RX_LEN]);
+            g_shell.rx_rd++;
+        }
+        /* Drivers with one shot receiving need to be armed again */
+        hal_uart_async_recv_data(g_shell.dev, &g_shell.recv);
+    }
+}
+
+int shell_init(const ShellCfg *cfg)
+{
+    int ret;
+
+    if (!cfg || !cfg->stack) {
+        return VPI_ERR_INVALID;
+    }
+    if (g_shell.started) {
+        return VPI_ERR_BUSY;
+    }
+    g_shell.dev = hal_uart_get_device(cfg->uart_id);
+    if (!g_shell.dev) {
+        return VPI_ERR_NODEVICE;
+    }
+    if (osal_create_sem(&g_shell.sem) != OSAL_TRUE) {
+        return VPI_ERR_NOMEM;
+    }
+    g_shell.recv.buffer   = g_shell.recv_buf;
+    g_shell.recv.buff_len = sizeof(g_shell.recv_buf);
+    g_shell.recv.trig_len = 1;
+    g_shell.recv.callback = shell_recv_cb;
+    g_shell.recv.use_dma  = false;
+    ret = hal_uart_async_recv_data(g_shell.dev, &g_shell.recv);
+    if (ret != VSD_SUCCESS) {
+        osal_delete_sem(&g_shell.sem);
+        return vsd_to_vpi(ret);
+    }
+    if (!osal_create_task(shell_task, "shell", cfg->stack, cfg->priority, NULL)) {
+        hal_uart_stop(g_shell.dev);
+        osal_delete_sem(&g_shell.sem);
+        return VPI_ERR_NOMEM;
+    }
+    g_shell.started = true;
+    return VPI_SUCCESS;
+}
+
+/* Registration runs concurrently from the APPLICATION boot workers */
+int shell_add_cmd(const ShellCmd *cmd)
+{
+    uint32_t i, mie;
+
+    if (!cmd || !cmd->name || !cmd->fn) {
+        return VPI_ERR_INVALID;
+    }
+    mie = shell_lock();
+    for (i = 0; i < SHELL_CMD_NUM; i++) {
+        if (!g_shell.cmds[i]) {
+            g_shell.cmds[i] = cmd;
+            shell_unlock(mie);
+            return VPI_SUCCESS;
+        }
+    }
+    shell_unlock(mie);
+    return VPI_ERR_NOMEM;
+}
+
+int shell_add_bench(const ShellBench *bench)
+{
+    uint32_t i, mie;
+
+    if (!bench || !bench->name || !bench->run) {
+        return VPI_ERR_INVALID;
+    }
+    mie = shell_lock();
+    for (i = 0; i < SHELL_BENCH_NUM; i++) {
+        if (!g_shell.benches[i]) {
+            g_shell.benches[i] = bench;
+            shell_unlock(mie);
+            return VPI_SUCCESS;
+        }
+    }
+    shell_unlock(mie);
+    return VPI_ERR_NOMEM;
+}
+
+int shell_watch_queue(const char *name, void *queue)
+{
+    uint32_t i, mie;
+
+    if (!name || !queue) {
+        return VPI_ERR_INVALID;
+    }
+    mie = shell_lock();
+    for (i = 0; i < SHELL_WATCH_NUM; i++) {
+        if (!g_shell.queues[i].queue) {
+            g_shell.queues[i].name  = name;
+            g_shell.queues[i].peak  = 0;
+            g_shell.queues[i].queue = queue;
+            shell_unlock(mie);
+            return VPI_SUCCESS;
+        }
+    }
+    shell_unlock(mie);
+    return VPI_ERR_NOMEM;
+}
+
+int shell_watch_timer(void *timer)
+{
+    uint32_t i, mie;
+
+    if (!timer) {
+        return VPI_ERR_INVALID;
+    }
+    mie = shell_lock();
+    for (i = 0; i < SHELL_WATCH_NUM; i++) {
+        if (!g_shell.timers[i]) {
+            g_shell.timers[i] = timer;
+            shell_unlock(mie);
+            return VPI_SUCCESS;
+        }
+    }
+    shell_unlock(mie);
+    return VPI_ERR_NOMEM;
+}
+
+#if CONFIG_SHELL
+static int shell_boot_init(void)
+{
+    const ShellCfg cfg = {
+        .uart_id  = CONFIG_SHELL_UART_ID,
+        .priority = 1,
+        .stack    = 384,
+    };
+
+    return shell_init(&cfg);
+}
+
+BOOT_INIT(APPLICATION, 90, shell_boot_init, 0);
+#endif
@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "stack_profile.h"
+#include "vpi_error.h"
+#include "bsp_common.h"
+#include "platform.h"
+#include "uart_printf.h"
+#include "osal_task_api.h"
+#include "osal_heap_api.h"
+#include "boot_init.h"
+#include "shell.h"
+#if CONFIG_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pmp_stack_guard.h"
+#endif
+
+#define STACK_FILL_WORD     0xA5A5A5A5UL
+#define STACK_LINE_LEN      64
+/* Left untouched below the stack pointer when filling the live stack of main */
+#define STACK_FILL_GUARD    64
+#define STACK_TASK_STACK    256
+#define STACK_TASK_PRIO     1
+
+typedef struct StackTask {
+    void *handle;
+    uint32_t size;
+    uint32_t peak;
+    uint32_t peak_tick;
+    /* Order of deletion, 0 while the task lives */
+    uint32_t deleted;
+    char name[16];
+} StackTask;
+
+typedef struct StackProfile {
+    StackTask task[CONFIG_STACK_PROFILE_TASK_NUM];
+    uint32_t isr_peak;
+    uint32_t isr_peak_tick;
+    uint32_t deleted;
+} StackProfile;
+
+/* Interrupt stack, also the stack of main before the scheduler starts */
+extern uint32_t __StackBottom[];
+extern uint32_t __StackTop[];
+
+static StackProfile g_stack;
+
+static inline uint32_t stack_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void stack_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+static uint32_t stack_now(void)
+{
+#if CONFIG_FREERTOS
+    return (uint32_t)xTaskGetTickCount();
+#else
+    return 0;
+#endif
+}
+
+static uint32_t stack_recommend(uint32_t used)
+{
+    uint32_t bytes = used + used * CONFIG_STACK_PROFILE_MARGIN / 100 + STACK_PROFILE_SLACK;
+
+    return DIV_ROUND_UP(bytes, 16) * 16 / sizeof(uint32_t);
+}
+
+/* Live tasks only, the handle of a deleted task may be reused */
+static StackTask *stack_find(void *handle)
+{
+    uint32_t i;
+
+    for (i = 0; i < CONFIG_STACK_PROFILE_TASK_NUM; i++) {
+        if (g_stack.task[i].handle == handle && !g_stack.task[i].deleted) {
+            return &g_stack.task[i];
+        }
+    }
+    return NULL;
+}
+
+/* A free slot, else the slot of the task deleted first */
+static StackTask *stack_slot(void)
+{
+    StackTask *oldest = NULL;
+    uint32_t i;
+
+    for (i = 0; i < CONFIG_STACK_PROFILE_TASK_NUM; i++) {
+        if (!g_stack.task[i].size) {
+            return &g_stack.task[i];
+        }
+        if (g_stack.task[i].deleted && (!oldest || g_stack.task[i].deleted < oldest->deleted)) {
+            oldest = &g_stack.task[i];
+        }
+    }
+    return oldest;
+}
+
+static void stack_track(void *handle, const char *name, uint32_t words)
+{
+    StackTask *task;
+    uint32_t mie;
+
+    mie  = stack_lock();
+    task = stack_find(handle);
+    if (!task) {
+        task = stack_slot();
+    }
+    if (task) {
+        task->handle    = handle;
+        task->size      = words * sizeof(uint32_t);
+        task->peak      = 0;
+        task->peak_tick = 0;
+        task->deleted   = 0;
+        strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+        task->name[sizeof(task->name) - 1] = '\0';
+    }
+    stack_unlock(mie);
+}
+
+#if CONFIG_STACK_PROFILE
+/*
+ * Linked with --wrap=osal_create_task, see CMakeLists.txt, so that tasks of
+ * the prebuilt libraries are recorded too
+ */
+void *__real_osal_create_task(void *func, char *name, uint32_t stack_size,
+                              uint32_t task_priority, void *param);
+
+void *__wrap_osal_create_task(void *func, char *name, uint32_t stack_size,
+                              uint32_t task_priority, void *param)
+{
+    void *handle;
+
+    handle = __real_osal_create_task(func, name, stack_size, task_priority, param);
+    if (handle) {
+        stack_track(handle, name, stack_size);
+    }
+    return handle;
+}
+#endif
+
+static uint32_t stack_isr_used(void)
+{
+    const uint32_t *word = __StackBottom;
+
+    while (word < __StackTop && *word == STACK_FILL_WORD) {
+        word++;
+    }
+    return (uint32_t)((uintptr_t)__StackTop - (uintptr_t)word);
+}
+
+int stack_profile_init(void)
+{
+    uint32_t *word, *end;
+    uint32_t mie, i;
+
+    end = __StackTop;
+#if CONFIG_FREERTOS
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        end = (uint32_t *)(((uintptr_t)__builtin_frame_address(0) - STACK_FILL_GUARD) & ~3UL);
+    }
+#endif
+    /* No interrupt frame is live on the interrupt stack while a task runs */
+    mie = stack_lock();
+    for (word = __StackBottom; word < end; word++) {
+        *word = STACK_FILL_WORD;
+    }
+    g_stack.isr_peak      = 0;
+    g_stack.isr_peak_tick = 0;
+    for (i = 0; i < CONFIG_STACK_PROFILE_TASK_NUM; i++) {
+        g_stack.task[i].peak      = 0;
+        g_stack.task[i].peak_tick = 0;
+    }
+    stack_unlock(mie);
+    return VPI_SUCCESS;
+}
+
+
+int stack_profile_sample(void)
+{
+    uint32_t now = stack_now();
+    uint32_t used;
+
+    used = stack_isr_used();
+    if (used > g_stack.isr_peak) {
+        g_stack.isr_peak      = used;
+        g_stack.isr_peak_tick = now;
+    }
+
+#if CONFIG_FREERTOS
+    TaskStatus_t *status;
+    StackTask *task;
+    UBaseType_t num, i, j;
+    bool alive;
+
+    num    = uxTaskGetNumberOfTasks();
+    status = osal_malloc(num * sizeof(TaskStatus_t));
+    if (!status) {
+        return VPI_ERR_NOMEM;
+    }
+    pmp_stack_guard_open();
+    num = uxTaskGetSystemState(status, num, NULL);
+    pmp_stack_guard_close();
+    if (!stack_find(xTaskGetIdleTaskHandle())) {
+        stack_track(xTaskGetIdleTaskHandle(), NULL, configMINIMAL_STACK_SIZE);
+    }
+    if (!stack_find(xTimerGetTimerDaemonTaskHandle())) {
+        stack_track(xTimerGetTimerDaemonTaskHandle(), NULL, configTIMER_TASK_STACK_DEPTH);
+    }
+    for (j = 0; j < CONFIG_STACK_PROFILE_TASK_NUM; j++) {
+        task = &g_stack.task[j];
+        if (!task->handle || task->deleted) {
+            continue;
+        }
+        alive = false;
+        for (i = 0; i < num; i++) {
+            if (status[i].xHandle != task->handle) {
+                continue;
+            }
+            alive = true;
+            if (!task->name[0]) {
+                strncpy(task->name, status[i].pcTaskName, sizeof(task->name) - 1);
+            }
+            used = task->size -
+                   MIN(task->size, status[i].usStackHighWaterMark * sizeof(StackType_t));
+            if (used > task->peak) {
+                task->peak      = used;
+                task->peak_tick = now;
+            }
+            break;
+        }
+        if (!alive && !task->deleted) {
+            /* Keep the peak of a deleted task until its slot is needed */
+            task->deleted = ++g_stack.deleted;
+        }
+    }
+    osal_free(status);
+#endif
+    return VPI_SUCCESS;
+}
+
+int stack_profile_isr(StackUsage *out)
+{
+    uint32_t size = (uint32_t)((uintptr_t)__StackTop - (uintptr_t)__StackBottom);
+
+    if (!out) {
+        return VPI_ERR_INVALID;
+    }
+    stack_profile_sample();
+    strcpy(out->name, "isr");
+    out->size        = size;
+    out->used        = g_stack.isr_peak;
+    out->free        = size - g_stack.isr_peak;
+    out->peak_tick   = g_stack.isr_peak_tick;
+    out->recommended = stack_recommend(g_stack.isr_peak);
+    return VPI_SUCCESS;
+}
+
+static void stack_write(StackWriter writer, void *arg, const StackUsage *usage)
+{
+    char line[STACK_LINE_LEN];
+
+    uart_sprintf(line, "K %s %d %d %d %d\n", usage->name[0] ? usage->name : "-",
+                 (int)usage->size, (int)usage->used, (int)usage->free,
+                 (int)usage->recommended);
+    writer(line, arg);
+}
+
+int stack_profile_dump(StackWriter writer, void *arg)
+{
+    StackUsage usage;
+    const StackTask *task;
+    uint32_t i;
+    int ret;
+
+    if (!writer) {
+        return VPI_ERR_INVALID;
+    }
+    ret = stack_profile_isr(&usage);
+    if (ret != VPI_SUCCESS) {
+        return ret;
+    }
+    writer("# name size used free recommended_words\n", arg);
+    stack_write(writer, arg, &usage);
+
+    for (i = 0; i < CONFIG_STACK_PROFILE_TASK_NUM; i++) {
+        task = &g_stack.task[i];
+        if (!task->size) {
+            continue;
+        }
+        memset(&usage, 0, sizeof(usage));
+        memcpy(usage.name, task->name, sizeof(usage.name));
+        usage.size        = task->size;
+        usage.used        = task->peak;
+        usage.free        = task->size - task->peak;
+        usage.peak_tick   = task->peak_tick;
+        usage.recommended = stack_recommend(task->peak);
+        stack_write(writer, arg, &usage);
+    }
+
+#if CONFIG_FREERTOS
+    /* Tasks of the kernel or of libraries, only the free part is known */
+    TaskStatus_t *status;
+    UBaseType_t num, j;
+
+    num    = uxTaskGetNumberOfTasks();
+    status = osal_malloc(num * sizeof(TaskStatus_t));
+    if (!status) {
+        return VPI_ERR_NOMEM;
+    }
+    pmp_stack_guard_open();
+    num = uxTaskGetSystemState(status, num, NULL);
+    pmp_stack_guard_close();
+    for (j = 0; j < num; j++) {
+        if (stack_find(status[j].xHandle)) {
+            continue;
+        }
+        memset(&usage, 0, sizeof(usage));
+        strncpy(usage.name, status[j].pcTaskName, sizeof(usage.name) - 1);
+        usage.free = status[j].usStackHighWaterMark * sizeof(StackType_t);
+        stack_write(writer, arg, &usage);
+    }
+    osal_free(status);
+#endif
+    return VPI_SUCCESS;
+}
+
+#if CONFIG_STACK_PROFILE
+#if CONFIG_SHELL
+static void stack_uart_writer(const char *line, void *arg)
+{
+    uart_printf("%s", line);
+}
+
+static int stack_cmd(int argc, char *argv[])
+{
+    return stack_profile_dump(stack_uart_writer, NULL);
+}
+
+static const ShellCmd g_stack_cmd = {"stack", "peak stack usage of tasks and interrupts",
+                                     stack_cmd};
+#endif
+
+/* Kernel stacks are only scanned here, at the lowest priority but idle */
+static void stack_profile_task(void *param)
+{
+    while (1) {
+        osal_sleep(CONFIG_STACK_PROFILE_PERIOD_MS);
+        stack_profile_sample();
+    }
+}
+
+static int stack_profile_boot(void)
+{
+    int ret = stack_profile_init();
+
+    if (ret != VPI_SUCCESS) {
+        return ret;
+    }
+    if (!osal_create_task(stack_profile_task, "stack_profile", STACK_TASK_STACK,
+                          STACK_TASK_PRIO, NULL)) {
+        return VPI_ERR_NOMEM;
+    }
+#if CONFIG_SHELL
+    ret = shell_add_cmd(&g_stack_cmd);
+#endif
+    return ret;
+}
+
+BOOT_INIT(POST_KERNEL, 0, stack_profile_boot, 0);
+#endif
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "vs_conf.h"
+#include "trace_recorder.h"
+#include "uart_stream.h"
+#include "vpi_error.h"
+#include "sys_common.h"
+#include "bsp_common.h"
+#include "soc_sysctl.h"
+#include "platform.h"
+#include "osal_heap_api.h"
+#include "osal_task_api.h"
+#if CONFIG_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pmp_stack_guard.h"
+#endif
+
+/* Number of records sent in one uart_stream frame */
+#define TRACE_STREAM_CHUNK 32
+/* Task names are resent periodically so that a late receiver can decode */
+#define TRACE_STREAM_NAMES_MS 1000
+#define TRACE_STREAM_STACK    512
+#define TRACE_STREAM_PRIO     1
+/* ECLIC puts the interrupt id in the low bits of mcause */
+#define TRACE_MCAUSE_ID_MASK 0xFFF
+
+typedef struct TraceCtx {
+    TraceRecord *buf;
+    uint32_t mask;
+    uint32_t head;
+    uint32_t count;
+    uint32_t dropped;
+    uint8_t mode;
+    volatile bool active;
+    void *stream;
+    uint8_t channel;
+    uint32_t period_ms;
+} TraceCtx;
+
+static TraceCtx g_trace;
+
+static inline uint32_t trace_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void trace_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+int trace_init(TraceRecord *buf, uint32_t num, uint8_t mode)
+{
+    if (!buf || num < 2 || (num & (num - 1)) || mode > TRACE_MODE_STREAM) {
+        return VPI_ERR_INVALID;
+    }
+
+    memset(&g_trace, 0, sizeof(g_trace));
+    g_trace.buf  = buf;
+    g_trace.mask = num - 1;
+    g_trace.mode = mode;
+    return VPI_SUCCESS;
+}
+
+void trace_start(void)
+{
+    uint32_t mie;
+
+    if (!g_trace.buf) {
+        return;
+    }
+    mie             = trace_lock();
+    g_trace.head    = 0;
+    g_trace.count   = 0;
+    g_trace.dropped = 0;
+    g_trace.active  = true;
+    trace_unlock(mie);
+}
+
+void trace_stop(void)
+{
+    g_trace.active = false;
+}
+
+CRITICAL_SECTION
+void trace_record(uint8_t type, uint32_t obj, uint32_t arg)
+{
+    TraceRecord *rec;
+    uint64_t cycle;
+    uint32_t mie;
+
+    if (!g_trace.active) {
+        return;
+    }
+
+    mie = trace_lock();
+    if (g_trace.count > g_trace.mask) {
+        if (g_trace.mode == TRACE_MODE_STREAM) {
+            g_trace.dropped++;
+            trace_unlock(mie);
+            return;
+        }
+        /* Snapshot overwrites the oldest record */
+        g_trace.count--;
+    }
+    cycle        = __get_rv_cycle();
+    rec          = &g_trace.buf[g_trace.head];
+    rec->ts_lo   = (uint32_t)cycle;
+    rec->ts_hi   = (uint16_t)(cycle >> 32);
+    rec->type    = type;
+    rec->rsvd    = 0;
+    rec->obj     = obj;
+    rec->arg     = arg;
+    g_trace.head = (g_trace.head + 1) & g_trace.mask;
+    g_trace.count++;
+    trace_unlock(mie);
+}
+
+uint32_t trace_read(TraceRecord *out, uint32_t max)
+{
+    uint32_t mie, tail, num = 0;
+
+    if (!g_trace.buf || !out) {
+        return 0;
+    }
+
+    while (num < max) {
+        mie = trace_lock();
+        if (!g_trace.count) {
+            trace_unlock(mie);
+            break;
+        }
+        tail       = (g_trace.head - g_trace.count) & g_trace.mask;
+        out[num++] = g_trace.buf[tail];
+        g_trace.count--;
+        trace_unlock(mie);
+    }
+    return num;
+}
+
+static void trace_write_info(TraceWriter writer, void *arg)
+{
+    TraceBlockHdr hdr = {TRACE_MAGIC, TRACE_BLK_INFO, 1};
+    TraceInfo info;
+
+    memset(&info, 0, sizeof(info));
+    info.cpu_hz  = soc_cpu_clock_get_freq();
+    info.dropped = g_trace.dropped;
+    writer(&hdr, sizeof(hdr), arg);
+    writer(&info, sizeof(info), arg);
+}
+
+static void trace_write_tasks(TraceWriter writer, void *arg, uint32_t max)
+{
+#if CONFIG_FREERTOS
+    TraceBlockHdr hdr = {TRACE_MAGIC, TRACE_BLK_TASKS, 0};
+    TaskStatus_t *status;
+    TraceTaskName entry;
+    UBaseType_t num, i;
+
+    num    = uxTaskGetNumberOfTasks();
+    status = osal_malloc(num * sizeof(TaskStatus_t));
+    if (!status) {
+        return;
+    }
+    pmp_stack_guard_open();
+    num = uxTaskGetSystemState(status, num, NULL);
+    pmp_stack_guard_close();
+    num       = MIN(num, max);
+    hdr.count = num;
+    writer(&hdr, sizeof(hdr), arg);
+    for (i = 0; i < num; i++) {
+        entry.tcb = (uint32_t)(uintptr_t)status[i].xHandle;
+        strncpy(entry.name, status[i].pcTaskName, TRACE_NAME_LEN);
+        writer(&entry, sizeof(entry), arg);
+    }
+    osal_free(status);
+#else
+    (void)writer;
+    (void)arg;
+    (void)max;
+#endif
+}
+
+int trace_dump(TraceWriter writer, void *arg)
+{
+    TraceBlockHdr hdr = {TRACE_MAGIC, TRACE_BLK_RECORDS, 0};
+    TraceRecord rec;
+    bool active;
+
+    if (!g_trace.buf || !writer) {
+        return VPI_ERR_INVALID;
+    }
+
+    active         = g_trace.active;
+    g_trace.active = false;
+    trace_write_info(writer, arg);
+    trace_write_tasks(writer, arg, 0xFFFF);
+    while (g_trace.count) {
+        hdr.count = MIN(g_trace.count, 0xFFFF);
+        writer(&hdr, sizeof(hdr), arg);
+        while (hdr.count-- && trace_read(&rec, 1)) {
+            writer(&rec, sizeof(rec), arg);
+        }
+    }
+    g_trace.active = active;
+    return VPI_SUCCESS;
+}
+
+/* Collects the pieces given by the writer into one uart_stream frame */
+typedef struct TraceFrame {
+    uint8_t data[sizeof(TraceBlockHdr) + TRACE_STREAM_CHUNK * TRACE_ENTRY_SIZE];
+    uint32_t len;
+} TraceFrame;
+
+static void trace_frame_write(const void *data, uint32_t len, void *arg)
+{
+    TraceFrame *frame = (TraceFrame *)arg;
+
+    if (frame->len + len <= sizeof(frame->data)) {
+        memcpy(frame->data + frame->len, data, len);
+        frame->len += len;
+    }
+}
+
+static void trace_stream_names(void)
+{
+    TraceFrame frame;
+
+    frame.len = 0;
+    trace_write_info(trace_frame_write, &frame);
+    uart_stream_send(g_trace.stream, g_trace.channel, frame.data, frame.len);
+    frame.len = 0;
+    trace_write_tasks(trace_frame_write, &frame, TRACE_STREAM_CHUNK);
+    uart_stream_send(g_trace.stream, g_trace.channel, frame.data, frame.len);
+}
+
+static void trace_stream_task(void *param)
+{
+    TraceFrame frame;
+    TraceBlockHdr *hdr = (TraceBlockHdr *)frame.data;
+    uint32_t elapsed   = TRACE_STREAM_NAMES_MS;
+    uint32_t num, mie;
+
+    (void)param;
+    while (1) {
+        if (elapsed >= TRACE_STREAM_NAMES_MS) {
+            trace_stream_names();
+            elapsed = 0;
+        }
+        do {
+            num        = trace_read((TraceRecord *)(hdr + 1), TRACE_STREAM_CHUNK);
+            hdr->magic = TRACE_MAGIC;
+            hdr->type  = TRACE_BLK_RECORDS;
+            hdr->count = num;
+            if (num && uart_stream_send(g_trace.stream, g_trace.channel, frame.data,
+                                        sizeof(*hdr) + num * TRACE_ENTRY_SIZE) != VPI_SUCCESS) {
+                /* trace_record counts drops from interrupts too */
+                mie = trace_lock();
+                g_trace.dropped += num;
+                trace_unlock(mie);
+            }
+        } while (num == TRACE_STREAM_CHUNK);
+        osal_sleep(g_trace.period_ms);
+        elapsed += g_trace.period_ms;
+    }
+}
+
+int trace_stream_start(void *stream, uint8_t channel, uint32_t period_ms)
+{
+    if (!g_trace.buf || !stream || !period_ms || g_trace.mode != TRACE_MODE_STREAM) {
+        return VPI_ERR_INVALID;
+    }
+
+    g_trace.stream    = stream;
+    g_trace.channel   = channel;
+    g_trace.period_ms = period_ms;
+    if (!osal_create_task(trace_stream_task, "trace_stream", TRACE_STREAM_STACK,
+                          TRACE_STREAM_PRIO, NULL)) {
+        return VPI_ERR_NOMEM;
+    }
+    trace_start();
+    return VPI_SUCCESS;
+}
+
+CRITICAL_SECTION
+void trace_port_switch_out(void *tcb)
+{
+    trace_record(TRACE_EVT_TASK_OUT, (uint32_t)(uintptr_t)tcb, 0);
+}
+
+CRITICAL_SECTION
+void trace_port_switch_in(void *tcb)
+{
+    trace_record(TRACE_EVT_TASK_IN, (uint32_t)(uintptr_t)tcb, 0);
+}
+
+CRITICAL_SECTION
+void trace_port_isr_enter(uint32_t mcause)
+{
+    trace_record(TRACE_EVT_ISR_ENTER, mcause & TRACE_MCAUSE_ID_MASK, 0);
+}
+
+CRITICAL_SECTION
+void trace_port_isr_exit(uint32_t mcause)
+{
+    trace_record(TRACE_EVT_ISR_EXIT, mcause & TRACE_MCAUSE_ID_MASK, 0);
+}
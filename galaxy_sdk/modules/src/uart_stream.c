@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2024, VeriSilicon Holdings Co., Ltd. All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "uart_stream.h"
+#include "hal_uart.h"
+#include "hal_dmac.h"
+#include "vsd_error.h"
+#include "bsp_common.h"
+#include "platform.h"
+#include "osal_heap_api.h"
+#include "osal_task_api.h"
+
+/* COBS adds one byte every 254 bytes, one code byte and the delimiter */
+#define COBS_MAX_LEN(n) ((n) + (n) / 254 + 2)
+
+/* Time for UART to shift out its FIFO after the last DMA transfer */
+#define UART_STREAM_FIFO_DRAIN_MS 2
+
+enum UartStreamBufState {
+    STREAM_BUF_FREE,
+    STREAM_BUF_FILLING,
+    STREAM_BUF_READY,
+};
+
+typedef struct UartStream {
+    UartDevice *dev;
+    UartXferConfig *uart_cfg;
+    DmacXferCfg *xfer_cfg;
+    DmaCbAndParam dma_cb;
+    uint8_t *mem;
+    uint8_t **buf;
+    uint32_t *len;
+    volatile uint8_t *state;
+    uint32_t buf_size;
+    uint16_t max_payload;
+    uint8_t buf_num;
+    uint8_t head;
+    volatile uint8_t tail;
+    volatile uint8_t count;
+    volatile bool sending;
+    UartStreamStats stats;
+} UartStream;
+
+/*
+ * The driver may keep the pointer given to hal_uart_config, so the
+ * configuration with the switched baud rate outlives the stream
+ */
+typedef struct UartStreamDevCfg {
+    const UartDevice *dev;
+    UartXferConfig cfg;
+} UartStreamDevCfg;
+
+static UartStreamDevCfg g_stream_cfg[HAL_UART_DEV_MAX];
+
+typedef struct CobsEncoder {
+    uint8_t *out;
+    uint8_t *code_ptr;
+    uint8_t code;
+    uint16_t crc;
+} CobsEncoder;
+
+/* CRC-16/CCITT-FALSE, poly 0x1021 */
+static const uint16_t crc16_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+static inline uint32_t stream_lock(void)
+{
+    return __RV_CSR_READ_CLEAR(CSR_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void stream_unlock(uint32_t mie)
+{
+    if (mie) {
+        __RV_CSR_SET(CSR_MSTATUS, MSTATUS_MIE);
+    }
+}
+
+static inline void cobs_begin(CobsEncoder *enc, uint8_t *out)
+{
+    enc->code_ptr = out;
+    enc->out      = out + 1;
+    enc->code     = 1;
+    enc->crc      = 0xFFFF;
+}
+
+static inline void cobs_put(CobsEncoder *enc, uint8_t byte)
+{
+    if (byte) {
+        *enc->out++ = byte;
+        enc->code++;
+    }
+    if (!byte || enc->code == 0xFF) {
+        *enc->code_ptr = enc->code;
+        enc->code_ptr  = enc->out++;
+        enc->code      = 1;
+    }
+}
+
+static inline void cobs_put_crc(CobsEncoder *enc, uint8_t byte)
+{
+    enc->crc = (enc->crc << 8) ^ crc16_table[(enc->crc >> 8) ^ byte];
+    cobs_put(enc, byte);
+}
+
+static uint32_t cobs_end(CobsEncoder *enc, uint8_t *start)
+{
+    uint16_t crc = enc->crc;
+
+    cobs_put(enc, crc & 0xFF);
+    cobs_put(enc, crc >> 8);
+    *enc->code_ptr = enc->code;
+    *enc->out++    = 0;
+    return enc->out - start;
+}
+
+/* Release the buffer at tail, called with the stream locked */
+static inline void stream_dequeue(UartStream *st)
+{
+    st->state[st->tail] = STREAM_BUF_FREE;
+    st->tail            = (st->tail + 1) % st->buf_num;
+    st->count--;
+    st->sending = false;
+}
+
+static void stream_kick(UartStream *st)
+{
+    uint32_t mie;
+    uint8_t idx;
+
+    while (1) {
+        mie = stream_lock();
+        if (st->sending || !st->count || st->state[st->tail] != STREAM_BUF_READY) {
+            stream_unlock(mie);
+            return;
+        }
+        idx         = st->tail;
+        st->sending = true;
+        stream_unlock(mie);
+
+        st->xfer_cfg->src_addr = (uint32_t)(uintptr_t)st->buf[idx];
+        st->xfer_cfg->len      = st->len[idx];
+        if (hal_dmac_chan_start(st->dev->dmac_dev, st->xfer_cfg, &st->dma_cb) == VSD_SUCCESS) {
+            return;
+        }
+        /* No completion will come for the frame, drop it so the queue keeps moving */
+        mie = stream_lock();
+        stream_dequeue(st);
+        st->stats.errors++;
+        stream_unlock(mie);
+    }
+}
+
+DRV_ISR_SECTION
+static void stream_tx_done(const void *param)
+{
+    UartStream *st = (UartStream *)param;
+    uint32_t mie;
+
+    mie = stream_lock();
+    stream_dequeue(st);
+    stream_unlock(mie);
+    stream_kick(st);
+}
+
+static int stream_send_frame(UartStream *st, uint8_t channel, uint8_t type, const uint8_t *data,
+                             uint32_t len)
+{
+    CobsEncoder enc;
+    uint32_t mie, i;
+    uint16_t seq;
+    uint8_t idx;
+
+    mie = stream_lock();
+    seq = st->stats.seq++;
+    if (st->count >= st->buf_num) {
+        st->stats.dropped++;
+        stream_unlock(mie);
+        return VPI_ERR_FULL;
+    }
+    idx            = st->head;
+    st->head       = (st->head + 1) % st->buf_num;
+    st->state[idx] = STREAM_BUF_FILLING;
+    st->count++;
+    stream_unlock(mie);
+
+    cobs_begin(&enc, st->buf[idx]);
+    cobs_put_crc(&enc, seq & 0xFF);
+    cobs_put_crc(&enc, seq >> 8);
+    cobs_put_crc(&enc, channel);
+    cobs_put_crc(&enc, type);
+    for (i = 0; i < len; i++) {
+        cobs_put_crc(&enc, data[i]);
+    }
+    st->len[idx] = cobs_end(&enc, st->buf[idx]);
+
+    mie = stream_lock();
+    st->state[idx] = STREAM_BUF_READY;
+    st->stats.frames++;
+    st->stats.bytes += st->len[idx];
+    stream_unlock(mie);
+    stream_kick(st);
+    return VPI_SUCCESS;
+}
+
+static int stream_drain(UartStream *st, uint32_t timeout_ms)
+{
+    while (st->count) {
+        if (!timeout_ms--) {
+            return VPI_ERR_TIMEOUT;
+        }
+        osal_sleep(1);
+    }
+    osal_sleep(UART_STREAM_FIFO_DRAIN_MS);
+    return VPI_SUCCESS;
+}
+
+static UartXferConfig *stream_dev_cfg(const UartDevice *dev)
+{
+    UartXferConfig *cfg = NULL;
+    uint32_t mie, i;
+
+    mie = stream_lock();
+    for (i = 0; i < HAL_UART_DEV_MAX && !cfg; i++) {
+        if (g_stream_cfg[i].dev == dev) {
+            cfg = &g_stream_cfg[i].cfg;
+        }
+    }
+    for (i = 0; i < HAL_UART_DEV_MAX && !cfg; i++) {
+        if (!g_stream_cfg[i].dev) {
+            g_stream_cfg[i].dev = dev;
+            cfg                 = &g_stream_cfg[i].cfg;
+        }
+    }
+    stream_unlock(mie);
+    return cfg;
+}
+
+void *uart_stream_open(const UartStreamCfg *cfg)
+{
+    UartStream *st;
+    DmaInitCfg init_cfg;
+    uint32_t i;
+
+    if (!cfg || cfg->buf_num < 2 || !cfg->max_payload) {
+        return NULL;
+    }
+
+    st = osal_malloc(sizeof(UartStream));
+    if (!st) {
+        return NULL;
+    }
+    memset(st, 0, sizeof(UartStream));
+    st->dev = hal_uart_get_device(cfg->uart_id);
+    if (!st->dev || !st->dev->dmac_dev || !st->dev->xfer_cfg) {
+        goto err_free;
+    }
+    st->uart_cfg = stream_dev_cfg(st->dev);
+    if (!st->uart_cfg) {
+        goto err_free;
+    }
+
+    st->buf_num     = cfg->buf_num;
+    st->max_payload = cfg->max_payload;
+    st->buf_size =
+        DIV_ROUND_UP(COBS_MAX_LEN(UART_STREAM_HDR_LEN + cfg->max_payload + UART_STREAM_CRC_LEN),
+                     4) * 4;
+    st->buf = osal_malloc(cfg->buf_num * (sizeof(uint8_t *) + sizeof(uint32_t) + 1));
+    st->mem = osal_malloc_noncache(cfg->buf_num * st->buf_size);
+    if (!st->buf || !st->mem) {
+        goto err_free;
+    }
+    st->len   = (uint32_t *)(st->buf + cfg->buf_num);
+    st->state = (volatile uint8_t *)(st->len + cfg->buf_num);
+    for (i = 0; i < cfg->buf_num; i++) {
+        st->buf[i]   = st->mem + i * st->buf_size;
+        st->state[i] = STREAM_BUF_FREE;
+    }
+
+    memset(&init_cfg, 0, sizeof(init_cfg));
+    init_cfg.src_type    = DMA_PERI_MEM;
+    init_cfg.dst_type    = DMA_UART;
+    init_cfg.fifo_width  = WIDTH_8_BITS_TYPE;
+    init_cfg.mux_id      = st->dev->hw_cfg->tx_mux_id;
+    init_cfg.block_ts    = MIN(st->buf_size, st->dev->dmac_dev->max_blk_ts);
+    init_cfg.src_addr    = (uint32_t)(uintptr_t)st->mem;
+    init_cfg.dst_addr    = cfg->fifo_addr ? cfg->fifo_addr : st->dev->hw_cfg->base;
+    init_cfg.len         = st->buf_size;
+    init_cfg.trigger_lvl = 1;
+    if (hal_dmac_chan_init(st->dev->dmac_dev, &st->xfer_cfg, &init_cfg) != VSD_SUCCESS) {
+        goto err_free;
+    }
+    st->dma_cb.callback = stream_tx_done;
+    st->dma_cb.param    = st;
+    *st->uart_cfg       = *st->dev->xfer_cfg;
+    return st;
+
+err_free:
+    if (st->mem) {
+        osal_free_noncache(st->mem);
+    }
+    if (st->buf) {
+        osal_free(st->buf);
+    }
+    osal_free(st);
+    return NULL;
+}
+
+int uart_stream_send(void *stream, uint8_t channel, const void *data, uint32_t len)
+{
+    UartStream *st = (UartStream *)stream;
+
+    if (!st || (!data && len)) {
+        return VPI_ERR_INVALID;
+    }
+    if (len > st->max_payload) {
+        return VPI_ERR_INVALID;
+    }
+    return stream_send_frame(st, channel, UART_STREAM_DATA, (const uint8_t *)data, len);
+}
+
+int uart_stream_send_text(void *stream, uint8_t channel, const char *text)
+{
+    UartStream *st = (UartStream *)stream;
+    uint32_t len;
+
+    if (!st || !text) {
+        return VPI_ERR_INVALID;
+    }
+    len = strlen(text);
+    if (len > st->max_payload) {
+        return VPI_ERR_INVALID;
+    }
+    return stream_send_frame(st, channel, UART_STREAM_TEXT, (const uint8_t *)text, len);
+}
+
+int uart_stream_set_baud(void *stream, uint32_t baud_rate, uint32_t timeout_ms)
+{
+    UartStream *st = (UartStream *)stream;
+    uint8_t payload[4];
+    int ret;
+
+    if (!st || !baud_rate || baud_rate > UART_BAUD_DIV32) {
+        return VPI_ERR_INVALID;
+    }
+
+    payload[0] = baud_rate & 0xFF;
+    payload[1] = (baud_rate >> 8) & 0xFF;
+    payload[2] = (baud_rate >> 16) & 0xFF;
+    payload[3] = baud_rate >> 24;
+    /* Let the announcement and everything before it leave at the old rate */
+    ret = stream_drain(st, timeout_ms);
+    if (ret == VPI_SUCCESS) {
+        ret = stream_send_frame(st, 0, UART_STREAM_BAUD, payload, sizeof(payload));
+    }
+    if (ret == VPI_SUCCESS) {
+        ret = stream_drain(st, timeout_ms);
+    }
+    if (ret != VPI_SUCCESS) {
+        return ret;
+    }
+
+    st->uart_cfg->baud_rate = baud_rate;
+    return vsd_to_vpi(hal_uart_config(st->dev, st->uart_cfg));
+}
+
+int uart_stream_get_stats(void *stream, UartStreamStats *stats)
+{
+    UartStream *st = (UartStream *)stream;
+    uint32_t mie;
+
+    if (!st || !stats) {
+        return VPI_ERR_INVALID;
+    }
+
+    mie    = stream_lock();
+    *stats = st->stats;
+    stream_unlock(mie);
+    return VPI_SUCCESS;
+}
+
+int uart_stream_close(void *stream, uint32_t timeout_ms)
+{
+    UartStream *st = (UartStream *)stream;
+    int ret;
+
+    if (!st) {
+        return VPI_ERR_INVALID;
+    }
+
+    /* On timeout the frames still queued are discarded */
+    ret = stream_drain(st, timeout_ms);
+    hal_dmac_chan_stop(st->dev->dmac_dev, st->xfer_cfg);
+    osal_free_noncache(st->mem);
+    osal_free(st->buf);
+    osal_free(st);
+    return ret;
+}
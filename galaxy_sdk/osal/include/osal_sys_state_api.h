@@ -60,6 +60,8 @@ extern "C" {
 
 /**
  * @brief Dump current status of all tasks
+ * @note With CONFIG_PMP_STACK_GUARD call it between pmp_stack_guard_open and
+ * pmp_stack_guard_close, it reads the bottom of the stacks
  */
 void osal_dump_os_state(void);
 
@@ -85,6 +85,14 @@ void osal_suspend_all(void);
  */
 void osal_resume_all(void);
 
+#if CONFIG_LATENCY_STATS
+/* Time the scheduler locked sections, see latency_stats.h */
+void latency_sched_lock(void);
+void latency_sched_unlock(void);
+#define osal_suspend_all() latency_sched_lock()
+#define osal_resume_all()  latency_sched_unlock()
+#endif
+
 /**
  * @brief Place the calling task into the sleep(aka blocked) state until the
  * sleep period has expired
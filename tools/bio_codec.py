@@ -0,0 +1,183 @@
+import argparse
+import struct
+import sys
+
+# Must match bio_codec.h and bio_codec.c
+MAGIC = 0xB0
+RAW = 0x0F
+HEADER = 6
+BLOCK_MAX = 4096
+ESCAPE = 20
+RICE_N0 = 4
+RICE_RESET = 32
+RICE_K_MAX = 24
+RICE_U_MAX = 1 << 26
+
+class Rice:
+    def __init__(self, k0):
+        self.a, self.n, self.k = RICE_N0 << k0, RICE_N0, k0
+
+    def update(self, u):
+        self.a += min(u, RICE_U_MAX)
+        self.n += 1
+        if self.n == RICE_RESET:
+            self.a >>= 1
+            self.n >>= 1
+        self.k = 0
+        while self.k < RICE_K_MAX and (self.n << self.k) < self.a:
+            self.k += 1
+
+def predict(x, n, order):
+    order = min(n, order)
+    if order == 0:
+        return 0
+    if order == 1:
+        return x[n - 1]
+    if order == 2:
+        return 2 * x[n - 1] - x[n - 2]
+    return 3 * (x[n - 1] - x[n - 2]) + x[n - 3]
+
+class Reader:
+    def __init__(self, data, pos):
+        self.data, self.pos, self.acc, self.n = data, pos, 0, 0
+
+    def get(self, n):
+        while self.n < n:
+            if self.pos >= len(self.data):
+                raise ValueError("block truncated")
+            self.acc = (self.acc << 8 | self.data[self.pos]) & 0xFFFFFFFF
+            self.pos += 1
+            self.n += 8
+        self.n -= n
+        return (self.acc >> self.n) & ((1 << n) - 1)
+
+class Writer:
+    def __init__(self):
+        self.out, self.acc, self.n = bytearray(), 0, 0
+
+    def put(self, v, n):
+        self.acc = (self.acc << n | (v & ((1 << n) - 1))) & 0xFFFFFFFF
+        self.n += n
+        while self.n >= 8:
+            self.n -= 8
+            self.out.append((self.acc >> self.n) & 0xFF)
+
+    def flush(self):
+        if self.n:
+            self.put(0, 8 - self.n)
+        return self.out
+
+def decode_block(data, pos=0):
+    """Samples, sequence number and position after the block"""
+    if len(data) - pos < HEADER:
+        raise ValueError("block truncated")
+    head, bits, count, k0, seq = struct.unpack_from("<BBHBB", data, pos)
+    mode = head & 0x0F
+    if head & 0xF0 != MAGIC or (mode > 3 and mode != RAW) or not 8 <= bits <= 24 \
+            or not 0 < count <= BLOCK_MAX or k0 > RICE_K_MAX:
+        raise ValueError(f"bad header at {pos}")
+    r, rice, x = Reader(data, pos + HEADER), Rice(k0), []
+    lo, hi = -(1 << (bits - 1)), (1 << (bits - 1)) - 1
+    for n in range(count):
+        if mode == RAW:
+            v = r.get(bits)
+            x.append(v - (1 << bits) if v > hi else v)
+            continue
+        q = 0
+        while q < ESCAPE and not r.get(1):
+            q += 1
+        if q == ESCAPE:
+            if not r.get(1):
+                raise ValueError(f"bad escape at {pos}")
+            u = r.get(bits - 8) << 12 | r.get(12)
+        else:
+            u = q << rice.k | r.get(rice.k)
+        rice.update(u)
+        v = (u >> 1 ^ -(u & 1)) + predict(x, n, mode)
+        if not lo <= v <= hi:
+            raise ValueError(f"sample out of range at {pos}")
+        x.append(v)
+    return x, seq, r.pos
+
+def encode_block(x, bits, order=None, seq=0):
+    """Same bytes as bio_encode, order None for the automatic choice"""
+    num = len(x)
+    bound = HEADER + (num * bits + 7) // 8
+    sums = [0] * 4
+    for n in range(3, num):
+        sums[0] += abs(x[n])
+        for k in range(1, 4):
+            sums[k] += abs(x[n] - predict(x, n, k))
+    if order is None:
+        order = min(range(4), key=lambda k: (sums[k], k))
+    k0 = 0
+    while k0 < RICE_K_MAX and (num << k0) < 2 * sums[order]:
+        k0 += 1
+    w, rice = Writer(), Rice(k0)
+    for n in range(num):
+        r = x[n] - predict(x, n, order)
+        u = r << 1 if r >= 0 else (-(r + 1) << 1) | 1
+        q = u >> rice.k
+        if q < ESCAPE:
+            w.put(1, q + 1)
+            w.put(u, rice.k)
+        else:
+            w.put(1, ESCAPE + 1)
+            w.put(u >> 12, bits - 8)
+            w.put(u, 12)
+        rice.update(u)
+    body = w.flush()
+    if HEADER + len(body) >= bound:
+        w = Writer()
+        for v in x:
+            w.put(v, bits)
+        body, order = w.flush(), RAW
+    return struct.pack("<BBHBB", MAGIC | order, bits, num, k0, seq & 0xFF) + body
+
+def read_samples(path):
+    with open(path) as f:
+        return [int(v) for line in f for v in line.replace(",", " ").split()]
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Host side of the bio_codec block format")
+    parser.add_argument("input", help="concatenated blocks, or text samples with --encode")
+    parser.add_argument("-o", "--out", help="decoded samples as text, or blocks with --encode")
+    parser.add_argument("-e", "--encode", action="store_true", help="encode text samples to estimate the ratio")
+    parser.add_argument("-b", "--bits", type=int, default=16, help="sample width for --encode")
+    parser.add_argument("-n", "--block", type=int, default=128, help="samples per block for --encode")
+    parser.add_argument("--order", type=int, choices=range(4), help="fixed order for --encode, default per block")
+    args = parser.parse_args()
+
+    if args.encode:
+        x = read_samples(args.input)
+        blocks = [encode_block(x[i:i + args.block], args.bits, args.order, i // args.block)
+                  for i in range(0, len(x), args.block)]
+        data = b"".join(blocks)
+        raw = (len(x) * args.bits + 7) // 8
+        print(f"{len(x)} samples in {len(blocks)} blocks: {raw} -> {len(data)} bytes, "
+              f"ratio {raw / max(len(data), 1):.2f}")
+        if args.out:
+            with open(args.out, "wb") as f:
+                f.write(data)
+        sys.exit(0)
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    samples, pos, blocks, lost, raw_bits, expect = [], 0, 0, 0, 0, None
+    while pos < len(data):
+        try:
+            x, seq, end = decode_block(data, pos)
+        except ValueError as e:
+            sys.exit(f"{e}, {len(samples)} samples decoded")
+        if expect is not None and seq != expect:
+            lost += (seq - expect) & 0xFF
+        expect = (seq + 1) & 0xFF
+        raw_bits += len(x) * data[pos + 1]
+        samples.extend(x)
+        blocks += 1
+        pos = end
+    print(f"{len(samples)} samples in {blocks} blocks, {lost} lost: {(raw_bits + 7) // 8} -> "
+          f"{len(data)} bytes, ratio {raw_bits / 8 / max(len(data), 1):.2f}")
+    if args.out:
+        with open(args.out, "w") as f:
+            f.write("\n".join(str(v) for v in samples) + "\n")
@@ -0,0 +1,165 @@
+import argparse
+import bisect
+import os
+import re
+import sys
+from collections import Counter
+
+SECTION_RE = re.compile(r"^ (\.\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+))?$")
+CONT_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+)$")
+SYMBOL_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+([A-Za-z_$.][\w$.]*)$")
+ARCHIVE_RE = re.compile(r"^(.*?)([^/\\]+\.a)\((.+)\)$")
+
+# Code which runs before .hottext is loaded or must stay in ROM
+EXCLUDE_SECTIONS = (".text.startup", ".text.unlikely", ".text.entry", ".init", ".vtable")
+
+class InputSection:
+    def __init__(self, name, addr, size, obj, out):
+        self.name = name
+        self.addr = addr
+        self.size = size
+        self.obj = obj
+        self.out = out
+        self.symbols = []
+        self.samples = 0
+
+    def pattern(self):
+        # Archive members are matched as *libfoo.a:member.o, objects by their path tail
+        m = ARCHIVE_RE.match(self.obj)
+        if m:
+            return f"*{m.group(2)}:{m.group(3)}({self.name})"
+        tail = "/".join(self.obj.replace("\\", "/").split("/")[-2:])
+        return f"*{tail}({self.name})"
+
+def parse_map(path):
+    """Input sections of the memory map part of a GNU ld map file"""
+    sections = []
+    out = None
+    pending = None
+    in_map = False
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                in_map = True
+                continue
+            if not in_map:
+                continue
+            if line and not line.startswith(" "):
+                out = line.split()[0]
+                pending = None
+                continue
+            m = SECTION_RE.match(line)
+            if m:
+                if m.group(2):
+                    sections.append(InputSection(m.group(1), int(m.group(2), 16),
+                                                 int(m.group(3), 16), m.group(4).strip(), out))
+                    pending = None
+                else:
+                    # Long section names are followed by address, size and file on the next line
+                    pending = m.group(1)
+                continue
+            m = CONT_RE.match(line)
+            if m and pending:
+                sections.append(InputSection(pending, int(m.group(1), 16), int(m.group(2), 16),
+                                             m.group(3).strip(), out))
+                pending = None
+                continue
+            m = SYMBOL_RE.match(line)
+            if m and sections:
+                sections[-1].symbols.append((int(m.group(1), 16), m.group(2)))
+    return [s for s in sections if s.size and s.out in (".text", ".itext", ".hottext")]
+
+def load_profile(path, sections):
+    """Samples per input section from a profiler dump or 'symbol count' lines"""
+    by_addr = sorted(sections, key=lambda s: s.addr)
+    starts = [s.addr for s in by_addr]
+    by_symbol = {}
+    for s in sections:
+        for _, name in s.symbols:
+            by_symbol[name] = s
+    unknown = Counter()
+    with open(path, errors="replace") as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) == 4 and parts[0] == "S":
+                # profiler_dump: S pc task count, all in hex
+                pc, count = int(parts[1], 16), int(parts[3], 16)
+                i = bisect.bisect_right(starts, pc) - 1
+                if i >= 0 and pc < by_addr[i].addr + by_addr[i].size:
+                    by_addr[i].samples += count
+                else:
+                    unknown[f"0x{pc:08x}"] += count
+            elif len(parts) == 2 and not parts[0].startswith("#"):
+                # gcov-style "function count" or folded "task;function count"
+                if parts[1].isdigit():
+                    name, count = parts[0].split(";")[-1], int(parts[1])
+                elif parts[0].isdigit():
+                    name, count = parts[1], int(parts[0])
+                else:
+                    continue
+                if name in by_symbol:
+                    by_symbol[name].samples += count
+                else:
+                    unknown[name] += count
+    return unknown
+
+def choose(sections, budget, min_share):
+    total = sum(s.samples for s in sections) or 1
+    # .itext holds CRITICAL_SECTION code which the linker keeps in ROM
+    candidates = [s for s in sections if s.samples and s.samples >= total * min_share
+                  and s.out != ".itext"
+                  and not any(s.name == e or s.name.startswith(e + ".") for e in EXCLUDE_SECTIONS)]
+    # Greedy by samples per byte, a knapsack solution gains little over this
+    candidates.sort(key=lambda s: s.samples / s.size, reverse=True)
+    chosen, used = [], 0
+    for s in candidates:
+        size = (s.size + 3) & ~3
+        if used + size <= budget:
+            chosen.append(s)
+            used += size
+    return chosen, used, total
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Place the hottest code into .hottext within a RAM budget")
+    parser.add_argument("profile", help="profiler_dump output, or 'function count' lines")
+    parser.add_argument("map", help="linker map, e.g. build/qemu.map")
+    parser.add_argument("-b", "--budget", type=lambda v: int(v, 0), default=16 * 1024,
+                        help="bytes of RAM given to .hottext")
+    parser.add_argument("-m", "--min-share", type=float, default=0.001,
+                        help="ignore sections below this share of all samples")
+    parser.add_argument("-o", "--out", default=os.path.join("galaxy_sdk", "hot_sections.ld"),
+                        help="linker script fragment INCLUDEd in .hottext")
+    parser.add_argument("-a", "--assign", default="hot_sections.txt", help="section assignment report")
+    args = parser.parse_args()
+
+    sections = parse_map(args.map)
+    if not sections:
+        sys.exit("no code sections found in map file")
+    unknown = load_profile(args.profile, sections)
+    chosen, used, total = choose(sections, args.budget, args.min_share)
+
+    hot = sum(s.samples for s in chosen)
+    with open(args.assign, "w") as f:
+        f.write(f"# budget {args.budget} used {used} samples {total} in_ram {hot}\n")
+        f.write("# samples size placement section object\n")
+        for s in sorted(sections, key=lambda s: -s.samples):
+            if not s.samples:
+                continue
+            where = "ram" if s in chosen else "flash"
+            f.write(f"{s.samples} {s.size} {where} {s.name} {s.obj}\n")
+    with open(args.out, "w") as f:
+        f.write("/*\n")
+        f.write(" * Input sections placed in .hottext in RAM, INCLUDEd by n309_iot_qemu.ld.\n")
+        f.write(f" * Generated by tools/hot_placement.py from {os.path.basename(args.profile)},\n")
+        f.write(f" * {used} of {args.budget} bytes, {100.0 * hot / total:.1f}% of samples.\n")
+        f.write(" */\n")
+        for s in chosen:
+            f.write(f"{s.pattern()}\n")
+
+    print(f"placed {len(chosen)} sections, {used}/{args.budget} bytes of RAM, "
+          f"{100.0 * hot / total:.1f}% of samples now run from RAM")
+    if unknown:
+        print(f"{sum(unknown.values())} samples outside known code, e.g. "
+              + ", ".join(k for k, _ in unknown.most_common(5)))
+    print(f"fragment in {args.out}, assignment in {args.assign}")
@@ -0,0 +1,294 @@
+import argparse
+import json
+import math
+import os
+import sys
+
+# Must match NnOp of nn_int8.h
+OPS = {"conv1d": "NN_CONV1D", "dwconv1d": "NN_DWCONV1D", "dense": "NN_DENSE",
+       "maxpool": "NN_MAXPOOL", "avgpool": "NN_AVGPOOL", "relu": "NN_RELU", "softmax": "NN_SOFTMAX"}
+WEIGHTED = ("conv1d", "dwconv1d", "dense")
+
+def align4(n):
+    return (n + 3) & ~3
+
+def flatten(v):
+    if isinstance(v, list):
+        return [x for item in v for x in flatten(item)]
+    return [float(v)]
+
+def quant_params(lo, hi):
+    """Asymmetric int8 format covering [lo, hi] and 0"""
+    lo, hi = min(lo, 0.0), max(hi, 0.0)
+    scale = (hi - lo) / 255 or 1.0
+    zero = max(-128, min(127, round(-128 - lo / scale)))
+    return scale, zero
+
+def quantize_multiplier(m):
+    """q31 mantissa and exponent with m = mult * 2^(shift - 31)"""
+    if m <= 0:
+        return 0, 0
+    frac, exp = math.frexp(m)
+    q = round(frac * (1 << 31))
+    if q == 1 << 31:
+        q, exp = q // 2, exp + 1
+    if exp < -31:
+        return 0, 0
+    if exp > 30:
+        sys.exit(f"multiplier {m} out of range")
+    return q, exp
+
+class Tensor:
+    def __init__(self, length, ch):
+        self.len, self.ch = length, ch
+        self.scale, self.zero = 1.0, 0
+        self.buffer = None
+
+class Layer:
+    def __init__(self, spec, index, tin):
+        self.op = spec["op"]
+        if self.op not in OPS:
+            sys.exit(f"layer {index}: unknown op {self.op}")
+        self.spec, self.index, self.tin = spec, index, tin
+        self.kernel = spec.get("kernel", spec.get("pool", 1))
+        self.stride = spec.get("stride", self.kernel if self.op in ("maxpool", "avgpool") else 1)
+        self.pad, self.activation = 0, spec.get("activation")
+        length = tin.len
+        if self.op in ("conv1d", "dwconv1d") and spec.get("padding", "valid") == "same":
+            length = -(-tin.len // self.stride)
+            self.pad = max((length - 1) * self.stride + self.kernel - tin.len, 0) // 2
+        elif self.op in ("conv1d", "dwconv1d", "maxpool", "avgpool"):
+            length = (tin.len - self.kernel) // self.stride + 1
+        ch = {"conv1d": spec.get("filters"), "dense": spec.get("units")}.get(self.op, tin.ch)
+        if self.op == "dense":
+            length = 1
+        if length < 1 or not ch or self.kernel > 255 or self.stride > 255 or self.pad > 255:
+            sys.exit(f"layer {index}: bad shape")
+        self.tout = Tensor(length, ch)
+        self.weight, self.bias = [], []
+        if self.op in WEIGHTED:
+            self.load_weights()
+
+    def load_weights(self):
+        # Keras layouts: conv1d [kernel][cin][cout], dwconv1d [kernel][ch], dense [len * ch][units]
+        w, cin, cout = flatten(self.spec["weights"]), self.tin.ch, self.tout.ch
+        span = {"conv1d": self.kernel * cin, "dwconv1d": self.kernel, "dense": self.tin.len * cin}[self.op]
+        if len(w) != span * cout:
+            sys.exit(f"layer {self.index}: {len(w)} weights, expected {span * cout}")
+        self.weight = [[w[i * cout + o] for i in range(span)] for o in range(cout)]
+        self.bias = flatten(self.spec.get("bias", [0.0] * cout))
+        if len(self.bias) != cout:
+            sys.exit(f"layer {self.index}: bad bias")
+
+    def forward(self, x):
+        """Float reference, x is [len][ch]"""
+        tin, tout, k = self.tin, self.tout, self.kernel
+        if self.op == "dense":
+            flat = [v for row in x for v in row]
+            y = [[self.bias[o] + sum(a * b for a, b in zip(flat, self.weight[o])) for o in range(tout.ch)]]
+        elif self.op in ("conv1d", "dwconv1d"):
+            y = []
+            for t in range(tout.len):
+                taps = [x[p] if 0 <= p < tin.len else [0.0] * tin.ch
+                        for p in range(t * self.stride - self.pad, t * self.stride - self.pad + k)]
+                if self.op == "conv1d":
+                    col = [v for row in taps for v in row]
+                    y.append([self.bias[o] + sum(a * b for a, b in zip(col, self.weight[o]))
+                              for o in range(tout.ch)])
+                else:
+                    y.append([self.bias[c] + sum(taps[i][c] * self.weight[c][i] for i in range(k))
+                              for c in range(tout.ch)])
+        elif self.op in ("maxpool", "avgpool"):
+            y = []
+            for t in range(tout.len):
+                win = x[t * self.stride:t * self.stride + k]
+                y.append([max(r[c] for r in win) if self.op == "maxpool" else sum(r[c] for r in win) / k
+                          for c in range(tout.ch)])
+        elif self.op == "relu":
+            y = [[max(v, 0.0) for v in row] for row in x]
+        else:
+            y = []
+            for row in x:
+                e = [math.exp(v - max(row)) for v in row]
+                y.append([v / sum(e) for v in e])
+        if self.activation == "relu":
+            y = [[max(v, 0.0) for v in row] for row in y]
+        elif self.activation == "relu6":
+            y = [[min(max(v, 0.0), 6.0) for v in row] for row in y]
+        return y
+
+class Model:
+    def __init__(self, spec):
+        inp = spec["input"]
+        self.input = Tensor(inp["len"], inp["ch"])
+        self.input.range = (inp.get("min", 0.0), inp.get("max", 0.0))
+        self.layers, t = [], self.input
+        for i, ls in enumerate(spec["layers"]):
+            layer = Layer(ls, i, t)
+            self.layers.append(layer)
+            t = layer.tout
+        self.tensors = [self.input] + [l.tout for l in self.layers]
+        if len(self.tensors) > 255:
+            sys.exit("too many layers")
+
+    def forward(self, x):
+        outs = [x]
+        for layer in self.layers:
+            outs.append(layer.forward(outs[-1]))
+        return outs
+
+    def calibrate(self, samples):
+        """Ranges from the samples, or from min and max given in the layers"""
+        ranges = [list(self.input.range)] + [[l.spec.get("out_min", 0.0), l.spec.get("out_max", 0.0)]
+                                              for l in self.layers]
+        for x in samples:
+            for i, y in enumerate(self.forward(x)):
+                flat = [v for row in y for v in row]
+                ranges[i][0] = min(ranges[i][0], min(flat))
+                ranges[i][1] = max(ranges[i][1], max(flat))
+        t = self.input
+        t.scale, t.zero = quant_params(*ranges[0])
+        for layer, r in zip(self.layers, ranges[1:]):
+            if layer.op in WEIGHTED:
+                layer.tout.scale, layer.tout.zero = quant_params(*r)
+            elif layer.op == "softmax":
+                layer.tout.scale, layer.tout.zero = 1.0 / 256, -128
+            else:
+                layer.tout.scale, layer.tout.zero = layer.tin.scale, layer.tin.zero
+            if layer.op in WEIGHTED and r[1] <= r[0]:
+                sys.exit(f"layer {layer.index}: no output range, give out_min, out_max or --calibration")
+
+    def quantize(self):
+        for layer in self.layers:
+            tin, tout = layer.tin, layer.tout
+            layer.act = (-128, 127)
+            if layer.activation in ("relu", "relu6") or layer.op == "relu":
+                hi = 127
+                if layer.activation == "relu6":
+                    hi = min(127, tout.zero + round(6.0 / tout.scale))
+                layer.act = (max(-128, tout.zero), hi)
+            if layer.op in WEIGHTED:
+                layer.qweight, layer.qbias, layer.mult, layer.shift = [], [], [], []
+                for w, b in zip(layer.weight, layer.bias):
+                    ws = max(abs(v) for v in w) / 127 or 1.0
+                    q = [round(v / ws) for v in w]
+                    layer.qweight.append(q)
+                    # The input zero point is folded so kernels multiply raw int8 codes
+                    layer.qbias.append(round(b / (tin.scale * ws)) - tin.zero * sum(q))
+                    m, s = quantize_multiplier(tin.scale * ws / tout.scale)
+                    layer.mult.append(m)
+                    layer.shift.append(s)
+            if layer.op == "softmax":
+                layer.lut = [round(math.exp(-d * tin.scale) * 65536) for d in range(256)]
+
+    def plan(self):
+        """Greedy placement of buffers by size, sharing space when lifetimes are disjoint"""
+        n = len(self.layers)
+        buffers = []  # [size, first layer, last layer]
+        for i, t in enumerate(self.tensors):
+            layer = self.layers[i - 1] if i else None
+            if layer and layer.op == "relu":
+                t.buffer = layer.tin.buffer
+                buffers[t.buffer][2] = i
+            else:
+                t.buffer = len(buffers)
+                buffers.append([align4(t.len * t.ch), max(i - 1, 0), i])
+        buffers[self.tensors[-1].buffer][2] = n
+        for i, layer in enumerate(self.layers):
+            if layer.op == "conv1d":
+                layer.scratch_buffer = len(buffers)
+                buffers.append([align4(layer.kernel * layer.tin.ch), i, i])
+        offsets, placed = [0] * len(buffers), []
+        for b in sorted(range(len(buffers)), key=lambda b: -buffers[b][0]):
+            size, first, last = buffers[b]
+            offset = 0
+            for o, s, f, l in sorted(placed):
+                if f <= last and first <= l and offset + size > o and o + s > offset:
+                    offset = max(offset, o + s)
+            offsets[b] = offset
+            placed.append((offset, size, first, last))
+        for t in self.tensors:
+            t.offset = offsets[t.buffer]
+        for layer in self.layers:
+            layer.scratch = offsets[layer.scratch_buffer] if layer.op == "conv1d" else 0
+        self.arena = max(o + s for o, s, _, _ in placed)
+        naive = sum(b[0] for b in buffers)
+        return self.arena, naive
+
+def c_float(v):
+    s = f"{v:.9g}"
+    return s + ("f" if "." in s or "e" in s else ".0f")
+
+def c_array(ctype, name, values, per_line=16, align=False):
+    attr = " __attribute__((aligned(4)))" if align else ""
+    lines = [", ".join(str(v) for v in values[i:i + per_line]) for i in range(0, len(values), per_line)]
+    body = ",\n    ".join(lines)
+    return f"static const {ctype} {name}[]{attr} = {{\n    {body},\n}};\n\n"
+
+def emit(model, name, out_dir, source):
+    guard = f"_{name.upper()}_MODEL_H_"
+    with open(os.path.join(out_dir, f"{name}_model.h"), "w") as f:
+        f.write(f"/* Generated by tools/nn_convert.py from {source}, do not edit */\n")
+        f.write(f"#ifndef {guard}\n#define {guard}\n\n#include \"nn_int8.h\"\n\n")
+        f.write(f"#define {name.upper()}_ARENA_SIZE {model.arena}\n\n")
+        f.write(f"extern const NnModel {name}_model;\n\n#endif /* {guard} */\n")
+    with open(os.path.join(out_dir, f"{name}_model.c"), "w") as f:
+        f.write(f"/* Generated by tools/nn_convert.py from {source}, do not edit */\n")
+        f.write(f"#include \"{name}_model.h\"\n\n")
+        rows = []
+        for i, layer in enumerate(model.layers):
+            fields = [f".op = {OPS[layer.op]}", f".in = {i}", f".out = {i + 1}",
+                      f".kernel = {layer.kernel}", f".stride = {layer.stride}", f".pad = {layer.pad}",
+                      f".act_min = {layer.act[0]}", f".act_max = {layer.act[1]}"]
+            if layer.op == "conv1d":
+                fields.append(f".scratch = {layer.scratch}")
+            if layer.op in WEIGHTED:
+                if layer.op == "dwconv1d":
+                    # [kernel][ch] so four channels load as one word
+                    w = [layer.qweight[c][k] for k in range(layer.kernel) for c in range(layer.tout.ch)]
+                else:
+                    w = [v for q in layer.qweight for v in q + [0] * (align4(len(q)) - len(q))]
+                f.write(c_array("int8_t", f"l{i}_weight", w, align=True))
+                f.write(c_array("int32_t", f"l{i}_bias", layer.qbias, 8))
+                f.write(c_array("int32_t", f"l{i}_mult", layer.mult, 8))
+                f.write(c_array("int8_t", f"l{i}_shift", layer.shift))
+                fields += [f".weight = l{i}_weight", f".bias = l{i}_bias",
+                           f".mult = l{i}_mult", f".shift = l{i}_shift"]
+            if layer.op == "softmax":
+                f.write(c_array("uint32_t", f"l{i}_lut", layer.lut, 8))
+                fields.append(f".lut = l{i}_lut")
+            rows.append("    {" + ", ".join(fields) + "},\n")
+        f.write(f"static const NnTensor {name}_tensors[] = {{\n")
+        for t in model.tensors:
+            f.write(f"    {{.offset = {t.offset}, .len = {t.len}, .ch = {t.ch}, "
+                    f".scale = {c_float(t.scale)}, .zero = {t.zero}}},\n")
+        f.write(f"}};\n\nstatic const NnLayer {name}_layers[] = {{\n{''.join(rows)}}};\n\n")
+        f.write(f"const NnModel {name}_model = {{\n")
+        f.write(f"    .tensors    = {name}_tensors,\n    .layers     = {name}_layers,\n")
+        f.write(f"    .arena_size = {model.arena},\n    .tensor_num = {len(model.tensors)},\n")
+        f.write(f"    .layer_num  = {len(model.layers)},\n    .input      = 0,\n")
+        f.write(f"    .output     = {len(model.layers)},\n}};\n")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Quantize a 1D CNN to int8 tables for nn_int8")
+    parser.add_argument("model", help="json model: input {len, ch, min, max} and layers with float weights")
+    parser.add_argument("-n", "--name", help="C prefix, by default the model file name")
+    parser.add_argument("-o", "--out", default=".", help="output directory of NAME_model.c and .h")
+    parser.add_argument("-c", "--calibration", help="json list of [len][ch] inputs for activation ranges")
+    args = parser.parse_args()
+
+    with open(args.model) as f:
+        spec = json.load(f)
+    name = args.name or os.path.splitext(os.path.basename(args.model))[0]
+    samples = []
+    if args.calibration:
+        with open(args.calibration) as f:
+            samples = json.load(f)
+    model = Model(spec)
+    model.calibrate(samples)
+    model.quantize()
+    arena, naive = model.plan()
+    emit(model, name, args.out, os.path.basename(args.model))
+    weights = sum(len(l.qweight) * len(l.qweight[0]) for l in model.layers if l.op in WEIGHTED)
+    print(f"{name}: {len(model.layers)} layers, weights {weights} B, arena {arena} B "
+          f"({naive} B without sharing)")
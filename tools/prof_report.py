@@ -0,0 +1,117 @@
+import argparse
+import bisect
+import subprocess
+import sys
+from collections import Counter
+from html import escape
+
+NM = "riscv64-unknown-elf-nm"
+
+def load_symbols(elf, nm):
+    out = subprocess.run([nm, "-n", "-S", "-C", elf], capture_output=True, text=True, check=True).stdout
+    addrs, syms = [], []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        # With -S sized symbols are "addr size type name", others "addr type name"
+        if len(parts) == 4 and parts[2] in "tTwW":
+            addr, size, name = int(parts[0], 16), int(parts[1], 16), parts[3]
+        elif len(parts) == 3 and parts[1] in "tTwW":
+            addr, size, name = int(parts[0], 16), 0, parts[2]
+        else:
+            continue
+        addrs.append(addr)
+        syms.append((addr, size, name))
+    return addrs, syms
+
+def symbolize(pc, addrs, syms):
+    i = bisect.bisect_right(addrs, pc) - 1
+    if i < 0:
+        return f"0x{pc:08x}"
+    addr, size, name = syms[i]
+    if size and pc >= addr + size:
+        return f"0x{pc:08x}"
+    return name
+
+def parse_dump(path):
+    info = {"hz": 0, "samples": 0, "dropped": 0}
+    tasks = {0: "ISR"}
+    samples = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            # The dump may be mixed with other console output
+            parts = line.strip().split(None, 3)
+            if len(parts) == 4 and parts[0] == "#":
+                info["hz"], info["samples"], info["dropped"] = (int(p, 16) for p in parts[1:])
+            elif len(parts) >= 2 and parts[0] == "T":
+                tasks[int(parts[1], 16)] = " ".join(parts[2:]) or parts[1]
+            elif len(parts) == 4 and parts[0] == "S":
+                samples.append(tuple(int(p, 16) for p in parts[1:]))
+    return info, tasks, samples
+
+def flame_svg(folded, width=1200, row=18):
+    # Two levels only (task, function), so build the rectangles directly
+    total = sum(folded.values()) or 1
+    by_task = {}
+    for (task, func), count in folded.items():
+        by_task.setdefault(task, []).append((func, count))
+    rects = []
+    x = 0.0
+    for task, funcs in sorted(by_task.items(), key=lambda t: -sum(c for _, c in t[1])):
+        task_total = sum(c for _, c in funcs)
+        rects.append((x, 0, task_total, task))
+        fx = x
+        for func, count in sorted(funcs, key=lambda f: -f[1]):
+            rects.append((fx, 1, count, func))
+            fx += count
+        x += task_total
+    height = row * 3
+    out = [f'<svg xmlns="http://www.w3.org/2000/svg" width="{width}" height="{height}" '
+           f'font-family="monospace" font-size="11">']
+    for pos, level, count, name in rects:
+        rx = pos * width / total
+        rw = count * width / total
+        ry = height - row * (level + 2) + row
+        hue = 20 + (sum(name.encode()) % 40)
+        label = escape(name) if rw > 40 else ""
+        pct = 100.0 * count / total
+        out.append(f'<g><title>{escape(name)} ({count} samples, {pct:.1f}%)</title>'
+                   f'<rect x="{rx:.1f}" y="{ry}" width="{rw:.1f}" height="{row - 1}" '
+                   f'fill="hsl({hue},90%,60%)"/>'
+                   f'<text x="{rx + 2:.1f}" y="{ry + row - 5}">{label[:int(rw / 7)]}</text></g>')
+    out.append("</svg>")
+    return "\n".join(out)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Symbolize a profiler dump and build a flat profile and flame graph")
+    parser.add_argument("dump", help="text dump printed by profiler_dump")
+    parser.add_argument("elf", help="firmware elf, e.g. build/qemu.out")
+    parser.add_argument("--nm", default=NM, help="nm of the riscv toolchain")
+    parser.add_argument("-n", "--top", type=int, default=30, help="functions in the flat profile")
+    parser.add_argument("-f", "--folded", default="prof.folded", help="folded stacks for flamegraph.pl")
+    parser.add_argument("-s", "--svg", default="prof.svg", help="flame graph svg")
+    args = parser.parse_args()
+
+    info, tasks, samples = parse_dump(args.dump)
+    if not samples:
+        sys.exit("no samples found in dump")
+    addrs, syms = load_symbols(args.elf, args.nm)
+
+    flat = Counter()
+    folded = Counter()
+    for pc, task, count in samples:
+        func = symbolize(pc, addrs, syms)
+        flat[func] += count
+        folded[(tasks.get(task, f"task_{task:08x}"), func)] += count
+
+    total = sum(flat.values())
+    print(f"rate: {info['hz']} Hz  samples: {total}  dropped: {info['dropped']}")
+    print(f"{'samples':>8} {'self%':>6}  function")
+    for func, count in flat.most_common(args.top):
+        print(f"{count:8d} {100.0 * count / total:6.2f}  {func}")
+
+    with open(args.folded, "w") as f:
+        for (task, func), count in sorted(folded.items()):
+            f.write(f"{task};{func} {count}\n")
+    with open(args.svg, "w") as f:
+        f.write(flame_svg(folded))
+    print(f"folded stacks in {args.folded}, flame graph in {args.svg}")
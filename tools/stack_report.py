@@ -0,0 +1,158 @@
+import argparse
+import fnmatch
+import glob
+import os
+import re
+import subprocess
+import sys
+
+OBJDUMP = "riscv64-unknown-elf-objdump"
+# Must match CONFIG_STACK_PROFILE_MARGIN and STACK_PROFILE_SLACK of stack_profile.h
+MARGIN = 25
+SLACK = 128
+
+FUNC_RE = re.compile(r"^[0-9a-f]+ <([^>]+)>:$")
+CALL_RE = re.compile(r"\s(jal|call|j|tail)\s+(?:[a-z0-9]+,\s*)?[0-9a-f]+ <([^>+]+)>")
+
+def load_su(root):
+    # Lines are "file:line:col:function<TAB>bytes<TAB>static|dynamic[,bounded]"
+    frames, dynamic = {}, set()
+    for path in glob.glob(os.path.join(root, "**", "*.su"), recursive=True):
+        with open(path, errors="replace") as f:
+            for line in f:
+                parts = line.rstrip("\n").split("\t")
+                if len(parts) != 3:
+                    continue
+                func = parts[0].rsplit(":", 1)[-1]
+                frames[func] = max(frames.get(func, 0), int(parts[1]))
+                if parts[2].startswith("dynamic") and "bounded" not in parts[2]:
+                    dynamic.add(func)
+    return frames, dynamic
+
+def load_calls(elf, objdump):
+    out = subprocess.run([objdump, "-d", "--no-show-raw-insn", elf],
+                         capture_output=True, text=True, check=True).stdout
+    calls, indirect = {}, set()
+    func = None
+    for line in out.splitlines():
+        m = FUNC_RE.match(line)
+        if m:
+            func = m.group(1)
+            calls.setdefault(func, set())
+            continue
+        if func is None:
+            continue
+        m = CALL_RE.search(line)
+        # Jumps to a label of the same function carry "+offset" and do not match
+        if m and m.group(2) != func:
+            calls[func].add(m.group(2))
+        elif "\tjalr" in line:
+            indirect.add(func)
+    return calls, indirect
+
+class CallGraph:
+    def __init__(self, frames, dynamic, calls, indirect):
+        self.frames, self.dynamic = frames, dynamic
+        self.calls, self.indirect = calls, indirect
+        self.memo, self.reached = {}, {}
+
+    def reach(self, func):
+        """Functions reachable from func, func itself only through a cycle"""
+        if func not in self.reached:
+            seen, todo = set(), list(self.calls.get(func, ()))
+            while todo:
+                f = todo.pop()
+                if f not in seen:
+                    seen.add(f)
+                    todo.extend(self.calls.get(f, ()))
+            self.reached[func] = frozenset(seen)
+        return self.reached[func]
+
+    def worst(self, func, active=None):
+        """Worst stack depth below func and its chain, cycles are cut"""
+        active = set() if active is None else active
+        # The cut depends on the callers on the path that func can reach again
+        key = (func, frozenset(active & self.reach(func)))
+        if key in self.memo:
+            return self.memo[key]
+        active.add(func)
+        best, chain = 0, []
+        for callee in sorted(self.calls.get(func, ())):
+            if callee in active:
+                continue
+            depth, sub = self.worst(callee, active)
+            if depth > best:
+                best, chain = depth, sub
+        active.discard(func)
+        result = (self.frames.get(func, 0) + best, [func] + chain)
+        self.memo[key] = result
+        return result
+
+    def flags(self, chain):
+        notes = []
+        if any(f in self.dynamic for f in chain):
+            notes.append("dynamic frame")
+        if any(f in self.indirect for f in chain):
+            notes.append("indirect call")
+        if any(f not in self.frames for f in chain):
+            notes.append("no .su")
+        return ", ".join(notes)
+
+def parse_dump(path):
+    rows = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            # The dump may be mixed with other console output
+            parts = line.split()
+            if len(parts) == 6 and parts[0] == "K":
+                rows.append((parts[1], *(int(p) for p in parts[2:])))
+    return rows
+
+def recommend(used):
+    size = used + used * MARGIN // 100 + SLACK
+    return (size + 15) // 16 * 16 // 4
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Combine stack_profile_dump with -fstack-usage worst cases")
+    parser.add_argument("dump", help="text dump printed by stack_profile_dump")
+    parser.add_argument("elf", help="firmware elf, e.g. build/qemu.out")
+    parser.add_argument("--su", default=".", help="build directory holding the .su files (cmake -DSTACK_USAGE=ON)")
+    parser.add_argument("--objdump", default=OBJDUMP, help="objdump of the riscv toolchain")
+    parser.add_argument("-t", "--task", action="append", default=[], metavar="NAME=FUNC",
+                        help="entry function of a task, by default the function named like the task")
+    parser.add_argument("--isr", default="*_handler", help="pattern of interrupt handler names")
+    parser.add_argument("-c", "--chains", action="store_true", help="print the worst call chain of each task")
+    args = parser.parse_args()
+
+    rows = parse_dump(args.dump)
+    if not rows:
+        sys.exit("no stack lines found in dump")
+    frames, dynamic = load_su(args.su)
+    if not frames:
+        print("warning: no .su files found, static depths are 0", file=sys.stderr)
+    graph = CallGraph(frames, dynamic, *load_calls(args.elf, args.objdump))
+    entries = dict(t.split("=", 1) for t in args.task)
+
+    print(f"{'task':<16} {'size':>6} {'used':>6} {'static':>6} {'words':>6} {'now':>6}  notes")
+    saved = 0
+    for name, size, used, free, _ in rows:
+        if name == "isr":
+            # Nested interrupts may add up, the deepest handler is a lower bound
+            roots = [f for f in graph.calls if fnmatch.fnmatch(f, args.isr)]
+        else:
+            roots = [entries.get(name, name)]
+        static, chain = max((graph.worst(r) for r in roots if r in graph.calls), default=(0, []))
+        if not size:
+            print(f"{name:<16} {'?':>6} {'?':>6} {static:6d} {'':>6} {'':>6}  free {free}")
+            continue
+        words = recommend(max(used, static))
+        notes = graph.flags(chain) if chain else "entry not found"
+        print(f"{name:<16} {size:6d} {used:6d} {static:6d} {words:6d} {size // 4:6d}  {notes}")
+        if words * 4 < size:
+            saved += size - words * 4
+        if args.chains and chain:
+            depth = 0
+            for func in chain:
+                depth += frames.get(func, 0)
+                print(f"    {frames.get(func, 0):5d} {depth:6d}  {func}")
+    print(f"reclaimable with the recommended sizes: {saved} bytes")
@@ -0,0 +1,137 @@
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x43525456
+BLK_INFO = 0
+BLK_TASKS = 1
+BLK_RECORDS = 2
+
+EVT_TASK_IN = 1
+EVT_TASK_OUT = 2
+EVT_ISR_ENTER = 3
+EVT_ISR_EXIT = 4
+EVT_QUEUE_SEND = 5
+EVT_QUEUE_RECV = 6
+EVT_MALLOC = 7
+EVT_FREE = 8
+EVT_TASK_CREATE = 9
+EVT_USER = 10
+
+ISR_TID = 1
+PID = 1
+
+def parse_blocks(data):
+    info = {"cpu_hz": 0, "dropped": 0}
+    names = {}
+    records = []
+    pos = 0
+    while pos + 8 <= len(data):
+        magic, btype, count = struct.unpack_from("<IHH", data, pos)
+        if magic != TRACE_MAGIC:
+            # Resync on the next block, e.g. after a lost stream frame
+            pos += 1
+            continue
+        pos += 8
+        body = data[pos:pos + count * 16]
+        if len(body) < count * 16:
+            break
+        pos += count * 16
+        for i in range(count):
+            entry = body[i * 16:(i + 1) * 16]
+            if btype == BLK_INFO:
+                info["cpu_hz"], dropped = struct.unpack_from("<II", entry)
+                info["dropped"] = max(info["dropped"], dropped)
+            elif btype == BLK_TASKS:
+                tcb = struct.unpack_from("<I", entry)[0]
+                names[tcb] = entry[4:].split(b"\0")[0].decode(errors="replace")
+            elif btype == BLK_RECORDS:
+                ts_lo, ts_hi, etype, _, obj, arg = struct.unpack("<IHBBII", entry)
+                records.append(((ts_hi << 32) | ts_lo, etype, obj, arg))
+    return info, names, records
+
+def to_chrome(info, names, records):
+    if not info["cpu_hz"]:
+        sys.exit("no info block found, cpu frequency unknown")
+    scale = 1e6 / info["cpu_hz"]
+    events = []
+    base = records[0][0] if records else 0
+
+    def us(ts):
+        return (ts - base) * scale
+
+    def task_name(tcb):
+        return names.get(tcb, f"task_{tcb:08x}")
+
+    tids = {}
+
+    def tid(tcb):
+        if tcb not in tids:
+            tids[tcb] = len(tids) + 2
+            events.append({"ph": "M", "pid": PID, "tid": tids[tcb], "name": "thread_name",
+                           "args": {"name": task_name(tcb)}})
+        return tids[tcb]
+
+    events.append({"ph": "M", "pid": PID, "name": "process_name", "args": {"name": "n309"}})
+    events.append({"ph": "M", "pid": PID, "tid": ISR_TID, "name": "thread_name",
+                   "args": {"name": "ISR"}})
+
+    running = None
+    run_start = 0
+    isr_stack = []
+    heap = 0
+    # A slice ends when another task is switched in, TASK_OUT carries no extra information
+    for ts, etype, obj, arg in records:
+        if etype == EVT_TASK_IN:
+            if running is not None and running != obj:
+                events.append({"ph": "X", "pid": PID, "tid": tid(running), "name": task_name(running),
+                               "ts": us(run_start), "dur": us(ts) - us(run_start)})
+            if running != obj:
+                run_start = ts
+            running = obj
+        elif etype == EVT_ISR_ENTER:
+            isr_stack.append((obj, ts))
+        elif etype == EVT_ISR_EXIT:
+            if isr_stack:
+                irq, start = isr_stack.pop()
+                events.append({"ph": "X", "pid": PID, "tid": ISR_TID, "name": f"IRQ {irq}",
+                               "ts": us(start), "dur": us(ts) - us(start)})
+        elif etype in (EVT_QUEUE_SEND, EVT_QUEUE_RECV):
+            name = "send" if etype == EVT_QUEUE_SEND else "recv"
+            owner = tid(running) if running is not None else ISR_TID
+            events.append({"ph": "i", "s": "t", "pid": PID, "tid": owner,
+                           "name": f"queue {name}", "ts": us(ts),
+                           "args": {"queue": f"0x{obj:08x}", "waiting": arg}})
+        elif etype in (EVT_MALLOC, EVT_FREE):
+            heap += arg if etype == EVT_MALLOC else -arg
+            events.append({"ph": "C", "pid": PID, "name": "heap", "ts": us(ts),
+                           "args": {"bytes": heap}})
+        elif etype == EVT_TASK_CREATE:
+            events.append({"ph": "i", "s": "p", "pid": PID, "name": f"create {task_name(obj)}",
+                           "ts": us(ts)})
+        elif etype == EVT_USER:
+            owner = tid(running) if running is not None else ISR_TID
+            events.append({"ph": "i", "s": "t", "pid": PID, "tid": owner, "name": f"user {obj}",
+                           "ts": us(ts), "args": {"value": arg}})
+
+    if running is not None and records:
+        end = records[-1][0]
+        events.append({"ph": "X", "pid": PID, "tid": tid(running), "name": task_name(running),
+                       "ts": us(run_start), "dur": us(end) - us(run_start)})
+    return {"traceEvents": events, "displayTimeUnit": "ns",
+            "metadata": {"dropped_records": info["dropped"], "cpu_hz": info["cpu_hz"]}}
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Convert a trace_recorder dump to Chrome/Perfetto JSON")
+    parser.add_argument("dump", help="binary dump or uart_stream channel file")
+    parser.add_argument("-o", "--out", default="trace.json", help="output JSON file")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        info, names, records = parse_blocks(f.read())
+    records.sort(key=lambda r: r[0])
+    with open(args.out, "w") as f:
+        json.dump(to_chrome(info, names, records), f)
+    print(f"records: {len(records)}  tasks: {len(names)}  dropped: {info['dropped']}")
+    print(f"open {args.out} in https://ui.perfetto.dev or chrome://tracing")
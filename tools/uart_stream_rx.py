@@ -0,0 +1,119 @@
+import argparse
+import os
+import struct
+import sys
+import time
+
+import serial
+
+FRAME_DATA = 0
+FRAME_BAUD = 1
+FRAME_TEXT = 2
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+class StreamWriter:
+    def __init__(self, out_dir):
+        self.out_dir = out_dir
+        self.files = {}
+        self.expected_seq = None
+        self.frames = 0
+        self.lost = 0
+        self.bad = 0
+        self.bytes = 0
+
+    def channel_file(self, channel):
+        if channel not in self.files:
+            path = os.path.join(self.out_dir, f"ch{channel}.bin")
+            self.files[channel] = open(path, "wb")
+        return self.files[channel]
+
+    def frame(self, raw):
+        frame = cobs_decode(raw)
+        if frame is None or len(frame) < 6:
+            self.bad += 1
+            return None
+        body, crc = frame[:-2], struct.unpack("<H", frame[-2:])[0]
+        if crc16_ccitt(body) != crc:
+            self.bad += 1
+            return None
+
+        seq, channel, ftype = struct.unpack("<HBB", body[:4])
+        payload = body[4:]
+        if self.expected_seq is not None and seq != self.expected_seq:
+            self.lost += (seq - self.expected_seq) & 0xFFFF
+        self.expected_seq = (seq + 1) & 0xFFFF
+        self.frames += 1
+
+        if ftype == FRAME_DATA:
+            self.channel_file(channel).write(payload)
+            self.bytes += len(payload)
+        elif ftype == FRAME_TEXT:
+            print(f"[text] {payload.decode(errors='replace')}")
+        elif ftype == FRAME_BAUD and len(payload) == 4:
+            return struct.unpack("<I", payload)[0]
+        return None
+
+    def close(self):
+        for f in self.files.values():
+            f.close()
+
+def receive(port, baud, out_dir, duration):
+    os.makedirs(out_dir, exist_ok=True)
+    writer = StreamWriter(out_dir)
+    ser = serial.Serial(port, baud, timeout=0.1)
+    pending = bytearray()
+    start = time.time()
+    try:
+        while duration <= 0 or time.time() - start < duration:
+            pending += ser.read(max(1, ser.in_waiting))
+            while True:
+                end = pending.find(b"\x00")
+                if end < 0:
+                    break
+                raw, pending = bytes(pending[:end]), pending[end + 1:]
+                if not raw:
+                    continue
+                new_baud = writer.frame(raw)
+                if new_baud:
+                    print(f"switch baud rate to {new_baud}")
+                    ser.baudrate = new_baud
+                    pending.clear()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        ser.close()
+        writer.close()
+
+    elapsed = max(time.time() - start, 1e-6)
+    print(f"frames: {writer.frames}  lost: {writer.lost}  bad: {writer.bad}")
+    print(f"payload: {writer.bytes} B  rate: {writer.bytes / elapsed / 1024:.1f} KB/s")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Receive uart_stream frames into per-channel files")
+    parser.add_argument("port", help="serial port, e.g. /dev/ttyUSB0 or COM3")
+    parser.add_argument("-b", "--baud", type=int, default=115200, help="initial baud rate")
+    parser.add_argument("-o", "--out", default="capture", help="output directory")
+    parser.add_argument("-t", "--time", type=float, default=0, help="capture time in seconds, 0 for Ctrl-C")
+    args = parser.parse_args()
+    receive(args.port, args.baud, args.out, args.time)
+    sys.exit(0)